@@ -60,7 +60,10 @@ void App_Init(void)
 
     magStrip_Init();
     display_init();
-    dispBus_init();
+    if (!dispBus_init()) {
+        while (1) {
+        }
+    }
 
     systick_ok = SysTick_Init(0,
                               SYSTEM_CORE_CLOCK_HZ /
@@ -1,4 +1,5 @@
 #include <drv/dma.h>
+#include <string.h>
 #include "MK64F12.h"
 #include "hardware.h"
 
@@ -13,7 +14,16 @@ typedef struct
 
 static dma_state_t dma_ch_states[DMA_NUM_CH];
 
+#if DMA_TCD_POOL_SIZE > 32
+#error "DMA_TCD_POOL_SIZE must be at most 32"
+#endif
+
+static dma_tcd_t tcd_pool[DMA_TCD_POOL_SIZE];
+static uint32_t tcd_pool_used;      // one bit per taken descriptor
+
 static int size2code(uint8_t bytes);
+static void channel_setup(const dma_cfg_t *cfg);
+static void tcd_write(uint8_t ch, const dma_tcd_t *tcd);
 static void DMA_IRQHandler(uint8_t ch);
 
 int DMA_Init(void)
@@ -44,60 +54,137 @@ int DMA_Config(const dma_cfg_t *cfg)
     {
         return -1;
     }
-    // Disarm b4 configuring
-    DMA0->CERQ = DMA_CERQ_CERQ(cfg->ch);
+    dma_tcd_t tcd;
+    int err = DMA_TcdSet(&tcd, cfg);
+    if (err)
+    {
+        return err;
+    }
 
-    // Remember config
-    dma_ch_states[ch].on_major_cb = cfg->on_major;
-    dma_ch_states[ch].user_param = cfg->user;
+    channel_setup(cfg);
+    tcd_write(ch, &tcd);
+    return 0;
+}
 
-	// Clear all the pending events
-	NVIC_ClearPendingIRQ(DMA0_IRQn + ch);
-	// Enable the DMA interrupts
-	NVIC_EnableIRQ(DMA0_IRQn + ch);
+int DMA_ConfigChain(const dma_cfg_t *cfg, const dma_tcd_t *first)
+{
+    int ch = cfg->ch;
+    if (ch >= DMA_NUM_CH || first == NULL)
+    {
+        return -1;
+    }
 
-    // Enable the eDMA channel 0 and set the PORTC as the DMA request source
-	DMAMUX->CHCFG[ch] |= DMAMUX_CHCFG_ENBL_MASK 
-                        |DMAMUX_CHCFG_SOURCE((uint8_t)cfg->request_src);
+    channel_setup(cfg);
+    tcd_write(ch, first);
+    return 0;
+}
 
-    // -------------- TCD setup ----------------------
-    DMA0->TCD[ch].SADDR= (uint32_t)(cfg->saddr);
-	DMA0->TCD[ch].DADDR = (uint32_t)(cfg->daddr);
+int DMA_TcdLoad(uint8_t ch, const dma_tcd_t *tcd)
+{
+    if (ch >= DMA_NUM_CH || tcd == NULL)
+    {
+        return -1;
+    }
+    tcd_write(ch, tcd);
+    return 0;
+}
 
-    /* Set an offset for source and destination address. */
-	DMA0->TCD[ch].SOFF =cfg->soff;
-	DMA0->TCD[ch].DOFF =cfg->doff;
+int DMA_TcdSet(dma_tcd_t *tcd, const dma_cfg_t *cfg)
+{
+    int size = size2code(cfg->elem_size);
+    if (size < 0)
+    {
+        return -2;
+    }
+    // With ELINK set, CITER/BITER lose their top 6 bits to LINKCH
+    uint16_t max_count = cfg->link_minor ? DMA_CITER_ELINKYES_CITER_MASK
+                                         : DMA_CITER_ELINKNO_CITER_MASK;
+    if (cfg->major_count == 0 || cfg->major_count > max_count)
+    {
+        return -2;
+    }
+    if ((cfg->link_minor && cfg->link_minor_ch >= DMA_NUM_CH) ||
+        (cfg->link_major && cfg->link_major_ch >= DMA_NUM_CH))
+    {
+        return -1;
+    }
 
-	/* Set source and destination data transfer size to 16 bits (CnV is 2 bytes wide). */
-	DMA0->TCD[0].ATTR = DMA_ATTR_SSIZE(1) | DMA_ATTR_DSIZE(1);
-	//////////jacoby
+    tcd->saddr = (uint32_t)(cfg->saddr);
+    tcd->daddr = (uint32_t)(cfg->daddr);
+    tcd->soff = cfg->soff;
+    tcd->doff = cfg->doff;
+    tcd->attr = DMA_ATTR_SSIZE(size) | DMA_ATTR_DSIZE(size);
+    tcd->nbytes = cfg->elem_size;
+    tcd->slast = cfg->slast;
+    tcd->dlast_sga = cfg->dlast;
 
-	/*DMA0->TCD[ch].ATTR = DMA_ATTR_SSIZE(size2code(cfg->elem_size))
-                        |DMA_ATTR_DSIZE(size2code(cfg->elem_size));
-	*/
-	/*Number of bytes to be transfered in each service request of the channel.*/
-	DMA0->TCD[ch].NBYTES_MLNO= cfg->elem_size;
+    if (cfg->link_minor)
+    {
+        // The last minor loop fires the major link instead (if any)
+        tcd->citer = DMA_CITER_ELINKYES_ELINK_MASK
+                    |DMA_CITER_ELINKYES_LINKCH(cfg->link_minor_ch)
+                    |DMA_CITER_ELINKYES_CITER(cfg->major_count);
+        tcd->biter = DMA_BITER_ELINKYES_ELINK_MASK
+                    |DMA_BITER_ELINKYES_LINKCH(cfg->link_minor_ch)
+                    |DMA_BITER_ELINKYES_BITER(cfg->major_count);
+    }
+    else
+    {
+        tcd->citer = DMA_CITER_ELINKNO_CITER(cfg->major_count);
+        tcd->biter = DMA_BITER_ELINKNO_BITER(cfg->major_count);
+    }
 
-	/* Current major iteration count. */
-	DMA0->TCD[ch].CITER_ELINKNO = DMA_CITER_ELINKNO_CITER(cfg->major_count);
-	DMA0->TCD[ch].BITER_ELINKNO = DMA_BITER_ELINKNO_BITER(cfg->major_count);
+    uint16_t csr = 0;
+    if (cfg->int_major)
+    {
+        csr |= DMA_CSR_INTMAJOR_MASK;	//Enable Major Interrupt.
+    }
+    if (cfg->link_major)
+    {
+        csr |= DMA_CSR_MAJORELINK_MASK | DMA_CSR_MAJORLINKCH(cfg->link_major_ch);
+    }
+    tcd->csr = csr;
 
-	/* Address for the next TCD to be loaded in the scatter/gather mode. */
-	//	tcd[TCD0].SLAST = 0;			// Source address adjustment not used.
-	//	tcd[TCD0].DLASTSGA = (uint32_t)&tcd[TCD1];	// The tcd[TCD1] is the next TCD to be loaded.
+    return 0;
+}
 
-	DMA0->TCD[ch].SLAST = cfg->slast;
-	DMA0->TCD[ch].DLAST_SGA = cfg->dlast;
+int DMA_TcdLink(dma_tcd_t *tcd, const dma_tcd_t *next)
+{
+    if (next == NULL)
+    {
+        tcd->dlast_sga = 0;
+        tcd->csr = (tcd->csr & ~DMA_CSR_ESG_MASK) | DMA_CSR_DREQ_MASK;
+        return 0;
+    }
+    if ((uint32_t)next & 31u)
+    {
+        return -2;
+    }
+    tcd->dlast_sga = (int32_t)(uint32_t)next;
+    tcd->csr = (tcd->csr & ~DMA_CSR_DREQ_MASK) | DMA_CSR_ESG_MASK;
+    return 0;
+}
 
-	/* Setup control and status register. */
-    if (cfg->int_major)
+dma_tcd_t *DMA_TcdAlloc(void)
+{
+    for (uint32_t i = 0; i < DMA_TCD_POOL_SIZE; i++)
     {
-	    DMA0->TCD[ch].CSR = DMA_CSR_INTMAJOR_MASK;	//Enable Major Interrupt.
+        if (!(tcd_pool_used & (1u << i)))
+        {
+            tcd_pool_used |= 1u << i;
+            memset(&tcd_pool[i], 0, sizeof(tcd_pool[i]));
+            return &tcd_pool[i];
+        }
     }
-    //dani
-    DMA0->ERQ = DMA_ERQ_ERQ0_MASK;
+    return NULL;
+}
 
-    return 0;
+void DMA_TcdFree(dma_tcd_t *tcd)
+{
+    if (tcd >= &tcd_pool[0] && tcd < &tcd_pool[DMA_TCD_POOL_SIZE])
+    {
+        tcd_pool_used &= ~(1u << (uint32_t)(tcd - tcd_pool));
+    }
 }
 
 int DMA_Start(uint8_t ch)
@@ -136,6 +223,48 @@ static int size2code(uint8_t bytes)
     return -1;
 }
 
+static void channel_setup(const dma_cfg_t *cfg)
+{
+    int ch = cfg->ch;
+
+    // Disarm b4 configuring
+    DMA0->CERQ = DMA_CERQ_CERQ(ch);
+
+    // Remember config
+    dma_ch_states[ch].on_major_cb = cfg->on_major;
+    dma_ch_states[ch].user_param = cfg->user;
+
+	// Clear all the pending events
+	NVIC_ClearPendingIRQ(DMA0_IRQn + ch);
+	// Enable the DMA interrupts
+	NVIC_EnableIRQ(DMA0_IRQn + ch);
+
+    // Enable the eDMA channel and set the DMA request source. Written, not
+    // ORed: a source left from an earlier config would mix into the new one
+    DMAMUX->CHCFG[ch] = 0;
+	DMAMUX->CHCFG[ch] = DMAMUX_CHCFG_ENBL_MASK
+                        |DMAMUX_CHCFG_SOURCE((uint8_t)cfg->request_src);
+}
+
+static void tcd_write(uint8_t ch, const dma_tcd_t *tcd)
+{
+    // CSR first: DONE has to be clear before ESG/MAJORELINK can be written
+    DMA0->TCD[ch].CSR = 0;
+    DMA0->CDNE = DMA_CDNE_CDNE(ch);
+
+    DMA0->TCD[ch].SADDR = tcd->saddr;
+    DMA0->TCD[ch].SOFF = tcd->soff;
+    DMA0->TCD[ch].ATTR = tcd->attr;
+    DMA0->TCD[ch].NBYTES_MLNO = tcd->nbytes;
+    DMA0->TCD[ch].SLAST = tcd->slast;
+    DMA0->TCD[ch].DADDR = tcd->daddr;
+    DMA0->TCD[ch].DOFF = tcd->doff;
+    DMA0->TCD[ch].CITER_ELINKNO = tcd->citer;   // raw, may carry ELINKYES fields
+    DMA0->TCD[ch].DLAST_SGA = tcd->dlast_sga;
+    DMA0->TCD[ch].BITER_ELINKNO = tcd->biter;
+    DMA0->TCD[ch].CSR = tcd->csr;
+}
+
 static void DMA_IRQHandler(uint8_t ch)
 {
 	/* Clear the interrupt flag. */
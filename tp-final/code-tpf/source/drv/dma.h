@@ -6,6 +6,10 @@
 
 #define DMA_NUM_CH 16
 
+#ifndef DMA_TCD_POOL_SIZE
+#define DMA_TCD_POOL_SIZE 4u      // RAM descriptors for scatter-gather chains (max 32)
+#endif
+
 #define FTM_DMA_ON  1
 #define FTM_DMA_OFF 0
 
@@ -101,11 +105,53 @@ typedef struct
     dma_cb_t on_major;      // may be NULL
     //dma_cb_t on_half;       // may be NULL
     void *user;             // user cookie for both callbacks
+    bool link_minor;        // request link_minor_ch after each minor loop (major_count <= 511)
+    uint8_t link_minor_ch;
+    bool link_major;        // request link_major_ch when the major loop ends
+    uint8_t link_major_ch;
 } dma_cfg_t;
 
+// RAM copy of a hardware TCD. The eDMA loads it whole when the previous
+// descriptor's major loop ends (scatter-gather), so it must be 32-byte aligned
+// and left alone while the chain runs.
+typedef struct __attribute__((aligned(32)))
+{
+    uint32_t saddr;
+    int16_t soff;
+    uint16_t attr;
+    uint32_t nbytes;
+    int32_t slast;
+    uint32_t daddr;
+    int16_t doff;
+    uint16_t citer;         // carries ELINK/LINKCH when minor-linked
+    int32_t dlast_sga;      // DLAST, or next descriptor address with ESG
+    uint16_t csr;
+    uint16_t biter;
+} dma_tcd_t;
+
+_Static_assert(sizeof(dma_tcd_t) == 32u, "dma_tcd_t must match the hardware TCD");
+
 int DMA_Init(void);                     // clocks, NVIC
 int DMA_Config(const dma_cfg_t *cfg);   // write TCD + DMAMUX
 int DMA_Start(uint8_t ch);              // set ERQ (arm)
 int DMA_Stop(uint8_t ch);               // clear ERQ (disarm)
 
+// Descriptor pool, init-time only (not reentrant). Alloc returns a zeroed TCD or NULL.
+dma_tcd_t *DMA_TcdAlloc(void);
+void DMA_TcdFree(dma_tcd_t *tcd);
+
+// Encode the transfer part of cfg (ch, request_src and callbacks are ignored).
+// The result ends a chain. Returns -1 for a bad linked channel, -2 for a bad size/count.
+int DMA_TcdSet(dma_tcd_t *tcd, const dma_cfg_t *cfg);
+
+// Load next when tcd's major loop ends (overwrites tcd's dlast). next == NULL
+// makes tcd the last one: DREQ disarms the channel when it completes.
+int DMA_TcdLink(dma_tcd_t *tcd, const dma_tcd_t *next);
+
+// DMAMUX, NVIC and callbacks from cfg, transfer from first.
+int DMA_ConfigChain(const dma_cfg_t *cfg, const dma_tcd_t *first);
+
+// Re-arm an already configured, idle channel with a prebuilt descriptor.
+int DMA_TcdLoad(uint8_t ch, const dma_tcd_t *tcd);
+
 #endif
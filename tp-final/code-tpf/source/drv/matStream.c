@@ -29,6 +29,8 @@ uint16_t duty_cycles[DUTY_BUFFER_SIZE]; //64*24+1 local array containing the dat
 
 uint8_t sendingDMA = 0;
 
+static dma_tcd_t *ws_tcd;   // whole-frame transfer, reloaded by WS2812_Update
+
 
 void WS2812_FrameDone(void);
 
@@ -55,7 +57,7 @@ void WS2812_FrameDone(void)
 }
 
 
-void dispBus_init(void)
+bool dispBus_init(void)
 {
     FTM_Init();
     DMA_Init();
@@ -67,7 +69,7 @@ void dispBus_init(void)
     }
     //config dma source and stop
 
-    dma_cfg_t cfg;
+    dma_cfg_t cfg = {0};
 
     cfg.ch           = 0;                          //DMA 0 
     cfg.request_src  = DMA_REQ_FTM3CH0;            // Source FTM3_CH0
@@ -85,28 +87,27 @@ void dispBus_init(void)
 
     DMA_Config(&cfg);
     NVIC_SetPriority(DMA0_IRQn, CPU_CFG_KA_IPL_BOUNDARY);
+
+    // Keep the frame transfer as a descriptor so each update only reloads it
+    ws_tcd = DMA_TcdAlloc();
+    if (ws_tcd == NULL)
+    {
+        return false;   // pool exhausted
+    }
+    if (DMA_TcdSet(ws_tcd, &cfg) != 0)
+    {
+        DMA_TcdFree(ws_tcd);
+        ws_tcd = NULL;
+        return false;
+    }
+    return true;
 }
 
 
 void WS2812_Update(void)
 {
     //lleno el buffer?
-    dma_cfg_t cfg;
-
-    cfg.ch           = 0;                          //DMA 0 
-    cfg.request_src  = DMA_REQ_FTM3CH0;            // Source correcto para FTM3_CH0
-    cfg.saddr        = duty_cycles;                // Origin
-    cfg.daddr        = (void*)&(FTM3->CONTROLS[0].CnV);  // to: CnV
-    cfg.elem_size    = 2;                          // 16-bit (CnV es de 16 bits)
-    cfg.soff         = 2;                          // Move 2 bytes on source
-    cfg.doff         = 0;                          // always write to cnv
-    cfg.major_count  = DUTY_BUFFER_SIZE;                // # of elements
-    cfg.slast        = - (int32_t)(DUTY_BUFFER_SIZE * 2);   // back to begining
-    cfg.dlast        = 0;                              // fixed adress
-    cfg.int_major    = true;  
-    cfg.on_major = (void*) WS2812_FrameDone;   // <-- callback
-    cfg.user = NULL;
-    DMA_Config(&cfg);
+    DMA_TcdLoad(0, ws_tcd);
 
     sendingDMA=1;
     DMA_Start(0);
@@ -1,6 +1,7 @@
 #ifndef MATSTREAM_H
 #define MATSTREAM_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -47,9 +48,12 @@ void loadDisplay(uint32_t * word, size_t n);
  *   - Transfer size  : 16 bits
  *   - Interrupt      : Major loop completion
  *
+ * @return true on success, false if no DMA descriptor could be allocated
+ *         (WS2812_Update() must not be called then).
+ *
  * @note Call this function once during system initialization before updating
  *       the LED matrix or starting a DMA transfer.
  */
-void dispBus_init(void);
+bool dispBus_init(void);
 
 #endif
@@ -23,7 +23,8 @@ int main (void)
     hw_DisableInterrupts();
     App_Init(); /* Program-specific setup */
     hw_EnableInterrupts();
-    if (!FXOS_Init(0, 9600))
+    /* 400 kHz fast mode: the FIFO bursts do not fit at lower rates */
+    if (!FXOS_Init(0, 400000))
     {
         __error_handler__();
     }
@@ -16,29 +16,103 @@
 #include "drv/SysTick.h"
 #include "drv/i2c.h"
 #include "drv/FXOS8700CQ.h"
+#include "misc/attitude.h"
+#include "misc/fusion.h"
+#include "misc/telemetry.h"
 
 #include <stdbool.h>
 #include "drv/UART_strings.h"
 #include "drv/UART.h"
 
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// 1: accelerometer through the FXOS FIFO, one I2C burst per APP_FIFO_WATERMARK
+// samples at 400 Hz (hybrid), averaged into one sample for the fusion, with
+// one magnetometer read per block: half the field samples of the other path,
+// so a noisier yaw (testbenchs/replay_fusion.c). 0: accelerometer and
+// magnetometer in one register read per new sample (ZYXDR, 50 Hz hybrid).
+#ifndef APP_ACC_FIFO
+#define APP_ACC_FIFO        1
+#endif
+
+#ifndef APP_FIFO_WATERMARK
+#define APP_FIFO_WATERMARK  FXOS_FIFO_WATERMARK
+#endif
+
+// Fusion_Update() calls per second and accelerometer samples averaged into
+// each one, for the filter gains
+#if APP_ACC_FIFO
+#define APP_FUSION_HZ       (400u / APP_FIFO_WATERMARK) // 25 Hz by default
+#define APP_FUSION_BLOCK    APP_FIFO_WATERMARK
+#else
+#define APP_FUSION_HZ       50u
+#define APP_FUSION_BLOCK    1u
+#endif
+
+// 1: send every fusion input as "ax,ay,az,mx,my,mz\n" in counts instead of
+// the angles ("ax,ay,az,,,\n" without a new magnetometer sample). The log
+// replays on the host with testbenchs/replay_fusion.c.
+#ifndef APP_LOG_RAW
+#define APP_LOG_RAW         0
+#endif
+
+// 1: angles as binary frames (misc/telemetry.h, 11 bytes per update).
+// 0: the three ASCII lines "A,0,O|R|C,<deg>\n".
+#ifndef APP_TELEMETRY_BINARY
+#define APP_TELEMETRY_BINARY 1
+#endif
+
+#ifndef APP_STATION_ID
+#define APP_STATION_ID      0
+#endif
+
+// 1: keep the worst Fusion_Update() time in fusion_cycles_max (DWT cycle
+// counter), to check it against FUSION_CYCLE_BUDGET from the debugger
+#ifndef APP_FUSION_PROFILE
+#define APP_FUSION_PROFILE  0
+#endif
+
 /*******************************************************************************
  * FILE SCOPE VARIABLES
  ******************************************************************************/
 
-static Vec3_t uT, mg;
-static Rotation_t rot;
+static RawData_t acc;
+static RawData_t mag;
+static Fusion_t fusion;
+static Attitude_t att;
 static char rx_line[128];
+#if APP_ACC_FIFO
+static FXOS_SampleBlock_t acc_block;
+static bool fifo_started;
+#endif
+#if APP_FUSION_PROFILE
+static volatile uint32_t fusion_cycles_max;
+#endif
+// fusion updates not sent because the TX ring was full
+static volatile uint32_t tlm_dropped;
 
 /*******************************************************************************
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
 static void delayLoop(uint32_t veces);
-static void UART_SendRotation0(const Rotation_t *r);
-static inline int clamp_deg_179(float x);
+static void fusionStep(const RawData_t *mag_new);
+#if APP_LOG_RAW
+static void UART_SendRaw(const RawData_t *a, const RawData_t *m);
+#endif
+#if APP_TELEMETRY_BINARY
+static void UART_SendAngles(const Attitude_t *a);
+#else
+static void UART_SendRotation0(const Attitude_t *a);
+#endif
+static inline int clamp_deg_179(int x);
+#if !APP_TELEMETRY_BINARY || APP_LOG_RAW
 static void append_int(char **p, int v);
 static void append_str(char **p, const char *s);
 static void int_to_ascii(int v, char *out);
+#endif
 
 /*******************************************************************************
  *******************************************************************************
@@ -52,6 +126,12 @@ void App_Init (void)
     gpioMode(PIN_LED_RED, OUTPUT);
     gpioWrite(PIN_LED_RED, !LED_ACTIVE);
 	UART_Init();
+    Fusion_Init(&fusion, APP_FUSION_HZ, APP_FUSION_BLOCK);
+#if APP_FUSION_PROFILE
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
 }
 
 /* Función que se llama constantemente en un ciclo infinito */
@@ -65,23 +145,34 @@ void App_Run (void)
 //        I2C_ServicePoll(0);
 //    }
 
-    FXOS_ReadAccelerometer(&mg);
-
+#if APP_ACC_FIFO
+    // FXOS_Init runs after App_Init, so the FIFO is set up on the first pass
+    if (!fifo_started)
+    {
+        fifo_started = FXOS_FifoStart(APP_FIFO_WATERMARK, true);
+    }
+#if I2C_POLLING_FLAG
+    I2C_ServicePoll(0);
+#endif
+    if (FXOS_FifoPoll(&acc_block))
+    {
+        FXOS_BlockMeanRaw(&acc_block, &acc);
+        // one magnetometer read per block: the one queued here lands during
+        // the next block and goes with it (none with the first block)
+        bool mag_new = FXOS_ReadMagnetometerRaw(&mag);
+        fusionStep(mag_new ? &mag : NULL);
+    }
+#else
 #if I2C_POLLING_FLAG
-    while (I2C_GetStatus(0) != I2C_AVAILABLE)
+    I2C_ServicePoll(0);
+#endif
+    if (FXOS_ReadBothRaw(&acc, &mag))
     {
-        I2C_ServicePoll(0);
+        fusionStep(&mag);
     }
 #endif
-    vec2rot(&mg, &uT, &rot);
 
 	UART_Poll();
-	/* TX no bloqueante */
-	if (UART_TxPending() == 0)
-	{
-		/* Intentar encolar (puede no entrar todo a la vez) */
-	    UART_SendRotation0(&rot);
-	}
 
 	/* RX no bloqueante: copiar disponible hasta fin de línea o hasta llenar */
 	int n = UART_ReceiveString(rx_line, sizeof(rx_line));
@@ -109,15 +200,43 @@ static void delayLoop(uint32_t veces)
      while (veces--);
 }
 
-static inline int clamp_deg_179(float x)
+static void fusionStep(const RawData_t *mag_new)
+{
+#if APP_LOG_RAW
+    UART_SendRaw(&acc, mag_new);
+#endif
+#if APP_FUSION_PROFILE
+    uint32_t t0 = DWT->CYCCNT;
+#endif
+    Fusion_Update(&fusion, &acc, mag_new, &att);
+#if APP_FUSION_PROFILE
+    uint32_t dt = DWT->CYCCNT - t0;
+    if (dt > fusion_cycles_max)
+    {
+        fusion_cycles_max = dt;
+    }
+#endif
+#if !APP_LOG_RAW
+    // one send per new attitude, never blocking (dropped if the TX ring is full)
+#if APP_TELEMETRY_BINARY
+    UART_SendAngles(&att);
+#else
+    UART_SendRotation0(&att);
+#endif
+#endif
+}
+
+static inline int clamp_deg_179(int x)
 {
-    /* redondeo a entero y saturación al rango [-179..179] */
-    int v = (int)(x >= 0.f ? x + 0.5f : x - 0.5f);
+    /* centésimas de grado: redondeo a entero y saturación al rango [-179..179] */
+    int v = (x >= 0 ? x + ATT_UNITS_PER_DEG / 2 : x - ATT_UNITS_PER_DEG / 2)
+            / ATT_UNITS_PER_DEG;
     if (v > 179)  v = 179;
     if (v < -179) v = -179;
     return v;
 }
 
+#if !APP_TELEMETRY_BINARY || APP_LOG_RAW
 /* int -> ASCII (C89), soporta negativos, out debe tener >=12 bytes */
 static void int_to_ascii(int v, char *out)
 {
@@ -147,15 +266,33 @@ static void append_int(char **p, int v)
     int_to_ascii(v, nb);
     append_str(p, nb);
 }
+#endif
 
+#if APP_TELEMETRY_BINARY
+/* Envía una trama binaria con los tres ángulos (ver misc/telemetry.h) */
+static void UART_SendAngles(const Attitude_t *a)
+{
+    static uint8_t seq;
+    uint8_t frame[TLM_FRAME_MAX];
+
+    if (!a) return;
+
+    // seq counts updates, so a dropped one shows up as lost_frames on the PC
+    size_t n = Tlm_EncodeAngles(APP_STATION_ID, seq++, a, frame);
+    if (UART_SendBytes(frame, n) != n)
+    {
+        tlm_dropped++;
+    }
+}
+#else
 /* Envía: "A,0,R,<roll>\nA,0,C,<pitch>\nA,0,O,<yaw>\n" */
-static void UART_SendRotation0(const Rotation_t *r)
+static void UART_SendRotation0(const Attitude_t *a)
 {
-    if (!r) return;
+    if (!a) return;
 
-    const int roll  = clamp_deg_179(r->roll);
-    const int pitch = clamp_deg_179(r->pitch);
-    const int yaw   = r->yaw;
+    const int roll  = clamp_deg_179(a->roll);
+    const int pitch = clamp_deg_179(a->pitch);
+    const int yaw   = a->yaw / ATT_UNITS_PER_DEG;
 
     /* 3 líneas en un solo buffer */
     char buf[256];
@@ -164,7 +301,38 @@ static void UART_SendRotation0(const Rotation_t *r)
     append_str(&p, "A,0,O,"); append_int(&p,yaw);   append_str(&p, "\n");
     append_str(&p, "A,0,R,"); append_int(&p, roll);  append_str(&p, "\n");
     append_str(&p, "A,0,C,"); append_int(&p, pitch); append_str(&p, "\n");
+
+    /* las 3 líneas o ninguna, para no cortar una línea con el ring lleno */
+    if (UART_SendBytes((const uint8_t *)buf, (size_t)(p - buf)) == 0)
+    {
+        tlm_dropped++;
+    }
+}
+#endif
+
+#if APP_LOG_RAW
+/* Envía: "ax,ay,az,mx,my,mz\n" en cuentas, "ax,ay,az,,,\n" sin magnetómetro */
+static void UART_SendRaw(const RawData_t *a, const RawData_t *m)
+{
+    char buf[48];
+    char *p = buf;
+
+    append_int(&p, a->x); append_str(&p, ",");
+    append_int(&p, a->y); append_str(&p, ",");
+    append_int(&p, a->z); append_str(&p, ",");
+    if (m)
+    {
+        append_int(&p, m->x); append_str(&p, ",");
+        append_int(&p, m->y); append_str(&p, ",");
+        append_int(&p, m->z);
+    }
+    else
+    {
+        append_str(&p, ",,");
+    }
+    append_str(&p, "\n");
     *p = '\0';
 
     UART_SendString(buf);
 }
+#endif
@@ -1,39 +1,63 @@
 #include "FXOS8700CQ.h"
 #include "i2c.h"
+#include "gpio.h"
 
-#include <math.h>
-#ifndef M_PI 
-#define M_PI   (3.14159265358793f)
+#ifndef FXOS_INT1_PIN
+#define FXOS_INT1_PIN   PORTNUM2PIN(PC,6) // FRDM-K64F: FXOS INT1 -> PTC6
 #endif
 
+// addr W + reg + Sr + addr R + F_STATUS + 6 bytes per sample
+#define FXOS_FIFO_SEQ_LEN   (5 + 6 * FXOS_FIFO_SIZE)
+
+// A queued read and its raw bytes; the I2C callback flags it done
 typedef struct
 {
-    int16_t x;
-    int16_t y;
-    int16_t z;
-} RawData_t;
+    volatile bool in_flight;
+    volatile bool ready;
+    uint8_t *rx;
+} FXOS_Read_t;
 
 static uint8_t i2c_channel_id;
-static uint8_t read_raw_buff[6]; // to read the acc or the mag
-static uint8_t read_raw_buff_double[12]; // to read the acc and the mag
+static uint8_t read_raw_buff[6]; // to read the acc
+static uint8_t read_raw_buff_mag[6]; // to read the mag
+static uint8_t read_raw_buff_double[FXOS_READ_LEN]; // status, acc and mag
+static FXOS_Read_t acc_read = { .rx = read_raw_buff };
+static FXOS_Read_t mag_read = { .rx = read_raw_buff_mag };
+static FXOS_Read_t both_read = { .rx = read_raw_buff_double };
 static RawData_t out14;
 static RawData_t out16;
 
+// FIFO streaming state
+static uint16_t fifo_seq[FXOS_FIFO_SEQ_LEN];
+static uint32_t fifo_seq_len;
+static uint8_t fifo_rx[1 + 6 * FXOS_FIFO_SIZE];
+static FXOS_Read_t fifo_read = { .rx = fifo_rx };
+static uint8_t fifo_watermark;
+static uint32_t fifo_period_us;
+static uint32_t fifo_sample_idx;
+static bool fifo_active;
+static volatile bool fifo_irq_pending;
+
 /*******************************************************************************
  * FILE SCOPE FUNCTIONS DECLARATIONS
  ******************************************************************************/
 
 static bool FXOS_ReadWhoAmI(uint8_t i2c_ch, uint8_t *who);
+static bool FXOS_WriteReg(uint8_t i2c_ch, uint8_t reg, uint8_t val);
+static void FXOS_FifoIRQ(void);
+static void FXOS_ReadDone(void *user, bool ok);
+static bool FXOS_Queue(uint8_t i2c_ch, const uint16_t *seq, uint32_t len,
+                       FXOS_Read_t *r);
 
-static bool FXOS_Acc_ReadRaw(uint8_t i2c_ch, uint8_t rx[6]);
+static bool FXOS_Acc_ReadRaw(uint8_t i2c_ch, FXOS_Read_t *r);
 static void FXOS_Acc_Unpack14b(const uint8_t rx[6], RawData_t *out14);
 static void FXOS_Acc2mg(const RawData_t *raw14, Vec3_t *mg);
 
-static bool FXOS_Mag_ReadRaw(uint8_t i2c_ch, uint8_t rx[6]);
+static bool FXOS_Mag_ReadRaw(uint8_t i2c_ch, FXOS_Read_t *r);
 static void FXOS_Mag_Unpack16b(const uint8_t rx[6], RawData_t *out16);
 static void FXOS_Mag2uT(const RawData_t *raw16, Vec3_t *uT);
 
-static bool FXOS_Both_ReadRaw(uint8_t i2c_ch, uint8_t rx[12]);
+static bool FXOS_Both_ReadRaw(uint8_t i2c_ch, FXOS_Read_t *r);
 static void FXOS_Both_Unpack(const uint8_t rx[12], RawData_t *out14, 
                             RawData_t *out16);
 
@@ -93,8 +117,8 @@ bool FXOS_Init(uint8_t i2c_ch, uint32_t baud)
 #endif
     }
 
-    // CTRL_REG1: set ODR and ACTIVE=1. For 100 Hz ODR: DR=010, 
-    // ACTIVE=1 to 0x19
+    // CTRL_REG1: set ODR and ACTIVE=1. DR=011 is 100 Hz, 50 Hz per sensor
+    // in hybrid mode; ACTIVE=1 to 0x19
     uint16_t seq4[] = { FXOS_ADDR_W, FXOS_CTRL_REG1, 0x19 };
     if (!I2C_MasterSendSequence(i2c_ch, seq4, 3, NULL)) return false;
     while(I2C_GetStatus(i2c_ch) != I2C_AVAILABLE)
@@ -113,76 +137,176 @@ bool FXOS_Init(uint8_t i2c_ch, uint32_t baud)
 
 bool FXOS_ReadAccelerometer(Vec3_t* mg)
 {
-    if (I2C_GetStatus(i2c_channel_id) == I2C_AVAILABLE)
+    if (!FXOS_ReadAccelerometerRaw(&out14)) return false;
+    FXOS_Acc2mg(&out14, mg);
+    return true;
+}
+
+bool FXOS_ReadAccelerometerRaw(RawData_t *acc)
+{
+    // unpack before the next read reuses the buffer
+    bool fresh = acc_read.ready;
+    if (fresh)
     {
-    	FXOS_Acc_ReadRaw(i2c_channel_id, read_raw_buff);
-        FXOS_Acc_Unpack14b(read_raw_buff, &out14);
-        FXOS_Acc2mg(&out14, mg);
-        return true;
+        acc_read.ready = false;
+        FXOS_Acc_Unpack14b(acc_read.rx, acc);
     }
-    else
+    if (!acc_read.in_flight)
     {
-        return false;
+        FXOS_Acc_ReadRaw(i2c_channel_id, &acc_read);
     }
+    return fresh;
 }
 
 bool FXOS_ReadMagnetometer(Vec3_t* uT)
 {
-    if (I2C_GetStatus(i2c_channel_id) == I2C_AVAILABLE)
+    if (!FXOS_ReadMagnetometerRaw(&out16)) return false;
+    FXOS_Mag2uT(&out16, uT);
+    return true;
+}
+
+bool FXOS_ReadMagnetometerRaw(RawData_t *mag)
+{
+    bool fresh = mag_read.ready;
+    if (fresh)
     {
-    	FXOS_Mag_ReadRaw(i2c_channel_id, read_raw_buff);
-        FXOS_Mag_Unpack16b(read_raw_buff, &out16);
-        FXOS_Mag2uT(&out16, uT);
-        return true;
+        mag_read.ready = false;
+        FXOS_Mag_Unpack16b(mag_read.rx, mag);
     }
-    else
+    if (!mag_read.in_flight)
     {
-        return false;
+        FXOS_Mag_ReadRaw(i2c_channel_id, &mag_read);
     }
+    return fresh;
 }
 
 bool FXOS_ReadBoth(Vec3_t *mg, Vec3_t *uT)
 {
-    if (I2C_GetStatus(i2c_channel_id) == I2C_AVAILABLE)
-    {
-        FXOS_Both_ReadRaw(i2c_channel_id, read_raw_buff_double);
-
-        FXOS_Both_Unpack(read_raw_buff_double, &out14, &out16);
+    if (!FXOS_ReadBothRaw(&out14, &out16)) return false;
+    FXOS_Acc2mg(&out14, mg);
+    FXOS_Mag2uT(&out16, uT);
+    return true;
+}
 
-        FXOS_Acc2mg(&out14, mg);
-        FXOS_Mag2uT(&out16, uT);
-        return true;
+bool FXOS_ReadBothRaw(RawData_t *acc, RawData_t *mag)
+{
+    bool fresh = both_read.ready;
+    if (fresh)
+    {
+        both_read.ready = false;
+        // polled faster than the ODR the same sample comes back: only a set
+        // ZYXDR (cleared by reading the data) is a new one
+        fresh = (both_read.rx[0] & FXOS_ZYXDR_MASK) != 0;
+        if (fresh)
+        {
+            FXOS_Both_Unpack(&both_read.rx[1], acc, mag);
+        }
     }
-    else
+    if (!both_read.in_flight)
     {
+        FXOS_Both_ReadRaw(i2c_channel_id, &both_read);
+    }
+    return fresh;
+}
+
+bool FXOS_FifoStart(uint8_t watermark, bool hybrid)
+{
+    if (watermark == 0 || watermark > FXOS_FIFO_SIZE) return false;
+
+    uint8_t ch = i2c_channel_id;
+    fifo_active = false;
+
+    // F_SETUP and M_CTRL_REG1 can only change in standby
+    if (!FXOS_WriteReg(ch, FXOS_CTRL_REG1, 0x00)) return false;
+    if (!FXOS_WriteReg(ch, FXOS_F_SETUP, FXOS_F_MODE_CIRCULAR | watermark))
         return false;
+    if (!FXOS_WriteReg(ch, FXOS_CTRL_REG4, FXOS_INT_EN_FIFO)) return false;
+    if (!FXOS_WriteReg(ch, FXOS_CTRL_REG5, FXOS_INT_CFG_FIFO)) return false;
+    // M_HMS = 11 hybrid or 00 accelerometer only, same oversampling as Init
+    if (!FXOS_WriteReg(ch, FXOS_M_CTRL_REG1, hybrid ? 0x1F : 0x1C)) return false;
+    // hyb_autoinc_mode off: bursts from OUT_X_MSB wrap 0x06 -> 0x01 (FIFO)
+    if (!FXOS_WriteReg(ch, FXOS_M_CTRL_REG2, 0x00)) return false;
+    // DR = 000 (800 Hz, 400 Hz per sensor in hybrid), ACTIVE = 1
+    if (!FXOS_WriteReg(ch, FXOS_CTRL_REG1, 0x01)) return false;
+
+    // F_STATUS first, then watermark samples in the same burst
+    uint32_t n = 0;
+    fifo_seq[n++] = FXOS_ADDR_W;
+    fifo_seq[n++] = FXOS_F_STATUS;
+    fifo_seq[n++] = I2C_RESTART;
+    fifo_seq[n++] = FXOS_ADDR_R;
+    for (uint32_t i = 0; i < 1 + 6 * (uint32_t)watermark; i++)
+    {
+        fifo_seq[n++] = I2C_READ;
     }
+    fifo_seq_len = n;
+    fifo_watermark = watermark;
+    fifo_period_us = hybrid ? 2500 : 1250;
+    fifo_sample_idx = 0;
+    fifo_read.ready = false;
+    fifo_irq_pending = false;
+
+    // INT1 is push-pull, active low
+    gpioMode(FXOS_INT1_PIN, INPUT);
+    gpioIRQ(FXOS_INT1_PIN, PORT_PCR_IRQC_INT_FALLING, FXOS_FifoIRQ);
+    fifo_active = true;
+    return true;
 }
 
-void vec2rot(Vec3_t *mg, Vec3_t *uT, Rotation_t *rot)
+bool FXOS_FifoPoll(FXOS_SampleBlock_t *blk)
 {
-    float ax = mg->x, ay = mg->y, az = mg->z;
-    float a_norm = sqrtf(ax*ax + ay*ay + az*az);
-    if (a_norm == 0) return;
+    if (!fifo_active) return false;
 
-    float pitch = atan2f(ay, az);
-    float roll = atan2f(-ax, sqrtf(ay*ay + az*az));
+    bool fresh = fifo_read.ready;
+    if (fresh)
+    {
+        fifo_read.ready = false;
+        for (uint8_t i = 0; i < fifo_watermark; i++)
+        {
+            FXOS_Acc_Unpack14b(&fifo_read.rx[1 + 6 * i], &blk->acc[i]);
+        }
+        blk->count = fifo_watermark;
+        blk->overflow = (fifo_read.rx[0] & FXOS_F_OVF_MASK) != 0;
+        blk->seq = fifo_sample_idx;
+        blk->period_us = fifo_period_us;
+        blk->t_us = fifo_sample_idx * fifo_period_us;
+        fifo_sample_idx += fifo_watermark;
+    }
 
-    float yaw = atan2f(uT->y, uT->x);
+    // the edge may have come while a burst was in flight: INT1 stays low
+    // as long as watermark samples are waiting. A failed burst leaves them
+    // there, so it is retried the same way.
+    if (!fifo_read.in_flight && (fifo_irq_pending || !gpioRead(FXOS_INT1_PIN)))
+    {
+        fifo_irq_pending = false;
+        FXOS_Queue(i2c_channel_id, fifo_seq, fifo_seq_len, &fifo_read);
+    }
+    return fresh;
+}
 
-    const float k = 57.2957795f;
-    rot->roll = -roll*k;
-    rot->pitch = -pitch*k;
-    rot->yaw = 0*yaw*k;
+void FXOS_BlockMean(const FXOS_SampleBlock_t *blk, Vec3_t *mg)
+{
+    if (blk->count == 0) return;
 
-    // float ax = (signed int)(((signed int)mg->x) * 3.9);
-    // float ay = (signed int)(((signed int)mg->y) * 3.9);
-    // float az = (signed int)(((signed int)mg->z) * 3.9);
+    RawData_t mean;
+    FXOS_BlockMeanRaw(blk, &mean);
+    FXOS_Acc2mg(&mean, mg);
+}
 
-    // rot->pitch = 180 * atan(ax/sqrt(ay*ay + az*az))/M_PI;
-    // rot->roll = 180 * atan(ay/sqrt(ax*ax + az*az))/M_PI;
-    // rot->yaw = 180 * atan(az/sqrt(ax*ax + az*az))/M_PI;
+void FXOS_BlockMeanRaw(const FXOS_SampleBlock_t *blk, RawData_t *acc)
+{
+    if (blk->count == 0) return;
 
+    int32_t sx = 0, sy = 0, sz = 0;
+    for (uint8_t i = 0; i < blk->count; i++)
+    {
+        sx += blk->acc[i].x;
+        sy += blk->acc[i].y;
+        sz += blk->acc[i].z;
+    }
+    acc->x = (int16_t)(sx / blk->count);
+    acc->y = (int16_t)(sy / blk->count);
+    acc->z = (int16_t)(sz / blk->count);
 }
 
 /*******************************************************************************
@@ -200,8 +324,46 @@ static bool FXOS_ReadWhoAmI(uint8_t i2c_ch, uint8_t *who)
     return I2C_MasterSendSequence(i2c_ch, seq, sizeof(seq)/sizeof(seq[0]), who);
 }
 
-// read 6 bytes into rx[0..5]
-static bool FXOS_Acc_ReadRaw(uint8_t i2c_ch, uint8_t rx[6])
+static bool FXOS_WriteReg(uint8_t i2c_ch, uint8_t reg, uint8_t val)
+{
+    uint16_t seq[] = { FXOS_ADDR_W, reg, val };
+    if (!I2C_MasterSendSequence(i2c_ch, seq, 3, NULL)) return false;
+    while(I2C_GetStatus(i2c_ch) != I2C_AVAILABLE)
+    {
+        if (I2C_GetStatus(i2c_ch) == I2C_ERROR) return false;
+#if I2C_POLLING_FLAG
+    	I2C_ServicePoll(i2c_ch); // wait for the tx to end
+#endif
+    }
+    return true;
+}
+
+static void FXOS_FifoIRQ(void)
+{
+    fifo_irq_pending = true;
+}
+
+static void FXOS_ReadDone(void *user, bool ok)
+{
+    FXOS_Read_t *r = user;
+    r->ready = ok;
+    r->in_flight = false;
+}
+
+static bool FXOS_Queue(uint8_t i2c_ch, const uint16_t *seq, uint32_t len,
+                       FXOS_Read_t *r)
+{
+    r->in_flight = true;
+    if (!I2C_MasterQueueSequence(i2c_ch, seq, len, r->rx, FXOS_ReadDone, r))
+    {
+        r->in_flight = false; // queue full, next call retries
+        return false;
+    }
+    return true;
+}
+
+// read 6 bytes into r->rx[0..5]
+static bool FXOS_Acc_ReadRaw(uint8_t i2c_ch, FXOS_Read_t *r)
 {
     uint16_t seq[] = 
     {
@@ -209,7 +371,7 @@ static bool FXOS_Acc_ReadRaw(uint8_t i2c_ch, uint8_t rx[6])
         I2C_RESTART, FXOS_ADDR_R,     // restart + read address
         I2C_READ, I2C_READ, I2C_READ, I2C_READ, I2C_READ, I2C_READ   // 6 bytes
     };
-    return I2C_MasterSendSequence(i2c_ch, seq, sizeof(seq)/sizeof(seq[0]), rx);
+    return FXOS_Queue(i2c_ch, seq, sizeof(seq)/sizeof(seq[0]), r);
 }
 
 static void FXOS_Acc_Unpack14b(const uint8_t rx[6], RawData_t *out14)
@@ -230,7 +392,7 @@ static void FXOS_Acc2mg(const RawData_t *raw14, Vec3_t *mg)
     mg->z = (raw14->z * 1000.0f) / 4096.0f;
 }
 
-static bool FXOS_Mag_ReadRaw(uint8_t i2c_ch, uint8_t rx[6])
+static bool FXOS_Mag_ReadRaw(uint8_t i2c_ch, FXOS_Read_t *r)
 {
     uint16_t seq[] = 
     {
@@ -238,7 +400,7 @@ static bool FXOS_Mag_ReadRaw(uint8_t i2c_ch, uint8_t rx[6])
         I2C_RESTART, FXOS_ADDR_R,
         I2C_READ, I2C_READ, I2C_READ, I2C_READ, I2C_READ, I2C_READ
     };
-    return I2C_MasterSendSequence(i2c_ch, seq, sizeof(seq)/sizeof(seq[0]), rx);
+    return FXOS_Queue(i2c_ch, seq, sizeof(seq)/sizeof(seq[0]), r);
 }
 
 static void FXOS_Mag_Unpack16b(const uint8_t rx[6], RawData_t *out16)
@@ -248,19 +410,22 @@ static void FXOS_Mag_Unpack16b(const uint8_t rx[6], RawData_t *out16)
     out16->z = (int16_t)((rx[4] << 8) | rx[5]);
 }
 
-static bool FXOS_Both_ReadRaw(uint8_t i2c_ch, uint8_t rx[12])
+// STATUS and acc in one burst (auto-increment from 0x00), then mag:
+// FXOS_READ_LEN bytes
+static bool FXOS_Both_ReadRaw(uint8_t i2c_ch, FXOS_Read_t *r)
 {
     uint16_t seq[] =
     {
-        FXOS_ADDR_W, FXOS_OUT_X_MSB,           
+        FXOS_ADDR_W, FXOS_STATUS,
         I2C_RESTART, FXOS_ADDR_R,
+        I2C_READ,
         I2C_READ, I2C_READ, I2C_READ, I2C_READ, I2C_READ, I2C_READ,
 
         I2C_RESTART, FXOS_ADDR_W, FXOS_M_OUT_X_MSB,
         I2C_RESTART, FXOS_ADDR_R,
         I2C_READ, I2C_READ, I2C_READ, I2C_READ, I2C_READ, I2C_READ
     };
-    return I2C_MasterSendSequence(i2c_ch, seq, sizeof(seq)/sizeof(seq[0]), rx);
+    return FXOS_Queue(i2c_ch, seq, sizeof(seq)/sizeof(seq[0]), r);
 }
 
 static void FXOS_Both_Unpack(const uint8_t rx[12], RawData_t *out14, 
@@ -9,6 +9,9 @@
 
 // FXOS8700CQ internal register addresses
 #define FXOS_STATUS         0x00 
+#define FXOS_ZYXDR_MASK     0x08 // STATUS: a new X, Y, Z sample since the last read
+#define FXOS_F_STATUS       0x00 // STATUS becomes F_STATUS with the FIFO on
+#define FXOS_F_SETUP        0x09
 #define FXOS_SYSMOD         0x0B 
 #define FXOS_WHO_AM_I       0x0D 
 #define FXOS_XYZ_DATA_CFG   0x0E
@@ -39,6 +42,15 @@
 // useful macros
 #define FXOS_WHOAMI_VAL 0xC7
 
+// accelerometer FIFO
+#define FXOS_FIFO_SIZE          32   // samples the FXOS can hold
+#define FXOS_FIFO_WATERMARK     16   // default samples per burst (1..32)
+#define FXOS_F_MODE_CIRCULAR    0x40 // F_SETUP: oldest sample dropped when full
+#define FXOS_F_OVF_MASK         0x80 // F_STATUS: samples were lost
+#define FXOS_F_CNT_MASK         0x3F // F_STATUS: samples in the FIFO
+#define FXOS_INT_EN_FIFO        0x40 // CTRL_REG4
+#define FXOS_INT_CFG_FIFO       0x40 // CTRL_REG5: FIFO interrupt on INT1
+
 // number of bytes to be read from the FXOS8700CQ
 #define FXOS_READ_LEN 13 /* status (1 byte) plus 6 channels (6 * 16-bit) 
 = 13 bytes */
@@ -46,6 +58,13 @@
 #define FXOS_ADDR_W      ((FXOS_SLAVE_ADDR << 1) | 0)  // 0x3A
 #define FXOS_ADDR_R      ((FXOS_SLAVE_ADDR << 1) | 1)  // 0x3B
 
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} RawData_t;
+
 typedef struct
 {
     float x;
@@ -53,21 +72,64 @@ typedef struct
     float z;
 } Vec3_t;
 
+// Accelerometer samples drained from the FIFO in one burst
 typedef struct
 {
-    float pitch;
-    float roll;
-    float yaw;
-} Rotation_t;
+    RawData_t acc[FXOS_FIFO_SIZE]; // 14-bit counts, 4096 counts/g
+    uint8_t count;      // valid samples in acc[]
+    bool overflow;      // the FIFO overflowed: samples were lost before acc[0]
+    uint32_t seq;       // index of acc[0] since FXOS_FifoStart()
+    uint32_t t_us;      // sensor time of acc[0] (seq * period_us)
+    uint32_t period_us; // time between samples
+} FXOS_SampleBlock_t;
 
 bool FXOS_Init(uint8_t i2c_ch, uint32_t baud);
 
+/*
+ * Non-blocking reads. Each call queues the next I2C read of that sensor (if
+ * the previous one has landed) and returns true when it wrote a sample that
+ * arrived since the last call. Accelerometer and magnetometer reads can be
+ * queued back-to-back; call I2C_ServicePoll() in the loop when polling.
+ */
 bool FXOS_ReadAccelerometer(Vec3_t *mg);
 
+// Same as FXOS_ReadAccelerometer(), in 14-bit counts (4096 counts/g)
+bool FXOS_ReadAccelerometerRaw(RawData_t *acc);
+
 bool FXOS_ReadMagnetometer(Vec3_t *uT);
 
+// Same as FXOS_ReadMagnetometer(), in 16-bit counts (10 counts/uT)
+bool FXOS_ReadMagnetometerRaw(RawData_t *mag);
+
 bool FXOS_ReadBoth(Vec3_t *mg, Vec3_t *uT);
 
-void vec2rot(Vec3_t *mg, Vec3_t *uT, Rotation_t *rot);
+// Same as FXOS_ReadBoth(), in counts: one transaction, so acc and mag are
+// from the same hybrid sample. The read starts at STATUS and only returns
+// true when ZYXDR says the sample is new, so at most once per ODR period
+// (50 Hz per sensor with the FXOS_Init() setup)
+bool FXOS_ReadBothRaw(RawData_t *acc, RawData_t *mag);
+
+/*
+ * FIFO streaming mode. The FXOS buffers accelerometer samples and pulls INT1
+ * low once watermark of them are waiting; FXOS_FifoPoll() then drains them
+ * with a single I2C transaction (F_STATUS + 6 bytes per sample) instead of
+ * one transaction per sample. ODR is 800 Hz with the accelerometer alone and
+ * 400 Hz with hybrid (mag still readable with FXOS_ReadMagnetometer()).
+ * Call after FXOS_Init(). Blocks while it writes the registers.
+ */
+bool FXOS_FifoStart(uint8_t watermark, bool hybrid);
+
+/*
+ * Non-blocking, call from the main loop (with I2C_ServicePoll() when polling).
+ * Queues the burst when INT1 is asserted and returns true once it has landed
+ * in blk.
+ */
+bool FXOS_FifoPoll(FXOS_SampleBlock_t *blk);
+
+// Mean of the block in mg (boxcar low-pass + decimation by blk->count)
+void FXOS_BlockMean(const FXOS_SampleBlock_t *blk, Vec3_t *mg);
+
+// Same mean, in counts
+void FXOS_BlockMeanRaw(const FXOS_SampleBlock_t *blk, RawData_t *acc);
 
 #endif // _FXOS8700CQ_H_
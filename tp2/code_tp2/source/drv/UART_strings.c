@@ -79,6 +79,23 @@ size_t UART_SendString(const char *str)
     return enq;
 }
 
+size_t UART_SendBytes(const uint8_t *data, size_t len)
+{
+    if (!data || len == 0) return 0;
+
+    /* Lugar libre: el ring deja un slot vacío para distinguir lleno de vacío */
+    if (len > (UART_TX_BUF_SIZE - 1u) - UART_TxPending()) return 0;
+
+    for (size_t i = 0; i < len; i++) {
+        s_tx_buf[s_tx_head] = (char)data[i];
+        s_tx_head = rb_next(s_tx_head, UART_TX_BUF_SIZE);
+    }
+
+    /* Empujar inmediatamente lo que se pueda */
+    UART_Poll();
+    return len;
+}
+
 int UART_ReceiveString(char *buffer, size_t max_len)
 {
     if (!buffer || max_len == 0) return 0;
@@ -35,6 +35,18 @@ void UART_Poll(void);
  */
 size_t UART_SendString(const char *str);
 
+/**
+ * @brief Encola len bytes (pueden incluir '\0') para transmisión no bloqueante.
+ *
+ * Encola todo o nada: si no hay lugar para los len bytes no encola ninguno,
+ * así una trama binaria nunca sale cortada.
+ *
+ * @param data Bytes a enviar.
+ * @param len Cantidad de bytes.
+ * @return size_t len si se encolaron, 0 si no había lugar.
+ */
+size_t UART_SendBytes(const uint8_t *data, size_t len);
+
 /**
  * @brief Copia de manera no bloqueante una "línea" desde el buffer RX.
  *
@@ -21,8 +21,14 @@
 
 #define F_MUL_VALUE	0x2		// mul = 4
 
+#define I2C_QUEUE_MASK  (I2C_QUEUE_LEN - 1u)
+
 static I2C_Type *const I2C_base_ptrs[] = I2C_BASE_PTRS;
 static IRQn_Type const I2C_IRQn[] = I2C_IRQS;
+#if I2C_DMA_MIN_READS
+// DMAMUX sources, 0 = no DMA (I2C2 would share I2C1's request)
+static const uint8_t I2C_dma_source[] = { 18, 19, 0 };
+#endif
 
 // SCL divider table for MK64F12 (from Reference Manual, 0x00–0x3F)
 static const uint16_t scl_div[] = 
@@ -43,8 +49,24 @@ typedef enum
     I2C_RX
 } I2C_Mode_e;
 
+typedef struct
+{
+    uint16_t sequence[I2C_MAX_SEQUENCE_LEN];
+    uint32_t len;
+    uint8_t *recieve_buffer;
+    I2C_Callback_t callback;
+    void *user;
+} I2C_Transaction_t;
+
 typedef struct I2C_Buffer_t
 {
+    I2C_Transaction_t queue[I2C_QUEUE_LEN];
+    uint32_t head; // written by whoever queues (under PRIMASK)
+    uint32_t tail; // written when a transaction ends
+    bool running;
+    bool dma_active;
+    uint8_t dma_len;
+    // transaction in flight
     uint16_t *sequence;
     uint16_t *sequence_end;
     uint8_t *recieve_buffer;
@@ -59,13 +81,19 @@ typedef struct I2C_Buffer_t
 
 static void setBaudRate(I2C_Type *i2c, uint32_t bus_clk, uint32_t baud);
 static void I2C_IRQHandler(uint8_t channel_id);
+static void I2C_ByteDone(uint8_t channel_id, uint8_t status);
+static void startTransaction(uint8_t channel_id);
+static void endTransaction(uint8_t channel_id, bool ok);
+#if I2C_DMA_MIN_READS
+static void startReadDMA(uint8_t channel_id);
+static void readDMADone(uint8_t channel_id);
+#endif
 
 /*******************************************************************************
  * LOCAL VARIABLES
  ******************************************************************************/
 
 volatile static I2C_Buffer_t I2C_channel[I2C_NUMBER_OF_CHANNELS];
-static uint16_t sequence_copy[I2C_MAX_SEQUENCE_LEN];
 
 /*******************************************************************************
  * FUNCTION DEFINITIONS WITH GLOBAL SCOPE
@@ -132,61 +160,77 @@ bool I2C_MasterInit(uint8_t channel_id, uint32_t baud_rate)
 	setBaudRate(i2c, (__CORE_CLOCK__)/2, baud_rate); // Bus' clk is half core's
     // ToDo (more coplex config): add glitch-filters, high-drive, timeouts, etc.
 
+#if I2C_DMA_MIN_READS
+    if (I2C_dma_source[channel_id])
+    {
+        uint8_t dma_ch = I2C_DMA_CH_BASE + channel_id;
+        SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+        SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+        DMAMUX->CHCFG[dma_ch] = 0;
+        DMAMUX->CHCFG[dma_ch] = DMAMUX_CHCFG_ENBL_MASK
+                                | DMAMUX_CHCFG_SOURCE(I2C_dma_source[channel_id]);
+#if !I2C_POLLING_FLAG
+        NVIC_EnableIRQ((IRQn_Type)(DMA0_IRQn + dma_ch));
+#endif
+    }
+#endif
+
 #if !I2C_POLLING_FLAG
 	NVIC_EnableIRQ(I2C_IRQn[channel_id]); // enable interrputs in NVIC
 #endif
 
+    I2C_channel[channel_id].status = I2C_AVAILABLE;
     return true;
 }
 
 bool I2C_MasterSendSequence(uint8_t channel_id, uint16_t *sequence, 
                             uint32_t len, uint8_t *recieve_buffer)
 {
-    if (channel_id >= I2C_NUMBER_OF_CHANNELS) 
+    return I2C_MasterQueueSequence(channel_id, sequence, len, recieve_buffer,
+                                   NULL, NULL);
+}
+
+bool I2C_MasterQueueSequence(uint8_t channel_id, const uint16_t *sequence,
+                             uint32_t len, uint8_t *recieve_buffer,
+                             I2C_Callback_t callback, void *user)
+{
+    if (channel_id >= I2C_NUMBER_OF_CHANNELS || len < 2
+        || len > I2C_MAX_SEQUENCE_LEN)
     {
         return false;
     }
 
-    I2C_Type *i2c = I2C_base_ptrs[channel_id];
     volatile I2C_Buffer_t *channel =  &(I2C_channel[channel_id]);
 
-    if (channel->status == I2C_BUSY)
+    // callbacks can queue from the ISR, so claiming a slot is atomic
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (channel->head - channel->tail == I2C_QUEUE_LEN)
     {
-        return false;
+        __set_PRIMASK(primask);
+        return false; // full
     }
 
-    for (int i = 0; i < len; i++) /* copy the entire sequence to static 
-    variable in file */
+    volatile I2C_Transaction_t *t = &channel->queue[channel->head & I2C_QUEUE_MASK];
+    for (uint32_t i = 0; i < len; i++) /* copy the entire sequence to the 
+    channel's own slot */
     {
-        sequence_copy[i] = sequence[i];
+        t->sequence[i] = sequence[i];
     }
-
-    channel->sequence = sequence_copy;
-    channel->sequence_end = sequence_copy + len;
-    channel->recieve_buffer = recieve_buffer;
+    t->len = len;
+    t->recieve_buffer = recieve_buffer;
+    t->callback = callback;
+    t->user = user;
+    channel->head++;
     channel->status = I2C_BUSY;
-    channel->mode = I2C_TX;
-
-    // Acknowledge the interrupt request
-    i2c->S |= I2C_S_IICIF_MASK;
-#if !I2C_POLLING_FLAG
-    i2c->C1 = (I2C_C1_IICEN_MASK | I2C_C1_IICIE_MASK);
-#else
-    i2c->C1 = I2C_C1_IICEN_MASK;
-#endif
-    // Generate a start condition and prepare for transmitting
-    i2c->C1 |= (I2C_C1_MST_MASK | I2C_C1_TX_MASK);
 
-//    if (i2c->S & I2C_S_ARBL_MASK) // Lost of arbitration
-//    {
-//        // Clean everything and leave
-//        i2c->C1 &= ~(I2C_C1_MST_MASK | I2C_C1_TX_MASK);
-//        channel->status = I2C_ERROR;
-//        return false;
-//    }
+    if (!channel->running)
+    {
+        startTransaction(channel_id);
+    }
 
-    i2c->D = *(channel->sequence)++; // Writes the first byte
-    // The ISR handler will take care of the rest
+    __set_PRIMASK(primask);
     return true;
 }
 
@@ -198,6 +242,17 @@ I2C_Status_e I2C_GetStatus(uint8_t channel_id)
 void I2C_ServicePoll(uint8_t ch)
 {
     I2C_Type *i2c = I2C_base_ptrs[ch];
+#if I2C_DMA_MIN_READS
+    if (I2C_channel[ch].dma_active)
+    {
+        // the I2C flags belong to the DMA until the major loop ends
+        if (DMA0->TCD[I2C_DMA_CH_BASE + ch].CSR & DMA_CSR_DONE_MASK)
+        {
+            readDMADone(ch);
+        }
+        return;
+    }
+#endif
     if (i2c->S & I2C_S_IICIF_MASK)
     {
         I2C_IRQHandler(ch);
@@ -232,18 +287,141 @@ static void setBaudRate(I2C_Type *i2c, uint32_t bus_clk, uint32_t baud)
     i2c->F = I2C_F_MULT(best_mult) | I2C_F_ICR(best_icr);
 }       
 
-static void I2C_IRQHandler(uint8_t channel_id)
+// Loads the oldest queued transaction and sends its first byte
+static void startTransaction(uint8_t channel_id)
 {
+    I2C_Type *i2c = I2C_base_ptrs[channel_id];
     volatile I2C_Buffer_t *channel = &(I2C_channel[channel_id]);
-    I2C_Type* i2c = I2C_base_ptrs[channel_id];
-    uint16_t element;
+    volatile I2C_Transaction_t *t = &channel->queue[channel->tail & I2C_QUEUE_MASK];
+
+    channel->running = true;
+    channel->sequence = (uint16_t *)t->sequence;
+    channel->sequence_end = (uint16_t *)t->sequence + t->len;
+    channel->recieve_buffer = t->recieve_buffer;
+    channel->mode = I2C_TX;
 
-    uint8_t status = i2c->S;
+    // Acknowledge the interrupt request
+    i2c->S |= I2C_S_IICIF_MASK;
+#if !I2C_POLLING_FLAG
+    i2c->C1 = (I2C_C1_IICEN_MASK | I2C_C1_IICIE_MASK);
+#else
+    i2c->C1 = I2C_C1_IICEN_MASK;
+#endif
+    // Generate a start condition and prepare for transmitting
+    i2c->C1 |= (I2C_C1_MST_MASK | I2C_C1_TX_MASK);
+
+    i2c->D = *(channel->sequence)++; // Writes the first byte
+    // The ISR handler will take care of the rest
+}
+
+// Pops the transaction that just ended (STOP already sent), tells its owner
+// and starts the next one, if any
+static void endTransaction(uint8_t channel_id, bool ok)
+{
+    volatile I2C_Buffer_t *channel = &(I2C_channel[channel_id]);
+    volatile I2C_Transaction_t *t = &channel->queue[channel->tail & I2C_QUEUE_MASK];
+    I2C_Callback_t callback = t->callback;
+    void *user = t->user;
+
+    channel->running = false;
+    channel->tail++;
+    if (channel->head == channel->tail)
+    {
+        channel->status = ok ? I2C_AVAILABLE : I2C_ERROR;
+    }
+
+    if (callback != NULL)
+    {
+        callback(user, ok); // may queue, and start, the next one
+    }
+
+    if (!channel->running && channel->head != channel->tail)
+    {
+        startTransaction(channel_id);
+    }
+}
+
+#if I2C_DMA_MIN_READS
+// RX of a long run of reads: the DMA takes D on every byte of the run but
+// the last two, which go back to I2C_ByteDone() for the NACK and STOP/Sr.
+// Called right after the dummy read that clocks in the first byte.
+static void startReadDMA(uint8_t channel_id)
+{
+    I2C_Type *i2c = I2C_base_ptrs[channel_id];
+    volatile I2C_Buffer_t *channel = &(I2C_channel[channel_id]);
+    uint8_t dma_ch = I2C_DMA_CH_BASE + channel_id;
+    uint8_t n = channel->reads_ahead - 1; // reads left after the dummy, minus 2
+
+    DMA0->TCD[dma_ch].SADDR = (uint32_t)&i2c->D;
+    DMA0->TCD[dma_ch].SOFF = 0;
+    DMA0->TCD[dma_ch].ATTR = DMA_ATTR_SSIZE(0) | DMA_ATTR_DSIZE(0);
+    DMA0->TCD[dma_ch].NBYTES_MLNO = 1;
+    DMA0->TCD[dma_ch].SLAST = 0;
+    DMA0->TCD[dma_ch].DADDR = (uint32_t)channel->recieve_buffer;
+    DMA0->TCD[dma_ch].DOFF = 1;
+    DMA0->TCD[dma_ch].CITER_ELINKNO = DMA_CITER_ELINKNO_CITER(n);
+    DMA0->TCD[dma_ch].BITER_ELINKNO = DMA_BITER_ELINKNO_BITER(n);
+    DMA0->TCD[dma_ch].DLAST_SGA = 0;
+#if !I2C_POLLING_FLAG
+    DMA0->TCD[dma_ch].CSR = DMA_CSR_DREQ_MASK | DMA_CSR_INTMAJOR_MASK;
+#else
+    DMA0->TCD[dma_ch].CSR = DMA_CSR_DREQ_MASK;
+#endif
+    DMA0->SERQ = DMA_SERQ_SERQ(dma_ch);
+
+    channel->dma_len = n;
+    channel->dma_active = true;
+    // byte requests go to the DMA, no IRQ per byte
+    i2c->C1 = (i2c->C1 & ~I2C_C1_IICIE_MASK) | I2C_C1_DMAEN_MASK;
+}
+
+// The DMA has read all but the last two bytes; the one before last is being
+// clocked in (or is already waiting in D, with SCL held low)
+static void readDMADone(uint8_t channel_id)
+{
+    I2C_Type *i2c = I2C_base_ptrs[channel_id];
+    volatile I2C_Buffer_t *channel = &(I2C_channel[channel_id]);
+    uint8_t dma_ch = I2C_DMA_CH_BASE + channel_id;
+
+    DMA0->CINT = DMA_CINT_CINT(dma_ch);
+    DMA0->CDNE = DMA_CDNE_CDNE(dma_ch);
+    channel->dma_active = false;
+    channel->sequence += channel->dma_len;
+    channel->recieve_buffer += channel->dma_len;
+    channel->reads_ahead = 1;
+
+    i2c->C1 &= ~I2C_C1_DMAEN_MASK;
+    i2c->S = I2C_S_IICIF_MASK; // stale flags from the DMA's bytes
+    if (i2c->S & I2C_S_TCF_MASK)
+    {
+        // already in: its IICIF may have been cleared above. IICIE is still
+        // off, so the I2C IRQ can't take this byte too
+        I2C_ByteDone(channel_id, i2c->S);
+    }
+#if !I2C_POLLING_FLAG
+    // the last byte is still ahead, its IRQ finishes the run
+    i2c->C1 |= I2C_C1_IICIE_MASK;
+#endif
+}
+#endif
+
+static void I2C_IRQHandler(uint8_t channel_id)
+{
+    uint8_t status = I2C_base_ptrs[channel_id]->S;
 
     if (!(status & I2C_S_IICIF_MASK))
     {   // the IICF was trigg'd by another module
         return;
     }
+    I2C_ByteDone(channel_id, status);
+}
+
+// One byte (or address) went through: moves the sequence one step
+static void I2C_ByteDone(uint8_t channel_id, uint8_t status)
+{
+    volatile I2C_Buffer_t *channel = &(I2C_channel[channel_id]);
+    I2C_Type* i2c = I2C_base_ptrs[channel_id];
+    uint16_t element;
 
     i2c->S |= I2C_S_IICIF_MASK; // Acknowledge the IRQ
 
@@ -252,7 +430,7 @@ static void I2C_IRQHandler(uint8_t channel_id)
         i2c->S |= I2C_S_ARBL_MASK;
         i2c->C1 &= ~(I2C_C1_MST_MASK | I2C_C1_IICIE_MASK); /* Generate STOP and
         disable further interrupts. */
-        channel->status = I2C_ERROR;
+        endTransaction(channel_id, false);
         return;
     }
 
@@ -268,7 +446,7 @@ static void I2C_IRQHandler(uint8_t channel_id)
             {
             ; // tiny wait, because the last byte is still being transmitted
             }
-            channel->status = I2C_AVAILABLE;
+            endTransaction(channel_id, true);
             return; // Success
         }
 
@@ -276,7 +454,7 @@ static void I2C_IRQHandler(uint8_t channel_id)
         {
             i2c->C1 &= ~(I2C_C1_MST_MASK | I2C_C1_IICIE_MASK); /* Generate STOP 
             and disable further interrupts. */
-            channel->status = I2C_ERROR;
+            endTransaction(channel_id, false);
             return; // Error
         }
 
@@ -311,12 +489,19 @@ static void I2C_IRQHandler(uint8_t channel_id)
                 }
                 else
                 {
-                    i2c->C1 &= ~I2C_C1_TX_MASK; // ACK but the final read
+                    i2c->C1 &= ~I2C_C1_TXAK_MASK; // ACK but the final read
                 }
                 /* Now comes a dummy read. Thats why we dont increment the 
                 recieve_buffer pointer*/
                 *channel->recieve_buffer = i2c->D;
                 channel->reads_ahead--;
+#if I2C_DMA_MIN_READS
+                if (channel->reads_ahead + 1 >= I2C_DMA_MIN_READS
+                    && I2C_dma_source[channel_id])
+                {
+                    startReadDMA(channel_id);
+                }
+#endif
             }
             else // Not a restart, not a read, must be a write
             {
@@ -354,7 +539,7 @@ static void I2C_IRQHandler(uint8_t channel_id)
                     ; /* tiny wait, because the last byte is still being 
                     transmitted */
                     }
-                    channel->status = I2C_AVAILABLE;
+                    endTransaction(channel_id, true);
                     return;
                 }
                 break;
@@ -393,3 +578,18 @@ __ISR__ I2C2_IRQHandler(void)
 {
     I2C_IRQHandler(2);
 }
+
+#if I2C_DMA_MIN_READS && !I2C_POLLING_FLAG
+#if I2C_DMA_CH_BASE != 0
+#error "move the DMA handlers below along with I2C_DMA_CH_BASE"
+#endif
+__ISR__ DMA0_IRQHandler(void)
+{
+    readDMADone(0);
+}
+
+__ISR__ DMA1_IRQHandler(void)
+{
+    readDMADone(1);
+}
+#endif
@@ -30,10 +30,40 @@
 #define I2C_NUMBER_OF_CHANNELS FSL_FEATURE_SOC_I2C_COUNT // three I2C modules on the Kinetis K64 
 #define I2C_RESTART 1<<8 // Reapeted start bit 8-bit symbol
 #define I2C_READ    2<<8 // Read bit 8-bit symbol
-#define I2C_MAX_SEQUENCE_LEN 100
+#define I2C_MAX_SEQUENCE_LEN 200 // fits a full FXOS FIFO burst (197)
 
 #define I2C_POLLING_FLAG true // Set to true to use polling instead of IRQs
 
+// Transactions each channel can hold (in flight + waiting). Every slot keeps
+// its own copy of the sequence: 2 * I2C_MAX_SEQUENCE_LEN bytes per slot.
+#ifndef I2C_QUEUE_LEN
+#define I2C_QUEUE_LEN 4
+#endif
+
+// Runs of at least this many I2C_READs are moved by the eDMA instead of one
+// IRQ per byte; the last two bytes of the run (NACK + STOP/Sr) stay in the ISR.
+// The IRQ saving (about 6 instead of about 200 for a 32-sample FXOS FIFO burst)
+// only applies with I2C_POLLING_FLAG false. When polling, as by default, the
+// DMA saves I2C_ServicePoll() from stepping every byte and keeps the burst
+// going while the main loop is busy elsewhere.
+// Set to 0 to disable the DMA. I2C1 and I2C2 share a DMAMUX source, so only
+// I2C0 and I2C1 use it.
+#ifndef I2C_DMA_MIN_READS
+#define I2C_DMA_MIN_READS 8
+#endif
+
+// eDMA channel used by I2C n is I2C_DMA_CH_BASE + n
+#ifndef I2C_DMA_CH_BASE
+#define I2C_DMA_CH_BASE 0
+#endif
+
+#if (I2C_QUEUE_LEN & (I2C_QUEUE_LEN - 1)) != 0
+#error "I2C_QUEUE_LEN must be a power of 2"
+#endif
+#if I2C_DMA_MIN_READS != 0 && I2C_DMA_MIN_READS < 3
+#error "I2C_DMA_MIN_READS must be 0 or at least 3"
+#endif
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
@@ -45,6 +75,15 @@ typedef enum
     I2C_ERROR
 } I2C_Status_e;
 
+/**
+ * @brief Called when a queued transaction ends, from the I2C ISR (or from
+ * I2C_ServicePoll() when polling). It may queue the next transaction.
+ * @param user Pointer given to I2C_MasterQueueSequence().
+ * @param ok   true if the whole sequence went through, false on NACK or lost
+ * arbitration.
+ */
+typedef void (*I2C_Callback_t)(void *user, bool ok);
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -70,25 +109,44 @@ bool I2C_MasterInit(uint8_t channel, uint32_t baud_rate);
  * 
  * @param channel_number   I2C channel number to use for the transmission
  * @param sequence         Pointer to the I2C operation sequence array
- * @param sequence_length  Number of elements in the sequence array (minimum: 2)
+ * @param sequence_length  Number of elements in the sequence array (minimum: 2,
+ *                         maximum: I2C_MAX_SEQUENCE_LEN)
  * @param received_data    Buffer to store bytes from I2C_READ operations. Pass 
  * @c NULL if there are no reads in the sequence. Buffer must be large enough 
  * to hold one byte per READ operation.
- * @return true on success, false on error.
+ * @return true on success, false on error (or if the queue is full).
  * @see I2C_RESTART
  * @see I2C_READ
+ * @see I2C_MasterQueueSequence
  */
 bool I2C_MasterSendSequence(uint8_t channel, uint16_t *sequence, 
                             uint32_t sequence_len, uint8_t *recieve_buffer);
 
 /**
- * @brief Returns the status of the channel selected.
+ * @brief Same as I2C_MasterSendSequence(), with a completion callback.
+ *
+ * The sequence is copied into the channel's queue, so the caller's array can
+ * be reused right away; transactions run back-to-back in the order they were
+ * queued. received_data must stay valid until the callback.
+ *
+ * @param callback Called once when this transaction ends. Can be NULL.
+ * @param user     Passed to the callback.
+ * @return true if queued, false on bad arguments or if I2C_QUEUE_LEN
+ * transactions are already pending.
+ */
+bool I2C_MasterQueueSequence(uint8_t channel, const uint16_t *sequence,
+                             uint32_t sequence_len, uint8_t *recieve_buffer,
+                             I2C_Callback_t callback, void *user);
+
+/**
+ * @brief Returns the status of the channel selected: I2C_BUSY while any
+ * transaction is queued, otherwise the result of the last one.
  */
 I2C_Status_e I2C_GetStatus(uint8_t channel);
 
 /**
- * @brief Polling service that should be called from your main loop and after
- * checking that I2C_GetStatus() returns I2C_AVAILABLE. 
+ * @brief Polling service that should be called from your main loop while
+ * I2C_GetStatus() returns I2C_BUSY. Runs the callbacks when polling.
  */
 void I2C_ServicePoll(uint8_t ch);
 
@@ -0,0 +1,139 @@
+/***************************************************************************//**
+  @file     attitude.c
+  @brief    Integer attitude math on raw FXOS8700CQ counts
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "attitude.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define ATT_90      (90 * ATT_UNITS_PER_DEG)
+#define ATT_180     (180 * ATT_UNITS_PER_DEG)
+
+// atan(z) ~ z*(C1 + z^2*(C3 + z^2*(C5 + z^2*C7))) on [0, 1], minimax fit.
+// Coefficients in 1/16 of the output unit; z is Q15.
+#define ATAN_C1     91601
+#define ATAN_C3     (-29443)
+#define ATAN_C5     13409
+#define ATAN_C7     (-3574)
+#define ATAN_FRAC   4
+
+/*******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************/
+
+// 1/sqrt(M) in Q15 at the middle of [i/32, (i+1)/32), i = 8..31
+static const uint16_t rsqrt_seed[24] =
+{
+    63579, 60140, 57205, 54661, 52429, 50450, 48679, 47082,
+    45633, 44310, 43096, 41977, 40940, 39977, 39078, 38238,
+    37449, 36708, 36008, 35347, 34722, 34128, 33564, 33027,
+};
+
+/*******************************************************************************
+ * LOCAL FUNCTIONS PROTOTYPES
+ ******************************************************************************/
+
+static uint32_t rsqrtNorm(uint32_t x, uint32_t *m, uint32_t *half_shift);
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+int16_t Att_Atan2(int32_t y, int32_t x)
+{
+    uint32_t ax = (x < 0) ? -(uint32_t)x : (uint32_t)x;
+    uint32_t ay = (y < 0) ? -(uint32_t)y : (uint32_t)y;
+    uint32_t mn = (ax < ay) ? ax : ay;
+    uint32_t mx = (ax < ay) ? ay : ax;
+
+    if (mx == 0) return 0;
+
+    // mn << 15 has to fit in 32 bits
+    while (mx > 0xFFFF)
+    {
+        mx >>= 1;
+        mn >>= 1;
+    }
+
+    int32_t z = (int32_t)(((mn << 15) + (mx >> 1)) / mx); // Q15, [0, 1]
+    int32_t z2 = (z * z) >> 15;
+    int32_t p = ATAN_C7;
+    p = ATAN_C5 + ((p * z2) >> 15);
+    p = ATAN_C3 + ((p * z2) >> 15);
+    p = ATAN_C1 + ((p * z2) >> 15);
+    // p > 0 here and p * z needs all 32 bits
+    int32_t a = (int32_t)((((uint32_t)p * (uint32_t)z >> 15)
+                           + (1u << (ATAN_FRAC - 1))) >> ATAN_FRAC);
+
+    if (ay > ax) a = ATT_90 - a;
+    if (x < 0) a = ATT_180 - a;
+    return (int16_t)((y < 0) ? -a : a);
+}
+
+uint32_t Att_RSqrtQ31(uint32_t x)
+{
+    if (x == 0) return 0;
+
+    uint32_t m, half_shift;
+    uint32_t y = rsqrtNorm(x, &m, &half_shift);
+    return y >> (15 - half_shift);
+}
+
+uint32_t Att_Sqrt(uint32_t x)
+{
+    if (x == 0) return 0;
+
+    uint32_t m, half_shift;
+    uint32_t y = rsqrtNorm(x, &m, &half_shift);
+
+    // sqrt(M) = M / sqrt(M), Q30; x = M * 2^(32 - 2 * half_shift)
+    uint32_t s = (uint32_t)(((uint64_t)m * y) >> 32);
+    s = (s + (1u << (13 + half_shift))) >> (14 + half_shift);
+
+    // the Newton result is within one of the floor
+    if ((uint64_t)s * s > x) s--;
+    else if ((uint64_t)(s + 1) * (s + 1) <= x) s++;
+    return s;
+}
+
+void Att_Tilt(const RawData_t *acc, Attitude_t *att)
+{
+    int32_t ax = acc->x, ay = acc->y, az = acc->z;
+    uint32_t yz2 = (uint32_t)(ay * ay) + (uint32_t)(az * az);
+
+    if (yz2 == 0 && ax == 0) return;
+
+    att->pitch = -Att_Atan2(ay, az);
+    att->roll = Att_Atan2(ax, (int32_t)Att_Sqrt(yz2));
+}
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS WITH FILE SCOPE
+ ******************************************************************************/
+
+// 1/sqrt(M) in Q30, where x << (2 * half_shift) = M * 2^32 = *m, M in [1/4, 1)
+static uint32_t rsqrtNorm(uint32_t x, uint32_t *m, uint32_t *half_shift)
+{
+    uint32_t n = (uint32_t)__builtin_clz(x) & ~1u;
+    uint32_t mm = x << n;
+    uint64_t y = (uint64_t)rsqrt_seed[(mm >> 27) - 8] << 15;
+
+    // y = y * (3 - M * y^2) / 2, twice: ~3 % -> 1e-3 -> 3e-6
+    for (int i = 0; i < 2; i++)
+    {
+        uint64_t y2 = (y * y) >> 30;
+        uint64_t my2 = (mm * y2) >> 32;
+        y = (y * ((3ull << 30) - my2)) >> 31;
+    }
+
+    *m = mm;
+    *half_shift = n >> 1;
+    return (uint32_t)y;
+}
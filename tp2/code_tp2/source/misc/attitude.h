@@ -0,0 +1,64 @@
+/***************************************************************************//**
+  @file     attitude.h
+  @brief    Integer attitude math on raw FXOS8700CQ counts: atan2, sqrt and
+            1/sqrt without libm or the FPU
+ ******************************************************************************/
+
+#ifndef _ATTITUDE_H_
+#define _ATTITUDE_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdint.h>
+
+#include "../drv/FXOS8700CQ.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define ATT_UNITS_PER_DEG   100     // angles are in 1/100 degree
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Angles in 1/100 degree, [-18000, 18000]
+typedef struct
+{
+    int16_t roll;
+    int16_t pitch;
+    int16_t yaw;
+} Attitude_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief atan2(y, x) in 1/100 degree. Octant reduction, one division and a
+ * degree 7 minimax polynomial (0.005 deg before rounding). atan2(0, 0) = 0.
+ */
+int16_t Att_Atan2(int32_t y, int32_t x);
+
+/**
+ * @brief 1/sqrt(x) in Q31 (1.0 = 2^31) for x >= 1; 0 for x = 0. Table seed
+ * and two Newton steps, relative error below 1e-5 (plus the Q31 step).
+ */
+uint32_t Att_RSqrtQ31(uint32_t x);
+
+/**
+ * @brief floor(sqrt(x)), from the same Newton steps as Att_RSqrtQ31.
+ */
+uint32_t Att_Sqrt(uint32_t x);
+
+/**
+ * @brief Roll and pitch from raw accelerometer counts (any scale), same axes
+ * and signs as the old float vec2rot(). yaw is not touched. A zero vector
+ * leaves att as it was.
+ */
+void Att_Tilt(const RawData_t *acc, Attitude_t *att);
+
+#endif // _ATTITUDE_H_
@@ -0,0 +1,166 @@
+/***************************************************************************//**
+  @file     fusion.c
+  @brief    Accelerometer + magnetometer fusion
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "fusion.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define G_LO        (FUSION_ONE_G - (FUSION_ONE_G >> FUSION_GATE_SHIFT))
+#define G_HI        (FUSION_ONE_G + (FUSION_ONE_G >> FUSION_GATE_SHIFT))
+
+/*******************************************************************************
+ * LOCAL FUNCTIONS PROTOTYPES
+ ******************************************************************************/
+
+static uint8_t shiftForTau(uint32_t tau_ms, uint32_t update_hz);
+static inline int32_t filterOut(int32_t state);
+static inline void filterStep(int32_t *state, int32_t in, uint32_t shift);
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+void Fusion_Init(Fusion_t *f, uint32_t update_hz, uint32_t block)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        f->acc[i] = 0;
+        f->mag[i] = 0;
+        f->tilt[i] = 0;
+    }
+    f->acc_shift = shiftForTau(FUSION_ACC_TAU_MS, update_hz);
+    f->acc_shift_moving = shiftForTau(FUSION_ACC_TAU_MOVING_MS, update_hz);
+    f->mag_shift = shiftForTau(FUSION_MAG_TAU_MS, update_hz);
+    f->tilt_shift = shiftForTau(FUSION_BLOCK_TAU_MS, update_hz);
+    f->tilt_shift_moving = shiftForTau(FUSION_BLOCK_TAU_MOVING_MS, update_hz);
+    f->block_means = (block > 1);
+    f->primed = false;
+}
+
+void Fusion_Update(Fusion_t *f, const RawData_t *acc, const RawData_t *mag,
+                   Attitude_t *att)
+{
+    const int32_t a_in[3] = { acc->x, acc->y, acc->z };
+    const int32_t m_in[3] =
+    {
+        (mag != NULL) ? mag->x : 0,
+        (mag != NULL) ? mag->y : 0,
+        (mag != NULL) ? mag->z : 0,
+    };
+
+    if (!f->primed)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            f->acc[i] = a_in[i] * (1 << FUSION_FRAC);
+            f->mag[i] = m_in[i] * (1 << FUSION_FRAC);
+            f->tilt[i] = f->acc[i];
+        }
+        f->primed = (mag != NULL);
+    }
+    else
+    {
+        uint32_t a2 = (uint32_t)(a_in[0] * a_in[0]) + (uint32_t)(a_in[1] * a_in[1])
+                      + (uint32_t)(a_in[2] * a_in[2]);
+        bool moving = (a2 < (uint32_t)G_LO * G_LO || a2 > (uint32_t)G_HI * G_HI);
+        uint32_t shift = moving ? f->acc_shift_moving : f->acc_shift;
+        for (int i = 0; i < 3; i++)
+        {
+            filterStep(&f->acc[i], a_in[i], shift);
+        }
+        shift = moving ? f->tilt_shift_moving : f->tilt_shift;
+        for (int i = 0; f->block_means && i < 3; i++)
+        {
+            filterStep(&f->tilt[i], a_in[i], shift);
+        }
+        for (int i = 0; mag != NULL && i < 3; i++)
+        {
+            filterStep(&f->mag[i], m_in[i], f->mag_shift);
+        }
+    }
+
+    const int32_t *tilt = f->block_means ? f->tilt : f->acc;
+    RawData_t a_f =
+    {
+        .x = (int16_t)filterOut(tilt[0]),
+        .y = (int16_t)filterOut(tilt[1]),
+        .z = (int16_t)filterOut(tilt[2]),
+    };
+    Att_Tilt(&a_f, att);
+
+    // d = down (the accelerometer reads up), e = d x m points east and
+    // n = e x d north; yaw = atan2(x . e/|e|, x . n/|n|), |n| = |e| |d|
+    int32_t d[3] = { -filterOut(f->acc[0]), -filterOut(f->acc[1]),
+                     -filterOut(f->acc[2]) };
+    int32_t m[3] = { filterOut(f->mag[0]), filterOut(f->mag[1]),
+                     filterOut(f->mag[2]) };
+
+    int32_t e[3] =
+    {
+        d[1] * m[2] - d[2] * m[1],
+        d[2] * m[0] - d[0] * m[2],
+        d[0] * m[1] - d[1] * m[0],
+    };
+
+    // e to 16 bits so that e x d fits in 32
+    uint32_t e_max = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        e_max |= (e[i] < 0) ? -(uint32_t)e[i] : (uint32_t)e[i];
+    }
+    if (e_max == 0) return; // field along gravity, or no field yet: keep yaw
+
+    int32_t sh = 17 - __builtin_clz(e_max);
+    if (sh > 0)
+    {
+        e[0] >>= sh;
+        e[1] >>= sh;
+        e[2] >>= sh;
+    }
+
+    int32_t n_x = e[1] * d[2] - e[2] * d[1];
+    uint32_t d_norm = Att_Sqrt((uint32_t)(d[0] * d[0]) + (uint32_t)(d[1] * d[1])
+                               + (uint32_t)(d[2] * d[2]));
+
+    att->yaw = Att_Atan2(e[0] * (int32_t)d_norm, n_x);
+}
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS WITH FILE SCOPE
+ ******************************************************************************/
+
+// Gain 2^-shift has a time constant of ~2^shift samples: the power of two
+// nearest (in log) to tau_ms * update_hz / 1000
+static uint8_t shiftForTau(uint32_t tau_ms, uint32_t update_hz)
+{
+    uint32_t x = tau_ms * update_hz; // samples * 1000
+    uint8_t k = 0;
+    while (k < 15 && (1000u << (k + 1)) <= x)
+    {
+        k++;
+    }
+    // past 2^k * sqrt(2) (99 / 70) rounds up
+    if (k < 15 && (uint64_t)x * 70u >= (uint64_t)(1000u << k) * 99u)
+    {
+        k++;
+    }
+    return k;
+}
+
+static inline int32_t filterOut(int32_t state)
+{
+    return (state + (1 << (FUSION_FRAC - 1))) >> FUSION_FRAC;
+}
+
+static inline void filterStep(int32_t *state, int32_t in, uint32_t shift)
+{
+    *state += (in * (1 << FUSION_FRAC) - *state) >> shift;
+}
@@ -0,0 +1,120 @@
+/***************************************************************************//**
+  @file     fusion.h
+  @brief    Accelerometer + magnetometer fusion: filtered roll and pitch and
+            tilt-compensated yaw, in integer math with a fixed cost per sample
+ ******************************************************************************/
+
+#ifndef _FUSION_H_
+#define _FUSION_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "attitude.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// The FXOS has no gyro, so there is no fast path to blend with: the filter
+// keeps the gravity and field vectors with first-order IIRs (gain 2^-shift)
+// and trusts the accelerometer less while |a| is away from 1 g, when it also
+// sees linear acceleration. Angles come from the filtered vectors, so they
+// never wrap inside the filter.
+//
+// The time constants are in ms: Fusion_Init() turns them into the nearest
+// power-of-two gain at the update rate of the caller, so the 50 Hz register
+// reads and the 25 Hz FIFO blocks of app.c get the same response (2^-3 and
+// 2^-2, 2^-5 and 2^-4 moving). Both vectors need the same lag, or the heading
+// mixes a tilt and a field from different times.
+//
+// Fed block means (the FIFO path), the accelerometer already averages a block
+// per update and the IIR above mostly adds lag: replay_fusion gets a worse roll
+// through it than from the raw means. Roll and pitch then come from a faster
+// filter of their own (2^-1, 2^-3 moving at 25 Hz), and the heading keeps the
+// accelerometer filtered at the magnetometer lag.
+
+#ifndef FUSION_ACC_TAU_MS
+#define FUSION_ACC_TAU_MS         160
+#endif
+
+#ifndef FUSION_ACC_TAU_MOVING_MS
+#define FUSION_ACC_TAU_MOVING_MS  640 // while |a| is off
+#endif
+
+#ifndef FUSION_MAG_TAU_MS
+#define FUSION_MAG_TAU_MS         FUSION_ACC_TAU_MS
+#endif
+
+#ifndef FUSION_BLOCK_TAU_MS
+#define FUSION_BLOCK_TAU_MS       80  // roll and pitch, fed block means
+#endif
+
+#ifndef FUSION_BLOCK_TAU_MOVING_MS
+#define FUSION_BLOCK_TAU_MOVING_MS 320
+#endif
+
+#ifndef FUSION_ONE_G
+#define FUSION_ONE_G            4096 // accelerometer counts per g (+-2 g)
+#endif
+
+#ifndef FUSION_GATE_SHIFT
+#define FUSION_GATE_SHIFT       3   // |a| off by more than 1/8 g -> moving
+#endif
+
+#define FUSION_FRAC             8   // fraction bits of the filter state
+
+// Cycles per Fusion_Update(), a bound derived on the host and not measured on
+// the K64: replay_fusion takes ~200 x86 cycles per sample, and the M4 gets 3x
+// that for its software Att_Atan2()/Att_Sqrt() and 32-bit multiplies. app.c
+// measures the real worst case with the DWT cycle counter when
+// APP_FUSION_PROFILE is set.
+#define FUSION_CYCLE_BUDGET     600
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef struct
+{
+    int32_t acc[3];     // filtered counts << FUSION_FRAC
+    int32_t mag[3];
+    int32_t tilt[3];    // accelerometer for roll and pitch, block means only
+    uint8_t acc_shift;  // gains from the time constants, see Fusion_Init()
+    uint8_t acc_shift_moving;
+    uint8_t mag_shift;
+    uint8_t tilt_shift;
+    uint8_t tilt_shift_moving;
+    bool block_means;   // roll and pitch from tilt instead of acc
+    bool primed;        // the first sample loads the filters
+} Fusion_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Clears the filters; the next sample is taken as is.
+ * @param update_hz Rate of the Fusion_Update() calls, to set the gains.
+ * @param block Accelerometer samples averaged into each update (1 for single
+ * samples, the FIFO watermark for FXOS_BlockMeanRaw()).
+ */
+void Fusion_Init(Fusion_t *f, uint32_t update_hz, uint32_t block);
+
+/**
+ * @brief Feeds one sample and writes roll, pitch (as Att_Tilt) and yaw.
+ * @param acc Accelerometer counts.
+ * @param mag Magnetometer counts, same axes as acc. NULL keeps the last field
+ * (for accelerometer samples between magnetometer reads).
+ * @param att yaw is the heading of the sensor x axis, clockwise from magnetic
+ * north, in 1/100 degree. No hard or soft iron correction is applied.
+ */
+void Fusion_Update(Fusion_t *f, const RawData_t *acc, const RawData_t *mag,
+                   Attitude_t *att);
+
+#endif // _FUSION_H_
@@ -0,0 +1,95 @@
+/***************************************************************************//**
+  @file     telemetry.c
+  @brief    Binary station telemetry
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "telemetry.h"
+
+/*******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************/
+
+// CRC-8 of the high nibble n << 4, poly 0x07
+static const uint8_t crc8_nibble[16] =
+{
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+};
+
+/*******************************************************************************
+ * LOCAL FUNCTIONS PROTOTYPES
+ ******************************************************************************/
+
+static inline void putInt16(uint8_t *p, int16_t v);
+static size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out);
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+uint8_t Tlm_Crc8(uint8_t crc, const uint8_t *data, size_t len)
+{
+    while (len--)
+    {
+        crc ^= *data++;
+        crc = (uint8_t)(crc << 4) ^ crc8_nibble[crc >> 4];
+        crc = (uint8_t)(crc << 4) ^ crc8_nibble[crc >> 4];
+    }
+    return crc;
+}
+
+size_t Tlm_EncodeAngles(uint8_t station, uint8_t seq, const Attitude_t *att,
+                        uint8_t out[TLM_FRAME_MAX])
+{
+    uint8_t payload[TLM_PAYLOAD_LEN];
+    payload[0] = station;
+    payload[1] = seq;
+    putInt16(&payload[2], att->roll);
+    putInt16(&payload[4], att->pitch);
+    putInt16(&payload[6], att->yaw);
+    payload[8] = Tlm_Crc8(0x00, payload, TLM_PAYLOAD_LEN - 1);
+
+    size_t n = cobsEncode(payload, TLM_PAYLOAD_LEN, out);
+    out[n++] = TLM_DELIMITER;
+    return n;
+}
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS WITH FILE SCOPE
+ ******************************************************************************/
+
+static inline void putInt16(uint8_t *p, int16_t v)
+{
+    p[0] = (uint8_t)((uint16_t)v & 0xFF);
+    p[1] = (uint8_t)((uint16_t)v >> 8);
+}
+
+// Each 0x00 is replaced by the distance to the next one; out gets len + 1
+// bytes (payloads under 254 bytes)
+static size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t code_at = 0;
+    size_t n = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (in[i] == 0)
+        {
+            out[code_at] = code;
+            code_at = n++;
+            code = 1;
+        }
+        else
+        {
+            out[n++] = in[i];
+            code++;
+        }
+    }
+    out[code_at] = code;
+    return n;
+}
@@ -0,0 +1,54 @@
+/***************************************************************************//**
+  @file     telemetry.h
+  @brief    Binary station telemetry: angles packed in a COBS frame with a
+            CRC-8, 11 bytes per update on the UART
+ ******************************************************************************/
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "attitude.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// Payload, little endian:
+//   [0]    station id
+//   [1]    sequence number, +1 per frame of that station (wraps)
+//   [2..3] roll  int16, 1/100 degree
+//   [4..5] pitch int16
+//   [6..7] yaw   int16
+//   [8]    CRC-8 of [0..7] (poly 0x07, init 0x00, CRC-8/SMBUS)
+// The payload goes out COBS encoded and followed by a 0x00, so 0x00 only
+// appears between frames and the receiver resyncs on the next one after a
+// lost byte. tools: TiltNetworkTool src/protocol/protocol_handler.py.
+#define TLM_PAYLOAD_LEN     9
+#define TLM_FRAME_MAX       (TLM_PAYLOAD_LEN + 2) // COBS code byte + 0x00
+#define TLM_DELIMITER       0x00
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief CRC-8 (poly 0x07, init crc = 0x00) of len bytes, nibble table.
+ */
+uint8_t Tlm_Crc8(uint8_t crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief Builds the frame of one attitude update.
+ * @param out TLM_FRAME_MAX bytes, ending with the delimiter.
+ * @return Bytes written to out (always TLM_FRAME_MAX for this payload).
+ */
+size_t Tlm_EncodeAngles(uint8_t station, uint8_t seq, const Attitude_t *att,
+                        uint8_t out[TLM_FRAME_MAX]);
+
+#endif // _TELEMETRY_H_
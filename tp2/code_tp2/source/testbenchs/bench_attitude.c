@@ -0,0 +1,198 @@
+/**
+ * @file bench_attitude.c
+ * @brief Host benchmark: integer attitude math (misc/attitude.c) against libm.
+ *
+ * Error sweep:
+ *   - Att_Atan2 over a grid of (y, x) covering the 14-bit accelerometer and
+ *     16-bit magnetometer ranges, against atan2().
+ *   - Att_Sqrt over every x < 2^27 (the largest ay^2 + az^2 of 14-bit counts)
+ *     plus random 32-bit x, against floor(sqrt()); Att_RSqrtQ31 relative error.
+ *   - Att_Tilt over roll/pitch at 0.25 deg steps with |g| = 4096 counts,
+ *     against the float formula of the old vec2rot() on the same counts.
+ * Timing: ns and cycles (TSC on x86) per sample of Att_Tilt and of the float
+ * version with sqrtf/atan2f, on random counts.
+ *
+ * Fails (exit 1) if any angle is off by more than 0.5 deg. Build from this
+ * directory with:
+ *   gcc -O2 -Wall -Wextra -std=c11 -o bench_attitude bench_attitude.c
+ *       ../misc/attitude.c -lm
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../misc/attitude.h"
+#include "bench_common.h"
+
+#define LIMIT_DEG 0.5
+#define N_TIME (1u << 20)
+#define RUNS 5
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static RawData_t samples[N_TIME];
+static volatile int32_t sink;
+
+static double wrap_deg(double d)
+{
+    while (d > 180.0) d -= 360.0;
+    while (d < -180.0) d += 360.0;
+    return d;
+}
+
+static uint32_t xorshift(void)
+{
+    static uint32_t s = 0x2545F491u;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+// old vec2rot() on counts, in degrees
+static void tilt_float(const RawData_t *a, float *roll, float *pitch)
+{
+    float ax = a->x, ay = a->y, az = a->z;
+    *pitch = -atan2f(ay, az) * 57.2957795f;
+    *roll = atan2f(ax, sqrtf(ay * ay + az * az)) * 57.2957795f;
+}
+
+static double sweep_atan2(int32_t range, int32_t step)
+{
+    double worst = 0.0;
+    for (int32_t y = -range; y <= range; y += step)
+    {
+        for (int32_t x = -range; x <= range; x += step)
+        {
+            if (x == 0 && y == 0) continue;
+            double ref = atan2((double)y, (double)x) * 180.0 / M_PI;
+            double got = Att_Atan2(y, x) / (double)ATT_UNITS_PER_DEG;
+            double e = fabs(wrap_deg(got - ref));
+            if (e > worst) worst = e;
+        }
+    }
+    return worst;
+}
+
+static int sweep_sqrt(double *rsqrt_rel)
+{
+    int bad = 0;
+    for (uint32_t x = 0; x < (1u << 27); x++)
+    {
+        uint32_t s = Att_Sqrt(x);
+        if ((uint64_t)s * s > x || (uint64_t)(s + 1) * (s + 1) <= x) bad++;
+    }
+    *rsqrt_rel = 0.0;
+    for (uint32_t i = 0; i < (1u << 22); i++)
+    {
+        uint32_t x = xorshift() >> (xorshift() & 31);
+        if (x == 0) continue;
+        uint32_t s = Att_Sqrt(x);
+        if ((uint64_t)s * s > x || (uint64_t)(s + 1) * (s + 1) <= x) bad++;
+
+        double ref = 2147483648.0 / sqrt((double)x);
+        double e = fabs(Att_RSqrtQ31(x) - ref) / ref;
+        // the Q31 step alone is 1/ref
+        if (e - 1.0 / ref > *rsqrt_rel) *rsqrt_rel = e - 1.0 / ref;
+    }
+    return bad;
+}
+
+static double sweep_tilt(void)
+{
+    double worst = 0.0;
+    for (int ir = -360; ir <= 360; ir++)
+    {
+        for (int ip = -720; ip <= 720; ip++)
+        {
+            double r = ir * 0.25 * M_PI / 180.0;
+            double p = ip * 0.25 * M_PI / 180.0;
+            // gravity seen by the sensor for that roll/pitch
+            RawData_t a =
+            {
+                .x = (int16_t)lrint(4096.0 * sin(r)),
+                .y = (int16_t)lrint(-4096.0 * cos(r) * sin(p)),
+                .z = (int16_t)lrint(4096.0 * cos(r) * cos(p)),
+            };
+            Attitude_t att = { 0, 0, 0 };
+            float fr, fp;
+            Att_Tilt(&a, &att);
+            tilt_float(&a, &fr, &fp);
+            double er = fabs(wrap_deg(att.roll / 100.0 - fr));
+            double ep = fabs(wrap_deg(att.pitch / 100.0 - fp));
+            if (er > worst) worst = er;
+            if (ep > worst) worst = ep;
+        }
+    }
+    return worst;
+}
+
+int main(void)
+{
+    int fail = 0;
+
+    double e14 = sweep_atan2(8192, 7);
+    double e16 = sweep_atan2(32768, 29);
+    double rsqrt_rel;
+    int sqrt_bad = sweep_sqrt(&rsqrt_rel);
+    double etilt = sweep_tilt();
+
+    printf("atan2 max err, 14-bit grid : %.4f deg\n", e14);
+    printf("atan2 max err, 16-bit grid : %.4f deg\n", e16);
+    printf("tilt max err (roll, pitch) : %.4f deg\n", etilt);
+    printf("sqrt not floor(sqrt)       : %d\n", sqrt_bad);
+    printf("rsqrt Q31 rel err          : %.2e\n", rsqrt_rel);
+    if (e14 > LIMIT_DEG || e16 > LIMIT_DEG || etilt > LIMIT_DEG || sqrt_bad)
+    {
+        fail = 1;
+    }
+
+    for (uint32_t i = 0; i < N_TIME; i++)
+    {
+        samples[i].x = (int16_t)((int32_t)(xorshift() & 0x3FFF) - 0x2000);
+        samples[i].y = (int16_t)((int32_t)(xorshift() & 0x3FFF) - 0x2000);
+        samples[i].z = (int16_t)((int32_t)(xorshift() & 0x3FFF) - 0x2000);
+    }
+
+    double best_int = 1e9, best_flt = 1e9;
+    uint64_t cyc_int = ~0ull, cyc_flt = ~0ull;
+    for (int run = 0; run < RUNS; run++)
+    {
+        Attitude_t att = { 0, 0, 0 };
+        uint64_t c0 = CYCLES();
+        double t0 = now_s();
+        for (uint32_t i = 0; i < N_TIME; i++)
+        {
+            Att_Tilt(&samples[i], &att);
+            sink += att.roll + att.pitch;
+        }
+        double t1 = now_s();
+        uint64_t c1 = CYCLES();
+
+        float fr, fp;
+        for (uint32_t i = 0; i < N_TIME; i++)
+        {
+            tilt_float(&samples[i], &fr, &fp);
+            sink += (int32_t)(fr + fp);
+        }
+        double t2 = now_s();
+        uint64_t c2 = CYCLES();
+
+        if (t1 - t0 < best_int) best_int = t1 - t0;
+        if (t2 - t1 < best_flt) best_flt = t2 - t1;
+        if (c1 - c0 < cyc_int) cyc_int = c1 - c0;
+        if (c2 - c1 < cyc_flt) cyc_flt = c2 - c1;
+    }
+    printf("Att_Tilt    : %6.1f ns/sample %6.1f cycles/sample\n",
+           best_int * 1e9 / N_TIME, (double)cyc_int / N_TIME);
+    printf("float libm  : %6.1f ns/sample %6.1f cycles/sample\n",
+           best_flt * 1e9 / N_TIME, (double)cyc_flt / N_TIME);
+
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
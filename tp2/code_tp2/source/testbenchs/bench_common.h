@@ -0,0 +1,28 @@
+/**
+ * @file bench_common.h
+ * @brief Helpers shared by the host benchmarks in this directory.
+ *
+ * Header only, so every bench keeps its own gcc line. Include it after
+ * _POSIX_C_SOURCE is defined.
+ */
+
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#else
+#define CYCLES() 0ull
+#endif
+
+// Monotonic time in seconds
+static inline double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#endif // BENCH_COMMON_H
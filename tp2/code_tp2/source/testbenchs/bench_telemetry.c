@@ -0,0 +1,250 @@
+/**
+ * @file bench_telemetry.c
+ * @brief Host benchmark: binary telemetry frames (misc/telemetry.c) against the
+ * ASCII lines of UART_SendRotation0().
+ *
+ *   bench_telemetry           self-test and timing
+ *   bench_telemetry -x N      prints N random frames as hex, one per line,
+ *                             "station,seq,roll,pitch,yaw,<hex>", to check the
+ *                             decoder of the PC tool against (replay_telemetry.py)
+ *
+ * Self-test: every frame is TLM_FRAME_MAX bytes with its only 0x00 at the end,
+ * decodes back (COBS + CRC-8) to the same angles, including the all-zero and
+ * the int16 extremes, and every single-bit error in a payload is caught by the
+ * CRC. Timing: ns and cycles (TSC on x86) per update of Tlm_EncodeAngles()
+ * and of the old ASCII formatting, and bytes on the wire of each.
+ *
+ * Fails (exit 1) on any mismatch. Build from this directory with:
+ *   gcc -O2 -Wall -Wextra -std=c11 -o bench_telemetry bench_telemetry.c
+ *       ../misc/telemetry.c
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../misc/telemetry.h"
+#include "bench_common.h"
+
+#define RANDOM_FRAMES 1000000u
+#define TIMED_UPDATES 1000000u
+#define RUNS 5
+
+// ---- copy of the ASCII path in app.c ----
+
+static int clamp_deg_179(int x)
+{
+    int v = (x >= 0 ? x + ATT_UNITS_PER_DEG / 2 : x - ATT_UNITS_PER_DEG / 2)
+            / ATT_UNITS_PER_DEG;
+    if (v > 179)  v = 179;
+    if (v < -179) v = -179;
+    return v;
+}
+
+static void int_to_ascii(int v, char *out)
+{
+    char tmp[12];
+    int n = 0;
+    unsigned int u;
+
+    if (v < 0) { *out++ = '-'; u = (unsigned int)(-v); }
+    else       { u = (unsigned int)v; }
+
+    if (u == 0) { *out++ = '0'; *out = '\0'; return; }
+
+    while (u) { tmp[n++] = (char)('0' + (u % 10)); u /= 10; }
+
+    while (n--) *out++ = tmp[n];
+    *out = '\0';
+}
+
+static void append_str(char **p, const char *s)
+{
+    while (*s) *(*p)++ = *s++;
+}
+
+static void append_int(char **p, int v)
+{
+    char nb[12];
+    int_to_ascii(v, nb);
+    append_str(p, nb);
+}
+
+static size_t ascii_rotation(const Attitude_t *a, char *buf)
+{
+    char *p = buf;
+    append_str(&p, "A,0,O,"); append_int(&p, a->yaw / ATT_UNITS_PER_DEG); append_str(&p, "\n");
+    append_str(&p, "A,0,R,"); append_int(&p, clamp_deg_179(a->roll)); append_str(&p, "\n");
+    append_str(&p, "A,0,C,"); append_int(&p, clamp_deg_179(a->pitch)); append_str(&p, "\n");
+    *p = '\0';
+    return (size_t)(p - buf);
+}
+
+// ---- reference decoder ----
+
+static size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t i = 0, n = 0;
+    while (i < len)
+    {
+        uint8_t code = in[i];
+        if (code == 0 || i + code > len) return 0;
+        for (size_t k = 1; k < code; k++) out[n++] = in[i + k];
+        i += code;
+        if (code < 0xFF && i < len) out[n++] = 0;
+    }
+    return n;
+}
+
+static uint8_t crc8_bitwise(const uint8_t *d, size_t len)
+{
+    uint8_t crc = 0;
+    while (len--)
+    {
+        crc ^= *d++;
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static int16_t rand16(void)
+{
+    return (int16_t)((rand() & 0xFF) | ((rand() & 0xFF) << 8));
+}
+
+static int check_frame(uint8_t st, uint8_t seq, const Attitude_t *a)
+{
+    uint8_t frame[TLM_FRAME_MAX + 4];
+    size_t n = Tlm_EncodeAngles(st, seq, a, frame);
+    if (n != TLM_FRAME_MAX || frame[n - 1] != TLM_DELIMITER) return 1;
+    if (memchr(frame, 0, n - 1) != NULL) return 1;
+
+    uint8_t p[TLM_FRAME_MAX];
+    if (cobs_decode(frame, n - 1, p) != TLM_PAYLOAD_LEN) return 1;
+    if (crc8_bitwise(p, TLM_PAYLOAD_LEN) != 0) return 1;
+    if (p[0] != st || p[1] != seq) return 1;
+    if ((int16_t)(p[2] | p[3] << 8) != a->roll) return 1;
+    if ((int16_t)(p[4] | p[5] << 8) != a->pitch) return 1;
+    if ((int16_t)(p[6] | p[7] << 8) != a->yaw) return 1;
+
+    for (int bit = 0; bit < 8 * TLM_PAYLOAD_LEN; bit++)
+    {
+        p[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        int caught = Tlm_Crc8(0x00, p, TLM_PAYLOAD_LEN) != 0;
+        p[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        if (!caught) return 1;
+    }
+    return 0;
+}
+
+static void print_hex(uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Attitude_t a = { rand16(), rand16(), rand16() };
+        uint8_t st = (uint8_t)rand(), seq = (uint8_t)rand();
+        uint8_t frame[TLM_FRAME_MAX];
+        size_t len = Tlm_EncodeAngles(st, seq, &a, frame);
+        printf("%u,%u,%d,%d,%d,", st, seq, a.roll, a.pitch, a.yaw);
+        for (size_t k = 0; k < len; k++) printf("%02x", frame[k]);
+        printf("\n");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 3 && strcmp(argv[1], "-x") == 0)
+    {
+        print_hex((uint32_t)strtoul(argv[2], NULL, 0));
+        return 0;
+    }
+
+    int fail = 0;
+    static const uint8_t check[] = "123456789";
+    if (Tlm_Crc8(0x00, check, 9) != 0xF4)
+    {
+        printf("CRC-8 check value 0x%02X, expected 0xF4\n", Tlm_Crc8(0x00, check, 9));
+        fail = 1;
+    }
+
+    static const Attitude_t edge[] =
+    {
+        { 0, 0, 0 }, { -32768, 32767, -1 }, { 256, 1, -256 }, { 18000, -18000, 0 },
+    };
+    for (size_t i = 0; i < sizeof(edge) / sizeof(edge[0]); i++)
+    {
+        fail |= check_frame(0, 0, &edge[i]);
+        fail |= check_frame(255, 255, &edge[i]);
+    }
+    uint32_t bad = 0;
+    for (uint32_t i = 0; i < RANDOM_FRAMES; i++)
+    {
+        Attitude_t a = { rand16(), rand16(), rand16() };
+        bad += check_frame((uint8_t)rand(), (uint8_t)i, &a);
+    }
+    printf("%u random frames, %u bad\n", RANDOM_FRAMES, bad);
+    if (bad) fail = 1;
+
+    Attitude_t *in = malloc(TIMED_UPDATES * sizeof(*in));
+    if (in == NULL) return 2;
+    for (uint32_t i = 0; i < TIMED_UPDATES; i++)
+    {
+        in[i].roll = (int16_t)(rand() % 36001 - 18000);
+        in[i].pitch = (int16_t)(rand() % 36001 - 18000);
+        in[i].yaw = (int16_t)(rand() % 36001 - 18000);
+    }
+
+    double best_bin = 1e9, best_txt = 1e9;
+    uint64_t cyc_bin = ~0ull, cyc_txt = ~0ull;
+    size_t bytes_bin = 0, bytes_txt = 0;
+    volatile uint8_t sink = 0;
+    for (int run = 0; run < RUNS; run++)
+    {
+        uint8_t frame[TLM_FRAME_MAX];
+        char text[64];
+
+        bytes_bin = 0;
+        uint64_t c0 = CYCLES();
+        double t0 = now_s();
+        for (uint32_t i = 0; i < TIMED_UPDATES; i++)
+        {
+            bytes_bin += Tlm_EncodeAngles(0, (uint8_t)i, &in[i], frame);
+            sink ^= frame[1];
+        }
+        double t1 = now_s();
+        uint64_t c1 = CYCLES();
+        if (t1 - t0 < best_bin) best_bin = t1 - t0;
+        if (c1 - c0 < cyc_bin) cyc_bin = c1 - c0;
+
+        bytes_txt = 0;
+        c0 = CYCLES();
+        t0 = now_s();
+        for (uint32_t i = 0; i < TIMED_UPDATES; i++)
+        {
+            bytes_txt += ascii_rotation(&in[i], text);
+            sink ^= (uint8_t)text[7];
+        }
+        t1 = now_s();
+        c1 = CYCLES();
+        if (t1 - t0 < best_txt) best_txt = t1 - t0;
+        if (c1 - c0 < cyc_txt) cyc_txt = c1 - c0;
+    }
+    free(in);
+
+    double per_bin = (double)bytes_bin / TIMED_UPDATES;
+    double per_txt = (double)bytes_txt / TIMED_UPDATES;
+    printf("binary: %.1f bytes/update, %.1f ns %.1f cycles/update (host)\n",
+           per_bin, best_bin * 1e9 / TIMED_UPDATES, (double)cyc_bin / TIMED_UPDATES);
+    printf("ascii:  %.1f bytes/update, %.1f ns %.1f cycles/update (host)\n",
+           per_txt, best_txt * 1e9 / TIMED_UPDATES, (double)cyc_txt / TIMED_UPDATES);
+    // 10 bits per byte at 8N1
+    printf("updates/s at 115200 8N1: binary %.0f, ascii %.0f\n",
+           11520.0 / per_bin, 11520.0 / per_txt);
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
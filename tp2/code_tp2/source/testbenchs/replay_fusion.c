@@ -0,0 +1,391 @@
+/**
+ * @file replay_fusion.c
+ * @brief Host replay harness for misc/fusion.c.
+ *
+ *   replay_fusion log.csv [hz [block]]
+ *                                  replays a recorded log and prints the
+ *                                  angles (hz: update rate, default 25;
+ *                                  block: samples per accelerometer mean,
+ *                                  default 16, 1 for APP_ACC_FIFO 0)
+ *   replay_fusion -g N [fifo|both] writes a synthetic log of N updates
+ *   replay_fusion                  self-test of both app.c paths
+ *
+ * Logs are what app.c prints with APP_LOG_RAW: one sample per line,
+ * "ax,ay,az,mx,my,mz" in raw counts; an empty magnetometer ("ax,ay,az,,,")
+ * is an accelerometer-only sample. Lines starting with '#' are skipped.
+ * Replay prints "n,roll,pitch,yaw" in degrees.
+ *
+ * The synthetic sensor sweeps roll, pitch and yaw slowly, with gaussian noise
+ * on both sensors and bumps of linear acceleration, and is read as app.c
+ * does: "both" takes one combined sample per update at 50 Hz (APP_ACC_FIFO
+ * 0); "fifo" averages blocks of FIFO_BLOCK samples at 400 Hz (25 Hz updates)
+ * and pairs each block with the magnetometer read queued at the end of the
+ * previous one. The self-test checks the filtered angles of each against the
+ * truth (delayed by the filter lag and, for the FIFO, by the block mean and
+ * the older field), requires the roll and pitch rms error to be no worse
+ * than Att_Tilt on the raw samples (block means for the FIFO), and times
+ * Fusion_Update (ns and TSC cycles per update). Build from this
+ * directory with:
+ *   gcc -O2 -Wall -Wextra -std=c11 -o replay_fusion replay_fusion.c
+ *       ../misc/fusion.c ../misc/attitude.c -lm
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../misc/fusion.h"
+#include "bench_common.h"
+
+#define BOTH_HZ 50u             // FXOS_Init ODR in hybrid mode
+#define FIFO_HZ 400u            // FXOS_FifoStart ODR in hybrid mode
+#define FIFO_BLOCK 16u          // FXOS_FIFO_WATERMARK
+#define DEFAULT_SECONDS 1000.0
+#define SETTLE_S 2.0            // skipped before checking
+#define ACC_NOISE 6.0           // counts rms, ~1.5 mg
+#define MAG_NOISE 4.0           // counts rms, 0.4 uT
+#define B_H 200.0               // 20 uT horizontal
+#define B_V 400.0               // 40 uT down
+#define LIMIT_TILT_DEG 0.5
+// the field is 10x weaker than gravity in counts: 0.4 uT of noise on 20 uT
+// horizontal is ~1.1 deg per sample, ~0.3 deg rms after the filter at 50 Hz;
+// the FIFO path gets half the field samples and one update older
+#define LIMIT_YAW_DEG 2.0
+#define LIMIT_YAW_FIFO_DEG 2.5
+#define RUNS 5
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct
+{
+    RawData_t acc;
+    RawData_t mag;
+    int has_mag;
+    double t;                   // update time in s, synthetic logs only
+} Sample_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t update_hz;
+    uint32_t block;             // sensor samples per update
+    double limit_yaw;
+} Profile_t;
+
+static const Profile_t profiles[] =
+{
+    { "both", BOTH_HZ, 1, LIMIT_YAW_DEG },
+    { "fifo", FIFO_HZ / FIFO_BLOCK, FIFO_BLOCK, LIMIT_YAW_FIFO_DEG },
+};
+
+static double gauss(void)
+{
+    double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int16_t sat16(double v)
+{
+    if (v > 32767.0) return 32767;
+    if (v < -32768.0) return -32768;
+    return (int16_t)lrint(v);
+}
+
+static double wrap_deg(double d)
+{
+    while (d > 180.0) d -= 360.0;
+    while (d < -180.0) d += 360.0;
+    return d;
+}
+
+// truth in degrees at time t
+static void truth(double t, double ang[3])
+{
+    ang[0] = 40.0 * sin(2.0 * M_PI * 0.05 * t);
+    ang[1] = 30.0 * sin(2.0 * M_PI * 0.031 * t + 1.0);
+    ang[2] = wrap_deg(10.0 * t);
+}
+
+// world is north-west-up; R = Rz(-yaw) Ry(-roll) Rx(-pitch) takes sensor
+// vectors to world, so the sensor sees R^T of up and of the field
+static void sense(double t, RawData_t *acc, RawData_t *mag)
+{
+    double ang[3];
+    truth(t, ang);
+    double r = -ang[0] * M_PI / 180.0;
+    double p = -ang[1] * M_PI / 180.0;
+    double y = -ang[2] * M_PI / 180.0;
+    double cr = cos(r), sr = sin(r), cp = cos(p), sp = sin(p);
+    double cy = cos(y), sy = sin(y);
+    double R[3][3] =
+    {
+        { cy * cr, cy * sr * sp - sy * cp, cy * sr * cp + sy * sp },
+        { sy * cr, sy * sr * sp + cy * cp, sy * sr * cp - cy * sp },
+        { -sr,     cr * sp,                cr * cp },
+    };
+    double up[3] = { 0.0, 0.0, FUSION_ONE_G };
+    double b[3] = { B_H, 0.0, -B_V };
+
+    // a 0.3 g bump along world x every 10 s, 0.2 s long
+    if (fmod(t, 10.0) < 0.2) up[0] += 0.3 * FUSION_ONE_G;
+
+    double a[3], m[3];
+    for (int k = 0; k < 3; k++)
+    {
+        a[k] = R[0][k] * up[0] + R[1][k] * up[1] + R[2][k] * up[2];
+        m[k] = R[0][k] * b[0] + R[1][k] * b[1] + R[2][k] * b[2];
+    }
+    acc->x = sat16(a[0] + ACC_NOISE * gauss());
+    acc->y = sat16(a[1] + ACC_NOISE * gauss());
+    acc->z = sat16(a[2] + ACC_NOISE * gauss());
+    mag->x = sat16(m[0] + MAG_NOISE * gauss());
+    mag->y = sat16(m[1] + MAG_NOISE * gauss());
+    mag->z = sat16(m[2] + MAG_NOISE * gauss());
+}
+
+// Update i of profile pr, as app.c reads it
+static void synth(Sample_t *s, const Profile_t *pr, uint32_t i)
+{
+    if (pr->block == 1)
+    {
+        // FXOS_ReadBothRaw: acc and mag of the same sample
+        s->t = (double)i / pr->update_hz;
+        sense(s->t, &s->acc, &s->mag);
+        s->has_mag = 1;
+        return;
+    }
+
+    // FXOS_BlockMeanRaw over the block, which ends at s->t
+    const double fs = (double)pr->update_hz * pr->block;
+    int32_t sum[3] = { 0, 0, 0 };
+    RawData_t acc, mag;
+    for (uint32_t k = 0; k < pr->block; k++)
+    {
+        sense((i * pr->block + k) / fs, &acc, &mag);
+        sum[0] += acc.x;
+        sum[1] += acc.y;
+        sum[2] += acc.z;
+    }
+    s->t = (i * pr->block + pr->block - 1u) / fs;
+    s->acc.x = (int16_t)(sum[0] / (int32_t)pr->block);
+    s->acc.y = (int16_t)(sum[1] / (int32_t)pr->block);
+    s->acc.z = (int16_t)(sum[2] / (int32_t)pr->block);
+
+    // the magnetometer read queued when the previous block landed
+    s->has_mag = (i > 0);
+    if (s->has_mag)
+    {
+        sense(s->t - 1.0 / pr->update_hz, &acc, &s->mag);
+    }
+}
+
+static int replay(const char *path, uint32_t update_hz, uint32_t block)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        perror(path);
+        return 2;
+    }
+
+    Fusion_t f;
+    Attitude_t att = { 0, 0, 0 };
+    Fusion_Init(&f, update_hz, block);
+
+    char line[256];
+    uint32_t n = 0;
+    printf("n,roll,pitch,yaw\n");
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+
+        int v[6];
+        int got = sscanf(line, "%d,%d,%d,%d,%d,%d",
+                         &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]);
+        if (got != 3 && got != 6)
+        {
+            fprintf(stderr, "%s: bad line %u\n", path, n + 1);
+            continue;
+        }
+        RawData_t acc = { (int16_t)v[0], (int16_t)v[1], (int16_t)v[2] };
+        RawData_t mag = { (int16_t)v[3], (int16_t)v[4], (int16_t)v[5] };
+        Fusion_Update(&f, &acc, (got == 6) ? &mag : NULL, &att);
+        printf("%u,%.2f,%.2f,%.2f\n", n++, att.roll / 100.0, att.pitch / 100.0,
+               att.yaw / 100.0);
+    }
+    fclose(fp);
+    return 0;
+}
+
+static void write_log(uint32_t n, const Profile_t *pr)
+{
+    printf("# ax,ay,az,mx,my,mz (synthetic, %s, %u Hz)\n", pr->name, pr->update_hz);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Sample_t s;
+        synth(&s, pr, i);
+        if (s.has_mag)
+        {
+            printf("%d,%d,%d,%d,%d,%d\n", s.acc.x, s.acc.y, s.acc.z,
+                   s.mag.x, s.mag.y, s.mag.z);
+        }
+        else
+        {
+            printf("%d,%d,%d,,,\n", s.acc.x, s.acc.y, s.acc.z);
+        }
+    }
+}
+
+// group delay of a first-order IIR of gain 2^-shift, (1 - a) / a updates
+static double iir_delay_s(uint8_t shift, uint32_t update_hz)
+{
+    return ((1u << shift) - 1u) / (double)update_hz;
+}
+
+static int self_test(const Profile_t *pr, double seconds)
+{
+    uint32_t n = (uint32_t)(seconds * pr->update_hz);
+    Sample_t *log = malloc(n * sizeof(*log));
+    Attitude_t *out = malloc(n * sizeof(*out));
+    if (log == NULL || out == NULL) return 2;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        synth(&log[i], pr, i);
+    }
+
+    double best = 1e9;
+    uint64_t best_cyc = ~0ull;
+    Fusion_t f;
+    for (int run = 0; run < RUNS; run++)
+    {
+        Attitude_t att = { 0, 0, 0 };
+        Fusion_Init(&f, pr->update_hz, pr->block);
+        uint64_t c0 = CYCLES();
+        double t0 = now_s();
+        for (uint32_t i = 0; i < n; i++)
+        {
+            Fusion_Update(&f, &log[i].acc, log[i].has_mag ? &log[i].mag : NULL,
+                          &att);
+            out[i] = att;
+        }
+        double t1 = now_s();
+        uint64_t c1 = CYCLES();
+        if (t1 - t0 < best) best = t1 - t0;
+        if (c1 - c0 < best_cyc) best_cyc = c1 - c0;
+    }
+
+    // the angles are checked against the truth that much earlier: the block
+    // mean is centered (block - 1) / 2 samples back, and the FIFO pairs each
+    // block with the field read one update before
+    const double mean_s = (pr->block - 1u) / 2.0 / ((double)pr->update_hz * pr->block);
+    const double tilt_lag = iir_delay_s(f.block_means ? f.tilt_shift : f.acc_shift,
+                                        pr->update_hz) + mean_s;
+    const double yaw_lag = iir_delay_s(f.mag_shift, pr->update_hz)
+                           + ((pr->block > 1) ? 1.0 / pr->update_hz : 0.0);
+
+    // error against the truth outside the bumps: worst case and rms, next to
+    // the rms error of Att_Tilt on the raw samples
+    double worst[3] = { 0, 0, 0 }, sum2[3] = { 0, 0, 0 }, raw2[2] = { 0, 0 };
+    uint32_t checked = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        // bumps of linear acceleration are allowed to pull the angles for a
+        // while
+        double t = log[i].t;
+        if (t < SETTLE_S || fmod(t, 10.0) < 1.0) continue;
+
+        double tilt[3], yaw[3], now[3];
+        truth(t - tilt_lag, tilt);
+        truth(t - yaw_lag, yaw);
+        truth(t - mean_s, now);
+        Attitude_t raw = { 0, 0, 0 };
+        Att_Tilt(&log[i].acc, &raw);
+        double err[3] =
+        {
+            wrap_deg(out[i].roll / 100.0 - tilt[0]),
+            wrap_deg(out[i].pitch / 100.0 - tilt[1]),
+            wrap_deg(out[i].yaw / 100.0 - yaw[2]),
+        };
+        double err_raw[2] =
+        {
+            wrap_deg(raw.roll / 100.0 - now[0]),
+            wrap_deg(raw.pitch / 100.0 - now[1]),
+        };
+        for (int k = 0; k < 3; k++)
+        {
+            if (fabs(err[k]) > worst[k]) worst[k] = fabs(err[k]);
+            sum2[k] += err[k] * err[k];
+            if (k < 2) raw2[k] += err_raw[k] * err_raw[k];
+        }
+        checked++;
+    }
+
+    printf("%s: %u Hz, gains 2^-%u (2^-%u moving) acc, 2^-%u mag", pr->name,
+           pr->update_hz, f.acc_shift, f.acc_shift_moving, f.mag_shift);
+    if (f.block_means)
+    {
+        printf(", 2^-%u (2^-%u moving) tilt", f.tilt_shift, f.tilt_shift_moving);
+    }
+    printf("\n");
+    static const char *const name[3] = { "roll", "pitch", "yaw" };
+    const double limit[3] = { LIMIT_TILT_DEG, LIMIT_TILT_DEG, pr->limit_yaw };
+    int fail = 0;
+    for (int k = 0; k < 3; k++)
+    {
+        printf("  %-5s max err %.3f deg (limit %.1f), rms %.4f deg", name[k],
+               worst[k], limit[k], sqrt(sum2[k] / checked));
+        // the filter must not do worse than no filter at all
+        if (k < 2)
+        {
+            printf(" (unfiltered %.4f)", sqrt(raw2[k] / checked));
+            if (sum2[k] > raw2[k]) fail = 1;
+        }
+        printf("\n");
+        if (worst[k] > limit[k]) fail = 1;
+    }
+    printf("  lag %.0f ms tilt, %.0f ms yaw\n", tilt_lag * 1000.0, yaw_lag * 1000.0);
+    printf("  Fusion_Update: %.1f ns/update %.1f cycles/update (host)\n",
+           best * 1e9 / n, (double)best_cyc / n);
+
+    free(log);
+    free(out);
+    return fail;
+}
+
+int main(int argc, char **argv)
+{
+    if ((argc == 3 || argc == 4) && strcmp(argv[1], "-g") == 0)
+    {
+        const Profile_t *pr = &profiles[1];
+        if (argc == 4 && strcmp(argv[3], "both") == 0) pr = &profiles[0];
+        write_log((uint32_t)strtoul(argv[2], NULL, 0), pr);
+        return 0;
+    }
+    if (argc >= 2 && argc <= 4)
+    {
+        uint32_t hz = (argc >= 3) ? (uint32_t)strtoul(argv[2], NULL, 0)
+                                  : profiles[1].update_hz;
+        uint32_t block = (argc == 4) ? (uint32_t)strtoul(argv[3], NULL, 0)
+                                     : profiles[1].block;
+        return replay(argv[1], hz, block);
+    }
+    if (argc != 1)
+    {
+        fprintf(stderr, "usage: %s [log.csv [hz [block]] | -g N [fifo|both]]\n",
+                argv[0]);
+        return 2;
+    }
+    int fail = 0;
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+    {
+        fail |= self_test(&profiles[i], DEFAULT_SECONDS);
+    }
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
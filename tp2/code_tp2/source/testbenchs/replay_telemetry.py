@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Replays bench_telemetry -x frames through the ProtocolHandler of the PC tool.
+
+    ./bench_telemetry -x 2000 | python3 replay_telemetry.py
+
+Each "station,seq,roll,pitch,yaw,<hex>" line is one encoded frame. The frames
+are joined into one stream, with an ASCII line "A,<st>,<R|C|O>,<val>\\n" after
+every fourth one, and fed to on_bytes() in random chunks of 1..32 bytes:
+
+  - auto (default handler): every frame gives its three angles (cdeg / 100)
+    and every line its value, in stream order, with no CRC errors
+  - binary=True on the frames only, binary=False on the lines only
+  - every 50th frame with a bit flipped in its CRC byte: only those frames
+    are dropped and each one counts in crc_errors
+
+Fails (exit 1) on any mismatch.
+"""
+
+import os
+import random
+import sys
+
+TOOL_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                        "..", "..", "..", "consiga&cosas", "TiltNetworkTool-1.0.0")
+sys.path.insert(0, TOOL_DIR)
+
+from src.protocol.protocol_handler import ProtocolHandler, cobs_decode  # noqa: E402
+
+LINE_EVERY = 4
+CORRUPT_EVERY = 50
+MAX_CHUNK = 32
+AXES = "RCO"
+
+
+def frame_msgs(st, roll, pitch, yaw):
+    return [{"station_index": st, "angle": i, "value": cdeg / 100.0}
+            for i, cdeg in enumerate((roll, pitch, yaw))]
+
+
+def feed(handler, stream, rng):
+    out = []
+    i = 0
+    while i < len(stream):
+        n = rng.randint(1, MAX_CHUNK)
+        out.extend(handler.on_bytes(stream[i:i + n]))
+        i += n
+    return out
+
+
+def check(name, got, expected, handler, crc_errors):
+    ok = got == expected and handler.crc_errors == crc_errors
+    print(f"{name}: {len(expected)} messages, crc_errors {handler.crc_errors}"
+          f"{'' if ok else ' MISMATCH'}")
+    if not ok:
+        for k, (g, e) in enumerate(zip(got, expected)):
+            if g != e:
+                print(f"  first difference at message {k}: got {g}, expected {e}")
+                break
+        else:
+            print(f"  got {len(got)} messages")
+    return ok
+
+
+def main():
+    frames = []
+    for line in sys.stdin:
+        st, _seq, roll, pitch, yaw, hexframe = line.strip().split(",")
+        frames.append((int(st), int(roll), int(pitch), int(yaw), bytes.fromhex(hexframe)))
+    if not frames:
+        print("no frames on stdin")
+        return 1
+
+    rng = random.Random(1)
+    mixed, mixed_exp = bytearray(), []
+    bin_only, bin_exp = bytearray(), []
+    txt_only, txt_exp = bytearray(), []
+    bad, bad_exp, n_bad = bytearray(), [], 0
+    for k, (st, roll, pitch, yaw, raw) in enumerate(frames):
+        msgs = frame_msgs(st, roll, pitch, yaw)
+        mixed += raw
+        mixed_exp += msgs
+        bin_only += raw
+        bin_exp += msgs
+
+        # CRC byte is the last one before 0x00 unless the CRC itself is 0
+        flipped = raw[-2] ^ 0x01
+        if k % CORRUPT_EVERY == 0 and cobs_decode(raw[:-1])[-1] != 0 \
+                and flipped not in (0x00, 0x0A):
+            bad += raw[:-2] + bytes([flipped]) + raw[-1:]
+            n_bad += 1
+        else:
+            bad += raw
+            bad_exp += msgs
+
+        if k % LINE_EVERY == LINE_EVERY - 1:
+            st_txt, axis, val = st % 8, rng.randrange(3), rng.randint(-179, 179)
+            text = f"A,{st_txt},{AXES[axis]},{val}\n".encode()
+            msg = {"station_index": st_txt, "angle": axis, "value": val}
+            mixed += text
+            mixed_exp.append(msg)
+            txt_only += text
+            txt_exp.append(msg)
+
+    ok = True
+    h = ProtocolHandler()
+    ok &= check("auto, frames + lines", feed(h, bytes(mixed), rng), mixed_exp, h, 0)
+    ok &= h.frames == len(frames)
+    h = ProtocolHandler(binary=True)
+    ok &= check("binary", feed(h, bytes(bin_only), rng), bin_exp, h, 0)
+    h = ProtocolHandler(binary=False)
+    ok &= check("text", feed(h, bytes(txt_only), rng), txt_exp, h, 0)
+    h = ProtocolHandler()
+    ok &= check(f"auto, {n_bad} corrupted", feed(h, bytes(bad), rng), bad_exp, h, n_bad)
+
+    print(f"{len(frames)} frames")
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,6 +1,50 @@
-from typing import List, Dict, Any
+from typing import List, Dict, Any, Optional
 import logging
 import re
+import struct
+
+# Trama binaria de la estación (misc/telemetry.h en el firmware):
+#   COBS(station u8, seq u8, roll i16, pitch i16, yaw i16, crc8 u8) + 0x00
+# ángulos little endian en centésimas de grado, CRC-8 poly 0x07 init 0x00
+TLM_DELIMITER = 0x00
+TLM_PAYLOAD_LEN = 9
+TLM_MAX_FRAME = 64      # más que esto sin delimitador es basura
+_TLM_STRUCT = struct.Struct("<BBhhh")
+
+
+def crc8(data: bytes, crc: int = 0x00) -> int:
+    """CRC-8/SMBUS (poly 0x07, init 0x00), el mismo que Tlm_Crc8()."""
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def cobs_decode(frame: bytes) -> Optional[bytes]:
+    """Deshace COBS (sin el 0x00 final). None si la trama está mal formada."""
+    out = bytearray()
+    i = 0
+    n = len(frame)
+    while i < n:
+        code = frame[i]
+        if code == 0 or i + code > n:
+            return None
+        out.extend(frame[i + 1:i + code])
+        i += code
+        if code < 0xFF and i < n:
+            out.append(0)
+    return bytes(out)
+
+
+def _is_text_line(line: bytes) -> bool:
+    """
+    True si line (sin el '\\n') es ASCII imprimible con '\\r' final opcional.
+    Vacía no cuenta: puede ser el código 0x0A de una trama sin ceros.
+    """
+    body = line[:-1] if line.endswith(b"\r") else line
+    return len(line) > 0 and all(0x20 <= b < 0x7F for b in body)
+
 
 class ProtocolHandler:
     """
@@ -11,9 +55,20 @@ class ProtocolHandler:
         validar y convertir a una estructura uniforme para la GUI según lo especificado.
       - Construcción de mensajes salientes en build_led_command().
     """
-    def __init__(self) -> None:
+    def __init__(self, binary: Optional[bool] = None) -> None:
+        """
+        binary: True solo tramas COBS del firmware (APP_TELEMETRY_BINARY=1),
+        False solo líneas de texto "A,<st>,<eje>,<valor>\\n" (APP_TELEMETRY_BINARY=0),
+        None (por defecto) detecta cada mensaje por su contenido.
+        """
         # Buffer de recepción por si llegan fragmentos
         self._rxbuf = bytearray()
+        self.binary = binary
+        # Estadísticas del modo binario
+        self._last_seq: Dict[int, int] = {}
+        self.frames = 0
+        self.crc_errors = 0
+        self.lost_frames = 0
         # Regex flexibles para soportar variantes de formato
         # 1) A,<st>,<axis>,<val>   2) <st>,<axis>,<val>   3) ANG,<st>,<axis_name>,<val>
         self._re_line_generic = re.compile(
@@ -45,63 +100,111 @@ class ProtocolHandler:
           - 'angle': int en {0: roll, 1: pitch, 2: yaw}
           - 'value': float|int
 
-        Retorna [] si no hay líneas completas (terminadas en '\n').
+        Retorna [] si no hay mensajes completos (líneas terminadas en '\\n' o
+        tramas terminadas en 0x00).
         Soporta separadores ',' o ';' y mayúsc/minúsc para el eje.
         """
         logging.debug(f"[ProtocolHandler] RX chunk: {data!r}")
         out: List[Dict[str, Any]] = []
 
-        # Acumular y procesar por líneas (framing por '\n')
         self._rxbuf.extend(data)
         while True:
-            nl = self._rxbuf.find(b"\n")
-            if nl < 0:
-                break  # no hay línea completa aún
-
-            # Tomar una línea completa (y tolerar '\r\n')
-            line = self._rxbuf[:nl].decode(errors="ignore").strip("\r")
-            # Consumir esa línea + '\n'
-            del self._rxbuf[:nl+1]
-
-            if not line.strip():
-                continue  # línea vacía
-
-            logging.debug(f"[ProtocolHandler] RX line: {line}")
-
-            # Normalizar posibles prefijos (A, / ANG,) si vinieron
-            if line.upper().startswith("A,") or line.upper().startswith("ANG,"):
-                # ya está contemplado por el regex con prefijo opcional
-                pass
-
-            m = self._re_line_generic.match(line)
-            if not m:
-                logging.warning(f"[ProtocolHandler] Línea ignorada (formato no reconocido): {line}")
-                continue
-
-            try:
-                st = int(m.group("st"))
-                angle_idx = self._axis_to_index(m.group("ax"))
-                # parsear valor como float (si es entero, luego se verá como 12.0; es OK para GUI)
-                val_str = m.group("val")
-                value = float(val_str)
-                # Si es entero exacto, devolver int (por prolijidad)
-                if value.is_integer():
-                    value_out: Any = int(value)
-                else:
-                    value_out = value
-
-                msg = {
-                    "station_index": st,
-                    "angle": angle_idx,
-                    "value": value_out,
-                }
-                out.append(msg)
-                logging.info(f"[ProtocolHandler] Parsed: {msg}")
-            except Exception as e:
-                logging.error(f"[ProtocolHandler] Error parseando línea '{line}': {e}")
+            nl = self._rxbuf.find(b"\n") if self.binary is not True else -1
+            end = self._rxbuf.find(bytes([TLM_DELIMITER])) if self.binary is not False else -1
+
+            if nl >= 0 and (end < 0 or nl < end):
+                line = bytes(self._rxbuf[:nl])
+                # Una trama COBS empieza con un código 1..10, nunca imprimible:
+                # una línea de ASCII imprimible es texto. Si no, el '\n' es un
+                # byte de la trama y se espera su 0x00.
+                if self.binary is False or _is_text_line(line):
+                    del self._rxbuf[:nl + 1]
+                    self._parse_line(line, out)
+                    continue
+                if end < 0:
+                    if len(self._rxbuf) > TLM_MAX_FRAME:
+                        # ni línea ni trama: descartar hasta el '\n'
+                        del self._rxbuf[:nl + 1]
+                        continue
+                    break
+
+            if end < 0:
+                if self.binary is not False and len(self._rxbuf) > TLM_MAX_FRAME:
+                    # sin delimitador: no es una trama, esperar la próxima
+                    self._rxbuf.clear()
+                break
+
+            frame = bytes(self._rxbuf[:end])
+            del self._rxbuf[:end + 1]
+            if frame:  # delimitadores seguidos
+                self._parse_frame(frame, out)
 
         return out
 
+    def _parse_line(self, raw: bytes, out: List[Dict[str, Any]]) -> None:
+        """Parsea una línea de texto (sin el '\\n') y agrega su mensaje a out."""
+        # Tolerar '\r\n'
+        line = raw.decode(errors="ignore").strip("\r")
+        if not line.strip():
+            return  # línea vacía
+
+        logging.debug(f"[ProtocolHandler] RX line: {line}")
+
+        m = self._re_line_generic.match(line)
+        if not m:
+            logging.warning(f"[ProtocolHandler] Línea ignorada (formato no reconocido): {line}")
+            return
+
+        try:
+            st = int(m.group("st"))
+            angle_idx = self._axis_to_index(m.group("ax"))
+            # parsear valor como float (si es entero, luego se verá como 12.0; es OK para GUI)
+            val_str = m.group("val")
+            value = float(val_str)
+            # Si es entero exacto, devolver int (por prolijidad)
+            if value.is_integer():
+                value_out: Any = int(value)
+            else:
+                value_out = value
+
+            msg = {
+                "station_index": st,
+                "angle": angle_idx,
+                "value": value_out,
+            }
+            out.append(msg)
+            logging.info(f"[ProtocolHandler] Parsed: {msg}")
+        except Exception as e:
+            logging.error(f"[ProtocolHandler] Error parseando línea '{line}': {e}")
+
+    def _parse_frame(self, frame: bytes, out: List[Dict[str, Any]]) -> None:
+        """
+        Deshace COBS de una trama (sin el 0x00), chequea largo y CRC, y agrega
+        un mensaje por ángulo (en grados) a out.
+        """
+        payload = cobs_decode(frame)
+        if payload is None or len(payload) != TLM_PAYLOAD_LEN or crc8(payload) != 0:
+            self.crc_errors += 1
+            logging.warning(f"[ProtocolHandler] Trama descartada: {frame.hex()}")
+            return
+
+        st, seq, roll, pitch, yaw = _TLM_STRUCT.unpack_from(payload)
+        last = self._last_seq.get(st)
+        if last is not None:
+            self.lost_frames += (seq - last - 1) & 0xFF
+        self._last_seq[st] = seq
+        self.frames += 1
+
+        for angle_idx, cdeg in enumerate((roll, pitch, yaw)):
+            msg = {
+                "station_index": st,
+                "angle": angle_idx,
+                "value": cdeg / 100.0,
+            }
+            out.append(msg)
+        logging.debug(f"[ProtocolHandler] Parsed frame st={st} seq={seq}: "
+                      f"{roll / 100.0}, {pitch / 100.0}, {yaw / 100.0}")
+
     def build_led_command(self, station_index: int, r: bool, g: bool, b: bool) -> bytes:
         """
         Construye los bytes a enviar por serial para comandar LEDs de una estación.
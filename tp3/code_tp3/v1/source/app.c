@@ -26,43 +26,76 @@
 #include "drv/mcal/SysTick.h"
 #include "dsp/bitstream.h"
 #include "dsp/demod_fsk.h"
+#include "dsp/frame_fifo.h"
+#include "dsp/tx_sched.h"
+#include "dsp/hdlc.h"
 
 /*******************************************************************************
  * DEFINES
  ******************************************************************************/
 
-#define RX_BUFFER_SIZE 32
-#define TX_BUFFER_SIZE 2048
+#define RX_BLOCK_SIZE 64 // samples demodulated per DMA half (5.3 ms @ 12 kHz)
+#define RX_BUFFER_SIZE (2 * RX_BLOCK_SIZE) // ping-pong: the demod reads one half while DMA fills the other
+#define TX_BUFFER_SIZE 2048 // power of 2: UART RX DMA ring, read in place by the modulator
+#define RX_MAX_FRAMES DEMOD_FSK_MAX_FRAMES(RX_BLOCK_SIZE)
+#define RX_MAX_BITS DEMOD_FSK_MAX_BITS(RX_BLOCK_SIZE)
+#define RX_DRAIN_MAX 16 // bytes taken from rx_fifo per App_Run()
+#define DAC_BUFFER_SIZE 256 // ping-pong: the NCO refills one half while DMA plays the other
+#define TX_RATE_WINDOW MODEM_BAUD // bits per throughput measurement (1 s of line time)
+
+// 1 = print the TX throughput through the UART once per TX_RATE_WINDOW
+#ifndef TX_RATE_REPORT
+#define TX_RATE_REPORT 0
+#endif
+
+// 1 = HDLC packets on the link (flags, NRZI, bit stuffing, CRC-16, see
+// dsp/hdlc.h) instead of one UART frame per byte; both ends must agree
+#ifndef MODEM_PACKET
+#define MODEM_PACKET 0
+#endif
+
+#if !UART_DMA
+#error "app.c needs UART_DMA: the modulator reads the UART RX DMA ring in place"
+#endif
+#if (TX_BUFFER_SIZE & (TX_BUFFER_SIZE - 1)) != 0
+#error "TX_BUFFER_SIZE must be a power of 2"
+#endif
+#if MODEM_PACKET && (FRAME_FIFO_SIZE < HDLC_MAX_PAYLOAD)
+#error "rx_fifo must hold a whole packet: FRAME_FIFO_SIZE >= HDLC_MAX_PAYLOAD"
+#endif
 
 /*******************************************************************************
  * FILE SCOPE VARIABLES
  ******************************************************************************/
 // Variables de recepcion de datos. Strings
 static uint16_t rx_buffer[RX_BUFFER_SIZE] __attribute__((aligned(4)));
-static char rx_word[2048];
-static char rx_line[2048];
-
-// Circular buffer for transmission data
-static char tx_buffer[TX_BUFFER_SIZE];
-static volatile size_t tx_head = 0; 
-static volatile size_t tx_tail = 0; 
+#if MODEM_PACKET
+static uint8_t rx_bits[RX_MAX_BITS];
+static HdlcRx hdlc_rx;              // only touched by the ADC DMA ISR
+#else
+static uint16_t rx_frames[RX_MAX_FRAMES];
+#endif
+static FrameFifo rx_fifo;           // DMA ISR -> main loop
+static uint32_t rx_sample_cnt;      // ADC samples demodulated so far
+static FrameFifo_Entry rx_entries[RX_DRAIN_MAX];
+
+// UART RX lands here by DMA (UART_DmaInit); the head comes from the DMA itself
+static volatile uint8_t tx_buffer[TX_BUFFER_SIZE];
+static uint32_t tx_tail = 0;        // free running, only tx_pull() moves it
 
 static NCO_Handle nco_handle;
-
-// Bitstream sent by the DAC
-static bool sending_bitstream[11];
-static bool idle_sending_bitstream[11];
-static bool idle_reciving_bitstream[11];
-static volatile uint16_t lut_value;
-static size_t bit_cnt;
-
-
-// Miscellaneous Variables - Manejo de Estados
-static char idle_counter;
-static bool last_byte_idle;
-static volatile bool rx_ready = false;
-static volatile bool initiate_send = false;
-static volatile bool sending_data = false;
+static NCO_BitClock tx_bit_clock;
+static uint16_t dac_buffer[DAC_BUFFER_SIZE] __attribute__((aligned(4)));
+
+#if MODEM_PACKET
+// Bytes from tx_buffer go out in packets, flags in between
+static HdlcTx hdlc_tx;
+#else
+// Bytes from tx_buffer go out back-to-back; idle only when it is empty
+static TxSched tx_sched;
+static TxSched_Rate tx_rate;    // last measurement, also handy from the debugger
+#endif
+static bool tx_busy;
 
 /*******************************************************************************
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
@@ -73,10 +106,16 @@ static volatile bool sending_data = false;
  * FUNCTION PROTOTYPES FOR CALLBACKS
  ******************************************************************************/
 
-static void rx_pit_cb(void *user);
+static void dma_rx_half_cb(void *user);
 static void dma_rx_major_cb(void *user);
-static void NCO_ISRBit(void);
-static void NCO_ISRLut(void *user);
+static void rx_block_ready(uint8_t half);
+static void dma_dac_half_cb(void *user);
+static void dma_dac_major_cb(void *user);
+static bool NCO_NextBit(void *user);
+static bool tx_pull(void *user, uint8_t *byte);
+#if MODEM_PACKET
+static size_t tx_avail(void *user);
+#endif
 
 /*******************************************************************************
  *******************************************************************************
@@ -103,31 +142,47 @@ void App_Init(void)
     
     UART_Init(UART_PARITY_ODD); 
     ADC_Init(true); // true = dma_req enable
+    ADC_SetTrigger(ADC0, ADC_trgPIT1); // PIT ch1 timeout starts each conversion
+    ADC_Start(ADC0, 1, ADC_mA);        // hardware trigger: only selects the channel
     NCO_InitFixed(&nco_handle, K_MARK, K_SPACE, true);
     DAC_Init();
     PIT_Init();
     DMA_Init();
+    FrameFifo_Init(&rx_fifo);
+    UART_DmaInit(tx_buffer, TX_BUFFER_SIZE);
+
+#if MODEM_PACKET
+    HdlcTx_Init(&hdlc_tx, tx_pull, tx_avail, NULL);
+    HdlcRx_Init(&hdlc_rx);
+#else
+    TxSched_Init(&tx_sched, TX_SCHED_GUARD_BITS, tx_pull, NULL);
+#endif
+    // the bit clock runs inside NCO_FillBlock, one DAC sample at a time
+    NCO_BitClockInit(&tx_bit_clock, MODEM_BAUD, MODEM_FS_DAC, NCO_NextBit, NULL);
+    NCO_FillBlock(&nco_handle, &tx_bit_clock, dac_buffer, DAC_BUFFER_SIZE);
 
     dma_cfg_t dma_dac_cfg =
     {
         .ch = 0,
         .request_src = DMA_REQ_ALWAYS63,
         .trig_mode = true, // PIT ch0 will trigger this dma req
-        .saddr = (void*)&lut_value,
+        .saddr = dac_buffer,
         .daddr = (void*)&DAC0->DAT[0].DATL,
         .nbytes = 2, // 16-bit
-        .soff = 0, .doff = 0,
-        .major_count = 1,
-        .slast = 0,
+        .soff = 2, .doff = 0,
+        .major_count = DAC_BUFFER_SIZE,
+        .slast = -(DAC_BUFFER_SIZE * 2),
         .dlast = 0,
-        .int_major = false,
-        .on_major = NULL,
+        .int_major = true,
+        .on_major = dma_dac_major_cb,
+        .int_half = true,
+        .on_half = dma_dac_half_cb,
         .user = NULL
     };
     DMA_Config(&dma_dac_cfg);
     DMA_Start(0);
 
-    dma_cfg_t dma_adc_cfg = // ToDo: implement ping pong buffer
+    dma_cfg_t dma_adc_cfg =
     {
         .ch = 1,
         .request_src = DMA_REQ_ADC0,
@@ -141,117 +196,89 @@ void App_Init(void)
         .dlast = -(RX_BUFFER_SIZE * 2),
         .int_major = true,
         .on_major = dma_rx_major_cb,
+        .int_half = true,
+        .on_half = dma_rx_half_cb,
         .user = NULL
     };
     DMA_Config(&dma_adc_cfg);
     DMA_Start(1);
 
-    // use systick for bit ISR
-	SysTick_Init(NCO_ISRBit, 83333); // systick isr at 1.2kHz
-
     // PIT configs
     pit_cfg_t pit_cfg_lut =
     {
         .ch = 0, // has to be the same channel as DMA channel to be triggered
-        .load_val = PIT_TICKS_FROM_US(20), // DAC's output refresh rate
+        .load_val = PIT_TICKS_FROM_HZ(MODEM_FS_DAC), // DAC's output refresh rate
         .periodic = true,
-        .int_en = true,
+        .int_en = false, // no CPU work per sample, only the DMA request
         .dma_req = true,
-        .callback = NCO_ISRLut,
+        .callback = NULL,
         .user = NULL
     };
     PIT_Config(&pit_cfg_lut);
 
     pit_cfg_t pit_adc_cfg =
     {
-        .ch = 1,
-        .load_val = PIT_TICKS_FROM_US(83), // 12kHz ADC sampling
+        .ch = 1, // routed to ADC0 through SIM_SOPT7, see ADC_SetTrigger
+        .load_val = PIT_TICKS_FROM_HZ(MODEM_FS_ADC), // ADC sampling
         .periodic = true,
-        .int_en = true,
+        .int_en = false, // PIT -> ADC -> DMA, no CPU work per sample
         .dma_req = false,
-        .callback = rx_pit_cb, // PIT starts ADC's start of conversion
+        .callback = NULL,
         .user = NULL
     };
     PIT_Config(&pit_adc_cfg);
 
-    // Inicializo los bitstreams en idle
-    for (int i = 0; i < 11; i++)
-    {
-        idle_sending_bitstream[i] = true;
-        idle_reciving_bitstream[i] = 0;
-    }
-
     // FPU enable
     SCB->CPACR |= (0xF << 20);
 }
 
 void App_Run(void)
 {
-    // TX main loop
-    UART_Poll();
-    int r = UART_ReceiveString(rx_line, sizeof(rx_line));
-
-    if (r > 0)
+    // TX main loop: UART RX DMA fills tx_buffer and the scheduler pulls from it
+    // inside the DAC DMA ISR, nothing to copy here
+#if MODEM_PACKET
+    // no byte-rate report: HdlcTx keeps bits/bytes/packets counters instead
+#elif TX_RATE_REPORT
+    if (TxSched_Measure(&tx_sched, MODEM_BAUD, TX_RATE_WINDOW, &tx_rate))
     {
-        // Queue all the recieved characters on the ring buffer
-        for (int i = 0; i < r; i++)
-        {
-            size_t next_head = (tx_head + 1) % TX_BUFFER_SIZE;
-
-            if (next_head != tx_tail)
-            {
-                tx_buffer[tx_head] = rx_line[i];
-                tx_head = next_head;
-            }
-        }
-
-        // UART_SendString(rx_line); // Echo from the recieve data
+        char msg[64];
+        snprintf(msg, sizeof(msg), "[tx] %lu/%lu B/s, %lu B overrun\r\n",
+                 (unsigned long)tx_rate.bytes_per_s, (unsigned long)tx_rate.line_bytes_per_s,
+                 (unsigned long)UART_RxOverflow());
+        UART_SendString(msg);
     }
+#else
+    TxSched_Measure(&tx_sched, MODEM_BAUD, TX_RATE_WINDOW, &tx_rate);
+#endif
+    UART_Poll();
 
-    // // If we aren't recieving data, send whats in the buffer
-    if (!sending_data && tx_head != tx_tail)
+    // RX main loop: the DMA ISR demodulates, here we only drain the bytes
+    // straight into the UART TX buffer, which its own DMA empties
+    size_t n_rx = FrameFifo_Pop(&rx_fifo, rx_entries, RX_DRAIN_MAX);
+    char *dst;
+    size_t room = UART_TxReserve(&dst);
+    size_t len = 0;
+    for (size_t i = 0; i < n_rx; i++)
     {
-<<<<<<< HEAD
-        if (idle_counter == 20){
-=======
-        if (idle_counter == 4){
->>>>>>> 7bb88c13bd4e796cc1c6cd59c516845ae8321edb
-            last_byte_idle = true;
-            idle_counter = 0;
-        }
-
-        if (last_byte_idle)
+        // bytes with parity/framing errors are dropped
+        if (rx_entries[i].status != 0)
         {
-            format_bitstream(tx_buffer[tx_tail], sending_bitstream);
-            tx_tail = (tx_tail + 1) % TX_BUFFER_SIZE;
-
-            initiate_send = true;
-            sending_data = true;
-
-        // Hacer un echo del caracter realmente enviado
-        //UART_SendString((char[]){tx_buffer[tx_tail], '\0'});
-            gpioWrite(PIN_LED_RED, LED_ACTIVE);
-            gpioWrite(PIN_TP1, HIGH);
+            continue;
         }
-    }
-    UART_Poll();
-
-    // RX main loop
-    if (rx_ready)
-    {
-        rx_ready = false;
-        for (int i = 0; i < RX_BUFFER_SIZE; i++)
+        if (len == room)
         {
-            float d = demodFSK(rx_buffer[i]);
-            bitstreamReconstruction(d);
-            if (isDataReady())
+            // end of the contiguous span (or full): publish and ask again
+            UART_TxCommit(len);
+            room = UART_TxReserve(&dst);
+            len = 0;
+            if (room == 0)
             {
-                bool *frame = retrieveBitstream();
-                rx_word[0] = deformat_bitstream(frame);
-                UART_SendString(rx_word);
+                break;
             }
         }
+        dst[len++] = (char)rx_entries[i].data;
     }
+    UART_TxCommit(len);
 }
 
 /*******************************************************************************
@@ -260,62 +287,101 @@ void App_Run(void)
  *******************************************************************************
  ******************************************************************************/
 
-static void rx_pit_cb(void *user)
+static void dma_rx_half_cb(void *user)
 {
-    //gpioWrite(PIN_TP3, HIGH);
-    ADC_Start(ADC0, 1, ADC_mA); // starts ADC's conversion
-    //gpioWrite(PIN_TP3, LOW);
+    // DMA is filling the second half: the first one is stable
+    rx_block_ready(0);
 }
 
 static void dma_rx_major_cb(void *user)
 {
-    rx_ready = true;
+    // DMA wrapped to the first half: the second one is stable
+    rx_block_ready(1);
 }
 
-static void NCO_ISRBit(void)
+static void rx_block_ready(uint8_t half)
 {
-    //gpioWrite(PIN_TP4, HIGH);
-    // Flag de reset de Contador de bits enviados (Redundancia para seguridad)
-    if (initiate_send)
+    // must finish before the DMA comes back to this half (RX_BLOCK_SIZE samples)
+#if MODEM_PACKET
+    size_t n_bits = demodFSK_ProcessBlockBits(&rx_buffer[half * RX_BLOCK_SIZE], RX_BLOCK_SIZE,
+                                              rx_bits, RX_MAX_BITS);
+    rx_sample_cnt += RX_BLOCK_SIZE;
+    for (size_t i = 0; i < n_bits; i++)
     {
-        bit_cnt = 0;
-        initiate_send = false;
+        if (!HdlcRx_PushBit(&hdlc_rx, rx_bits[i]))
+        {
+            continue;
+        }
+        // good FCS: the whole payload goes to the main loop, bad packets never do
+        FrameFifo_Entry entry = { .status = 0, .timestamp = rx_sample_cnt };
+        for (uint16_t k = 0; k < hdlc_rx.payload_len; k++)
+        {
+            entry.data = hdlc_rx.buf[k];
+            FrameFifo_Push(&rx_fifo, &entry);
+        }
     }
-
-    // Decidir si envio en idle o si envio datos
-    if (sending_data)
+#else
+    size_t n_frames = demodFSK_ProcessBlock(&rx_buffer[half * RX_BLOCK_SIZE], RX_BLOCK_SIZE,
+                                            rx_frames, RX_MAX_FRAMES);
+    rx_sample_cnt += RX_BLOCK_SIZE;
+    for (size_t i = 0; i < n_frames; i++)
     {
-        NCO_FskBit(&nco_handle, sending_bitstream[bit_cnt]);
+        FrameFifo_PushFrame(&rx_fifo, rx_frames[i], rx_sample_cnt);
     }
-    else
-    {
+#endif
+}
 
-        NCO_FskBit(&nco_handle, idle_sending_bitstream[bit_cnt]);
-        if (!last_byte_idle)
-        {
-            idle_counter++;
-        }
+static void dma_dac_half_cb(void *user)
+{
+    // DMA is playing the second half: refill the first one
+    NCO_FillBlock(&nco_handle, &tx_bit_clock, dac_buffer, DAC_BUFFER_SIZE / 2);
+}
+
+static void dma_dac_major_cb(void *user)
+{
+    // DMA wrapped to the first half: refill the second one
+    NCO_FillBlock(&nco_handle, &tx_bit_clock, &dac_buffer[DAC_BUFFER_SIZE / 2],
+                  DAC_BUFFER_SIZE / 2);
+}
+
+static bool NCO_NextBit(void *user)
+{
+#if MODEM_PACKET
+    bool bit = HdlcTx_NextBit(&hdlc_tx);
+
+    // LED and TP1 on while a packet is on the air
+    bool busy = HdlcTx_Busy(&hdlc_tx);
+#else
+    bool bit = TxSched_NextBit(&tx_sched);
+
+    // LED and TP1 on while a frame (or its guard) is on the air
+    bool busy = TxSched_Busy(&tx_sched);
+#endif
+    if (busy != tx_busy)
+    {
+        tx_busy = busy;
+        gpioWrite(PIN_LED_RED, busy ? LED_ACTIVE : !LED_ACTIVE);
+        gpioWrite(PIN_TP1, busy ? HIGH : LOW);
     }
+    return bit;
+}
 
-    bit_cnt++;
-    // Se setearon bit_cnt bits en el NCO.
-    if (bit_cnt == 11)
+// Consumer side of tx_buffer, runs in the DAC DMA ISR
+static bool tx_pull(void *user, uint8_t *byte)
+{
+    if (UART_RxRingPending(&tx_tail) == 0)
     {
-        if (sending_data)
-        {
-            last_byte_idle = false;
-        }
-        sending_data = false;
-        gpioWrite(PIN_LED_RED, !LED_ACTIVE);
-        gpioWrite(PIN_TP1, LOW);
-        bit_cnt = 0;
+        return false;
     }
-    //gpioWrite(PIN_TP4, LOW);
+    *byte = tx_buffer[tx_tail & (TX_BUFFER_SIZE - 1)];
+    tx_tail++;
+    return true;
 }
 
-static void NCO_ISRLut(void *user)
+#if MODEM_PACKET
+// Bytes waiting in tx_buffer, so HdlcTx can fill its packets
+static size_t tx_avail(void *user)
 {
-	//gpioWrite(PIN_TP2, HIGH);
-    lut_value = NCO_TickQ15(&nco_handle);
-    //gpioWrite(PIN_TP2, LOW);
+    return UART_RxRingPending(&tx_tail);
 }
+#endif
@@ -7,11 +7,86 @@
  */
 
 #include "NCO.h"
-#include "SinLutQ15.h"   // SINE_Q15[LUT_SIZE], LUT_BITS/LUT_SIZE
+#include "SinLutQ15.h"   // SINE_Q15 / SINE_Q15_QUARTER, LUT_BITS/LUT_SIZE
 
+#if (NCO_PHASE_BITS < LUT_BITS) || (NCO_PHASE_BITS > 32u)
+#error "NCO_PHASE_BITS must be between LUT_BITS and 32"
+#endif
+#if (NCO_INTERP != 0) && (NCO_INTERP != 1)
+#error "NCO_INTERP must be 0 or 1"
+#endif
+
+#define NCO_PHASE_SHIFT       (32u - NCO_PHASE_BITS)
 #define NCO_PHASE_FRAC_BITS   (NCO_PHASE_BITS - LUT_BITS)
-#define NCO_PHASE_FRAC_MASK   ((NCO_PHASE_FRAC_BITS >= NCO_PHASE_BOT) ?\
-0xFFFFFFFFu : ((1u << NCO_PHASE_FRAC_BITS) - 1u))
+#define NCO_PHASE_FRAC_MASK   ((1u << NCO_PHASE_FRAC_BITS) - 1u)
+
+// La diferencia entre puntos vecinos entra en 12 bits con signo, así que con
+// 16 bits de fracción el producto de la interpolación entra en 32 bits.
+#if NCO_PHASE_FRAC_BITS > 16u
+#define NCO_LERP_BITS         (16u)
+#else
+#define NCO_LERP_BITS         (NCO_PHASE_FRAC_BITS)
+#endif
+#define NCO_LERP_SHIFT        (NCO_PHASE_FRAC_BITS - NCO_LERP_BITS)
+#if NCO_LERP_BITS > 0u
+#define NCO_LERP_ROUND        (1 << (NCO_LERP_BITS - 1u))
+#else
+#define NCO_LERP_ROUND        (0)
+#endif
+
+/**
+ * @brief Interpola entre dos puntos vecinos de la LUT.
+ *
+ * Redondea al más cercano: truncando, el semiciclo que LUT_QUARTER arma
+ * espejado quedaría sesgado al revés que el otro.
+ *
+ * @param a Punto en idx.
+ * @param b Punto siguiente en la dirección de la fase.
+ * @param frac Fracción de fase, NCO_PHASE_FRAC_BITS bits.
+ * @return a si NCO_INTERP es 0, si no a + (b - a) * frac.
+ */
+static inline int32_t nco_lerp(int32_t a, int32_t b, uint32_t frac)
+{
+#if NCO_INTERP
+    const int32_t f = (int32_t)(frac >> NCO_LERP_SHIFT);
+    return a + (((b - a) * f + NCO_LERP_ROUND) >> NCO_LERP_BITS);
+#else
+    (void)b;
+    (void)frac;
+    return a;
+#endif
+}
+
+/**
+ * @brief Lee la LUT de seno para una fase dada.
+ *
+ * Con LUT_QUARTER los cuadrantes 1 y 3 recorren la tabla al revés y los
+ * cuadrantes 2 y 3 se espejan respecto de LUT_DAC_MAX / 2. Leyendo desde
+ * el pico hacia abajo se obtiene exactamente lo mismo que la tabla completa
+ * en el semiciclo positivo.
+ *
+ * @param phase Fase de 32 bits.
+ * @return El valor de la LUT (interpolado si NCO_INTERP).
+ */
+static inline int16_t nco_lut(uint32_t phase)
+{
+    const uint32_t p    = phase >> NCO_PHASE_SHIFT;
+    const uint32_t frac = p & NCO_PHASE_FRAC_MASK;
+
+#if LUT_QUARTER
+    const uint32_t quad = p >> (NCO_PHASE_BITS - 2u);
+    const uint32_t r    = (p >> NCO_PHASE_FRAC_BITS) & (LUT_QUARTER_SIZE - 1u);
+    const uint32_t ia   = (quad & 1u) ? LUT_QUARTER_SIZE - r : r;
+    const uint32_t ib   = (quad & 1u) ? ia - 1u : ia + 1u;
+    const int32_t  v    = nco_lerp((int32_t)SINE_Q15_QUARTER[ia],
+                                   (int32_t)SINE_Q15_QUARTER[ib], frac);
+    return (int16_t)((quad & 2u) ? (int32_t)LUT_DAC_MAX - v : v);
+#else
+    const uint32_t idx = p >> NCO_PHASE_FRAC_BITS;
+    return (int16_t)nco_lerp((int32_t)SINE_Q15[idx],
+                             (int32_t)SINE_Q15[(idx + 1u) & (LUT_SIZE - 1u)], frac);
+#endif
+}
 
 /**
  * @brief Inicializa el NCO con palabras de sintonía fijas para MARK y SPACE.
@@ -39,18 +114,56 @@ void NCO_InitFixed(NCO_Handle* nco, uint32_t K_mark, uint32_t K_space,
 int16_t NCO_TickQ15(NCO_Handle* nco)
 {
     nco->phase += nco->K;  // se envuelve naturalmente
-    const uint32_t idx = nco->phase >> NCO_PHASE_FRAC_BITS;
+    return nco_lut(nco->phase);
+}
 
-#if defined(NCO_ENABLE_LERP)
-    const uint32_t frac = nco->phase & NCO_PHASE_FRAC_MASK;
-    const int32_t  a    = (int32_t)SINE_Q15[idx];
-    const int32_t  b    = (int32_t)SINE_Q15[(idx + 1u) & (LUT_SIZE - 1u)];
-    const int32_t  diff = b - a;
-    const int32_t  interp = a + (int32_t)(((int64_t)diff * (int64_t)frac) >> NCO_PHASE_FRAC_BITS);
-    return (int16_t)interp;
-#else
-    return SINE_Q15[idx];
-#endif
+/**
+ * @brief Inicializa el reloj de bit de NCO_FillBlock().
+ *
+ * @param clk Reloj de bit.
+ * @param baud Baud rate en Hz.
+ * @param fs Frecuencia de muestreo del NCO en Hz.
+ * @param next_bit Fuente de bits.
+ * @param user Cookie para next_bit.
+ */
+void NCO_BitClockInit(NCO_BitClock* clk, uint32_t baud, uint32_t fs,
+                      NCO_BitCb next_bit, void* user)
+{
+    clk->step     = TW32_ROUND(baud, fs);
+    clk->phase    = 0u - clk->step;    // wraps on the first sample
+    clk->next_bit = next_bit;
+    clk->user     = user;
+}
+
+/**
+ * @brief Genera un bloque de n muestras para el DAC.
+ *
+ * @param nco Puntero a la estructura NCO_Handle.
+ * @param bits Reloj de bit y fuente de bits.
+ * @param out Destino de los códigos del DAC.
+ * @param n Cantidad de muestras.
+ */
+void NCO_FillBlock(NCO_Handle* nco, NCO_BitClock* bits, uint16_t* out, size_t n)
+{
+    uint32_t phase = nco->phase;
+    uint32_t K = nco->K;
+    uint32_t bit_phase = bits->phase;
+    const uint32_t step = bits->step;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        bit_phase += step;
+        if (bit_phase < step)   // the bit clock wrapped: new bit on this sample
+        {
+            K = bits->next_bit(bits->user) ? nco->K_mark : nco->K_space;
+        }
+        phase += K;
+        out[i] = (uint16_t)nco_lut(phase);
+    }
+
+    nco->phase = phase;
+    nco->K = K;
+    bits->phase = bit_phase;
 }
 
 /**
@@ -11,21 +11,49 @@
 #ifndef _NCO_H_
 #define _NCO_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "../../dsp/modem_profile.h"
+
 // ---- Perillas de tiempo de compilación ----
+
+/**
+ * @def NCO_PHASE_BITS
+ * @brief Bits altos del acumulador que se usan para leer la LUT.
+ *
+ * El acumulador sigue siendo de 32 bits; con menos bits se trunca la fase
+ * antes de indexar (LUT_BITS <= NCO_PHASE_BITS <= 32). Lo que sobra de
+ * LUT_BITS es la fracción que usa la interpolación.
+ */
 #ifndef NCO_PHASE_BITS
 #define NCO_PHASE_BITS (32u)
 #endif
 
-#define FS      (50000u)  // frecuencia de muestreo
+/**
+ * @def NCO_INTERP
+ * @brief Orden de interpolación entre puntos de la LUT: 0 (truncar) o 1 (lineal).
+ *
+ * El tamaño de la tabla y el cuarto de onda se eligen con LUT_BITS y
+ * LUT_QUARTER, ver SinLutQ15.h. testbenchs/bench_nco_lut.sh mide SFDR, THD
+ * y costo por muestra de cada combinación.
+ */
+#ifndef NCO_INTERP
+#if defined(NCO_ENABLE_LERP)
+#define NCO_INTERP 1
+#else
+#define NCO_INTERP 0
+#endif
+#endif
+
+#define FS      (MODEM_FS_DAC)  // frecuencia de muestreo, ver modem_profile.h
 
 #define TW32_ROUND(f, FS) ( (uint32_t)((((uint64_t)(f) << 32) + ((FS)/2)) / (uint64_t)(FS)) )
-#define K_MARK  TW32_ROUND(1200u,  FS)
-#define K_SPACE TW32_ROUND(2200u,  FS)
+#define K_MARK  TW32_ROUND(MODEM_F_MARK,  FS)
+#define K_SPACE TW32_ROUND(MODEM_F_SPACE, FS)
 
-// Si deseas interpolación lineal entre puntos de la LUT, habilita esto.
+// Equivale a NCO_INTERP 1, se mantiene por compatibilidad.
 // #define NCO_ENABLE_LERP
 
 /**
@@ -41,6 +69,31 @@ typedef struct {
     uint32_t K_space;   /**< Palabra de sintonía precomputada para SPACE. */
 } NCO_Handle;
 
+/**
+ * @brief Callback que entrega el próximo bit a modular (1 = MARK, 0 = SPACE).
+ *
+ * Lo llama NCO_FillBlock() en cada flanco del reloj de bit, desde el mismo
+ * contexto que la llamada (normalmente el ISR del DMA del DAC).
+ *
+ * @param user Cookie de NCO_BitClockInit().
+ * @return El bit a transmitir durante el próximo período de bit.
+ */
+typedef bool (*NCO_BitCb)(void *user);
+
+/**
+ * @brief Reloj de bit de NCO_FillBlock(): un segundo acumulador de fase.
+ *
+ * Avanza step por muestra y cada vez que desborda empieza un bit nuevo, así
+ * los flancos caen en la muestra exacta aunque FS / baud no sea entero
+ * (41.67 muestras por bit a 1200 Bd).
+ */
+typedef struct {
+    uint32_t  phase;    /**< Acumulador del reloj de bit. */
+    uint32_t  step;     /**< TW32_ROUND(baud, FS). */
+    NCO_BitCb next_bit; /**< Fuente de bits. */
+    void     *user;     /**< Cookie para next_bit. */
+} NCO_BitClock;
+
 /* ------------ Núcleo ------------ */
 
 /**
@@ -68,14 +121,44 @@ static inline void NCO_SetTuningWord(NCO_Handle* nco, uint32_t K) { nco->K = K;
 /**
  * @brief Avanza el NCO en una muestra y devuelve el valor sinusoidal en formato Q15.
  *
- * Utiliza una LUT externa de seno (SINE_Q15) para generar la salida. Soporta interpolación
- * lineal opcional si NCO_ENABLE_LERP está definido.
+ * Utiliza la LUT de seno de SinLutQ15.h (completa o un cuarto de onda según
+ * LUT_QUARTER) para generar la salida. Soporta interpolación lineal si
+ * NCO_INTERP es 1.
  *
  * @param nco Puntero a la estructura NCO_Handle.
  * @return El valor sinusoidal formateado en Q15.
  */
 int16_t NCO_TickQ15(NCO_Handle* nco);
 
+/**
+ * @brief Inicializa el reloj de bit de NCO_FillBlock().
+ *
+ * El primer bit se pide en la primera muestra generada.
+ *
+ * @param clk Reloj de bit.
+ * @param baud Baud rate en Hz.
+ * @param fs Frecuencia de muestreo del NCO en Hz.
+ * @param next_bit Fuente de bits.
+ * @param user Cookie para next_bit.
+ */
+void NCO_BitClockInit(NCO_BitClock* clk, uint32_t baud, uint32_t fs,
+                      NCO_BitCb next_bit, void* user);
+
+/**
+ * @brief Genera un bloque de n muestras para el DAC.
+ *
+ * Equivale a n llamadas a NCO_TickQ15() con NCO_FskBit() en cada flanco del
+ * reloj de bit, pero con la fase y la palabra de sintonía en registros.
+ * Pensada para llenar la mitad libre de un buffer ping-pong que el DMA
+ * copia al DAC.
+ *
+ * @param nco Puntero a la estructura NCO_Handle.
+ * @param bits Reloj de bit y fuente de bits.
+ * @param out Destino de los códigos del DAC (los de la LUT, 0..4095).
+ * @param n Cantidad de muestras.
+ */
+void NCO_FillBlock(NCO_Handle* nco, NCO_BitClock* bits, uint16_t* out, size_t n);
+
 /* -------- Conversiones -------- */
 
 /**
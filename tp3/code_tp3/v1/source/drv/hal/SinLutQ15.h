@@ -1,9 +1,11 @@
 /**
  * @file SinLutQ15.h
- * @brief Tabla de búsqueda de seno en formato Q15.
+ * @brief Tabla de búsqueda de seno para el NCO.
  *
- * Este archivo define una tabla de búsqueda (LUT) para valores de seno en formato Q15,
- * con 256 puntos por defecto. La LUT está precomputada para una onda sinusoidal.
+ * Generado por gen_sin_lut.py --min 6 --max 10, no editar a mano.
+ *
+ * Los valores son códigos del DAC de 12 bits, round(2047.5 + 2047.5 * sin(2π k / LUT_SIZE)),
+ * de 0 a 4095 centrados en 2047.5. El nombre SINE_Q15 es histórico.
  */
 
 #ifndef _SINLUT_H_
@@ -11,29 +13,85 @@
 
 #include <stdint.h>
 
+// ---- Perillas de tiempo de compilación ----
+
 /**
  * @def LUT_BITS
- * @brief Número de bits para el tamaño de la LUT (8 bits por defecto, corresponding a 256 puntos).
+ * @brief Log2 de los puntos por período (6 a 10, 8 por defecto = 256 puntos).
  */
+#ifndef LUT_BITS
 #define LUT_BITS (8u) // 256 puntos por defecto
+#endif
+
+/**
+ * @def LUT_QUARTER
+ * @brief 1 para guardar solo un cuarto de onda (LUT_SIZE / 4 + 1 puntos).
+ */
+#ifndef LUT_QUARTER
+#define LUT_QUARTER 0
+#endif
 
 /**
  * @def LUT_SIZE
- * @brief Tamaño de la LUT, calculado como 2 elevado a LUT_BITS.
+ * @brief Puntos por período, calculado como 2 elevado a LUT_BITS.
  */
 #define LUT_SIZE (1u << LUT_BITS)
 
-// LUT de seno Q15: SINE_Q15[k] = round( sin(2π k / 256) * 32767 )
-// Nota: "static const" para evitar múltiples definiciones al incluir este header
+/**
+ * @def LUT_QUARTER_SIZE
+ * @brief Puntos por cuadrante; SINE_Q15_QUARTER tiene uno más (el pico).
+ */
+#define LUT_QUARTER_SIZE (LUT_SIZE / 4u)
 
 /**
- * @var SINE_Q15
- * @brief Tabla de lookup estática de valores de seno en formato Q15.
- *
- * Esta tabla contiene 256 valores precomputados de seno, calculados como round(sin(2π k / 256) * 32767)
- * para k de 0 a 255. Los valores están almacenados como uint16_t, pero se utilizan como int16_t en el contexto Q15.
- * Nota: Los valores en la tabla van de 0 a 4095, lo que sugiere una escala reducida en comparación con el rango completo Q15 (-32767 a 32767).
+ * @def LUT_DAC_MAX
+ * @brief Código máximo; el semiciclo negativo es LUT_DAC_MAX - positivo.
  */
+#define LUT_DAC_MAX (4095u)
+
+#if LUT_BITS == 6
+#if LUT_QUARTER
+static const uint16_t SINE_Q15_QUARTER[LUT_QUARTER_SIZE + 1u] = {
+2048, 2248, 2447, 2642, 2831, 3013, 3185, 3346, 3495, 3630, 3750, 3853, 3939, 4007, 4056, 4085,
+4095
+};
+#else
+static const uint16_t SINE_Q15[LUT_SIZE] = {
+2048, 2248, 2447, 2642, 2831, 3013, 3185, 3346, 3495, 3630, 3750, 3853, 3939, 4007, 4056, 4085,
+4095, 4085, 4056, 4007, 3939, 3853, 3750, 3630, 3495, 3346, 3185, 3013, 2831, 2642, 2447, 2248,
+2048, 1847, 1648, 1453, 1264, 1082, 910, 749, 600, 465, 345, 242, 156, 88, 39, 10,
+0, 10, 39, 88, 156, 242, 345, 465, 600, 749, 910, 1082, 1264, 1453, 1648, 1847
+};
+#endif
+#elif LUT_BITS == 7
+#if LUT_QUARTER
+static const uint16_t SINE_Q15_QUARTER[LUT_QUARTER_SIZE + 1u] = {
+2048, 2148, 2248, 2348, 2447, 2545, 2642, 2737, 2831, 2923, 3013, 3100, 3185, 3267, 3346, 3423,
+3495, 3565, 3630, 3692, 3750, 3804, 3853, 3898, 3939, 3975, 4007, 4034, 4056, 4073, 4085, 4093,
+4095
+};
+#else
+static const uint16_t SINE_Q15[LUT_SIZE] = {
+2048, 2148, 2248, 2348, 2447, 2545, 2642, 2737, 2831, 2923, 3013, 3100, 3185, 3267, 3346, 3423,
+3495, 3565, 3630, 3692, 3750, 3804, 3853, 3898, 3939, 3975, 4007, 4034, 4056, 4073, 4085, 4093,
+4095, 4093, 4085, 4073, 4056, 4034, 4007, 3975, 3939, 3898, 3853, 3804, 3750, 3692, 3630, 3565,
+3495, 3423, 3346, 3267, 3185, 3100, 3013, 2923, 2831, 2737, 2642, 2545, 2447, 2348, 2248, 2148,
+2048, 1947, 1847, 1747, 1648, 1550, 1453, 1358, 1264, 1172, 1082, 995, 910, 828, 749, 672,
+600, 530, 465, 403, 345, 291, 242, 197, 156, 120, 88, 61, 39, 22, 10, 2,
+0, 2, 10, 22, 39, 61, 88, 120, 156, 197, 242, 291, 345, 403, 465, 530,
+600, 672, 749, 828, 910, 995, 1082, 1172, 1264, 1358, 1453, 1550, 1648, 1747, 1847, 1947
+};
+#endif
+#elif LUT_BITS == 8
+#if LUT_QUARTER
+static const uint16_t SINE_Q15_QUARTER[LUT_QUARTER_SIZE + 1u] = {
+2048, 2098, 2148, 2198, 2248, 2298, 2348, 2398, 2447, 2496, 2545, 2594, 2642, 2690, 2737, 2784,
+2831, 2877, 2923, 2968, 3013, 3057, 3100, 3143, 3185, 3226, 3267, 3307, 3346, 3385, 3423, 3459,
+3495, 3530, 3565, 3598, 3630, 3662, 3692, 3722, 3750, 3777, 3804, 3829, 3853, 3876, 3898, 3919,
+3939, 3958, 3975, 3992, 4007, 4021, 4034, 4045, 4056, 4065, 4073, 4080, 4085, 4089, 4093, 4094,
+4095
+};
+#else
 static const uint16_t SINE_Q15[LUT_SIZE] = {
 2048, 2098, 2148, 2198, 2248, 2298, 2348, 2398, 2447, 2496, 2545, 2594, 2642, 2690, 2737, 2784,
 2831, 2877, 2923, 2968, 3013, 3057, 3100, 3143, 3185, 3226, 3267, 3307, 3346, 3385, 3423, 3459,
@@ -52,5 +110,147 @@ static const uint16_t SINE_Q15[LUT_SIZE] = {
 600, 636, 672, 710, 749, 788, 828, 869, 910, 952, 995, 1038, 1082, 1127, 1172, 1218,
 1264, 1311, 1358, 1405, 1453, 1501, 1550, 1599, 1648, 1697, 1747, 1797, 1847, 1897, 1947, 1997
 };
+#endif
+#elif LUT_BITS == 9
+#if LUT_QUARTER
+static const uint16_t SINE_Q15_QUARTER[LUT_QUARTER_SIZE + 1u] = {
+2048, 2073, 2098, 2123, 2148, 2173, 2198, 2223, 2248, 2273, 2298, 2323, 2348, 2373, 2398, 2422,
+2447, 2472, 2496, 2521, 2545, 2569, 2594, 2618, 2642, 2666, 2690, 2714, 2737, 2761, 2784, 2808,
+2831, 2854, 2877, 2900, 2923, 2946, 2968, 2990, 3013, 3035, 3057, 3078, 3100, 3122, 3143, 3164,
+3185, 3206, 3226, 3247, 3267, 3287, 3307, 3327, 3346, 3366, 3385, 3404, 3423, 3441, 3459, 3477,
+3495, 3513, 3530, 3548, 3565, 3581, 3598, 3614, 3630, 3646, 3662, 3677, 3692, 3707, 3722, 3736,
+3750, 3764, 3777, 3791, 3804, 3816, 3829, 3841, 3853, 3865, 3876, 3888, 3898, 3909, 3919, 3929,
+3939, 3949, 3958, 3967, 3975, 3984, 3992, 3999, 4007, 4014, 4021, 4027, 4034, 4040, 4045, 4051,
+4056, 4060, 4065, 4069, 4073, 4076, 4080, 4083, 4085, 4087, 4089, 4091, 4093, 4094, 4094, 4095,
+4095
+};
+#else
+static const uint16_t SINE_Q15[LUT_SIZE] = {
+2048, 2073, 2098, 2123, 2148, 2173, 2198, 2223, 2248, 2273, 2298, 2323, 2348, 2373, 2398, 2422,
+2447, 2472, 2496, 2521, 2545, 2569, 2594, 2618, 2642, 2666, 2690, 2714, 2737, 2761, 2784, 2808,
+2831, 2854, 2877, 2900, 2923, 2946, 2968, 2990, 3013, 3035, 3057, 3078, 3100, 3122, 3143, 3164,
+3185, 3206, 3226, 3247, 3267, 3287, 3307, 3327, 3346, 3366, 3385, 3404, 3423, 3441, 3459, 3477,
+3495, 3513, 3530, 3548, 3565, 3581, 3598, 3614, 3630, 3646, 3662, 3677, 3692, 3707, 3722, 3736,
+3750, 3764, 3777, 3791, 3804, 3816, 3829, 3841, 3853, 3865, 3876, 3888, 3898, 3909, 3919, 3929,
+3939, 3949, 3958, 3967, 3975, 3984, 3992, 3999, 4007, 4014, 4021, 4027, 4034, 4040, 4045, 4051,
+4056, 4060, 4065, 4069, 4073, 4076, 4080, 4083, 4085, 4087, 4089, 4091, 4093, 4094, 4094, 4095,
+4095, 4095, 4094, 4094, 4093, 4091, 4089, 4087, 4085, 4083, 4080, 4076, 4073, 4069, 4065, 4060,
+4056, 4051, 4045, 4040, 4034, 4027, 4021, 4014, 4007, 3999, 3992, 3984, 3975, 3967, 3958, 3949,
+3939, 3929, 3919, 3909, 3898, 3888, 3876, 3865, 3853, 3841, 3829, 3816, 3804, 3791, 3777, 3764,
+3750, 3736, 3722, 3707, 3692, 3677, 3662, 3646, 3630, 3614, 3598, 3581, 3565, 3548, 3530, 3513,
+3495, 3477, 3459, 3441, 3423, 3404, 3385, 3366, 3346, 3327, 3307, 3287, 3267, 3247, 3226, 3206,
+3185, 3164, 3143, 3122, 3100, 3078, 3057, 3035, 3013, 2990, 2968, 2946, 2923, 2900, 2877, 2854,
+2831, 2808, 2784, 2761, 2737, 2714, 2690, 2666, 2642, 2618, 2594, 2569, 2545, 2521, 2496, 2472,
+2447, 2422, 2398, 2373, 2348, 2323, 2298, 2273, 2248, 2223, 2198, 2173, 2148, 2123, 2098, 2073,
+2048, 2022, 1997, 1972, 1947, 1922, 1897, 1872, 1847, 1822, 1797, 1772, 1747, 1722, 1697, 1673,
+1648, 1623, 1599, 1574, 1550, 1526, 1501, 1477, 1453, 1429, 1405, 1381, 1358, 1334, 1311, 1287,
+1264, 1241, 1218, 1195, 1172, 1149, 1127, 1105, 1082, 1060, 1038, 1017, 995, 973, 952, 931,
+910, 889, 869, 848, 828, 808, 788, 768, 749, 729, 710, 691, 672, 654, 636, 618,
+600, 582, 565, 547, 530, 514, 497, 481, 465, 449, 433, 418, 403, 388, 373, 359,
+345, 331, 318, 304, 291, 279, 266, 254, 242, 230, 219, 207, 197, 186, 176, 166,
+156, 146, 137, 128, 120, 111, 103, 96, 88, 81, 74, 68, 61, 55, 50, 44,
+39, 35, 30, 26, 22, 19, 15, 12, 10, 8, 6, 4, 2, 1, 1, 0,
+0, 0, 1, 1, 2, 4, 6, 8, 10, 12, 15, 19, 22, 26, 30, 35,
+39, 44, 50, 55, 61, 68, 74, 81, 88, 96, 103, 111, 120, 128, 137, 146,
+156, 166, 176, 186, 197, 207, 219, 230, 242, 254, 266, 279, 291, 304, 318, 331,
+345, 359, 373, 388, 403, 418, 433, 449, 465, 481, 497, 514, 530, 547, 565, 582,
+600, 618, 636, 654, 672, 691, 710, 729, 749, 768, 788, 808, 828, 848, 869, 889,
+910, 931, 952, 973, 995, 1017, 1038, 1060, 1082, 1105, 1127, 1149, 1172, 1195, 1218, 1241,
+1264, 1287, 1311, 1334, 1358, 1381, 1405, 1429, 1453, 1477, 1501, 1526, 1550, 1574, 1599, 1623,
+1648, 1673, 1697, 1722, 1747, 1772, 1797, 1822, 1847, 1872, 1897, 1922, 1947, 1972, 1997, 2022
+};
+#endif
+#elif LUT_BITS == 10
+#if LUT_QUARTER
+static const uint16_t SINE_Q15_QUARTER[LUT_QUARTER_SIZE + 1u] = {
+2048, 2060, 2073, 2085, 2098, 2110, 2123, 2135, 2148, 2161, 2173, 2186, 2198, 2211, 2223, 2236,
+2248, 2261, 2273, 2286, 2298, 2311, 2323, 2335, 2348, 2360, 2373, 2385, 2398, 2410, 2422, 2435,
+2447, 2459, 2472, 2484, 2496, 2508, 2521, 2533, 2545, 2557, 2569, 2581, 2594, 2606, 2618, 2630,
+2642, 2654, 2666, 2678, 2690, 2702, 2714, 2725, 2737, 2749, 2761, 2773, 2784, 2796, 2808, 2819,
+2831, 2843, 2854, 2866, 2877, 2889, 2900, 2912, 2923, 2934, 2946, 2957, 2968, 2979, 2990, 3002,
+3013, 3024, 3035, 3046, 3057, 3068, 3078, 3089, 3100, 3111, 3122, 3132, 3143, 3154, 3164, 3175,
+3185, 3195, 3206, 3216, 3226, 3237, 3247, 3257, 3267, 3277, 3287, 3297, 3307, 3317, 3327, 3337,
+3346, 3356, 3366, 3375, 3385, 3394, 3404, 3413, 3423, 3432, 3441, 3450, 3459, 3468, 3477, 3486,
+3495, 3504, 3513, 3522, 3530, 3539, 3548, 3556, 3565, 3573, 3581, 3590, 3598, 3606, 3614, 3622,
+3630, 3638, 3646, 3654, 3662, 3669, 3677, 3685, 3692, 3700, 3707, 3714, 3722, 3729, 3736, 3743,
+3750, 3757, 3764, 3771, 3777, 3784, 3791, 3797, 3804, 3810, 3816, 3823, 3829, 3835, 3841, 3847,
+3853, 3859, 3865, 3871, 3876, 3882, 3888, 3893, 3898, 3904, 3909, 3914, 3919, 3924, 3929, 3934,
+3939, 3944, 3949, 3953, 3958, 3962, 3967, 3971, 3975, 3980, 3984, 3988, 3992, 3996, 3999, 4003,
+4007, 4010, 4014, 4017, 4021, 4024, 4027, 4031, 4034, 4037, 4040, 4042, 4045, 4048, 4051, 4053,
+4056, 4058, 4060, 4063, 4065, 4067, 4069, 4071, 4073, 4075, 4076, 4078, 4080, 4081, 4083, 4084,
+4085, 4086, 4087, 4088, 4089, 4090, 4091, 4092, 4093, 4093, 4094, 4094, 4094, 4095, 4095, 4095,
+4095
+};
+#else
+static const uint16_t SINE_Q15[LUT_SIZE] = {
+2048, 2060, 2073, 2085, 2098, 2110, 2123, 2135, 2148, 2161, 2173, 2186, 2198, 2211, 2223, 2236,
+2248, 2261, 2273, 2286, 2298, 2311, 2323, 2335, 2348, 2360, 2373, 2385, 2398, 2410, 2422, 2435,
+2447, 2459, 2472, 2484, 2496, 2508, 2521, 2533, 2545, 2557, 2569, 2581, 2594, 2606, 2618, 2630,
+2642, 2654, 2666, 2678, 2690, 2702, 2714, 2725, 2737, 2749, 2761, 2773, 2784, 2796, 2808, 2819,
+2831, 2843, 2854, 2866, 2877, 2889, 2900, 2912, 2923, 2934, 2946, 2957, 2968, 2979, 2990, 3002,
+3013, 3024, 3035, 3046, 3057, 3068, 3078, 3089, 3100, 3111, 3122, 3132, 3143, 3154, 3164, 3175,
+3185, 3195, 3206, 3216, 3226, 3237, 3247, 3257, 3267, 3277, 3287, 3297, 3307, 3317, 3327, 3337,
+3346, 3356, 3366, 3375, 3385, 3394, 3404, 3413, 3423, 3432, 3441, 3450, 3459, 3468, 3477, 3486,
+3495, 3504, 3513, 3522, 3530, 3539, 3548, 3556, 3565, 3573, 3581, 3590, 3598, 3606, 3614, 3622,
+3630, 3638, 3646, 3654, 3662, 3669, 3677, 3685, 3692, 3700, 3707, 3714, 3722, 3729, 3736, 3743,
+3750, 3757, 3764, 3771, 3777, 3784, 3791, 3797, 3804, 3810, 3816, 3823, 3829, 3835, 3841, 3847,
+3853, 3859, 3865, 3871, 3876, 3882, 3888, 3893, 3898, 3904, 3909, 3914, 3919, 3924, 3929, 3934,
+3939, 3944, 3949, 3953, 3958, 3962, 3967, 3971, 3975, 3980, 3984, 3988, 3992, 3996, 3999, 4003,
+4007, 4010, 4014, 4017, 4021, 4024, 4027, 4031, 4034, 4037, 4040, 4042, 4045, 4048, 4051, 4053,
+4056, 4058, 4060, 4063, 4065, 4067, 4069, 4071, 4073, 4075, 4076, 4078, 4080, 4081, 4083, 4084,
+4085, 4086, 4087, 4088, 4089, 4090, 4091, 4092, 4093, 4093, 4094, 4094, 4094, 4095, 4095, 4095,
+4095, 4095, 4095, 4095, 4094, 4094, 4094, 4093, 4093, 4092, 4091, 4090, 4089, 4088, 4087, 4086,
+4085, 4084, 4083, 4081, 4080, 4078, 4076, 4075, 4073, 4071, 4069, 4067, 4065, 4063, 4060, 4058,
+4056, 4053, 4051, 4048, 4045, 4042, 4040, 4037, 4034, 4031, 4027, 4024, 4021, 4017, 4014, 4010,
+4007, 4003, 3999, 3996, 3992, 3988, 3984, 3980, 3975, 3971, 3967, 3962, 3958, 3953, 3949, 3944,
+3939, 3934, 3929, 3924, 3919, 3914, 3909, 3904, 3898, 3893, 3888, 3882, 3876, 3871, 3865, 3859,
+3853, 3847, 3841, 3835, 3829, 3823, 3816, 3810, 3804, 3797, 3791, 3784, 3777, 3771, 3764, 3757,
+3750, 3743, 3736, 3729, 3722, 3714, 3707, 3700, 3692, 3685, 3677, 3669, 3662, 3654, 3646, 3638,
+3630, 3622, 3614, 3606, 3598, 3590, 3581, 3573, 3565, 3556, 3548, 3539, 3530, 3522, 3513, 3504,
+3495, 3486, 3477, 3468, 3459, 3450, 3441, 3432, 3423, 3413, 3404, 3394, 3385, 3375, 3366, 3356,
+3346, 3337, 3327, 3317, 3307, 3297, 3287, 3277, 3267, 3257, 3247, 3237, 3226, 3216, 3206, 3195,
+3185, 3175, 3164, 3154, 3143, 3132, 3122, 3111, 3100, 3089, 3078, 3068, 3057, 3046, 3035, 3024,
+3013, 3002, 2990, 2979, 2968, 2957, 2946, 2934, 2923, 2912, 2900, 2889, 2877, 2866, 2854, 2843,
+2831, 2819, 2808, 2796, 2784, 2773, 2761, 2749, 2737, 2725, 2714, 2702, 2690, 2678, 2666, 2654,
+2642, 2630, 2618, 2606, 2594, 2581, 2569, 2557, 2545, 2533, 2521, 2508, 2496, 2484, 2472, 2459,
+2447, 2435, 2422, 2410, 2398, 2385, 2373, 2360, 2348, 2335, 2323, 2311, 2298, 2286, 2273, 2261,
+2248, 2236, 2223, 2211, 2198, 2186, 2173, 2161, 2148, 2135, 2123, 2110, 2098, 2085, 2073, 2060,
+2048, 2035, 2022, 2010, 1997, 1985, 1972, 1960, 1947, 1934, 1922, 1909, 1897, 1884, 1872, 1859,
+1847, 1834, 1822, 1809, 1797, 1784, 1772, 1760, 1747, 1735, 1722, 1710, 1697, 1685, 1673, 1660,
+1648, 1636, 1623, 1611, 1599, 1587, 1574, 1562, 1550, 1538, 1526, 1514, 1501, 1489, 1477, 1465,
+1453, 1441, 1429, 1417, 1405, 1393, 1381, 1370, 1358, 1346, 1334, 1322, 1311, 1299, 1287, 1276,
+1264, 1252, 1241, 1229, 1218, 1206, 1195, 1183, 1172, 1161, 1149, 1138, 1127, 1116, 1105, 1093,
+1082, 1071, 1060, 1049, 1038, 1027, 1017, 1006, 995, 984, 973, 963, 952, 941, 931, 920,
+910, 900, 889, 879, 869, 858, 848, 838, 828, 818, 808, 798, 788, 778, 768, 758,
+749, 739, 729, 720, 710, 701, 691, 682, 672, 663, 654, 645, 636, 627, 618, 609,
+600, 591, 582, 573, 565, 556, 547, 539, 530, 522, 514, 505, 497, 489, 481, 473,
+465, 457, 449, 441, 433, 426, 418, 410, 403, 395, 388, 381, 373, 366, 359, 352,
+345, 338, 331, 324, 318, 311, 304, 298, 291, 285, 279, 272, 266, 260, 254, 248,
+242, 236, 230, 224, 219, 213, 207, 202, 197, 191, 186, 181, 176, 171, 166, 161,
+156, 151, 146, 142, 137, 133, 128, 124, 120, 115, 111, 107, 103, 99, 96, 92,
+88, 85, 81, 78, 74, 71, 68, 64, 61, 58, 55, 53, 50, 47, 44, 42,
+39, 37, 35, 32, 30, 28, 26, 24, 22, 20, 19, 17, 15, 14, 12, 11,
+10, 9, 8, 7, 6, 5, 4, 3, 2, 2, 1, 1, 1, 0, 0, 0,
+0, 0, 0, 0, 1, 1, 1, 2, 2, 3, 4, 5, 6, 7, 8, 9,
+10, 11, 12, 14, 15, 17, 19, 20, 22, 24, 26, 28, 30, 32, 35, 37,
+39, 42, 44, 47, 50, 53, 55, 58, 61, 64, 68, 71, 74, 78, 81, 85,
+88, 92, 96, 99, 103, 107, 111, 115, 120, 124, 128, 133, 137, 142, 146, 151,
+156, 161, 166, 171, 176, 181, 186, 191, 197, 202, 207, 213, 219, 224, 230, 236,
+242, 248, 254, 260, 266, 272, 279, 285, 291, 298, 304, 311, 318, 324, 331, 338,
+345, 352, 359, 366, 373, 381, 388, 395, 403, 410, 418, 426, 433, 441, 449, 457,
+465, 473, 481, 489, 497, 505, 514, 522, 530, 539, 547, 556, 565, 573, 582, 591,
+600, 609, 618, 627, 636, 645, 654, 663, 672, 682, 691, 701, 710, 720, 729, 739,
+749, 758, 768, 778, 788, 798, 808, 818, 828, 838, 848, 858, 869, 879, 889, 900,
+910, 920, 931, 941, 952, 963, 973, 984, 995, 1006, 1017, 1027, 1038, 1049, 1060, 1071,
+1082, 1093, 1105, 1116, 1127, 1138, 1149, 1161, 1172, 1183, 1195, 1206, 1218, 1229, 1241, 1252,
+1264, 1276, 1287, 1299, 1311, 1322, 1334, 1346, 1358, 1370, 1381, 1393, 1405, 1417, 1429, 1441,
+1453, 1465, 1477, 1489, 1501, 1514, 1526, 1538, 1550, 1562, 1574, 1587, 1599, 1611, 1623, 1636,
+1648, 1660, 1673, 1685, 1697, 1710, 1722, 1735, 1747, 1760, 1772, 1784, 1797, 1809, 1822, 1834,
+1847, 1859, 1872, 1884, 1897, 1909, 1922, 1934, 1947, 1960, 1972, 1985, 1997, 2010, 2022, 2035
+};
+#endif
+#else
+#error "LUT_BITS must be between 6 and 10, see gen_sin_lut.py"
+#endif
 
-#endif // _SINLUT_H_
\ No newline at end of file
+#endif // _SINLUT_H_
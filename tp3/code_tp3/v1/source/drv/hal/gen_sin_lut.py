@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""
+Generador de SinLutQ15.h para el NCO (solo biblioteca estándar).
+
+Para cada tamaño de LUT_BITS_MIN a LUT_BITS_MAX emite dos tablas de códigos
+del DAC de 12 bits, round(2047.5 + 2047.5 * sin(2 pi k / 2^bits)):
+
+  - SINE_Q15[LUT_SIZE], el período completo (la tabla histórica de 256
+    puntos sale idéntica).
+  - SINE_Q15_QUARTER[LUT_SIZE / 4 + 1], el primer cuadrante con el pico
+    incluido; NCO.c arma los otros tres espejando el índice y el signo.
+
+Cuál se compila lo eligen LUT_BITS y LUT_QUARTER en tiempo de compilación.
+
+Uso:
+    python3 gen_sin_lut.py [--min 6] [--max 10] > SinLutQ15.h
+"""
+
+import argparse
+import math
+import sys
+
+DAC_MAX = 4095
+
+
+def table(bits, count):
+    size = 1 << bits
+    mid = DAC_MAX / 2.0
+    return [round(mid + mid * math.sin(2.0 * math.pi * k / size)) for k in range(count)]
+
+
+def rows(values):
+    out = []
+    for i in range(0, len(values), 16):
+        out.append(", ".join("%d" % v for v in values[i:i + 16]))
+    return ",\n".join(out)
+
+
+def emit(lo, hi):
+    out = []
+    out.append("/**")
+    out.append(" * @file SinLutQ15.h")
+    out.append(" * @brief Tabla de búsqueda de seno para el NCO.")
+    out.append(" *")
+    out.append(" * Generado por gen_sin_lut.py --min %d --max %d, no editar a mano." % (lo, hi))
+    out.append(" *")
+    out.append(" * Los valores son códigos del DAC de 12 bits, round(2047.5 + 2047.5 * sin(2π k / LUT_SIZE)),")
+    out.append(" * de 0 a 4095 centrados en 2047.5. El nombre SINE_Q15 es histórico.")
+    out.append(" */")
+    out.append("")
+    out.append("#ifndef _SINLUT_H_")
+    out.append("#define _SINLUT_H_")
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("")
+    out.append("// ---- Perillas de tiempo de compilación ----")
+    out.append("")
+    out.append("/**")
+    out.append(" * @def LUT_BITS")
+    out.append(" * @brief Log2 de los puntos por período (%d a %d, 8 por defecto = 256 puntos)." % (lo, hi))
+    out.append(" */")
+    out.append("#ifndef LUT_BITS")
+    out.append("#define LUT_BITS (8u) // 256 puntos por defecto")
+    out.append("#endif")
+    out.append("")
+    out.append("/**")
+    out.append(" * @def LUT_QUARTER")
+    out.append(" * @brief 1 para guardar solo un cuarto de onda (LUT_SIZE / 4 + 1 puntos).")
+    out.append(" */")
+    out.append("#ifndef LUT_QUARTER")
+    out.append("#define LUT_QUARTER 0")
+    out.append("#endif")
+    out.append("")
+    out.append("/**")
+    out.append(" * @def LUT_SIZE")
+    out.append(" * @brief Puntos por período, calculado como 2 elevado a LUT_BITS.")
+    out.append(" */")
+    out.append("#define LUT_SIZE (1u << LUT_BITS)")
+    out.append("")
+    out.append("/**")
+    out.append(" * @def LUT_QUARTER_SIZE")
+    out.append(" * @brief Puntos por cuadrante; SINE_Q15_QUARTER tiene uno más (el pico).")
+    out.append(" */")
+    out.append("#define LUT_QUARTER_SIZE (LUT_SIZE / 4u)")
+    out.append("")
+    out.append("/**")
+    out.append(" * @def LUT_DAC_MAX")
+    out.append(" * @brief Código máximo; el semiciclo negativo es LUT_DAC_MAX - positivo.")
+    out.append(" */")
+    out.append("#define LUT_DAC_MAX (%du)" % DAC_MAX)
+    out.append("")
+    for bits in range(lo, hi + 1):
+        size = 1 << bits
+        out.append("%s LUT_BITS == %d" % ("#if" if bits == lo else "#elif", bits))
+        out.append("#if LUT_QUARTER")
+        out.append("static const uint16_t SINE_Q15_QUARTER[LUT_QUARTER_SIZE + 1u] = {")
+        out.append(rows(table(bits, size // 4 + 1)))
+        out.append("};")
+        out.append("#else")
+        out.append("static const uint16_t SINE_Q15[LUT_SIZE] = {")
+        out.append(rows(table(bits, size)))
+        out.append("};")
+        out.append("#endif")
+    out.append("#else")
+    out.append("#error \"LUT_BITS must be between %d and %d, see gen_sin_lut.py\"" % (lo, hi))
+    out.append("#endif")
+    out.append("")
+    out.append("#endif // _SINLUT_H_")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    p.add_argument("--min", dest="lo", type=int, default=6, help="LUT_BITS más chico")
+    p.add_argument("--max", dest="hi", type=int, default=10, help="LUT_BITS más grande")
+    args = p.parse_args()
+    if not 2 <= args.lo <= args.hi <= 14:
+        p.error("se necesita 2 <= min <= max <= 14")
+    sys.stdout.write(emit(args.lo, args.hi))
+
+
+if __name__ == "__main__":
+    main()
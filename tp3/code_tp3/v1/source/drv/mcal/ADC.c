@@ -248,6 +248,36 @@ bool ADC_Calibrate (ADC_t adc)
 	return true;
 }
 
+/**
+ * @brief Selecciona qué dispara las conversiones del ADC.
+ *
+ * @param adc ADC0 o ADC1.
+ * @param trg Fuente de disparo.
+ */
+void ADC_SetTrigger (ADC_t adc, ADCTrigger_t trg)
+{
+	uint32_t sopt7 = SIM->SOPT7;
+
+	if (adc == ADC0)
+	{
+		sopt7 &= ~(SIM_SOPT7_ADC0ALTTRGEN_MASK | SIM_SOPT7_ADC0PRETRGSEL_MASK | SIM_SOPT7_ADC0TRGSEL_MASK);
+		if (trg < ADC_trgSoftware)
+			sopt7 |= SIM_SOPT7_ADC0ALTTRGEN_MASK | SIM_SOPT7_ADC0TRGSEL(trg);
+	}
+	else if (adc == ADC1)
+	{
+		sopt7 &= ~(SIM_SOPT7_ADC1ALTTRGEN_MASK | SIM_SOPT7_ADC1PRETRGSEL_MASK | SIM_SOPT7_ADC1TRGSEL_MASK);
+		if (trg < ADC_trgSoftware)
+			sopt7 |= SIM_SOPT7_ADC1ALTTRGEN_MASK | SIM_SOPT7_ADC1TRGSEL(trg);
+	}
+	SIM->SOPT7 = sopt7;
+
+	if (trg == ADC_trgSoftware)
+		adc->SC2 &= ~ADC_SC2_ADTRG_MASK;
+	else
+		adc->SC2 |= ADC_SC2_ADTRG_MASK;
+}
+
 /**
  * @brief Dispara una conversión en el canal indicado.
  *
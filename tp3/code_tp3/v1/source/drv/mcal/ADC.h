@@ -58,6 +58,31 @@ typedef enum
 	ADC_mB,  /**< MUX B. */
 } ADCMux_t;
 
+/**
+ * @brief Enumeración para la fuente que dispara cada conversión del ADC.
+ *
+ * Los valores de ADC_trgCMP0 a ADC_trgLPTMR son los de SIM_SOPT7[ADCxTRGSEL]
+ * (disparo alternativo, siempre pre-trigger A). Con ADC_trgPDB el disparo
+ * lo da el PDB, que se configura aparte.
+ */
+typedef enum
+{
+	ADC_trgSoftware = 0x10, /**< Cada escritura de SC1 (ADC_Start) convierte. */
+	ADC_trgPDB      = 0x11, /**< Pre-trigger A del PDB0. */
+	ADC_trgCMP0     = 0x01, /**< Salida del comparador 0. */
+	ADC_trgCMP1     = 0x02, /**< Salida del comparador 1. */
+	ADC_trgCMP2     = 0x03, /**< Salida del comparador 2. */
+	ADC_trgPIT0     = 0x04, /**< Timeout del PIT canal 0. */
+	ADC_trgPIT1     = 0x05, /**< Timeout del PIT canal 1. */
+	ADC_trgPIT2     = 0x06, /**< Timeout del PIT canal 2. */
+	ADC_trgPIT3     = 0x07, /**< Timeout del PIT canal 3. */
+	ADC_trgFTM0     = 0x08, /**< Trigger del FTM0. */
+	ADC_trgFTM1     = 0x09, /**< Trigger del FTM1. */
+	ADC_trgFTM2     = 0x0A, /**< Trigger del FTM2. */
+	ADC_trgFTM3     = 0x0B, /**< Trigger del FTM3. */
+	ADC_trgLPTMR    = 0x0E, /**< Match del LPTMR. */
+} ADCTrigger_t;
+
 /**
  * @brief Tipo de puntero a la estructura del ADC (ADC_Type).
  */
@@ -184,9 +209,26 @@ ADCTaps_t   ADC_GetHardwareAverage (ADC_t);
  */
 bool 		ADC_Calibrate 		   (ADC_t);
 
+/**
+ * @brief Selecciona qué dispara las conversiones del ADC.
+ *
+ * Con un disparo por hardware (p. ej. ADC_trgPIT1) el timer arranca cada
+ * conversión a intervalos exactos, sin ISR por muestra; con DMA habilitado
+ * en ADC_Init() el resultado va a memoria sin intervención de la CPU.
+ *
+ * @param adc ADC0 o ADC1.
+ * @param trg Fuente de disparo (enum ADCTrigger_t).
+ * @note Programa SC2[ADTRG] y los campos del ADC en SIM_SOPT7. Después hay
+ *       que llamar a ADC_Start() una vez para elegir el canal.
+ */
+void 		ADC_SetTrigger 		   (ADC_t, ADCTrigger_t);
+
 /**
  * @brief Dispara una conversión en el canal indicado.
  *
+ * Con un disparo por hardware (ADC_SetTrigger()) no convierte: solo deja el
+ * canal seleccionado para los próximos disparos.
+ *
  * @param adc ADC0 o ADC1.
  * @param channel Canal a convertir (enum ADCChannel_t).
  * @param mux Selección del MUX (enum ADCMux_t).
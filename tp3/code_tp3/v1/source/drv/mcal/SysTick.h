@@ -27,6 +27,18 @@
  */
 #define SYSTICK_ISR_FREQUENCY_HZ 2000U
 
+/**
+ * @def SYSTICK_CORE_CLK
+ * @brief Reloj del core que cuenta el SysTick (100 MHz).
+ */
+#define SYSTICK_CORE_CLK 100000000UL
+
+/**
+ * @def SYSTICK_COUNT_FROM_HZ(hz)
+ * @brief Conteo para SysTick_Init() que da una interrupción a hz (redondeado).
+ */
+#define SYSTICK_COUNT_FROM_HZ(hz) ((uint32_t)((SYSTICK_CORE_CLK + (hz)/2) / (hz)))
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
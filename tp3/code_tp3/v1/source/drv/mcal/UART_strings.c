@@ -5,29 +5,75 @@
  * Este archivo implementa buffers circulares para TX y RX, funciones de polling para
  * transmisión y recepción no bloqueante, y manejo de cadenas. Verifica errores en recepción
  * como paridad, framing, ruido u overrun.
+ *
+ * Los índices corren libres y se enmascaran con el tamaño - 1; cada uno lo
+ * escribe un solo lado (head el productor, tail el consumidor).
  */
 
 #include "UART_strings.h"
+#if UART_DMA
+#include "dma.h"
+#endif
+
+#define UART_TX_MASK (UART_TX_BUF_SIZE - 1u)
+#define UART_RX_MASK (UART_RX_BUF_SIZE - 1u)
 
 /* -------- Buffers circulares -------- */
 /**
  * @var s_tx_buf
  * @brief Buffer circular para datos de transmisión (TX).
  */
-static volatile char s_tx_buf[UART_TX_BUF_SIZE];
+static char s_tx_buf[UART_TX_BUF_SIZE];
 
 /**
  * @var s_tx_head
  * @brief Índice de cabeza para el buffer TX (donde se inserta).
  */
-static volatile size_t s_tx_head = 0;
+static volatile uint32_t s_tx_head = 0;
 
 /**
  * @var s_tx_tail
  * @brief Índice de cola para el buffer TX (donde se extrae).
  */
-static volatile size_t s_tx_tail = 0;
+static volatile uint32_t s_tx_tail = 0;
+
+#if UART_DMA
+/**
+ * @var s_tx_dma_len
+ * @brief Bytes del tramo que está sacando el DMA de TX, 0 con el canal parado.
+ */
+static volatile uint32_t s_tx_dma_len = 0;
+
+/**
+ * @var s_tx_tcd
+ * @brief Descriptor del tramo de TX; se rearma en cada tramo.
+ */
+static dma_tcd_t s_tx_tcd;
+
+/**
+ * @var s_rx_ring_size
+ * @brief Tamaño del anillo de RX de UART_DmaInit().
+ */
+static size_t s_rx_ring_size = 0;
+
+/**
+ * @var s_rx_laps
+ * @brief Vueltas del DMA de RX por el anillo (interrupción de loop mayor).
+ */
+static volatile uint32_t s_rx_laps = 0;
+
+/**
+ * @var s_rx_written
+ * @brief Bytes escritos en el anillo según el último UART_RxRingPending().
+ */
+static uint32_t s_rx_written = 0;
 
+/**
+ * @var s_dma_ready
+ * @brief True desde UART_DmaInit(); antes el TX espera en el buffer.
+ */
+static bool s_dma_ready = false;
+#else
 /**
  * @var s_rx_buf
  * @brief Buffer circular para datos de recepción (RX).
@@ -38,50 +84,193 @@ static volatile char s_rx_buf[UART_RX_BUF_SIZE];
  * @var s_rx_head
  * @brief Índice de cabeza para el buffer RX (donde se inserta).
  */
-static volatile size_t s_rx_head = 0;
+static volatile uint32_t s_rx_head = 0;
 
 /**
  * @var s_rx_tail
  * @brief Índice de cola para el buffer RX (donde se extrae).
  */
-static volatile size_t s_rx_tail = 0;
+static volatile uint32_t s_rx_tail = 0;
+#endif
+
+/**
+ * @var s_rx_overflow
+ * @brief Bytes de RX pisados antes de leerse, ver UART_RxOverflow().
+ */
+static uint32_t s_rx_overflow = 0;
 
-/* Helpers para ring buffer */
+#if UART_DMA
 /**
- * @brief Calcula el siguiente índice en un buffer circular.
+ * @brief Lanza el DMA de TX con el próximo tramo contiguo, si está parado y hay datos.
  *
- * @param idx Índice actual.
- * @param size Tamaño del buffer.
- * @return Siguiente índice.
+ * Corre en el loop principal (solo con el canal parado) y en la ISR de fin de
+ * tramo, así que los dos nunca se pisan.
  */
-static inline size_t rb_next(size_t idx, size_t size)
+static void tx_dma_kick(void)
 {
-    return (idx + 1u) % size;
+    uint32_t pending = s_tx_head - s_tx_tail;
+    if (!s_dma_ready || s_tx_dma_len != 0 || pending == 0)
+    {
+        return;
+    }
+    uint32_t start = s_tx_tail & UART_TX_MASK;
+    uint32_t len = UART_TX_BUF_SIZE - start;
+    if (pending < len)
+    {
+        len = pending;
+    }
+
+    dma_cfg_t cfg =
+    {
+        .saddr = &s_tx_buf[start],
+        .daddr = (void *)&UART0->D,
+        .nbytes = 1,
+        .soff = 1, .doff = 0,
+        .major_count = (uint16_t)len,
+        .int_major = true,
+    };
+    DMA_TcdSet(&s_tx_tcd, &cfg);
+    DMA_TcdLink(&s_tx_tcd, NULL);   // DREQ: el canal se desarma al final del tramo
+    s_tx_dma_len = len;
+    DMA_TcdLoad(UART_TX_DMA_CH, &s_tx_tcd);
+    DMA_Start(UART_TX_DMA_CH);
+}
+
+/**
+ * @brief Fin de un tramo de TX: libera los bytes y lanza el siguiente.
+ */
+static void tx_dma_done(void *user)
+{
+    (void)user;
+    s_tx_tail += s_tx_dma_len;
+    s_tx_dma_len = 0;
+    tx_dma_kick();
 }
 
 /**
- * @brief Verifica si el buffer circular está lleno.
+ * @brief El DMA de RX volvió al inicio del anillo.
+ */
+static void rx_dma_lap(void *user)
+{
+    (void)user;
+    s_rx_laps++;
+}
+
+/**
+ * @brief Arma los canales de eDMA de RX y TX de UART0.
  *
- * @param head Índice de cabeza.
- * @param tail Índice de cola.
- * @param size Tamaño del buffer.
- * @return True si lleno, false caso contrario.
+ * @param rx_ring Anillo de recepción.
+ * @param rx_size Tamaño del anillo (potencia de 2).
+ * @return 0 si éxito, <0 si error.
  */
-static inline bool rb_full(size_t head, size_t tail, size_t size)
+int UART_DmaInit(volatile uint8_t *rx_ring, size_t rx_size)
 {
-    return rb_next(head, size) == tail;
+    if (rx_ring == NULL || rx_size == 0 || (rx_size & (rx_size - 1u)) != 0
+        || rx_size > DMA_CITER_ELINKNO_CITER_MASK)
+    {
+        return -1;
+    }
+
+    const dma_cfg_t rx_cfg =
+    {
+        .ch = UART_RX_DMA_CH,
+        .request_src = DMA_REQ_UART0_RX,
+        .saddr = (void *)&UART0->D,
+        .daddr = (void *)rx_ring,
+        .nbytes = 1,
+        .soff = 0, .doff = 1,
+        .major_count = (uint16_t)rx_size,
+        .dlast = -(int32_t)rx_size,
+        .int_major = true,  // una interrupción por vuelta, para contar las pisadas
+        .on_major = rx_dma_lap,
+    };
+    int err = DMA_Config(&rx_cfg);
+    if (err)
+    {
+        return err;
+    }
+    s_rx_ring_size = rx_size;
+
+    // TX: DMAMUX y callback ahora, el TCD lo carga tx_dma_kick() en cada tramo
+    const dma_cfg_t tx_cfg =
+    {
+        .ch = UART_TX_DMA_CH,
+        .request_src = DMA_REQ_UART0_TX,
+        .saddr = s_tx_buf,
+        .daddr = (void *)&UART0->D,
+        .nbytes = 1,
+        .soff = 1, .doff = 0,
+        .major_count = 1,
+        .int_major = true,
+        .on_major = tx_dma_done,
+    };
+    err = DMA_Config(&tx_cfg);
+    if (err)
+    {
+        return err;
+    }
+
+    // RDRF y TDRE piden DMA en vez de interrupción
+    UART0->C5 |= UART_C5_RDMAS_MASK | UART_C5_TDMAS_MASK;
+    UART0->C2 |= UART_C2_RIE_MASK | UART_C2_TIE_MASK;
+    DMA_Start(UART_RX_DMA_CH);
+    s_dma_ready = true;
+    tx_dma_kick();
+    return 0;
 }
 
 /**
- * @brief Verifica si el buffer circular está vacío.
+ * @brief Índice del anillo de RX que el DMA va a escribir a continuación.
  *
- * @param head Índice de cabeza.
- * @param tail Índice de cola.
- * @return True si vacío, false caso contrario.
+ * @return Índice en [0, rx_size).
  */
-static inline bool rb_empty(size_t head, size_t tail)
+size_t UART_RxRingHead(void)
 {
-    return head == tail;
+    // CITER vuelve a rx_size al dar la vuelta, que es el índice 0
+    return (s_rx_ring_size - DMA_GetCount(UART_RX_DMA_CH)) & (s_rx_ring_size - 1u);
+}
+
+/**
+ * @brief Bytes del anillo de RX sin leer desde *tail; descarta los pisados.
+ *
+ * @param tail Índice libre del consumidor.
+ * @return Bytes listos.
+ */
+size_t UART_RxRingPending(uint32_t *tail)
+{
+    uint32_t laps, head;
+    do
+    {
+        laps = s_rx_laps;
+        head = UART_RxRingHead();
+    } while (laps != s_rx_laps);
+
+    uint32_t written = laps * s_rx_ring_size + head;
+    if ((int32_t)(written - s_rx_written) < 0)
+    {
+        written += s_rx_ring_size;  // dio la vuelta y su ISR todavía no corrió
+    }
+    s_rx_written = written;
+
+    uint32_t pending = written - *tail;
+    if (pending > s_rx_ring_size)
+    {
+        s_rx_overflow += pending - s_rx_ring_size;
+        *tail = written - s_rx_ring_size;
+        pending = s_rx_ring_size;
+    }
+    return pending;
+}
+#endif
+
+/**
+ * @brief Bytes de RX pisados antes de leerse.
+ *
+ * @return Total desde el arranque.
+ */
+uint32_t UART_RxOverflow(void)
+{
+    return s_rx_overflow;
 }
 
 /**
@@ -91,9 +280,7 @@ static inline bool rb_empty(size_t head, size_t tail)
  */
 size_t UART_TxPending(void)
 {
-    if (s_tx_head >= s_tx_tail)
-        return s_tx_head - s_tx_tail;
-    return (UART_TX_BUF_SIZE - s_tx_tail) + s_tx_head;
+    return s_tx_head - s_tx_tail;
 }
 
 /**
@@ -103,9 +290,11 @@ size_t UART_TxPending(void)
  */
 size_t UART_RxAvailable(void)
 {
-    if (s_rx_head >= s_rx_tail)
-        return s_rx_head - s_rx_tail;
-    return (UART_RX_BUF_SIZE - s_rx_tail) + s_rx_head;
+#if UART_DMA
+    return 0;
+#else
+    return s_rx_head - s_rx_tail;
+#endif
 }
 
 /**
@@ -113,6 +302,9 @@ size_t UART_RxAvailable(void)
  */
 void UART_Poll(void)
 {
+#if UART_DMA
+    tx_dma_kick();
+#else
     /* RX: leer mientras haya datos */
     while (UART0->S1 & UART_S1_RDRF_MASK)
     {
@@ -126,21 +318,55 @@ void UART_Poll(void)
             continue;
         }
 
-        size_t next = rb_next(s_rx_head, UART_RX_BUF_SIZE);
-        if (rb_full(s_rx_head, s_rx_tail, UART_RX_BUF_SIZE))
+        if (s_rx_head - s_rx_tail == UART_RX_BUF_SIZE)
         {
-            s_rx_tail = rb_next(s_rx_tail, UART_RX_BUF_SIZE);
+            s_rx_tail++; /* lleno: se pierde el más viejo */
+            s_rx_overflow++;
         }
-        s_rx_buf[s_rx_head] = c;
-        s_rx_head = next;
+        s_rx_buf[s_rx_head & UART_RX_MASK] = c;
+        s_rx_head++;
     }
 
     /* TX: mientras el HW esté listo y haya datos */
-    while ((UART0->S1 & UART_S1_TDRE_MASK) && !rb_empty(s_tx_head, s_tx_tail))
+    while ((UART0->S1 & UART_S1_TDRE_MASK) && s_tx_head != s_tx_tail)
     {
-        UART0->D = s_tx_buf[s_tx_tail];
-        s_tx_tail = rb_next(s_tx_tail, UART_TX_BUF_SIZE);
+        UART0->D = s_tx_buf[s_tx_tail & UART_TX_MASK];
+        s_tx_tail++;
     }
+#endif
+}
+
+/**
+ * @brief Tramo contiguo libre del buffer TX.
+ *
+ * @param dst Inicio del tramo.
+ * @return Bytes disponibles en el tramo.
+ */
+size_t UART_TxReserve(char **dst)
+{
+    uint32_t head = s_tx_head;
+    uint32_t room = UART_TX_BUF_SIZE - (head - s_tx_tail);
+    uint32_t contiguous = UART_TX_BUF_SIZE - (head & UART_TX_MASK);
+
+    *dst = &s_tx_buf[head & UART_TX_MASK];
+    return (room < contiguous) ? room : contiguous;
+}
+
+/**
+ * @brief Publica bytes escritos con UART_TxReserve().
+ *
+ * @param n Bytes escritos.
+ */
+void UART_TxCommit(size_t n)
+{
+    if (n == 0)
+        return;
+
+    __DMB(); /* los datos antes que el índice, también para el DMA */
+    s_tx_head += n;
+
+    /* Empujar inmediatamente lo que se pueda */
+    UART_Poll();
 }
 
 /**
@@ -157,19 +383,23 @@ size_t UART_SendString(const char *str)
     size_t enq = 0;
     while (*str)
     {
-        size_t next = rb_next(s_tx_head, UART_TX_BUF_SIZE);
-        if (next == s_tx_tail)
+        char *dst;
+        size_t room = UART_TxReserve(&dst);
+        if (room == 0)
         {
             /* Buffer TX lleno: salir (no bloquear) */
             break;
         }
-        s_tx_buf[s_tx_head] = *str++;
-        s_tx_head = next;
-        enq++;
+        size_t n = 0;
+        while (n < room && str[n])
+        {
+            dst[n] = str[n];
+            n++;
+        }
+        str += n;
+        enq += n;
+        UART_TxCommit(n);
     }
-
-    /* Empujar inmediatamente lo que se pueda */
-    UART_Poll();
     return enq;
 }
 
@@ -186,12 +416,13 @@ int UART_ReceiveString(char *buffer, size_t max_len)
         return 0;
 
     size_t i = 0;
+#if !UART_DMA
     bool endline = false;
 
-    while ((i < (max_len - 1)) && !rb_empty(s_rx_head, s_rx_tail))
+    while ((i < (max_len - 1)) && s_rx_head != s_rx_tail)
     {
-        char c = s_rx_buf[s_rx_tail];
-        s_rx_tail = rb_next(s_rx_tail, UART_RX_BUF_SIZE);
+        char c = s_rx_buf[s_rx_tail & UART_RX_MASK];
+        s_rx_tail++;
 
         if (c == '\n' || c == '\r')
         {
@@ -200,8 +431,9 @@ int UART_ReceiveString(char *buffer, size_t max_len)
         }
         buffer[i++] = c;
     }
+    (void)endline; /* útil si más adelante querés diferenciar línea completa o parcial */
+#endif
 
     buffer[i] = '\0';
-    (void)endline; /* útil si más adelante querés diferenciar línea completa o parcial */
     return (int)i;
-}
\ No newline at end of file
+}
@@ -5,6 +5,12 @@
  * Este archivo proporciona funciones para el manejo no bloqueante de transmisión y recepción
  * de cadenas a través de UART, utilizando buffers circulares para TX y RX. Define tamaños de buffers
  * y funciones para polling, envío y recepción de strings.
+ *
+ * Con UART_DMA los bytes no pasan por copias intermedias: el eDMA escribe lo
+ * que llega por RX directo en un anillo del usuario (UART_DmaInit()), que lo
+ * consume en el lugar, y saca por TX tramos contiguos del buffer TX, que se
+ * llena en el lugar con UART_TxReserve()/UART_TxCommit(). Los anillos son
+ * potencias de 2 y se indexan con máscara.
  */
 
 #ifndef UART_ABSTRACT_H_
@@ -12,14 +18,41 @@
 
 #include "UART.h"
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include "MK64F12.h"
 
+// ---- Perillas de tiempo de compilación ----
+
+/**
+ * @def UART_DMA
+ * @brief 1 = RX y TX de UART0 por eDMA, sin copias; 0 = polling de S1 desde UART_Poll().
+ */
+#ifndef UART_DMA
+#define UART_DMA 1
+#endif
+
+/**
+ * @def UART_RX_DMA_CH
+ * @brief Canal de eDMA que copia UART0->D al anillo de RX.
+ */
+#ifndef UART_RX_DMA_CH
+#define UART_RX_DMA_CH 2
+#endif
+
+/**
+ * @def UART_TX_DMA_CH
+ * @brief Canal de eDMA que copia el buffer TX a UART0->D.
+ */
+#ifndef UART_TX_DMA_CH
+#define UART_TX_DMA_CH 3
+#endif
+
 /* Ajustá los tamaños según tu caso de uso */
 #ifndef UART_TX_BUF_SIZE
 /**
  * @def UART_TX_BUF_SIZE
- * @brief Tamaño del buffer circular para transmisión (TX) en bytes (2048 por defecto).
+ * @brief Tamaño del buffer circular para transmisión (TX) en bytes (2048 por defecto, potencia de 2).
  */
 #define UART_TX_BUF_SIZE 2048
 #endif
@@ -27,17 +60,23 @@
 #ifndef UART_RX_BUF_SIZE
 /**
  * @def UART_RX_BUF_SIZE
- * @brief Tamaño del buffer circular para recepción (RX) en bytes (2048 por defecto).
+ * @brief Tamaño del buffer circular para recepción (RX) en bytes (2048 por defecto, potencia de 2).
  */
 #define UART_RX_BUF_SIZE 2048
 #endif
 
+#if (UART_TX_BUF_SIZE & (UART_TX_BUF_SIZE - 1)) != 0 || (UART_RX_BUF_SIZE & (UART_RX_BUF_SIZE - 1)) != 0
+#error "UART_TX_BUF_SIZE and UART_RX_BUF_SIZE must be powers of 2"
+#endif
+
 /**
  * @brief Realiza polling no bloqueante del hardware UART.
  *
  * Debe llamarse con frecuencia (por ejemplo en el lazo principal).
  * - Transmite bytes encolados (mientras TDRE esté en 1).
  * - Lee bytes disponibles (mientras RDRF esté en 1) y los encola en RX.
+ *
+ * Con UART_DMA solo arranca el DMA de TX si quedó parado con datos pendientes.
  */
 void UART_Poll(void);
 
@@ -52,6 +91,24 @@ void UART_Poll(void);
  */
 size_t UART_SendString(const char *str);
 
+/**
+ * @brief Tramo contiguo libre del buffer TX, para escribir los bytes en el lugar.
+ *
+ * El tramo puede ser más corto que el espacio libre total cuando llega al final
+ * del buffer: después de UART_TxCommit() una segunda llamada da el resto.
+ *
+ * @param dst Donde se devuelve el inicio del tramo.
+ * @return Bytes que se pueden escribir desde *dst (0 si el buffer está lleno).
+ */
+size_t UART_TxReserve(char **dst);
+
+/**
+ * @brief Publica n bytes escritos en el tramo de UART_TxReserve() y los empuja.
+ *
+ * @param n Bytes escritos, como mucho lo que devolvió UART_TxReserve().
+ */
+void UART_TxCommit(size_t n);
+
 /**
  * @brief Copia de manera no bloqueante una "línea" desde el buffer RX.
  *
@@ -59,6 +116,8 @@ size_t UART_SendString(const char *str);
  * o hasta completar max_len-1, o hasta que no haya más datos en RX.
  * Siempre agrega terminador '\0'.
  *
+ * Con UART_DMA lo recibido va al anillo de UART_DmaInit() y devuelve 0.
+ *
  * @param buffer Destino del string recibido.
  * @param max_len Tamaño del buffer destino (incluye '\0').
  * @return int Cantidad de bytes copiados (sin contar el '\0').
@@ -72,7 +131,55 @@ size_t UART_TxPending(void);
 
 /**
  * @brief Devuelve bytes disponibles para leer en el buffer RX.
+ *
+ * Con UART_DMA siempre 0: ver UART_RxRingPending().
  */
 size_t UART_RxAvailable(void);
 
-#endif /* UART_ABSTRACT_H_ */
\ No newline at end of file
+/**
+ * @brief Bytes de RX pisados antes de que se los leyera, desde el arranque.
+ *
+ * Sin UART_DMA, los que UART_Poll() descartó con el buffer lleno; con
+ * UART_DMA, los que UART_RxRingPending() encontró pisados.
+ */
+uint32_t UART_RxOverflow(void);
+
+#if UART_DMA
+/**
+ * @brief Arma los dos canales de eDMA de UART0. Llamar después de UART_Init() y DMA_Init().
+ *
+ * El canal de RX copia cada byte recibido a rx_ring en forma circular y no se
+ * detiene nunca: el consumidor lleva su propio índice y pregunta con
+ * UART_RxRingPending(). No hay control de flujo; si se atrasa más de rx_size
+ * bytes los pisa (ver UART_RxOverflow()). Los bytes con error de paridad o
+ * framing también llegan al anillo.
+ *
+ * @param rx_ring Anillo de recepción.
+ * @param rx_size Tamaño del anillo, potencia de 2 y hasta 32767.
+ * @return 0 si éxito, -1 si rx_size no sirve, <0 si falló el DMA.
+ */
+int UART_DmaInit(volatile uint8_t *rx_ring, size_t rx_size);
+
+/**
+ * @brief Índice del anillo de RX que el DMA va a escribir a continuación.
+ *
+ * Los bytes entre el índice del consumidor y este ya están escritos.
+ *
+ * @return Índice en [0, rx_size).
+ */
+size_t UART_RxRingHead(void);
+
+/**
+ * @brief Bytes del anillo de RX que el consumidor todavía no leyó.
+ *
+ * Si el DMA ya dio la vuelta sobre bytes sin leer, adelanta *tail al más viejo
+ * que queda y suma los perdidos a UART_RxOverflow(). Llamar siempre desde el
+ * mismo contexto (o de ISRs de igual prioridad).
+ *
+ * @param tail Índice libre del consumidor (se enmascara con rx_size - 1 para leer).
+ * @return Bytes listos desde *tail, como mucho rx_size.
+ */
+size_t UART_RxRingPending(uint32_t *tail);
+#endif
+
+#endif /* UART_ABSTRACT_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include "dma.h"
+#include <string.h>
 #include "MK64F12.h"
 #include "hardware.h"
 #include "board.h"
@@ -23,8 +24,11 @@ static bool initialized = false;
 typedef struct 
 {
     dma_cb_t on_major_cb;   /**< Callback para interrupción mayor. */
+    dma_cb_t on_half_cb;    /**< Callback para interrupción de mitad. */
     void *user_param;       /**< Parámetro de usuario. */
     bool active;            /**< Flag de activo. */
+    uint16_t csr;           /**< CSR del descriptor cargado en la última entrada. */
+    bool half_done;         /**< INTHALF del loop mayor en curso ya atendido. */
 } dma_state_t;
 
 /**
@@ -33,6 +37,17 @@ typedef struct
  */
 static dma_state_t dma_ch_states[DMA_NUM_CH];
 
+#if DMA_TCD_POOL_SIZE > 32
+#error "DMA_TCD_POOL_SIZE must be at most 32"
+#endif
+
+/**
+ * @var tcd_pool
+ * @brief Descriptores para cadenas scatter-gather; tcd_pool_used marca los tomados.
+ */
+static dma_tcd_t tcd_pool[DMA_TCD_POOL_SIZE];
+static uint32_t tcd_pool_used;
+
 /**
  * @brief Convierte tamaño en bytes a código para ATTR (SSIZE/DSIZE).
  *
@@ -41,6 +56,30 @@ static dma_state_t dma_ch_states[DMA_NUM_CH];
  */
 static int size2code(uint8_t bytes);
 
+/**
+ * @brief Desarma el canal y programa NVIC, callbacks y DMAMUX desde cfg.
+ *
+ * @param cfg Configuración del canal.
+ * @param irq True para habilitar la interrupción del canal.
+ */
+static void channel_setup(const dma_cfg_t *cfg, bool irq);
+
+/**
+ * @brief Copia un descriptor en RAM al TCD del canal.
+ *
+ * @param ch Canal DMA.
+ * @param tcd Descriptor a copiar.
+ */
+static void tcd_write(uint8_t ch, const dma_tcd_t *tcd);
+
+/**
+ * @brief Cuenta de un CITER/BITER crudo, con o sin link de canal.
+ *
+ * @param iter Valor del registro.
+ * @return Iteraciones.
+ */
+static uint16_t iter_count(uint16_t iter);
+
 /**
  * @brief Manejador genérico de interrupción DMA para un canal.
  *
@@ -87,66 +126,183 @@ int DMA_Config(const dma_cfg_t *cfg)
     {
         return -1;
     }
-    // Disarm and clear pending IRQs before configuring
-    DMA0->CERQ = DMA_CERQ_CERQ(cfg->ch);
-	NVIC_ClearPendingIRQ(DMA0_IRQn + ch);
-	if (cfg->int_major) 
-    {
-        NVIC_EnableIRQ(DMA0_IRQn + ch);
-    }
-    else
+    dma_tcd_t tcd;
+    int err = DMA_TcdSet(&tcd, cfg);
+    if (err)
     {
-        NVIC_DisableIRQ(DMA0_IRQn + ch);
+        return err;
     }
 
-    // Remember config
-    dma_ch_states[ch].on_major_cb = cfg->on_major;
-    dma_ch_states[ch].user_param = cfg->user;
+    channel_setup(cfg, cfg->int_major || cfg->int_half);
+    tcd_write(ch, &tcd);
 
-    // Enable the eDMA channel and set the DMA request source
-    DMAMUX->CHCFG[ch] = 0;
-	DMAMUX->CHCFG[ch] |= DMAMUX_CHCFG_ENBL_MASK 
-                        |DMAMUX_CHCFG_SOURCE((uint8_t)cfg->request_src);
-    if (cfg->trig_mode) // If trigger mode enabled
+    return 0;
+}
+
+/**
+ * @brief Configura un canal para correr una cadena de descriptores.
+ *
+ * @param cfg Configuración del canal (DMAMUX y callbacks).
+ * @param first Primer descriptor de la cadena.
+ * @return 0 si éxito, <0 si error.
+ */
+int DMA_ConfigChain(const dma_cfg_t *cfg, const dma_tcd_t *first)
+{
+    int ch = cfg->ch;
+    if (ch >= DMA_NUM_CH || first == NULL)
     {
-        DMAMUX->CHCFG[ch] |= DMAMUX_CHCFG_TRIG_MASK;
+        return -1;
     }
 
-    // -------------- TCD setup ----------------------
-    DMA0->TCD[ch].SADDR= (uint32_t)(cfg->saddr);
-	DMA0->TCD[ch].DADDR = (uint32_t)(cfg->daddr);
-
-    /* Set an offset for source and destination address. */
-	DMA0->TCD[ch].SOFF =cfg->soff;
-	DMA0->TCD[ch].DOFF =cfg->doff;
+    channel_setup(cfg, cfg->on_major || cfg->on_half);
+    tcd_write(ch, first);
 
-	/* Set source and destination data transfer size in byte. */
-	DMA0->TCD[ch].ATTR = DMA_ATTR_SSIZE(size2code(cfg->nbytes)) 
-                        |DMA_ATTR_DSIZE(size2code(cfg->nbytes));
+    return 0;
+}
 
-	/*Number of bytes to be transfered in each service request of the channel.*/
-	DMA0->TCD[ch].NBYTES_MLNO= cfg->nbytes;
+/**
+ * @brief Rearma un canal copiando un descriptor a su TCD.
+ *
+ * @param ch Canal DMA.
+ * @param tcd Descriptor a cargar.
+ * @return 0 si éxito, <0 si error.
+ */
+int DMA_TcdLoad(uint8_t ch, const dma_tcd_t *tcd)
+{
+    if (ch >= DMA_NUM_CH || tcd == NULL)
+    {
+        return -1;
+    }
+    tcd_write(ch, tcd);
+    return 0;
+}
 
-	/* Current major iteration count. */
-	DMA0->TCD[ch].CITER_ELINKNO = DMA_CITER_ELINKNO_CITER(cfg->major_count);
-	DMA0->TCD[ch].BITER_ELINKNO = DMA_BITER_ELINKNO_BITER(cfg->major_count);
+/**
+ * @brief Codifica una configuración en un descriptor en RAM.
+ *
+ * @param tcd Descriptor destino.
+ * @param cfg Configuración de la transferencia.
+ * @return 0 si éxito, <0 si error.
+ */
+int DMA_TcdSet(dma_tcd_t *tcd, const dma_cfg_t *cfg)
+{
+    int size = size2code(cfg->nbytes);
+    if (size < 0)
+    {
+        return -2;
+    }
+    // With ELINK set, CITER/BITER lose their top 6 bits to LINKCH
+    uint16_t max_count = cfg->link_minor ? DMA_CITER_ELINKYES_CITER_MASK
+                                         : DMA_CITER_ELINKNO_CITER_MASK;
+    if (cfg->major_count == 0 || cfg->major_count > max_count)
+    {
+        return -2;
+    }
+    if ((cfg->link_minor && cfg->link_minor_ch >= DMA_NUM_CH) ||
+        (cfg->link_major && cfg->link_major_ch >= DMA_NUM_CH))
+    {
+        return -1;
+    }
 
-	/* Address for the next TCD to be loaded in the scatter/gather mode. */
-	//	tcd[TCD0].SLAST = 0;			// Source address adjustment not used.
-	//	tcd[TCD0].DLASTSGA = (uint32_t)&tcd[TCD1];	// The tcd[TCD1] is the next TCD to be loaded.
+    tcd->saddr = (uint32_t)(cfg->saddr);
+    tcd->daddr = (uint32_t)(cfg->daddr);
+    tcd->soff = cfg->soff;
+    tcd->doff = cfg->doff;
+    tcd->attr = DMA_ATTR_SSIZE(size) | DMA_ATTR_DSIZE(size);
+    tcd->nbytes = cfg->nbytes;
+    tcd->slast = cfg->slast;
+    tcd->dlast_sga = cfg->dlast;
 
-	DMA0->TCD[ch].SLAST = cfg->slast;
-	DMA0->TCD[ch].DLAST_SGA = cfg->dlast;
+    if (cfg->link_minor)
+    {
+        // The last minor loop fires the major link instead (if any)
+        tcd->citer = DMA_CITER_ELINKYES_ELINK_MASK
+                    |DMA_CITER_ELINKYES_LINKCH(cfg->link_minor_ch)
+                    |DMA_CITER_ELINKYES_CITER(cfg->major_count);
+        tcd->biter = DMA_BITER_ELINKYES_ELINK_MASK
+                    |DMA_BITER_ELINKYES_LINKCH(cfg->link_minor_ch)
+                    |DMA_BITER_ELINKYES_BITER(cfg->major_count);
+    }
+    else
+    {
+        tcd->citer = DMA_CITER_ELINKNO_CITER(cfg->major_count);
+        tcd->biter = DMA_BITER_ELINKNO_BITER(cfg->major_count);
+    }
 
-	/* Setup control and status register. */
+    uint16_t csr = 0;
     if (cfg->int_major)
     {
-	    DMA0->TCD[ch].CSR = DMA_CSR_INTMAJOR_MASK;	//Enable Major Interrupt.
+        csr |= DMA_CSR_INTMAJOR_MASK;   //Enable Major Interrupt.
+    }
+    if (cfg->int_half)
+    {
+        csr |= DMA_CSR_INTHALF_MASK;    //Enable Half Interrupt (CITER == BITER / 2).
     }
+    if (cfg->link_major)
+    {
+        csr |= DMA_CSR_MAJORELINK_MASK | DMA_CSR_MAJORLINKCH(cfg->link_major_ch);
+    }
+    tcd->csr = csr;
 
     return 0;
 }
 
+/**
+ * @brief Encadena dos descriptores (scatter-gather).
+ *
+ * @param tcd Descriptor a modificar.
+ * @param next Próximo descriptor o NULL para cerrar la cadena.
+ * @return 0 si éxito, <0 si error.
+ */
+int DMA_TcdLink(dma_tcd_t *tcd, const dma_tcd_t *next)
+{
+    if (next == NULL)
+    {
+        tcd->dlast_sga = 0;
+        tcd->csr = (tcd->csr & ~DMA_CSR_ESG_MASK) | DMA_CSR_DREQ_MASK;
+        return 0;
+    }
+    if ((uint32_t)next & 31u)
+    {
+        return -2;
+    }
+    tcd->dlast_sga = (int32_t)(uint32_t)next;
+    tcd->csr = (tcd->csr & ~DMA_CSR_DREQ_MASK) | DMA_CSR_ESG_MASK;
+    return 0;
+}
+
+/**
+ * @brief Toma un descriptor libre del pool.
+ *
+ * @return Descriptor en cero o NULL si no quedan.
+ */
+dma_tcd_t *DMA_TcdAlloc(void)
+{
+    for (uint32_t i = 0; i < DMA_TCD_POOL_SIZE; i++)
+    {
+        if (!(tcd_pool_used & (1u << i)))
+        {
+            tcd_pool_used |= 1u << i;
+            memset(&tcd_pool[i], 0, sizeof(tcd_pool[i]));
+            return &tcd_pool[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Devuelve un descriptor al pool.
+ *
+ * @param tcd Descriptor a liberar.
+ */
+void DMA_TcdFree(dma_tcd_t *tcd)
+{
+    if (tcd >= &tcd_pool[0] && tcd < &tcd_pool[DMA_TCD_POOL_SIZE])
+    {
+        tcd_pool_used &= ~(1u << (uint32_t)(tcd - tcd_pool));
+    }
+}
+
 /**
  * @brief Inicia un canal DMA.
  *
@@ -184,6 +340,19 @@ int DMA_Stop(uint8_t ch)
     return 0;
 }
 
+/**
+ * @brief Elementos que le faltan al loop mayor en curso.
+ *
+ * @param ch Canal DMA.
+ * @return CITER, 0 si el canal es inválido.
+ */
+uint16_t DMA_GetCount(uint8_t ch)
+{
+    if (ch >= DMA_NUM_CH) return 0;
+
+    return iter_count(DMA0->TCD[ch].CITER_ELINKNO);
+}
+
 static int size2code(uint8_t bytes) 
 {
     switch (bytes) 
@@ -195,15 +364,112 @@ static int size2code(uint8_t bytes)
     return -1;
 }
 
+static void channel_setup(const dma_cfg_t *cfg, bool irq)
+{
+    int ch = cfg->ch;
+
+    // Disarm and clear pending IRQs before configuring
+    DMA0->CERQ = DMA_CERQ_CERQ(ch);
+    NVIC_ClearPendingIRQ(DMA0_IRQn + ch);
+    if (irq)
+    {
+        NVIC_EnableIRQ(DMA0_IRQn + ch);
+    }
+    else
+    {
+        NVIC_DisableIRQ(DMA0_IRQn + ch);
+    }
+
+    // Remember config
+    dma_ch_states[ch].on_major_cb = cfg->on_major;
+    dma_ch_states[ch].on_half_cb = cfg->on_half;
+    dma_ch_states[ch].user_param = cfg->user;
+
+    // Enable the eDMA channel and set the DMA request source
+    DMAMUX->CHCFG[ch] = 0;
+    DMAMUX->CHCFG[ch] |= DMAMUX_CHCFG_ENBL_MASK
+                        |DMAMUX_CHCFG_SOURCE((uint8_t)cfg->request_src);
+    if (cfg->trig_mode) // If trigger mode enabled
+    {
+        DMAMUX->CHCFG[ch] |= DMAMUX_CHCFG_TRIG_MASK;
+    }
+}
+
+static uint16_t iter_count(uint16_t iter)
+{
+    if (iter & DMA_CITER_ELINKYES_ELINK_MASK)
+    {
+        return iter & DMA_CITER_ELINKYES_CITER_MASK;
+    }
+    return iter & DMA_CITER_ELINKNO_CITER_MASK;
+}
+
+static void tcd_write(uint8_t ch, const dma_tcd_t *tcd)
+{
+    // CSR first: DONE has to be clear before ESG/MAJORELINK can be written
+    DMA0->TCD[ch].CSR = 0;
+    DMA0->CDNE = DMA_CDNE_CDNE(ch);
+
+    DMA0->TCD[ch].SADDR = tcd->saddr;
+    DMA0->TCD[ch].SOFF = tcd->soff;
+    DMA0->TCD[ch].ATTR = tcd->attr;
+    DMA0->TCD[ch].NBYTES_MLNO = tcd->nbytes;
+    DMA0->TCD[ch].SLAST = tcd->slast;
+    DMA0->TCD[ch].DADDR = tcd->daddr;
+    DMA0->TCD[ch].DOFF = tcd->doff;
+    DMA0->TCD[ch].CITER_ELINKNO = tcd->citer;   // raw, may carry ELINKYES fields
+    DMA0->TCD[ch].DLAST_SGA = tcd->dlast_sga;
+    DMA0->TCD[ch].BITER_ELINKNO = tcd->biter;
+    DMA0->TCD[ch].CSR = tcd->csr;
+    dma_ch_states[ch].csr = tcd->csr;
+    dma_ch_states[ch].half_done = false;
+}
+
 static void DMA_IRQHandler(uint8_t ch)
 {
+    dma_state_t *st = &dma_ch_states[ch];
+
     gpioWrite(PIN_TP3, HIGH);
 	/* Clear the interrupt flag. */
-	DMA0->CINT |= DMA_CINT_CINT(ch);
-	if(dma_ch_states[ch].on_major_cb)
+	DMA0->CINT = DMA_CINT_CINT(ch);
+
+    /* Half and major share the INT flag, so a late entry can find both pending.
+       DONE, or a loop still in its first half (the next request already cleared
+       DONE), means the last major loop ended: its half runs first if it was not
+       serviced. Otherwise it is the INTHALF of the loop in progress. A latency
+       over half a loop is an overrun and is not detected here.
+       The callbacks follow the INTHALF/INTMAJOR flags of the descriptor that
+       ran the loop. With scatter-gather the next one is already loaded when a
+       major ends (and DONE stays clear), so those come from st->csr. */
+    uint16_t csr = DMA0->TCD[ch].CSR;
+    uint16_t citer = iter_count(DMA0->TCD[ch].CITER_ELINKNO);
+    uint16_t biter = iter_count(DMA0->TCD[ch].BITER_ELINKNO);
+    if ((csr & DMA_CSR_DONE_MASK) || citer > biter / 2)
+    {
+        uint16_t done_csr = (!(csr & DMA_CSR_DONE_MASK) && (st->csr & DMA_CSR_ESG_MASK))
+                            ? st->csr : csr;
+        bool half = (done_csr & DMA_CSR_INTHALF_MASK) && !st->half_done;
+        if (half && st->on_half_cb)
+        {
+            st->on_half_cb(st->user_param);
+        }
+        st->half_done = false;
+        DMA0->CDNE = DMA_CDNE_CDNE(ch);
+        // a late half of a descriptor without INTMAJOR is all there was
+        if ((!half || (done_csr & DMA_CSR_INTMAJOR_MASK)) && st->on_major_cb)
+        {
+            st->on_major_cb(st->user_param);
+        }
+    }
+    else if (!st->half_done)
     {
-		dma_ch_states[ch].on_major_cb(dma_ch_states[ch].user_param);
-	}
+        st->half_done = true;
+        if ((csr & DMA_CSR_INTHALF_MASK) && st->on_half_cb)
+        {
+            st->on_half_cb(st->user_param);
+        }
+    }
+    st->csr = csr;
     gpioWrite(PIN_TP3, LOW);
 }
 
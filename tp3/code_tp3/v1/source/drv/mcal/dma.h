@@ -23,6 +23,16 @@
 
 #define DMA_NUM_CH 16
 
+// ---- Perillas de tiempo de compilación ----
+
+/**
+ * @def DMA_TCD_POOL_SIZE
+ * @brief Descriptores en RAM disponibles para cadenas scatter-gather (máx. 32).
+ */
+#ifndef DMA_TCD_POOL_SIZE
+#define DMA_TCD_POOL_SIZE 8u
+#endif
+
 /*******************************************************************************
  * PUBLIC TYPES
  ******************************************************************************/
@@ -128,9 +138,39 @@ typedef struct
     int32_t dlast;          /**< Ajuste de puntero al final mayor (destino). */
     bool int_major;         /**< True para interrupción al final mayor. */
     dma_cb_t on_major;      /**< Callback al final mayor (puede ser NULL). */
+    bool int_half;          /**< True para interrupción a mitad del loop mayor (ping-pong). */
+    dma_cb_t on_half;       /**< Callback a mitad del loop mayor (puede ser NULL). */
     void *user;             /**< Cookie de usuario para callbacks. */
+    bool link_minor;        /**< True para pedir link_minor_ch tras cada loop menor (major_count <= 511). */
+    uint8_t link_minor_ch;  /**< Canal enlazado por loop menor. */
+    bool link_major;        /**< True para pedir link_major_ch al final del loop mayor. */
+    uint8_t link_major_ch;  /**< Canal enlazado por loop mayor. */
 } dma_cfg_t;
 
+/**
+ * @brief Descriptor de transferencia (TCD) en RAM, con el mismo layout que el del eDMA.
+ *
+ * El eDMA lo copia entero al canal cuando termina el loop mayor del descriptor
+ * anterior (scatter-gather, CSR.ESG), por eso tiene que estar alineado a 32 bytes
+ * y no se toca mientras la cadena corre. Se arma con DMA_TcdSet() y DMA_TcdLink().
+ */
+typedef struct __attribute__((aligned(32)))
+{
+    uint32_t saddr;         /**< SADDR. */
+    int16_t soff;           /**< SOFF. */
+    uint16_t attr;          /**< ATTR (SSIZE/DSIZE). */
+    uint32_t nbytes;        /**< NBYTES_MLNO. */
+    int32_t slast;          /**< SLAST. */
+    uint32_t daddr;         /**< DADDR. */
+    int16_t doff;           /**< DOFF. */
+    uint16_t citer;         /**< CITER, con ELINK/LINKCH si hay enlace menor. */
+    int32_t dlast_sga;      /**< DLAST, o dirección del próximo descriptor si ESG. */
+    uint16_t csr;           /**< CSR (INTMAJOR/INTHALF/DREQ/ESG/MAJORELINK). */
+    uint16_t biter;         /**< BITER, igual a citer. */
+} dma_tcd_t;
+
+_Static_assert(sizeof(dma_tcd_t) == 32u, "dma_tcd_t must match the hardware TCD");
+
 /*******************************************************************************
  * PUBLIC API
  ******************************************************************************/
@@ -174,4 +214,83 @@ int DMA_Start(uint8_t ch);
  */
 int DMA_Stop(uint8_t ch);
 
+/**
+ * @brief Elementos que le faltan al loop mayor en curso (CITER).
+ *
+ * Con un destino circular sirve para saber hasta dónde escribió el DMA:
+ * el índice es major_count - DMA_GetCount(ch), que vuelve a 0 al dar la vuelta.
+ *
+ * @param ch Índice de canal DMA [0..15].
+ * @return CITER del canal, 0 si el canal es inválido.
+ */
+uint16_t DMA_GetCount(uint8_t ch);
+
+/**
+ * @brief Toma un descriptor libre del pool estático.
+ *
+ * Pensado para la inicialización: no es reentrante, no llamar desde ISRs.
+ *
+ * @return Descriptor en cero, o NULL si el pool (DMA_TCD_POOL_SIZE) está agotado.
+ */
+dma_tcd_t *DMA_TcdAlloc(void);
+
+/**
+ * @brief Devuelve un descriptor al pool. Ignora NULL y punteros ajenos al pool.
+ *
+ * @param tcd Descriptor obtenido con DMA_TcdAlloc(); no debe estar en una cadena activa.
+ */
+void DMA_TcdFree(dma_tcd_t *tcd);
+
+/**
+ * @brief Codifica la parte de transferencia de cfg en un descriptor en RAM.
+ *
+ * Usa saddr/daddr/nbytes/soff/doff/major_count/slast/dlast, las interrupciones
+ * y los enlaces de canal; ch, request_src, trig_mode y los callbacks se ignoran.
+ * El descriptor queda sin enlazar (fin de cadena).
+ *
+ * @param tcd Descriptor destino.
+ * @param cfg Configuración de la transferencia.
+ * @return 0 si éxito, -1 si un canal enlazado es inválido, -2 si nbytes o major_count no sirven.
+ */
+int DMA_TcdSet(dma_tcd_t *tcd, const dma_cfg_t *cfg);
+
+/**
+ * @brief Encadena tcd con next: al terminar el loop mayor de tcd el eDMA carga next.
+ *
+ * Pisa el DLAST de tcd con la dirección de next. Con next = NULL tcd pasa a ser
+ * el último: vuelve DLAST a 0 y pone DREQ para que el canal se desarme solo.
+ * Para una cadena circular, enlazar el último con el primero.
+ *
+ * @param tcd Descriptor a modificar.
+ * @param next Próximo descriptor (alineado a 32 bytes) o NULL.
+ * @return 0 si éxito, -2 si next no está alineado.
+ */
+int DMA_TcdLink(dma_tcd_t *tcd, const dma_tcd_t *next);
+
+/**
+ * @brief Configura un canal para correr una cadena de descriptores.
+ *
+ * De cfg se usan ch, request_src, trig_mode, on_major, on_half y user; la
+ * transferencia sale de first, que se copia al canal. En un canal con cadena
+ * on_major se llama al final de cada descriptor que tenga int_major.
+ *
+ * @param cfg Configuración del canal (DMAMUX y callbacks).
+ * @param first Primer descriptor de la cadena.
+ * @return 0 si éxito, -1 si el canal es inválido.
+ */
+int DMA_ConfigChain(const dma_cfg_t *cfg, const dma_tcd_t *first);
+
+/**
+ * @brief Rearma un canal ya configurado copiando un descriptor a su TCD.
+ *
+ * No toca DMAMUX, NVIC ni callbacks: sirve para relanzar una transferencia
+ * armada de antemano sin pasar de nuevo por DMA_Config(). El canal tiene que
+ * estar detenido o con su loop mayor terminado.
+ *
+ * @param ch Índice de canal DMA [0..15].
+ * @param tcd Descriptor a cargar.
+ * @return 0 si éxito, -1 si el canal es inválido.
+ */
+int DMA_TcdLoad(uint8_t ch, const dma_tcd_t *tcd);
+
 #endif
\ No newline at end of file
@@ -34,6 +34,12 @@
  */
 #define PIT_TICKS_FROM_MS(ms) ((uint32_t)((((SYS_BUS_CLK/1000UL)*(ms)) - 1)))
 
+/**
+ * @def PIT_TICKS_FROM_HZ(hz)
+ * @brief Convierte una frecuencia de disparo en Hz a ticks del PIT (redondeado).
+ */
+#define PIT_TICKS_FROM_HZ(hz) ((uint32_t)(((SYS_BUS_CLK + (hz)/2) / (hz)) - 1))
+
 /**
  * @def PIT_CHANNELS
  * @brief Número de canales disponibles en el PIT (4).
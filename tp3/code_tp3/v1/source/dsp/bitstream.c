@@ -3,81 +3,90 @@
  * @brief Archivo de implementación para el manejo de bitstreams en comunicación UART.
  *
  * Este archivo contiene las implementaciones de las funciones declaradas en bitstream.h,
- * incluyendo formateo de datos a frames UART, cálculo de paridad y conversiones entre
- * bytes y arreglos de bits.
+ * incluyendo formateo de datos a frames UART empaquetados y cálculo de paridad por tabla.
  */
 
 #include "bitstream.h"
 
-// Formatea un byte de datos en un bitstream con start, parity y stop bits.
+#if BITSTREAM_PARITY_BITS
+// Paridad (cantidad de unos & 1) de cada byte, armada en tiempo de compilación.
+#define P2(n) n, n ^ 1, n ^ 1, n
+#define P4(n) P2(n), P2(n ^ 1), P2(n ^ 1), P2(n)
+#define P6(n) P4(n), P4(n ^ 1), P4(n ^ 1), P4(n)
+
+/**
+ * @var parity_lut
+ * @brief 1 si el byte tiene una cantidad impar de unos.
+ */
+static const uint8_t parity_lut[256] = { P6(0), P6(1), P6(1), P6(0) };
+#endif
+
 /**
- * @brief Formatea un byte de datos en un frame UART de 11 bits.
+ * @brief Formatea un dato en un frame UART empaquetado.
  *
- * @param data El byte de datos a formatear.
+ * @param data El dato a formatear.
  * @return El frame UART como uint16_t.
  */
-uint16_t data_to_uart(uint8_t data){
-    // use existing parity_bit(data) function (returns bool)
-    bool p = parity_bit(data);
-    // pack: bit0 = start(0), bits1..8 = data (LSB-first), bit9 = parity, bit10 = stop(1)
-    uint16_t frame = ((uint16_t)1 << 10)         // stop bit at bit10
-                   | ((uint16_t)p << 9)          // parity at bit9
-                   | ((uint16_t)data << 1);      // data in bits1..8
+uint16_t data_to_uart(uint16_t data){
+    data &= BITSTREAM_DATA_MASK;
+    // pack: bit0 = start(0), then data (LSB-first), parity, stop(1)
+    uint16_t frame = (uint16_t)(1u << BITSTREAM_STOP_POS)   // stop bit
+                   | (uint16_t)(data << 1);                 // data from bit1
                    // Start en cero implicito
+#if BITSTREAM_PARITY_BITS
+    frame |= (uint16_t)((unsigned)parity_bit(data) << BITSTREAM_PARITY_POS);
+#endif
     return frame;
 }
 
 /**
- * @brief Calcula el bit de paridad par para un byte de datos entrante.
+ * @brief Convierte un frame UART de vuelta a un dato.
  *
- * @param data El byte de datos para calcular la paridad.
- * @return true si la cantidad de 1s es par (paridad = 1), false si es impar (paridad = 0).
+ * @param frame El frame UART como uint16_t.
+ * @return El dato extraído.
  */
-bool parity_bit(const uint8_t data){
-    int counter = 0;
-    // Procesar el byte de datos entrante
-    for (int i = 0; i < 8; i++) {
-        bool bit = (data >> (7 - i)) & 0x01;
-        if (bit){
-            counter ++;
-        }
-    }
-    if (counter % 2 == 0){
-        return true; //Hay una cantidad par de unos. P = 1.
-    } else {
-        return false; //Hay una cantidad impar de unos. P = 0.
-    }
+uint16_t uart_to_data(uint16_t frame){
+    return (frame >> 1) & BITSTREAM_DATA_MASK; // data from bit1
 }
 
-//--------------FUNCION DE ENTRADA A NCO-----------------
-//-------------------------------------------------------
-// Funcion para modificar a formato bool[11]. 
-// Modifica el arreglo original introducido en la funcion.
 /**
- * @brief Formatea un bitstream en un arreglo de 11 bits booleanos.
+ * @brief Verifica el bit de paridad de un frame UART.
  *
- * @param data El byte de datos a formatear.
- * @param out Arreglo de 11 booleanos donde se almacenará el bitstream.
+ * @param frame El frame UART como uint16_t.
+ * @return true si la paridad es correcta o el formato no tiene paridad.
  */
-void format_bitstream(uint8_t data, bool out[11]){
-    uint16_t frame = data_to_uart(data);
-    for (int i = 0; i < 11; ++i){
-        out[i] = (frame >> i) & 1;
-    }
+bool uart_parity_ok(uint16_t frame){
+#if BITSTREAM_PARITY_BITS
+    return (bool)((frame >> BITSTREAM_PARITY_POS) & 1u) == parity_bit(uart_to_data(frame));
+#else
+    (void)frame;
+    return true;
+#endif
 }
 
 /**
- * @brief Deformatea un arreglo de 11 bits booleanos en un byte de datos.
+ * @brief Verifica el bit de stop de un frame UART.
  *
- * @param in Arreglo de 11 booleanos que representa el bitstream.
- * @return El byte de datos extraído como char.
+ * @param frame El frame UART como uint16_t.
+ * @return true si el bit de stop está en 1.
  */
-char deformat_bitstream(bool in[11]){
-    uint8_t frame = 0;
-    for (int i = 1; i < 9; ++i){
-        if (in[i]){
-            frame |= (1 << (i-1));
-        }
-    }
-    return frame;
-}
\ No newline at end of file
+bool uart_framing_ok(uint16_t frame){
+    return (frame >> BITSTREAM_STOP_POS) & 1u;
+}
+
+/**
+ * @brief Calcula el bit de paridad de un dato según BITSTREAM_FORMAT.
+ *
+ * @param data El dato para calcular la paridad.
+ * @return El bit de paridad a transmitir.
+ */
+bool parity_bit(uint16_t data){
+#if BITSTREAM_PARITY_BITS
+    data &= BITSTREAM_DATA_MASK;
+    uint8_t ones = parity_lut[data & 0xFFu] ^ parity_lut[data >> 8];
+    return (ones ^ BITSTREAM_PARITY_ODD) != 0u;
+#else
+    (void)data;
+    return false;
+#endif
+}
@@ -3,8 +3,11 @@
  * @brief Archivo de cabecera para el manejo de bitstreams en comunicación UART.
  *
  * Este archivo define funciones para formatear y deformatear datos en frames UART,
- * incluyendo bits de start, paridad y stop. Soporta cálculos de paridad par y conversiones
- * entre bytes de datos y arreglos de bits booleanos.
+ * incluyendo bits de start, paridad y stop. Los frames viajan siempre empaquetados
+ * en un uint16_t que se transmite LSB-first: bit 0 = start, luego los datos
+ * (LSB-first), la paridad si el formato la tiene y el stop en el bit
+ * BITSTREAM_SIZE - 1. El formato se elige en tiempo de compilación con
+ * BITSTREAM_FORMAT.
  */
 
 #ifndef BITSTREAM
@@ -13,61 +16,124 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// ---- Formatos de frame ----
+#define BITSTREAM_8N1 0 /**< 8 datos, sin paridad. */
+#define BITSTREAM_8E1 1 /**< 8 datos, paridad par. */
+#define BITSTREAM_8O1 2 /**< 8 datos, paridad impar. */
+#define BITSTREAM_7E1 3 /**< 7 datos, paridad par. */
+#define BITSTREAM_9N1 4 /**< 9 datos, sin paridad (el bit 8 suele marcar dirección). */
+
+// ---- Perillas de tiempo de compilación ----
+
+/**
+ * @def BITSTREAM_FORMAT
+ * @brief Formato de frame del módem, uno de BITSTREAM_8N1 ... BITSTREAM_9N1.
+ *
+ * Por defecto 8O1, el frame de 11 bits original.
+ */
+#ifndef BITSTREAM_FORMAT
+#define BITSTREAM_FORMAT BITSTREAM_8O1
+#endif
+
+#if BITSTREAM_FORMAT == BITSTREAM_8N1
+#define BITSTREAM_DATA_BITS 8u
+#define BITSTREAM_PARITY_BITS 0u
+#define BITSTREAM_PARITY_ODD 0u
+#elif BITSTREAM_FORMAT == BITSTREAM_8E1
+#define BITSTREAM_DATA_BITS 8u
+#define BITSTREAM_PARITY_BITS 1u
+#define BITSTREAM_PARITY_ODD 0u
+#elif BITSTREAM_FORMAT == BITSTREAM_8O1
+#define BITSTREAM_DATA_BITS 8u
+#define BITSTREAM_PARITY_BITS 1u
+#define BITSTREAM_PARITY_ODD 1u
+#elif BITSTREAM_FORMAT == BITSTREAM_7E1
+#define BITSTREAM_DATA_BITS 7u
+#define BITSTREAM_PARITY_BITS 1u
+#define BITSTREAM_PARITY_ODD 0u
+#elif BITSTREAM_FORMAT == BITSTREAM_9N1
+#define BITSTREAM_DATA_BITS 9u
+#define BITSTREAM_PARITY_BITS 0u
+#define BITSTREAM_PARITY_ODD 0u
+#else
+#error "Unknown BITSTREAM_FORMAT"
+#endif
+
 /**
  * @def BITSTREAM_SIZE
- * @brief Tamaño del bitstream en bits (1 start + 8 data + 1 parity + 1 stop).
+ * @brief Tamaño del bitstream en bits (1 start + datos + paridad + 1 stop).
+ */
+#define BITSTREAM_SIZE (1u + BITSTREAM_DATA_BITS + BITSTREAM_PARITY_BITS + 1u)
+
+/**
+ * @def BITSTREAM_DATA_MASK
+ * @brief Máscara de los bits de datos una vez quitado el start.
  */
-#define BITSTREAM_SIZE 11u // 1 start + 8 data + 1 parity + 1 stop
+#define BITSTREAM_DATA_MASK ((1u << BITSTREAM_DATA_BITS) - 1u)
 
 /**
- * @brief Formatea un byte de datos en un frame UART de 11 bits.
+ * @def BITSTREAM_PARITY_POS
+ * @brief Posición del bit de paridad en el frame (si el formato la tiene).
+ */
+#define BITSTREAM_PARITY_POS (1u + BITSTREAM_DATA_BITS)
+
+/**
+ * @def BITSTREAM_STOP_POS
+ * @brief Posición del bit de stop en el frame.
+ */
+#define BITSTREAM_STOP_POS (BITSTREAM_SIZE - 1u)
+
+/**
+ * @def BITSTREAM_IDLE
+ * @brief Frame todo en MARK: lo que se transmite en idle.
+ */
+#define BITSTREAM_IDLE ((uint16_t)((1u << BITSTREAM_SIZE) - 1u))
+
+/**
+ * @brief Formatea un dato en un frame UART de BITSTREAM_SIZE bits.
  *
- * Agrega bit de start (0), los 8 bits de datos (LSB-first), bit de paridad y bit de stop (1).
+ * Agrega bit de start (0), los bits de datos (LSB-first), bit de paridad y bit de stop (1).
  *
- * @param data El byte de datos a formatear.
- * @return El frame UART como uint16_t (solo los 11 bits inferiores son relevantes).
+ * @param data El dato a formatear (se usan BITSTREAM_DATA_BITS bits).
+ * @return El frame UART como uint16_t (solo los BITSTREAM_SIZE bits inferiores son relevantes).
  */
-uint16_t data_to_uart(uint8_t data);
+uint16_t data_to_uart(uint16_t data);
 
 /**
- * @brief Convierte un frame UART de 11 bits de vuelta a un byte de datos.
+ * @brief Convierte un frame UART de vuelta a un dato.
  *
- * Extrae los 8 bits de datos del frame, ignorando start, paridad y stop.
+ * Extrae los bits de datos del frame, ignorando start, paridad y stop.
  *
  * @param frame El frame UART como uint16_t.
- * @return El byte de datos extraído.
+ * @return El dato extraído.
  */
-uint8_t uart_to_data(uint16_t frame);
+uint16_t uart_to_data(uint16_t frame);
 
 /**
- * @brief Calcula el bit de paridad par para un byte de datos.
- *
- * Cuenta la cantidad de bits en 1; si es par, retorna true (1), sino false (0).
+ * @brief Verifica el bit de paridad de un frame UART.
  *
- * @param data El byte de datos para calcular la paridad.
- * @return true si la paridad es par (bit de paridad = 1), false en caso contrario.
+ * @param frame El frame UART como uint16_t.
+ * @return true si la paridad coincide con parity_bit() de los datos, o si el
+ *         formato no tiene paridad.
  */
-bool parity_bit(const uint8_t data);
+bool uart_parity_ok(uint16_t frame);
 
 /**
- * @brief Formatea un byte de datos en un arreglo de 11 bits booleanos.
+ * @brief Verifica el bit de stop de un frame UART.
  *
- * Utiliza data_to_uart para generar el frame y lo descompone en un arreglo bool[11].
- * Modifica el arreglo out proporcionado.
- *
- * @param data El byte de datos a formatear.
- * @param out Arreglo de 11 booleanos donde se almacenará el bitstream.
+ * @param frame El frame UART como uint16_t.
+ * @return true si el bit de stop está en 1.
  */
-void format_bitstream(uint8_t data, bool out[11]);
+bool uart_framing_ok(uint16_t frame);
 
 /**
- * @brief Deformatea un arreglo de 11 bits booleanos en un byte de datos.
+ * @brief Calcula el bit de paridad de un dato según BITSTREAM_FORMAT.
  *
- * Extrae los 8 bits de datos (posiciones 1 a 8) y los convierte en un char (uint8_t).
+ * Por tabla: la paridad de cada byte está precalculada.
  *
- * @param in Arreglo de 11 booleanos que representa el bitstream.
- * @return El byte de datos extraído como char.
+ * @param data El dato para calcular la paridad.
+ * @return El bit de paridad a transmitir (false si el formato no tiene paridad).
  */
-char deformat_bitstream(bool in[11]);
+bool parity_bit(uint16_t data);
 
-#endif // BITSTREAM
\ No newline at end of file
+#endif // BITSTREAM
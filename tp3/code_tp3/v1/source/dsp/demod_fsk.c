@@ -6,14 +6,28 @@
  * Reconstruye bits con oversampling y detección de idle/datos.
  */
 
+#include <string.h>
+
 #include "demod_fsk.h"
 #include "fir_coefs.h"
 
-#define DELAY 5    /* optimal delay is 446us. so DELAY = (int)446us * FS */
-#define SAMPLES_PER_BIT 10    /* FS_DAC / baud */
+#if defined(__ARM_FEATURE_DSP)
+#include "MK64F12.h"    // CMSIS SIMD intrinsics (__QADD16, __SMLAD)
+#endif
+
+#define DELAY DEMOD_FSK_DELAY    /* half a bit, see modem_profile.h */
+#define SAMPLES_PER_BIT MODEM_SAMPLES_PER_BIT    /* FS_ADC / baud */
 #define ADC_MAX_VAL (1 << 12)   /* ADC no. of bits */
-#define UART_LEN 11
+#define UART_LEN BITSTREAM_SIZE
 #define SCALE 2048.0f
+#define M_Q15_SHIFT 8   /* 12b x 12b product down to 15 bits, see blk_q15 */
+#define PROBE_TAP 6     /* outer folded taps skipped by the idle probe */
+#define TIMING_ACC_LIMIT 2  /* edge votes before moving the bit clock */
+
+_Static_assert(DEMOD_FSK_TAPS == N, "DEMOD_FSK_TAPS must match fir_coefs.h");
+_Static_assert(FIR_SAMPLES_PER_BIT == MODEM_SAMPLES_PER_BIT,
+               "fir_coefs.h was designed for another MODEM_SAMPLES_PER_BIT, "
+               "regenerate it with gen_fir_coefs.py");
 
 // i dont want them calculated at runtime
 static const uint8_t HALF_SAMPLES_BIT = SAMPLES_PER_BIT >> 1;
@@ -38,10 +52,10 @@ static bool data_ready;
 static uint8_t samples_per_bit_cnt;
 
 /**
- * @var bits_recovered
- * @brief Arreglo para bits reconstruidos (11 bits para frame UART).
+ * @var frame_recovered
+ * @brief Frame UART reconstruido, empaquetado LSB primero como en data_to_uart().
  */
-static bool bits_recovered[UART_LEN];
+static uint16_t frame_recovered;
 
 /**
  * @var bit_cnt
@@ -49,6 +63,136 @@ static bool bits_recovered[UART_LEN];
  */
 static uint8_t bit_cnt;
 
+/**
+ * @var fsk_x
+ * @brief Señal FSK normalizada del camino por muestra (línea de retardo).
+ */
+static float fsk_x[DELAY + 1];
+
+/**
+ * @var fsk_m
+ * @brief Producto FSK * FSK retardada del camino por muestra (entrada del FIR).
+ */
+static float fsk_m[N];
+
+/**
+ * @var fsk_curr
+ * @brief Índice actual de fsk_x.
+ */
+static uint8_t fsk_curr;
+
+/**
+ * @var fsk_i
+ * @brief Índice actual de fsk_m.
+ */
+static uint8_t fsk_i;
+
+/**
+ * @var bit_democracy
+ * @brief Votos del oversampling del bit actual.
+ */
+static uint8_t bit_democracy[3];
+
+/**
+ * @var bit_democracy_idx
+ * @brief Índice actual de bit_democracy.
+ */
+static uint8_t bit_democracy_idx;
+
+/**
+ * @brief Estado de la máquina de bits del camino por bloques.
+ */
+typedef struct
+{
+    bool idle;                  /**< Esperando bit de start. */
+    int8_t samples_per_bit_cnt; /**< Muestras contadas en el bit actual. */
+    uint8_t votes;              /**< Votos "1" del oversampling del bit. */
+    uint8_t bit_cnt;            /**< Bits recibidos del frame actual. */
+    uint16_t frame;             /**< Frame en construcción (LSB primero). */
+    bool last_bit;              /**< Último bit decidido. */
+    bool last_neg;              /**< Salida < 0 en la última muestra del bit. */
+    bool first_neg;             /**< Salida < 0 en la primera muestra del bit. */
+    int8_t timing_acc;          /**< Integrador del lazo de sincronismo. */
+} demod_bits_t;
+
+/**
+ * @brief Estado privado del camino por bloques en float.
+ *
+ * Las líneas de retardo están espejadas (cada muestra se escribe en pos y
+ * pos + LEN) para que la ventana más reciente sea siempre contigua en memoria
+ * y el FIR quede como un producto escalar sin aritmética modular.
+ */
+typedef struct
+{
+    float x[2 * (DELAY + 1)];   /**< Señal FSK normalizada, espejada. */
+    float m[2 * N];             /**< Producto FSK * FSK retardada, espejado. */
+    uint8_t x_pos;              /**< Posición de la muestra más nueva en x. */
+    uint8_t m_pos;              /**< Posición del producto más nuevo en m. */
+    demod_bits_t bits;          /**< Máquina de bits. */
+} demod_block_t;
+
+/**
+ * @brief Estado privado del camino por bloques en punto fijo.
+ *
+ * Misma organización que demod_block_t. x guarda la muestra sin DC (12 bits
+ * con signo) y m el producto escalado a Q15 con un bit de margen, de modo que
+ * la suma de dos taps simétricos siempre entra en 16 bits.
+ */
+typedef struct
+{
+    int16_t x[2 * (DELAY + 1)]; /**< Señal FSK sin DC, espejada. */
+    int16_t m[2 * N];           /**< Producto >> M_Q15_SHIFT, espejado. */
+    uint8_t x_pos;              /**< Posición de la muestra más nueva en x. */
+    uint8_t m_pos;              /**< Posición del producto más nuevo en m. */
+    int32_t peak_cur;           /**< Máx. |m| desde la última vuelta de m_pos. */
+    int32_t peak_prev;          /**< Máx. |m| de la vuelta anterior. */
+    demod_bits_t bits;          /**< Máquina de bits. */
+} demod_block_q15_t;
+
+/**
+ * @brief Estado del reloj de bit libre de demodFSK_ProcessBlockBits().
+ */
+typedef struct
+{
+    int8_t samples_per_bit_cnt; /**< Muestras contadas en el bit actual. */
+    uint8_t votes;              /**< Votos "1" del oversampling del bit. */
+    bool last_bit;              /**< Último bit decidido. */
+    bool last_neg;              /**< Salida < 0 en la muestra anterior. */
+    int8_t timing_acc;          /**< Integrador del lazo de sincronismo. */
+} demod_slicer_t;
+
+/**
+ * @brief Estado privado del camino de bits sueltos (modo paquete).
+ *
+ * Mismo filtro que demod_block_q15_t, sin la sonda de idle.
+ */
+typedef struct
+{
+    int16_t x[2 * (DELAY + 1)]; /**< Señal FSK sin DC, espejada. */
+    int16_t m[2 * N];           /**< Producto >> M_Q15_SHIFT, espejado. */
+    uint8_t x_pos;              /**< Posición de la muestra más nueva en x. */
+    uint8_t m_pos;              /**< Posición del producto más nuevo en m. */
+    demod_slicer_t slicer;      /**< Reloj de bit. */
+} demod_stream_q15_t;
+
+/**
+ * @var blk
+ * @brief Estado del demodulador por bloques en float.
+ */
+static demod_block_t blk = { .bits.idle = true };
+
+/**
+ * @var blk_q15
+ * @brief Estado del demodulador por bloques en punto fijo.
+ */
+static demod_block_q15_t blk_q15 = { .bits.idle = true };
+
+/**
+ * @var blk_bits
+ * @brief Estado del demodulador de bits sueltos.
+ */
+static demod_stream_q15_t blk_bits;
+
 /**
  * @brief Demodula una muestra ADC en formato FSK.
  *
@@ -57,31 +201,26 @@ static uint8_t bit_cnt;
  */
 float demodFSK(uint16_t adc_value)
 {
-    static float x[DELAY + 1] = {0};  // the FSK signal read form the ADC
-    static float m[N] = {0};          // product of FSK and FSK delayed 
-    static uint8_t curr = 0;          // current index of delay array
-    static uint8_t i = 0;             // fir index
-
     // get value form ADC
-    x[curr] = ((float)adc_value - ADC_DC_VAL) / SCALE; /* substract DC value 
-    and normalize to [-1, +1]*/
+    fsk_x[fsk_curr] = ((float)adc_value - ADC_DC_VAL) / SCALE; /* substract DC
+    value and normalize to [-1, +1]*/
 
     // get the product of the fsk and delayed fsk
-    m[i] = x[curr] * x[(curr + 1) % (DELAY + 1)];
+    fsk_m[fsk_i] = fsk_x[fsk_curr] * fsk_x[(fsk_curr + 1) % (DELAY + 1)];
 
     // calculate FIR
     float d = 0.0f;
-    int r = i;
+    int r = fsk_i;
     for (int k = 0; k < N; k++)
     {
-        d += m[r] * h[k];
+        d += fsk_m[r] * h[k];
         if (--r < 0)
             r = N - 1;
     }
 
     // advance indices ring buffer style
-    curr = (curr + 1) % (DELAY + 1);
-    i = (i + 1) % N;
+    fsk_curr = (fsk_curr + 1) % (DELAY + 1);
+    fsk_i = (fsk_i + 1) % N;
 
     return d * SCALE; // scale back
 }
@@ -93,9 +232,6 @@ float demodFSK(uint16_t adc_value)
  */
 void bitstreamReconstruction(float fir_output)
 {
-    static uint8_t bit_democracy[3]; // oversampled bits
-    static uint8_t j = 0;         // bit_democracy index
-
     if (idle)
     {
         if (fir_output > 0) // bit start detected
@@ -103,6 +239,7 @@ void bitstreamReconstruction(float fir_output)
             idle = false;
             samples_per_bit_cnt = 1;
             bit_cnt = 0;
+            frame_recovered = 0;
         }
     }
     else // recieving data
@@ -112,25 +249,21 @@ void bitstreamReconstruction(float fir_output)
         if ((samples_per_bit_cnt >= (HALF_SAMPLES_BIT) - 1) && 
             (samples_per_bit_cnt <= (HALF_SAMPLES_BIT) + 1)) 
         {
-            bit_democracy[j] = (fir_output < 0);
-            j++;
+            bit_democracy[bit_democracy_idx] = (fir_output < 0);
+            bit_democracy_idx++;
         }
         else if (samples_per_bit_cnt == SAMPLES_PER_BIT)
         {
             // we read all samples per bit: now bit election, majority wins
             if (bit_democracy[0] + bit_democracy[1] + bit_democracy[2] >= 2)
             {
-                bits_recovered[bit_cnt] = 1;
-            }
-            else 
-            {
-                bits_recovered[bit_cnt] = 0;
+                frame_recovered |= (uint16_t)1 << bit_cnt;
             }
             bit_cnt++;
             samples_per_bit_cnt = 0;
-            j = 0;
+            bit_democracy_idx = 0;
         }
-        else; // ignore samples
+        // else: ignore samples
 
         if (bit_cnt == UART_LEN) // full UART frame has been read
         {
@@ -151,12 +284,728 @@ bool isDataReady(void)
 }
 
 /**
- * @brief Recupera el bitstream reconstruido.
+ * @brief Recupera el frame reconstruido.
  *
- * @return Puntero al bitstream.
+ * @return Frame empaquetado (bit 0 = start).
  */
-bool *retrieveBitstream(void)
+uint16_t retrieveBitstream(void)
 {
     data_ready = false;
-    return bits_recovered;
-}
\ No newline at end of file
+    return frame_recovered;
+}
+
+/**
+ * @brief Avanza la máquina de bits del camino por bloques una muestra.
+ *
+ * Misma lógica que bitstreamReconstruction(), pero el bit se arma en el frame
+ * empaquetado y solo se guarda la cantidad de votos.
+ *
+ * Con DEMOD_FSK_TIMING_RECOVERY además se sigue cada transición entre bits:
+ * el cruce por cero debería caer entre la última muestra de un bit y la
+ * primera del siguiente. Si la última ya tiene el signo del bit nuevo el reloj
+ * va tarde, si la primera todavía tiene el del anterior va temprano. El
+ * integrador corrige una muestra cada TIMING_ACC_LIMIT votos en el mismo
+ * sentido. El frame termina en el centro del bit de stop, así la detección
+ * de start queda armada medio bit antes del siguiente frame.
+ *
+ * @param b Estado de bits (una copia local, para que quede en registros).
+ * @param positive Salida del FIR > 0.
+ * @param negative Salida del FIR < 0.
+ * @return true si se completó un frame UART (queda en b->frame).
+ */
+static inline bool bitsStep(demod_bits_t *b, bool positive, bool negative)
+{
+    if (b->idle)
+    {
+        if (positive) // bit start detected
+        {
+            b->idle = false;
+            b->samples_per_bit_cnt = 1;
+            b->bit_cnt = 0;
+            b->votes = 0;
+            b->frame = 0;
+            b->timing_acc = 0;
+        }
+        return false;
+    }
+
+    b->samples_per_bit_cnt++;
+#if DEMOD_FSK_TIMING_RECOVERY
+    if (b->samples_per_bit_cnt == 1)
+    {
+        b->first_neg = negative;
+    }
+#endif
+    if ((b->samples_per_bit_cnt >= HALF_SAMPLES_BIT - 1) &&
+        (b->samples_per_bit_cnt <= HALF_SAMPLES_BIT + 1))
+    {
+        b->votes += negative;
+#if DEMOD_FSK_TIMING_RECOVERY
+        if ((b->bit_cnt == UART_LEN - 1) &&
+            (b->samples_per_bit_cnt == HALF_SAMPLES_BIT + 1))
+        {
+            // stop bit decided at its centre: rearm the start detector now
+            if (b->votes >= 2)
+            {
+                b->frame |= (uint16_t)1 << b->bit_cnt;
+            }
+            b->idle = true;
+            return true;
+        }
+#endif
+    }
+    else if (b->samples_per_bit_cnt == SAMPLES_PER_BIT)
+    {
+        // majority wins
+        bool bit = (b->votes >= 2);
+        if (bit)
+        {
+            b->frame |= (uint16_t)1 << b->bit_cnt;
+        }
+        b->samples_per_bit_cnt = 0;
+        b->votes = 0;
+
+#if DEMOD_FSK_TIMING_RECOVERY
+        // the start edge is the reference, track every edge after it
+        if ((b->bit_cnt > 0) && (bit != b->last_bit))
+        {
+            if (b->last_neg == bit)
+            {
+                b->timing_acc++;    // late: edge before the bit boundary
+            }
+            else if (b->first_neg == b->last_bit)
+            {
+                b->timing_acc--;    // early: edge after the bit boundary
+            }
+        }
+        b->last_bit = bit;
+        b->last_neg = negative;
+
+        if (b->timing_acc >= TIMING_ACC_LIMIT)
+        {
+            // next bit one sample shorter: this sample is already its first,
+            // and the next call counts 2, so capture first_neg here
+            b->samples_per_bit_cnt = 1;
+            b->first_neg = negative;
+            b->timing_acc = 0;
+        }
+        else if (b->timing_acc <= -TIMING_ACC_LIMIT)
+        {
+            b->samples_per_bit_cnt = -1;    // next bit one sample longer
+            b->timing_acc = 0;
+        }
+#endif
+
+        b->bit_cnt++;
+        if (b->bit_cnt == UART_LEN) // full UART frame has been read
+        {
+            b->idle = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Indica si la próxima llamada a bitsStep() va a usar la salida del FIR.
+ *
+ * En idle se mira cada muestra (detección de start); recibiendo, solo las 3
+ * muestras centrales de cada bit y, con DEMOD_FSK_TIMING_RECOVERY, la primera
+ * y la última. El resto de las salidas se descartan, así que no hace falta
+ * calcularlas: la línea de retardo se actualiza igual.
+ *
+ * @param b Estado de bits.
+ * @return true si hace falta evaluar el FIR en esta muestra.
+ */
+static inline bool bitsNeedFir(const demod_bits_t *b)
+{
+    int8_t next = b->samples_per_bit_cnt + 1;
+    return b->idle || ((next >= HALF_SAMPLES_BIT - 1) &&
+                       (next <= HALF_SAMPLES_BIT + 1))
+#if DEMOD_FSK_TIMING_RECOVERY
+                   || (next == 1) || (next == SAMPLES_PER_BIT)
+#endif
+                   ;
+}
+
+/**
+ * @brief Camino por bloques en float.
+ *
+ * El FIR es el mismo que en demodFSK() (solo cambia el orden de suma). Con
+ * DEMOD_FSK_TIMING_RECOVERY en 0 la máquina de bits es la de
+ * bitstreamReconstruction() y ambos caminos recuperan los mismos frames. Con
+ * el valor por defecto (1) el reloj de bit se recentra en cada transición y
+ * el frame termina en el centro del bit de stop, así que con frames pegados
+ * o un ADC que no muestrea exactamente a MODEM_FS_ADC los frames pueden
+ * diferir de los de bitstreamReconstruction(). El estado se copia a locales
+ * durante el bloque para que quede en registros.
+ *
+ * @param samples Muestras ADC.
+ * @param n Cantidad de muestras.
+ * @param frames Destino de los frames (BITSTREAM_SIZE bits, LSB primero).
+ * @param max_frames Capacidad de frames.
+ * @return Cantidad de frames escritos en frames.
+ */
+size_t demodFSK_ProcessBlockF32(const uint16_t *samples, size_t n,
+                                uint16_t *frames, size_t max_frames)
+{
+    float *x = blk.x;
+    float *m = blk.m;
+    uint8_t x_pos = blk.x_pos;
+    uint8_t m_pos = blk.m_pos;
+    demod_bits_t bits = blk.bits;
+    size_t n_frames = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        // the newest sample is at pos, the one k samples old at pos + k
+        x_pos = (x_pos == 0) ? DELAY : x_pos - 1;
+        float xn = ((float)samples[i] - ADC_DC_VAL) / SCALE;
+        x[x_pos] = xn;
+        x[x_pos + DELAY + 1] = xn;
+
+        float prod = xn * x[x_pos + DELAY];
+        m_pos = (m_pos == 0) ? N - 1 : m_pos - 1;
+        m[m_pos] = prod;
+        m[m_pos + N] = prod;
+
+        bool positive = false;
+        bool negative = false;
+#if DEMOD_FSK_LAZY
+        if (bitsNeedFir(&bits))
+#endif
+        {
+            // two accumulators break the add dependency chain (N is even)
+            const float *w = &m[m_pos];
+            float d0 = 0.0f;
+            float d1 = 0.0f;
+            for (int k = 0; k < N; k += 2)
+            {
+                d0 += w[k] * h[k];
+                d1 += w[k + 1] * h[k + 1];
+            }
+            float d = d0 + d1;
+            positive = (d > 0);
+            negative = (d < 0);
+        }
+
+        if (bitsStep(&bits, positive, negative) && n_frames < max_frames)
+        {
+            frames[n_frames++] = bits.frame;
+        }
+    }
+
+    blk.x_pos = x_pos;
+    blk.m_pos = m_pos;
+    blk.bits = bits;
+    return n_frames;
+}
+
+/**
+ * @brief Parte del FIR plegado en punto fijo: taps simétricos k0..k1-1.
+ *
+ * Suma primero los taps simétricos (w[k] + w[N-1-k]) con saturación a 16
+ * bits y acumula en 32 bits. Con la extensión DSP del Cortex-M4 las sumas y
+ * productos se hacen de a pares (QADD16 + SMLAD).
+ *
+ * @param w Ventana del producto, w[0] el más nuevo.
+ * @param k0 Primer tap (par).
+ * @param k1 Tap final, excluido (k1 - k0 par, k1 <= N / 2 - 1).
+ * @return Contribución de esos taps.
+ */
+static inline int32_t firFoldedQ15Part(const int16_t *w, int k0, int k1)
+{
+    int32_t acc = 0;
+#if defined(__ARM_FEATURE_DSP)
+    for (int k = k0; k < k1; k += 2)
+    {
+        uint32_t fwd, rev;
+        memcpy(&fwd, &w[k], sizeof(fwd));             // w[k], w[k+1]
+        memcpy(&rev, &w[N - 2 - k], sizeof(rev));     // w[N-2-k], w[N-1-k]
+        uint32_t sum = __QADD16(fwd, __ROR(rev, 16));
+        uint32_t coef = (uint16_t)h_q15[k] | ((uint32_t)h_q15[k + 1] << 16);
+        acc = (int32_t)__SMLAD(sum, coef, (uint32_t)acc);
+    }
+#else
+    for (int k = k0; k < k1; k++)
+    {
+        int32_t sum = (int32_t)w[k] + w[N - 1 - k];
+        sum = (sum > INT16_MAX) ? INT16_MAX : sum;  // QADD16
+        sum = (sum < INT16_MIN) ? INT16_MIN : sum;
+        acc += sum * h_q15[k];
+    }
+#endif
+    return acc;
+}
+
+/**
+ * @brief Tap central del FIR plegado (N / 2 es impar, queda sin par).
+ *
+ * @param w Ventana del producto, w[0] el más nuevo.
+ * @return Contribución del tap central.
+ */
+static inline int32_t firCentreQ15(const int16_t *w)
+{
+    int32_t sum = (int32_t)w[N / 2 - 1] + w[N / 2];
+    sum = (sum > INT16_MAX) ? INT16_MAX : sum;
+    sum = (sum < INT16_MIN) ? INT16_MIN : sum;
+    return sum * h_q15[N / 2 - 1];
+}
+
+/**
+ * @brief FIR plegado completo en punto fijo sobre la ventana w[0..N-1].
+ *
+ * @param w Ventana del producto, w[0] el más nuevo.
+ * @return Salida del FIR (solo interesa el signo).
+ */
+static inline int32_t firFoldedQ15(const int16_t *w)
+{
+    return firFoldedQ15Part(w, 0, PROBE_TAP)
+         + firFoldedQ15Part(w, PROBE_TAP, N / 2 - 1) + firCentreQ15(w);
+}
+
+/**
+ * @brief Cota de |contribución| de los taps externos (0..PROBE_TAP-1).
+ *
+ * Cada suma plegada está acotada por 2 * peak, con peak el máximo |m| de la
+ * ventana. El compilador pliega la suma de |h_q15| en una constante.
+ *
+ * @param peak Cota de |m| en la ventana.
+ * @return Cota de la contribución de los taps externos.
+ */
+static inline int32_t firTailBoundQ15(int32_t peak)
+{
+    int32_t h_abs = 0;
+    for (int k = 0; k < PROBE_TAP; k++)
+    {
+        h_abs += (h_q15[k] < 0) ? -h_q15[k] : h_q15[k];
+    }
+    return 2 * peak * h_abs;
+}
+
+/**
+ * @brief Signo del FIR en punto fijo para la próxima llamada a bitsStep().
+ *
+ * Con DEMOD_FSK_LAZY en idle solo se busca una salida positiva: primero los
+ * taps centrales y una cota de los externos, y el FIR completo únicamente si
+ * la cota lo permite. Recibiendo se evalúa solo en las muestras que usa la
+ * máquina de bits. Si no se evalúa, positive y negative quedan en false.
+ *
+ * @param w Ventana del producto, w[0] el más nuevo.
+ * @param peak Cota de |m| en la ventana.
+ * @param b Estado de bits.
+ * @param positive Salida del FIR > 0.
+ * @param negative Salida del FIR < 0.
+ */
+static inline void firDecideQ15(const int16_t *w, int32_t peak,
+                                const demod_bits_t *b,
+                                bool *positive, bool *negative)
+{
+#if DEMOD_FSK_LAZY
+    if (b->idle)
+    {
+        // cheap probe: central taps plus a bound on the outer ones.
+        // Only a positive output matters here, and if even the bound
+        // can't make it positive the full FIR isn't needed.
+        int32_t d = firFoldedQ15Part(w, PROBE_TAP, N / 2 - 1) + firCentreQ15(w);
+        if (d + firTailBoundQ15(peak) > 0)
+        {
+            d += firFoldedQ15Part(w, 0, PROBE_TAP);
+            *positive = (d > 0);
+        }
+        return;
+    }
+    if (!bitsNeedFir(b))
+    {
+        return;
+    }
+#else
+    (void)peak;
+    (void)b;
+#endif
+    int32_t d = firFoldedQ15(w);
+    *positive = (d > 0);
+    *negative = (d < 0);
+}
+
+/**
+ * @brief Camino por bloques en punto fijo (Q15, acumulador de 32 bits).
+ *
+ * Misma estructura que demodFSK_ProcessBlockF32(): líneas de retardo
+ * espejadas y estado en locales, pero sin FPU y con el FIR plegado.
+ *
+ * @param samples Muestras ADC.
+ * @param n Cantidad de muestras.
+ * @param frames Destino de los frames (BITSTREAM_SIZE bits, LSB primero).
+ * @param max_frames Capacidad de frames.
+ * @return Cantidad de frames escritos en frames.
+ */
+size_t demodFSK_ProcessBlockQ15(const uint16_t *samples, size_t n,
+                                uint16_t *frames, size_t max_frames)
+{
+    int16_t *x = blk_q15.x;
+    int16_t *m = blk_q15.m;
+    uint8_t x_pos = blk_q15.x_pos;
+    uint8_t m_pos = blk_q15.m_pos;
+    demod_bits_t bits = blk_q15.bits;
+    int32_t peak_cur = blk_q15.peak_cur;
+    int32_t peak_prev = blk_q15.peak_prev;
+    size_t n_frames = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        x_pos = (x_pos == 0) ? DELAY : x_pos - 1;
+        int16_t xn = (int16_t)(samples[i] - ADC_DC_VAL);
+        x[x_pos] = xn;
+        x[x_pos + DELAY + 1] = xn;
+
+        // |xn * xd| <= 2^22, so >> M_Q15_SHIFT leaves |prod| <= 2^14
+        int16_t prod = (int16_t)(((int32_t)xn * x[x_pos + DELAY])
+                                 >> M_Q15_SHIFT);
+        m_pos = (m_pos == 0) ? N - 1 : m_pos - 1;
+        m[m_pos] = prod;
+        m[m_pos + N] = prod;
+
+        int32_t mag = (prod < 0) ? -prod : prod;
+        peak_cur = (mag > peak_cur) ? mag : peak_cur;
+        if (m_pos == 0) // every N samples: the window spans cur and prev
+        {
+            peak_prev = peak_cur;
+            peak_cur = 0;
+        }
+
+        bool positive = false;
+        bool negative = false;
+        firDecideQ15(&m[m_pos], (peak_cur > peak_prev) ? peak_cur : peak_prev,
+                     &bits, &positive, &negative);
+
+        if (bitsStep(&bits, positive, negative) && n_frames < max_frames)
+        {
+            frames[n_frames++] = bits.frame;
+        }
+    }
+
+    blk_q15.x_pos = x_pos;
+    blk_q15.m_pos = m_pos;
+    blk_q15.bits = bits;
+    blk_q15.peak_cur = peak_cur;
+    blk_q15.peak_prev = peak_prev;
+    return n_frames;
+}
+
+/**
+ * @brief Reloj de bit libre para el modo paquete.
+ *
+ * Mismo muestreo que bitsStep(), voto de 3 muestras en el centro del bit,
+ * pero sin bit de start: el reloj corre siempre y se recentra con los cruces
+ * por cero del FIR, que se mira en todas las muestras. Un cruce en la primera
+ * muestra del bit está en hora; hasta medio bit después el reloj va temprano
+ * y más allá va tarde. El integrador corrige una muestra cada
+ * TIMING_ACC_LIMIT cruces en el mismo sentido. Necesita transiciones
+ * frecuentes, que en HDLC garantizan el NRZI y el bit stuffing.
+ *
+ * @param s Estado del reloj (una copia local, para que quede en registros).
+ * @param negative Salida del FIR < 0 (mark).
+ * @return true si se decidió un bit (queda en s->last_bit).
+ */
+static inline bool slicerStep(demod_slicer_t *s, bool negative)
+{
+    s->samples_per_bit_cnt++;
+    if (negative != s->last_neg)
+    {
+        // an edge half a bit away counts as early, otherwise the loop
+        // could sit there with one vote each way
+        if (s->samples_per_bit_cnt > HALF_SAMPLES_BIT + 1)
+        {
+            s->timing_acc++;    // late: edge before the bit boundary
+        }
+        else if (s->samples_per_bit_cnt > 1)
+        {
+            s->timing_acc--;    // early: edge after the bit boundary
+        }
+    }
+    s->last_neg = negative;
+
+    if ((s->samples_per_bit_cnt >= HALF_SAMPLES_BIT - 1) &&
+        (s->samples_per_bit_cnt <= HALF_SAMPLES_BIT + 1))
+    {
+        s->votes += negative;
+        return false;
+    }
+    if (s->samples_per_bit_cnt < SAMPLES_PER_BIT)
+    {
+        return false;
+    }
+
+    s->last_bit = (s->votes >= 2);
+    s->samples_per_bit_cnt = 0;
+    s->votes = 0;
+    if (s->timing_acc >= TIMING_ACC_LIMIT)
+    {
+        // next bit one sample shorter: this sample is already its first. Its
+        // edge was classified above and the slicer keeps no first-sample
+        // state, so nothing else moves with the counter
+        s->samples_per_bit_cnt = 1;
+        s->timing_acc = 0;
+    }
+    else if (s->timing_acc <= -TIMING_ACC_LIMIT)
+    {
+        s->samples_per_bit_cnt = -1;    // next bit one sample longer
+        s->timing_acc = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Demodula un bloque a bits sueltos, para el modo paquete (hdlc.h).
+ *
+ * Mismo discriminador y FIR que demodFSK_ProcessBlockQ15(), con el reloj de
+ * bit libre de slicerStep(). El FIR se evalúa en todas las muestras: el
+ * lazo necesita ver dónde cae cada cruce por cero.
+ *
+ * @param samples Muestras ADC.
+ * @param n Cantidad de muestras.
+ * @param bits Destino de los niveles (1 = mark), uno por byte.
+ * @param max_bits Capacidad de bits.
+ * @return Cantidad de bits escritos en bits.
+ */
+size_t demodFSK_ProcessBlockBits(const uint16_t *samples, size_t n,
+                                 uint8_t *bits, size_t max_bits)
+{
+    int16_t *x = blk_bits.x;
+    int16_t *m = blk_bits.m;
+    uint8_t x_pos = blk_bits.x_pos;
+    uint8_t m_pos = blk_bits.m_pos;
+    demod_slicer_t slicer = blk_bits.slicer;
+    size_t n_bits = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        x_pos = (x_pos == 0) ? DELAY : x_pos - 1;
+        int16_t xn = (int16_t)(samples[i] - ADC_DC_VAL);
+        x[x_pos] = xn;
+        x[x_pos + DELAY + 1] = xn;
+
+        int16_t prod = (int16_t)(((int32_t)xn * x[x_pos + DELAY])
+                                 >> M_Q15_SHIFT);
+        m_pos = (m_pos == 0) ? N - 1 : m_pos - 1;
+        m[m_pos] = prod;
+        m[m_pos + N] = prod;
+
+        bool negative = (firFoldedQ15(&m[m_pos]) < 0);
+        if (slicerStep(&slicer, negative) && n_bits < max_bits)
+        {
+            bits[n_bits++] = slicer.last_bit;
+        }
+    }
+
+    blk_bits.x_pos = x_pos;
+    blk_bits.m_pos = m_pos;
+    blk_bits.slicer = slicer;
+    return n_bits;
+}
+
+/**
+ * @brief Inicializa un demodulador multicanal.
+ *
+ * @param dm Puntero al handle.
+ * @param n_ch Canales entrelazados.
+ * @return true si éxito, false si n_ch es inválido.
+ */
+bool DemodFSK_Init(DemodFSK_Handle *dm, uint8_t n_ch)
+{
+    if (n_ch == 0 || n_ch > DEMOD_FSK_MAX_CH)
+    {
+        return false;
+    }
+    dm->n_ch = n_ch;
+    DemodFSK_Reset(dm);
+    return true;
+}
+
+/**
+ * @brief Vuelve todos los canales a idle y limpia las líneas de retardo.
+ *
+ * @param dm Puntero al handle.
+ */
+void DemodFSK_Reset(DemodFSK_Handle *dm)
+{
+    uint8_t n_ch = dm->n_ch;
+    memset(dm, 0, sizeof(*dm));
+    dm->n_ch = n_ch;
+    for (int c = 0; c < DEMOD_FSK_MAX_CH; c++)
+    {
+        dm->idle[c] = true;
+    }
+}
+
+/**
+ * @brief Copia el estado de bits del canal c del handle a un demod_bits_t.
+ *
+ * @param dm Puntero al handle.
+ * @param c Canal.
+ * @return Estado de bits del canal.
+ */
+static inline demod_bits_t loadBits(const DemodFSK_Handle *dm, int c)
+{
+    return (demod_bits_t)
+    {
+        .idle = dm->idle[c],
+        .samples_per_bit_cnt = dm->samples_per_bit_cnt[c],
+        .votes = dm->votes[c],
+        .bit_cnt = dm->bit_cnt[c],
+        .frame = dm->frame[c],
+        .last_bit = dm->last_bit[c],
+        .last_neg = dm->last_neg[c],
+        .first_neg = dm->first_neg[c],
+        .timing_acc = dm->timing_acc[c],
+    };
+}
+
+/**
+ * @brief Guarda un demod_bits_t en el canal c del handle.
+ *
+ * @param dm Puntero al handle.
+ * @param c Canal.
+ * @param b Estado de bits del canal.
+ */
+static inline void storeBits(DemodFSK_Handle *dm, int c, const demod_bits_t *b)
+{
+    dm->idle[c] = b->idle;
+    dm->samples_per_bit_cnt[c] = b->samples_per_bit_cnt;
+    dm->votes[c] = b->votes;
+    dm->bit_cnt[c] = b->bit_cnt;
+    dm->frame[c] = b->frame;
+    dm->last_bit[c] = b->last_bit;
+    dm->last_neg[c] = b->last_neg;
+    dm->first_neg[c] = b->first_neg;
+    dm->timing_acc[c] = b->timing_acc;
+}
+
+/**
+ * @brief Demodula un buffer DMA con n_ch canales entrelazados.
+ *
+ * @param dm Puntero al handle.
+ * @param samples Muestras ADC entrelazadas.
+ * @param n Muestras por canal.
+ * @param frames Destino de los frames.
+ * @param max_frames Capacidad de frames.
+ * @return Cantidad de frames escritos.
+ */
+size_t DemodFSK_Process(DemodFSK_Handle *dm, const uint16_t *samples, size_t n,
+                        DemodFSK_Frame *frames, size_t max_frames)
+{
+    const uint8_t n_ch = dm->n_ch;
+    size_t n_frames = 0;
+
+    // one channel at a time over the whole block, with its state in locals
+    for (int c = 0; c < n_ch; c++)
+    {
+        int16_t *x = dm->x[c];
+        int16_t *m = dm->m[c];
+        uint8_t x_pos = dm->x_pos;
+        uint8_t m_pos = dm->m_pos;
+        demod_bits_t bits = loadBits(dm, c);
+        int32_t peak_cur = dm->peak_cur[c];
+        int32_t peak_prev = dm->peak_prev[c];
+        const uint16_t *in = &samples[c];
+
+        for (size_t i = 0; i < n; i++, in += n_ch)
+        {
+            x_pos = (x_pos == 0) ? DELAY : x_pos - 1;
+            int16_t xn = (int16_t)(*in - ADC_DC_VAL);
+            x[x_pos] = xn;
+            x[x_pos + DELAY + 1] = xn;
+
+            int16_t prod = (int16_t)(((int32_t)xn * x[x_pos + DELAY])
+                                     >> M_Q15_SHIFT);
+            m_pos = (m_pos == 0) ? N - 1 : m_pos - 1;
+            m[m_pos] = prod;
+            m[m_pos + N] = prod;
+
+            int32_t mag = (prod < 0) ? -prod : prod;
+            peak_cur = (mag > peak_cur) ? mag : peak_cur;
+            if (m_pos == 0)
+            {
+                peak_prev = peak_cur;
+                peak_cur = 0;
+            }
+
+            bool positive = false;
+            bool negative = false;
+            firDecideQ15(&m[m_pos], (peak_cur > peak_prev) ? peak_cur : peak_prev,
+                         &bits, &positive, &negative);
+
+            if (bitsStep(&bits, positive, negative) && n_frames < max_frames)
+            {
+                // keep the block in arrival order: frames are rare, so an
+                // insertion behind the ones that came later is cheap
+                size_t k = n_frames++;
+                while ((k > 0) && (frames[k - 1].pos > i))
+                {
+                    frames[k] = frames[k - 1];
+                    k--;
+                }
+                frames[k].ch = (uint8_t)c;
+                frames[k].pos = (uint32_t)i;
+                frames[k].frame = bits.frame;
+            }
+        }
+
+        storeBits(dm, c, &bits);
+        dm->peak_cur[c] = peak_cur;
+        dm->peak_prev[c] = peak_prev;
+    }
+
+    // every channel moved the shared positions by n
+    dm->x_pos = (uint8_t)((dm->x_pos + (DELAY + 1) - n % (DELAY + 1)) % (DELAY + 1));
+    dm->m_pos = (uint8_t)((dm->m_pos + N - n % N) % N);
+    return n_frames;
+}
+
+/**
+ * @brief Demodula un bloque con el motor elegido por DEMOD_FSK_FIXED.
+ *
+ * @param samples Muestras ADC.
+ * @param n Cantidad de muestras.
+ * @param frames Destino de los frames (BITSTREAM_SIZE bits, LSB primero).
+ * @param max_frames Capacidad de frames.
+ * @return Cantidad de frames escritos en frames.
+ */
+size_t demodFSK_ProcessBlock(const uint16_t *samples, size_t n,
+                             uint16_t *frames, size_t max_frames)
+{
+#if DEMOD_FSK_FIXED
+    return demodFSK_ProcessBlockQ15(samples, n, frames, max_frames);
+#else
+    return demodFSK_ProcessBlockF32(samples, n, frames, max_frames);
+#endif
+}
+
+/**
+ * @brief Reinicia el estado del camino por muestra.
+ */
+void demodFSK_Reset(void)
+{
+    memset(fsk_x, 0, sizeof(fsk_x));
+    memset(fsk_m, 0, sizeof(fsk_m));
+    fsk_curr = 0;
+    fsk_i = 0;
+    memset(bit_democracy, 0, sizeof(bit_democracy));
+    bit_democracy_idx = 0;
+    idle = true;
+    data_ready = false;
+    samples_per_bit_cnt = 0;
+    frame_recovered = 0;
+    bit_cnt = 0;
+}
+
+/**
+ * @brief Reinicia el estado del demodulador por bloques.
+ */
+void demodFSK_ResetBlock(void)
+{
+    blk = (demod_block_t){ .bits.idle = true };
+    blk_q15 = (demod_block_q15_t){ .bits.idle = true };
+    blk_bits = (demod_stream_q15_t){ 0 };
+}
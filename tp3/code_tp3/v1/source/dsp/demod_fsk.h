@@ -9,9 +9,129 @@
 #ifndef _DEMOD_FSK_
 #define _DEMOD_FSK_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "bitstream.h"
+#include "modem_profile.h"
+
+// ---- Perillas de tiempo de compilación ----
+/**
+ * @def DEMOD_FSK_FIXED
+ * @brief 1 para que demodFSK_ProcessBlock() use el motor en punto fijo
+ * (Q15 con FIR plegado), 0 para el motor en float.
+ */
+#ifndef DEMOD_FSK_FIXED
+#define DEMOD_FSK_FIXED (0)
+#endif
+
+/**
+ * @def DEMOD_FSK_LAZY
+ * @brief 1 para que los motores por bloques evalúen el FIR solo cuando la
+ * máquina de bits usa su salida (3 de cada 10 muestras recibiendo). En idle
+ * el motor en punto fijo primero prueba los taps centrales y una cota de los
+ * externos. Los frames recuperados son los mismos que con 0.
+ */
+#ifndef DEMOD_FSK_LAZY
+#define DEMOD_FSK_LAZY (1)
+#endif
+
+/**
+ * @def DEMOD_FSK_TIMING_RECOVERY
+ * @brief 1 para que los motores por bloques recentren el muestreo en cada
+ * transición entre bits y terminen el frame en el centro del bit de stop.
+ * Permite recibir frames pegados aunque el ADC no muestree exactamente a
+ * MODEM_FS_ADC (redondeo del PIT, error de reloj del transmisor). Con 0 el
+ * reloj de bit queda libre desde el flanco de start, como en
+ * bitstreamReconstruction().
+ */
+#ifndef DEMOD_FSK_TIMING_RECOVERY
+#define DEMOD_FSK_TIMING_RECOVERY (1)
+#endif
+
+/**
+ * @def DEMOD_FSK_MAX_CH
+ * @brief Canales por DemodFSK_Handle.
+ */
+#ifndef DEMOD_FSK_MAX_CH
+#define DEMOD_FSK_MAX_CH (4)
+#endif
+
+/**
+ * @def DEMOD_FSK_DELAY
+ * @brief Retardo del discriminador en muestras (medio bit a MODEM_FS_ADC).
+ */
+#define DEMOD_FSK_DELAY MODEM_DELAY
+
+/**
+ * @def DEMOD_FSK_TAPS
+ * @brief Largo del FIR, igual a N en fir_coefs.h.
+ */
+#define DEMOD_FSK_TAPS 26
+
+/**
+ * @def DEMOD_FSK_MAX_FRAMES
+ * @brief Cota de frames que puede entregar un bloque de n muestras
+ * (MODEM_SAMPLES_PER_BIT muestras por bit, BITSTREAM_SIZE bits por frame,
+ * más el frame ya empezado).
+ */
+#define DEMOD_FSK_MAX_FRAMES(n) \
+    ((n) / (MODEM_SAMPLES_PER_BIT * BITSTREAM_SIZE) + 1u)
+
+/**
+ * @def DEMOD_FSK_MAX_BITS
+ * @brief Cota de bits que puede entregar demodFSK_ProcessBlockBits() con un
+ * bloque de n muestras (más uno por el bit ya empezado y otro por un bit
+ * acortado por el lazo de sincronismo).
+ */
+#define DEMOD_FSK_MAX_BITS(n) ((n) / MODEM_SAMPLES_PER_BIT + 2u)
+
+/**
+ * @brief Frame recibido por un DemodFSK_Handle.
+ */
+typedef struct
+{
+    uint8_t ch;         /**< Canal por el que llegó. */
+    uint32_t pos;       /**< Muestra del bloque (por canal) en que terminó. */
+    uint16_t frame;     /**< Frame empaquetado como en data_to_uart(). */
+} DemodFSK_Frame;
+
+/**
+ * @brief Demodulador FSK re-entrante de hasta DEMOD_FSK_MAX_CH canales.
+ *
+ * Todo el estado vive acá (no hay estáticos), así que se pueden tener varias
+ * instancias. Las líneas de retardo están organizadas como [canal][muestra]:
+ * todos los canales avanzan juntos con un único índice y la ventana de cada
+ * uno queda contigua, así el FIR de un canal se evalúa solo cuando su máquina
+ * de bits lo necesita. Motor en punto fijo, igual que
+ * demodFSK_ProcessBlockQ15().
+ *
+ * No es más rápido que llamar demodFSK_ProcessBlockQ15() una vez por canal:
+ * bench_demod_multi mide x0.9-1.0 contra eso, porque los canales no comparten
+ * cuentas (cada uno pide su FIR en muestras distintas). Lo que aporta es el
+ * estado re-entrante y demodular el buffer DMA entrelazado sin copiarlo.
+ */
+typedef struct
+{
+    int16_t x[DEMOD_FSK_MAX_CH][2 * (DEMOD_FSK_DELAY + 1)]; /**< Señal sin DC, espejada. */
+    int16_t m[DEMOD_FSK_MAX_CH][2 * DEMOD_FSK_TAPS];        /**< Producto en Q15, espejado. */
+    uint8_t x_pos;                          /**< Posición de la muestra más nueva en x. */
+    uint8_t m_pos;                          /**< Posición del producto más nuevo en m. */
+    uint8_t n_ch;                           /**< Canales en uso. */
+    int32_t peak_cur[DEMOD_FSK_MAX_CH];     /**< Máx. |m| desde la última vuelta de m_pos. */
+    int32_t peak_prev[DEMOD_FSK_MAX_CH];    /**< Máx. |m| de la vuelta anterior. */
+    bool idle[DEMOD_FSK_MAX_CH];            /**< Esperando bit de start. */
+    int8_t samples_per_bit_cnt[DEMOD_FSK_MAX_CH]; /**< Muestras del bit actual. */
+    uint8_t votes[DEMOD_FSK_MAX_CH];        /**< Votos "1" del bit actual. */
+    uint8_t bit_cnt[DEMOD_FSK_MAX_CH];      /**< Bits del frame actual. */
+    uint16_t frame[DEMOD_FSK_MAX_CH];       /**< Frame en construcción. */
+    bool last_bit[DEMOD_FSK_MAX_CH];        /**< Último bit decidido. */
+    bool last_neg[DEMOD_FSK_MAX_CH];        /**< Signo en la última muestra del bit. */
+    bool first_neg[DEMOD_FSK_MAX_CH];       /**< Signo en la primera muestra del bit. */
+    int8_t timing_acc[DEMOD_FSK_MAX_CH];    /**< Integrador del lazo de sincronismo. */
+} DemodFSK_Handle;
+
 /**
  * @brief Demodula una muestra ADC en formato FSK.
  *
@@ -40,12 +160,117 @@ void bitstreamReconstruction(float fir_output);
 bool isDataReady(void);
 
 /**
- * @brief Recupera el bitstream reconstruido (11 bits).
+ * @brief Recupera el frame reconstruido (BITSTREAM_SIZE bits).
+ *
+ * Limpia el flag de datos listos. Hay un solo frame: si no se lo retira
+ * antes de que termine el siguiente, se pisa. app.c usa en su lugar
+ * demodFSK_ProcessBlock() y una FrameFifo (frame_fifo.h).
+ *
+ * @return Frame empaquetado como en data_to_uart() (bit 0 = start).
+ */
+uint16_t retrieveBitstream(void);
+
+/**
+ * @brief Reinicia el estado de demodFSK() y bitstreamReconstruction() (idle,
+ * filtro en 0, sin frame pendiente).
+ */
+void demodFSK_Reset(void);
+
+/**
+ * @brief Demodula un bloque completo de muestras ADC (p. ej. un buffer DMA).
+ *
+ * Equivalente a llamar demodFSK() + bitstreamReconstruction() por cada
+ * muestra, pero sin llamadas por muestra ni aritmética modular: las líneas
+ * de retardo están espejadas y el FIR es un producto escalar directo.
+ * Mantiene su propio estado entre bloques, independiente del camino por
+ * muestra; no mezclar ambos sobre la misma señal. El motor (float o punto
+ * fijo) se elige en tiempo de compilación con DEMOD_FSK_FIXED. Con
+ * DEMOD_FSK_TIMING_RECOVERY el reloj de bit además se corrige en cada
+ * transición (ver la perilla).
+ *
+ * @param samples Muestras ADC de 12 bits.
+ * @param n Cantidad de muestras.
+ * @param frames Destino de los frames recibidos, empaquetados como en
+ *               data_to_uart() (bit 0 = start, stop en BITSTREAM_STOP_POS).
+ * @param max_frames Capacidad de frames; ver DEMOD_FSK_MAX_FRAMES().
+ * @return Cantidad de frames escritos. Los que no entran se descartan.
+ */
+size_t demodFSK_ProcessBlock(const uint16_t *samples, size_t n,
+                             uint16_t *frames, size_t max_frames);
+
+/**
+ * @brief Motor por bloques en float (ver demodFSK_ProcessBlock()).
+ */
+size_t demodFSK_ProcessBlockF32(const uint16_t *samples, size_t n,
+                                uint16_t *frames, size_t max_frames);
+
+/**
+ * @brief Motor por bloques en punto fijo (ver demodFSK_ProcessBlock()).
+ *
+ * Muestras y productos en 16 bits, coeficientes en Q15 y acumulador de 32
+ * bits. Aprovecha la simetría del FIR (13 productos en vez de 26) y, si el
+ * compilador define __ARM_FEATURE_DSP, hace dos MAC de 16 bits por
+ * instrucción (SMLAD). Sin la extensión DSP usa la versión en C portable,
+ * que da exactamente el mismo resultado.
+ */
+size_t demodFSK_ProcessBlockQ15(const uint16_t *samples, size_t n,
+                                uint16_t *frames, size_t max_frames);
+
+/**
+ * @brief Demodula un bloque a niveles de línea sueltos, para el modo paquete.
+ *
+ * Mismo filtro que demodFSK_ProcessBlockQ15() y mismo muestreo (voto de 3
+ * muestras en el centro del bit), pero el reloj de bit corre libre en vez de
+ * arrancar con un bit de start, y se recentra en cada transición. Sirve para
+ * líneas con transiciones frecuentes, como HDLC con NRZI (hdlc.h). Estado
+ * propio, independiente del de demodFSK_ProcessBlock().
+ *
+ * @param samples Muestras ADC de 12 bits.
+ * @param n Cantidad de muestras.
+ * @param bits Destino de los bits decididos, 1 = mark, uno por byte.
+ * @param max_bits Capacidad de bits; ver DEMOD_FSK_MAX_BITS().
+ * @return Cantidad de bits escritos. Los que no entran se descartan.
+ */
+size_t demodFSK_ProcessBlockBits(const uint16_t *samples, size_t n,
+                                 uint8_t *bits, size_t max_bits);
+
+/**
+ * @brief Reinicia el estado del demodulador por bloques (idle, filtro en 0).
+ */
+void demodFSK_ResetBlock(void);
+
+/**
+ * @brief Inicializa un demodulador multicanal.
+ *
+ * @param dm Puntero al handle.
+ * @param n_ch Canales entrelazados en el buffer (1..DEMOD_FSK_MAX_CH).
+ * @return true si éxito, false si n_ch es inválido.
+ */
+bool DemodFSK_Init(DemodFSK_Handle *dm, uint8_t n_ch);
+
+/**
+ * @brief Vuelve todos los canales a idle y limpia las líneas de retardo.
+ *
+ * @param dm Puntero al handle.
+ */
+void DemodFSK_Reset(DemodFSK_Handle *dm);
+
+/**
+ * @brief Demodula un buffer DMA con n_ch canales entrelazados.
  *
- * Limpia el flag de datos listos.
+ * La muestra i del canal c está en samples[i * n_ch + c] (orden de un ADC que
+ * convierte los canales en secuencia). Con DEMOD_FSK_LAZY cada canal evalúa
+ * su FIR solo en las muestras en que lo necesita, como
+ * demodFSK_ProcessBlockQ15() (sonda barata en idle incluida).
  *
- * @return Puntero al arreglo de bits booleanos.
+ * @param dm Puntero al handle.
+ * @param samples Muestras ADC entrelazadas.
+ * @param n Muestras por canal.
+ * @param frames Destino de los frames, en orden de llegada.
+ * @param max_frames Capacidad de frames. Los que no entran se descartan.
+ * @return Cantidad de frames escritos.
  */
-bool *retrieveBitstream(void);
+size_t DemodFSK_Process(DemodFSK_Handle *dm, const uint16_t *samples, size_t n,
+                        DemodFSK_Frame *frames, size_t max_frames);
 
 #endif // _DEMOD_FSK_
\ No newline at end of file
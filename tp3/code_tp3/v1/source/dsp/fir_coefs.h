@@ -3,26 +3,25 @@
  * @brief Coeficientes del filtro FIR generados por herramienta de diseño.
  *
  * Este archivo define coeficientes para un filtro FIR de paso bajo, estable y de fase lineal.
- * Generado por MATLAB y Signal Processing Toolbox.
+ * Generado por gen_fir_coefs.py --spb 10 --taps 26 --pass 1 --stop 2 --ripple 1
+ * --atten 80 --density 20 (equiripple de Parks-McClellan).
+ *
+ * Las frecuencias del diseño están normalizadas a FS_ADC (paso hasta 0.1 FS_ADC con
+ * 0.8 dB de rizado, rechazo de 76 dB desde 0.2 FS_ADC), así que la misma tabla sirve
+ * para todos los perfiles de modem_profile.h mientras FS_ADC / baud sea FIR_SAMPLES_PER_BIT.
+ * Para otro largo o muestras por bit, regenerar con gen_fir_coefs.py.
  */
 
 #ifndef _FIR_COEFS_
 #define _FIR_COEFS_
 
-/*
- * Discrete-Time FIR Filter (real)
- * -------------------------------
- * Filter Structure  : Direct-Form FIR
- * Filter Length     : 26
- * Stable            : Yes
- * Linear Phase      : Yes (Type 1)
- */
+#include <stdint.h>
 
 /**
- * @def FS_ADC
- * @brief Frecuencia de muestreo del ADC (12000 Hz).
+ * @def FIR_SAMPLES_PER_BIT
+ * @brief Muestras por bit (FS_ADC / baud) para las que se diseñó el filtro.
  */
-#define FS_ADC 12000
+#define FIR_SAMPLES_PER_BIT 10
 
 /**
  * @def N
@@ -44,4 +43,17 @@ const float h[N] =
   0.0009219922358
 };
 
+/**
+ * @var h_q15
+ * @brief Primera mitad de h en Q15, round(h[k] * 32768).
+ *
+ * El filtro es simétrico (h[k] == h[N - 1 - k]), así que alcanza con N / 2
+ * coeficientes para la forma plegada del FIR.
+ */
+const int16_t h_q15[N / 2] =
+{
+    30,   110,   219,   247,    34,  -507, -1211,
+ -1605, -1090,   685,  3466,  6360,  8210
+};
+
 #endif // _FIR_COEFS_
\ No newline at end of file
@@ -0,0 +1,111 @@
+/**
+ * @file frame_fifo.c
+ * @brief Implementación de la cola de bytes recibidos (un productor, un consumidor).
+ */
+
+#include "frame_fifo.h"
+#include "bitstream.h"
+
+#define FIFO_MASK (FRAME_FIFO_SIZE - 1u)
+
+/**
+ * @brief Vacía la cola y pone en cero el contador de descartes.
+ *
+ * @param fifo Cola a inicializar.
+ */
+void FrameFifo_Init(FrameFifo *fifo)
+{
+    fifo->head = 0;
+    fifo->tail = 0;
+    fifo->dropped = 0;
+}
+
+/**
+ * @brief Encola un byte (lado productor).
+ *
+ * @param fifo Cola.
+ * @param entry Byte, status y timestamp.
+ * @return True si se encoló, false si la cola estaba llena.
+ */
+bool FrameFifo_Push(FrameFifo *fifo, const FrameFifo_Entry *entry)
+{
+    uint32_t head = fifo->head;
+    if (head - fifo->tail >= FRAME_FIFO_SIZE)
+    {
+        fifo->dropped++;
+        return false;
+    }
+
+    volatile FrameFifo_Entry *slot = &fifo->buf[head & FIFO_MASK];
+    slot->data = entry->data;
+    slot->status = entry->status;
+    slot->timestamp = entry->timestamp;
+    fifo->head = head + 1u;     // publish only after the entry is written
+    return true;
+}
+
+/**
+ * @brief Encola un frame UART, chequeando paridad y stop.
+ *
+ * @param fifo Cola.
+ * @param frame Frame empaquetado como en data_to_uart().
+ * @param timestamp Muestras del ADC desde el arranque.
+ * @return True si se encoló, false si la cola estaba llena.
+ */
+bool FrameFifo_PushFrame(FrameFifo *fifo, uint16_t frame, uint32_t timestamp)
+{
+    FrameFifo_Entry entry =
+    {
+        .data = uart_to_data(frame),
+        .status = 0,
+        .timestamp = timestamp
+    };
+    if (!uart_parity_ok(frame))
+    {
+        entry.status |= FRAME_FIFO_PARITY_ERR;
+    }
+    if (!uart_framing_ok(frame))
+    {
+        entry.status |= FRAME_FIFO_FRAMING_ERR;
+    }
+    return FrameFifo_Push(fifo, &entry);
+}
+
+/**
+ * @brief Desencola hasta max entradas de una vez (lado consumidor).
+ *
+ * @param fifo Cola.
+ * @param out Destino de las entradas.
+ * @param max Capacidad de out.
+ * @return Cantidad de entradas copiadas.
+ */
+size_t FrameFifo_Pop(FrameFifo *fifo, FrameFifo_Entry *out, size_t max)
+{
+    uint32_t tail = fifo->tail;
+    size_t count = (size_t)(fifo->head - tail);
+    if (count > max)
+    {
+        count = max;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const volatile FrameFifo_Entry *slot = &fifo->buf[(tail + i) & FIFO_MASK];
+        out[i].data = slot->data;
+        out[i].status = slot->status;
+        out[i].timestamp = slot->timestamp;
+    }
+    fifo->tail = tail + (uint32_t)count;   // free the slots only after reading
+    return count;
+}
+
+/**
+ * @brief Entradas pendientes de leer.
+ *
+ * @param fifo Cola.
+ * @return Cantidad de entradas en la cola.
+ */
+size_t FrameFifo_Count(const FrameFifo *fifo)
+{
+    return (size_t)(fifo->head - fifo->tail);
+}
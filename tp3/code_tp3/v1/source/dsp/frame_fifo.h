@@ -0,0 +1,114 @@
+/**
+ * @file frame_fifo.h
+ * @brief Cola circular de bytes recibidos entre el demodulador y la aplicación.
+ *
+ * Un único productor (el ISR que demodula) y un único consumidor (el loop
+ * principal). Cada índice lo escribe solo uno de los dos lados, así que no
+ * hace falta deshabilitar interrupciones: el productor escribe la entrada y
+ * recién después avanza head; el consumidor lee la entrada y recién después
+ * avanza tail. Los índices corren libres y se enmascaran con
+ * FRAME_FIFO_SIZE - 1.
+ */
+
+#ifndef _FRAME_FIFO_H_
+#define _FRAME_FIFO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// ---- Perillas de tiempo de compilación ----
+
+/**
+ * @def FRAME_FIFO_SIZE
+ * @brief Cantidad de entradas de la cola (potencia de 2).
+ */
+#ifndef FRAME_FIFO_SIZE
+#define FRAME_FIFO_SIZE (64u)
+#endif
+
+#if (FRAME_FIFO_SIZE & (FRAME_FIFO_SIZE - 1u)) != 0
+#error "FRAME_FIFO_SIZE must be a power of 2"
+#endif
+
+/**
+ * @def FRAME_FIFO_PARITY_ERR
+ * @brief Flag de status: el bit de paridad no coincide con los datos.
+ */
+#define FRAME_FIFO_PARITY_ERR  (1u << 0)
+
+/**
+ * @def FRAME_FIFO_FRAMING_ERR
+ * @brief Flag de status: el bit de stop llegó en 0.
+ */
+#define FRAME_FIFO_FRAMING_ERR (1u << 1)
+
+/**
+ * @brief Byte recibido con su status y el instante de llegada.
+ */
+typedef struct
+{
+    uint16_t data;       /**< Dato (hasta 9 bits según BITSTREAM_FORMAT). */
+    uint8_t  status;     /**< 0 o combinación de FRAME_FIFO_*_ERR. */
+    uint32_t timestamp;  /**< Muestras del ADC desde el arranque. */
+} FrameFifo_Entry;
+
+/**
+ * @brief Cola de un productor y un consumidor.
+ */
+typedef struct
+{
+    volatile FrameFifo_Entry buf[FRAME_FIFO_SIZE]; /**< Entradas. */
+    volatile uint32_t head;     /**< Próxima a escribir, solo el productor. */
+    volatile uint32_t tail;     /**< Próxima a leer, solo el consumidor. */
+    volatile uint32_t dropped;  /**< Bytes descartados con la cola llena. */
+} FrameFifo;
+
+/**
+ * @brief Vacía la cola y pone en cero el contador de descartes.
+ *
+ * No es seguro con el productor activo.
+ *
+ * @param fifo Cola a inicializar.
+ */
+void FrameFifo_Init(FrameFifo *fifo);
+
+/**
+ * @brief Encola un byte (lado productor, p. ej. desde un ISR).
+ *
+ * @param fifo Cola.
+ * @param entry Byte, status y timestamp.
+ * @return True si se encoló, false si la cola estaba llena (se cuenta en
+ *         dropped y la entrada se pierde).
+ */
+bool FrameFifo_Push(FrameFifo *fifo, const FrameFifo_Entry *entry);
+
+/**
+ * @brief Encola un frame UART, chequeando paridad y stop.
+ *
+ * @param fifo Cola.
+ * @param frame Frame empaquetado como en data_to_uart().
+ * @param timestamp Muestras del ADC desde el arranque.
+ * @return Igual que FrameFifo_Push().
+ */
+bool FrameFifo_PushFrame(FrameFifo *fifo, uint16_t frame, uint32_t timestamp);
+
+/**
+ * @brief Desencola hasta max entradas de una vez (lado consumidor).
+ *
+ * @param fifo Cola.
+ * @param out Destino de las entradas.
+ * @param max Capacidad de out.
+ * @return Cantidad de entradas copiadas.
+ */
+size_t FrameFifo_Pop(FrameFifo *fifo, FrameFifo_Entry *out, size_t max);
+
+/**
+ * @brief Entradas pendientes de leer.
+ *
+ * @param fifo Cola.
+ * @return Cantidad de entradas en la cola.
+ */
+size_t FrameFifo_Count(const FrameFifo *fifo);
+
+#endif // _FRAME_FIFO_H_
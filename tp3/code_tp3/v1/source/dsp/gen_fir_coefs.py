@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+"""
+Generador de fir_coefs.h para el demodulador FSK (solo biblioteca estándar).
+
+Diseña el pasabajos que sigue al discriminador (FSK * FSK retardada) como
+equiripple de Parks-McClellan (firpm de MATLAB), con las frecuencias
+normalizadas al baud rate: pasa hasta pass * baud y rechaza desde
+stop * baud. El peso de la banda de rechazo sale del rizado y la atenuación
+pedidos, como en firpmord. Como FS_ADC = spb * baud, la misma tabla sirve
+para todos los perfiles de modem_profile.h; solo hay que regenerarla al
+cambiar las muestras por bit o el largo del filtro.
+
+Con los valores por defecto reproduce la tabla original de MATLAB (firpm de
+orden 25 con densidad de grilla 20, guardada en float) byte por byte.
+
+Uso:
+    python3 gen_fir_coefs.py [--spb 10] [--taps 26] [--pass 1.0]
+                             [--stop 2.0] [--ripple 1.0] [--atten 80.0]
+                             [--density 20] > fir_coefs.h
+
+Escribe a stderr la ganancia en DC, el peor rizado de la banda de paso y la
+atenuación mínima de la banda de rechazo.
+"""
+
+import argparse
+import math
+import struct
+import sys
+
+MAX_ITER = 25
+NODE_TOL = 1.0e-6       # como FSH del programa de McClellan-Parks
+
+
+def make_grid(taps, bands, density):
+    """
+    Grilla densa de frecuencias (normalizadas a FS) con su respuesta deseada,
+    peso y banda, de a density puntos por coeficiente libre como en firpm.
+
+    bands: lista de (f_inicio, f_fin, deseado, peso).
+    """
+    nfcns = taps // 2 + taps % 2
+    delf = 0.5 / (density * nfcns)
+    grid, des, wt, band = [], [], [], []
+    for b, (lo, hi, d, w) in enumerate(bands):
+        f = lo
+        pts = []
+        while f <= hi:
+            pts.append(f)
+            f += delf
+        pts[-1] = hi
+        grid += pts
+        des += [d] * len(pts)
+        wt += [w] * len(pts)
+        band += [b] * len(pts)
+    if taps % 2 == 0:
+        # Tipo II: H(0.5) = 0, sacar Nyquist y aproximar D / cos(pi f)
+        if grid[-1] > 0.5 - delf:
+            del grid[-1], des[-1], wt[-1], band[-1]
+        for i, f in enumerate(grid):
+            c = math.cos(math.pi * f)
+            des[i] /= c
+            wt[i] *= c
+    return grid, des, wt, band
+
+
+class Interp:
+    """Polinomio en x = cos(2 pi f) que pasa por (x[j], y[j]), forma baricéntrica."""
+
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+        self.ad = []
+        for k, xk in enumerate(x):
+            q = 1.0
+            for j, xj in enumerate(x):
+                if j != k:
+                    q *= 2.0 * (xk - xj)
+            self.ad.append(1.0 / q)
+
+    def __call__(self, xf):
+        num = den = 0.0
+        for xj, yj, aj in zip(self.x, self.y, self.ad):
+            if abs(xf - xj) < NODE_TOL:
+                return yj
+            c = aj / (xf - xj)
+            num += c * yj
+            den += c
+        return num / den
+
+
+def exchange(nfcns, grid, des, wt, band):
+    """
+    Algoritmo de intercambio de Remez: itera hasta que los nfcns + 1 puntos
+    extremos del error ponderado no cambian. Devuelve el interpolante final.
+    """
+    n = len(grid)
+    ext = [int(j * (n - 1) / nfcns) for j in range(nfcns)] + [n - 1]
+    for _ in range(MAX_ITER):
+        x = [math.cos(2.0 * math.pi * grid[i]) for i in ext]
+        ad = Interp(x, [0.0] * len(x)).ad
+        num = sum(a * des[i] for a, i in zip(ad, ext))
+        den = sum((-1) ** k * a / wt[i] for k, (a, i) in enumerate(zip(ad, ext)))
+        dev = num / den
+        y = [des[i] - (-1) ** k * dev / wt[i] for k, i in enumerate(ext)]
+        p = Interp(x, y)
+
+        err = [(p(math.cos(2.0 * math.pi * f)) - d) * w for f, d, w in zip(grid, des, wt)]
+        new = local_extrema(band, err)
+        new = alternate(new, err)
+        while len(new) > nfcns + 1:
+            # sobran extremos: sacar el menor de las puntas
+            new.pop(0 if abs(err[new[0]]) < abs(err[new[-1]]) else -1)
+        if new == ext or len(new) < nfcns + 1:
+            break
+        ext = new
+    return p
+
+
+def local_extrema(band, err):
+    """Índices donde |err| es máximo local, tomando cada banda por separado."""
+    out = []
+    n = len(err)
+    for i, e in enumerate(err):
+        s = 1.0 if e >= 0.0 else -1.0
+        if i > 0 and band[i - 1] == band[i] and s * err[i - 1] > s * e:
+            continue
+        if i < n - 1 and band[i + 1] == band[i] and s * err[i + 1] > s * e:
+            continue
+        out.append(i)
+    return out
+
+
+def alternate(idx, err):
+    """Deja un solo extremo (el mayor) por cada tramo de igual signo."""
+    out = []
+    for i in idx:
+        if out and (err[i] >= 0.0) == (err[out[-1]] >= 0.0):
+            if abs(err[i]) > abs(err[out[-1]]):
+                out[-1] = i
+        else:
+            out.append(i)
+    return out
+
+
+def coefficients(taps, p):
+    """
+    Respuesta al impulso a partir del interpolante: muestrea P en 2 nfcns - 1
+    frecuencias equiespaciadas y arma h con la DFT inversa de cosenos.
+    """
+    nfcns = taps // 2 + taps % 2
+    cn = 2 * nfcns - 1
+    a = [p(math.cos(2.0 * math.pi * j / cn)) for j in range(nfcns)]
+    alpha = []
+    for j in range(nfcns):
+        s = sum(a[k] * math.cos(2.0 * math.pi * j * k / cn) for k in range(1, nfcns))
+        alpha.append((2.0 * s + a[0]) * (1.0 if j == 0 else 2.0) / cn)
+    alpha += [0.0, 0.0]
+    if taps % 2:
+        half = [0.5 * alpha[nfcns - 1 - j] for j in range(nfcns - 1)] + [alpha[0]]
+        return half + half[-2::-1]
+    half = [0.25 * alpha[nfcns - 1]]
+    half += [0.25 * (alpha[nfcns - j] + alpha[nfcns - 1 - j]) for j in range(1, nfcns - 1)]
+    half += [0.5 * alpha[0] + 0.25 * alpha[1]]
+    return half + half[::-1]
+
+
+def design(taps, f_pass, f_stop, weight, density):
+    """Equiripple de Parks-McClellan (firpm) con las frecuencias normalizadas a FS."""
+    bands = [(0.0, f_pass, 1.0, 1.0), (f_stop, 0.5, 0.0, weight)]
+    grid, des, wt, band = make_grid(taps, bands, density)
+    return coefficients(taps, exchange(taps // 2 + taps % 2, grid, des, wt, band))
+
+
+def to_float(v):
+    """Valor que guarda el compilador en un float."""
+    return struct.unpack("f", struct.pack("f", v))[0]
+
+
+def response_db(h, f):
+    re = sum(v * math.cos(2.0 * math.pi * f * k) for k, v in enumerate(h))
+    im = sum(v * math.sin(2.0 * math.pi * f * k) for k, v in enumerate(h))
+    return 20.0 * math.log10(max(math.hypot(re, im), 1e-12))
+
+
+def emit(h, spb, args, ripple, stop):
+    taps = len(h)
+    q15 = [max(-32768, min(32767, round(v * 32768.0))) for v in h[:taps // 2]]
+    out = []
+    out.append("/**")
+    out.append(" * @file fir_coefs.h")
+    out.append(" * @brief Coeficientes del filtro FIR generados por herramienta de diseño.")
+    out.append(" *")
+    out.append(" * Este archivo define coeficientes para un filtro FIR de paso bajo, estable y de fase lineal.")
+    out.append(" * Generado por gen_fir_coefs.py --spb %d --taps %d --pass %g --stop %g --ripple %g"
+               % (spb, taps, args.f_pass, args.f_stop, args.ripple))
+    out.append(" * --atten %g --density %d (equiripple de Parks-McClellan)." % (args.atten, args.density))
+    out.append(" *")
+    out.append(" * Las frecuencias del diseño están normalizadas a FS_ADC (paso hasta %g FS_ADC con"
+               % (args.f_pass / spb))
+    out.append(" * %.1f dB de rizado, rechazo de %.0f dB desde %g FS_ADC), así que la misma tabla sirve"
+               % (ripple, -stop, args.f_stop / spb))
+    out.append(" * para todos los perfiles de modem_profile.h mientras FS_ADC / baud sea FIR_SAMPLES_PER_BIT.")
+    out.append(" * Para otro largo o muestras por bit, regenerar con gen_fir_coefs.py.")
+    out.append(" */")
+    out.append("")
+    out.append("#ifndef _FIR_COEFS_")
+    out.append("#define _FIR_COEFS_")
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("")
+    out.append("/**")
+    out.append(" * @def FIR_SAMPLES_PER_BIT")
+    out.append(" * @brief Muestras por bit (FS_ADC / baud) para las que se diseñó el filtro.")
+    out.append(" */")
+    out.append("#define FIR_SAMPLES_PER_BIT %d" % spb)
+    out.append("")
+    out.append("/**")
+    out.append(" * @def N")
+    out.append(" * @brief Longitud del filtro FIR (%d)." % taps)
+    out.append(" */")
+    out.append("#define N %d" % taps)
+    out.append("")
+    out.append("/**")
+    out.append(" * @var h")
+    out.append(" * @brief Arreglo de coeficientes del filtro FIR (float).")
+    out.append(" */")
+    out.append("const float h[N] =")
+    out.append("{")
+    rows = ["  " + ",".join("%15.10g" % v for v in h[i:i + 5]) for i in range(0, taps, 5)]
+    out.append(",\n".join(rows))
+    out.append("};")
+    out.append("")
+    out.append("/**")
+    out.append(" * @var h_q15")
+    out.append(" * @brief Primera mitad de h en Q15, round(h[k] * 32768).")
+    out.append(" *")
+    out.append(" * El filtro es simétrico (h[k] == h[N - 1 - k]), así que alcanza con N / 2")
+    out.append(" * coeficientes para la forma plegada del FIR.")
+    out.append(" */")
+    out.append("const int16_t h_q15[N / 2] =")
+    out.append("{")
+    rows = ["".join("%6d," % v for v in q15[i:i + 7]) for i in range(0, len(q15), 7)]
+    out.append("\n".join(rows).rstrip(","))
+    out.append("};")
+    out.append("")
+    out.append("#endif // _FIR_COEFS_")
+    return "\n".join(out)
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    p.add_argument("--spb", type=int, default=10, help="muestras por bit (FS_ADC / baud)")
+    p.add_argument("--taps", type=int, default=26, help="largo del filtro (N)")
+    p.add_argument("--pass", dest="f_pass", type=float, default=1.0,
+                   help="borde de la banda de paso, en veces el baud rate")
+    p.add_argument("--stop", dest="f_stop", type=float, default=2.0,
+                   help="borde de la banda de rechazo, en veces el baud rate")
+    p.add_argument("--ripple", type=float, default=1.0,
+                   help="rizado pedido en la banda de paso, en dB (fija el peso)")
+    p.add_argument("--atten", type=float, default=80.0,
+                   help="atenuación pedida en la banda de rechazo, en dB (fija el peso)")
+    p.add_argument("--density", type=int, default=20,
+                   help="puntos de grilla por coeficiente")
+    args = p.parse_args()
+    if not 0.0 < args.f_pass < args.f_stop < args.spb / 2.0:
+        p.error("se necesita 0 < pass < stop < spb / 2")
+
+    f_pass = args.f_pass / args.spb
+    f_stop = args.f_stop / args.spb
+    # Pesos de firpmord: inversamente proporcionales a los desvíos pedidos
+    g = 10.0 ** (args.ripple / 20.0)
+    weight = ((g - 1.0) / (g + 1.0)) / 10.0 ** (-args.atten / 20.0)
+    h = [to_float(v) for v in design(args.taps, f_pass, f_stop, weight, args.density)]
+
+    grid = [0.5 * i / 2048 for i in range(2049)]
+    ripple = max(abs(response_db(h, f)) for f in grid if f <= f_pass)
+    stop = max(response_db(h, f) for f in grid if f >= f_stop)
+    sys.stderr.write("DC %.2f dB, passband ripple %.2f dB, stopband %.1f dB\n"
+                     % (response_db(h, 0.0), ripple, stop))
+    sys.stdout.write(emit(h, args.spb, args, ripple, stop))
+
+
+if __name__ == "__main__":
+    main()
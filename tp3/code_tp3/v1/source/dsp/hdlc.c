@@ -0,0 +1,304 @@
+/**
+ * @file hdlc.c
+ * @brief Implementación del modo paquete HDLC (flags, stuffing, NRZI, FCS).
+ */
+
+#include "hdlc.h"
+
+/**
+ * @brief Qué lleva shift en el transmisor.
+ */
+enum
+{
+    HDLC_TX_FLAG,   /**< Flags entre paquetes. */
+    HDLC_TX_DATA,   /**< Byte de datos. */
+    HDLC_TX_FCS,    /**< Los 16 bits del FCS. */
+};
+
+/**
+ * @brief CRC-16/X.25 de a 4 bits: 16 entradas en vez de 256.
+ */
+static const uint16_t crc_nibble[16] =
+{
+    0x0000, 0x1081, 0x2102, 0x3183, 0x4204, 0x5285, 0x6306, 0x7387,
+    0x8408, 0x9489, 0xA50A, 0xB58B, 0xC60C, 0xD68D, 0xE70E, 0xF78F,
+};
+
+/**
+ * @brief Acumula un byte en el CRC-16/X.25 (polinomio 0x1021 reflejado).
+ *
+ * @param crc CRC parcial (HDLC_CRC_INIT al empezar).
+ * @param byte Byte a acumular.
+ * @return CRC actualizado.
+ */
+uint16_t Hdlc_Crc16(uint16_t crc, uint8_t byte)
+{
+    crc ^= byte;
+    crc = (crc >> 4) ^ crc_nibble[crc & 0x0Fu];
+    crc = (crc >> 4) ^ crc_nibble[crc & 0x0Fu];
+    return crc;
+}
+
+/**
+ * @brief Inicializa el transmisor mandando flags.
+ *
+ * @param tx Transmisor.
+ * @param pull Fuente de bytes.
+ * @param avail Bytes esperando en la fuente.
+ * @param user Cookie para pull y avail.
+ */
+void HdlcTx_Init(HdlcTx *tx, HdlcTx_PullFn pull, HdlcTx_AvailFn avail, void *user)
+{
+    tx->pull = pull;
+    tx->avail = avail;
+    tx->user = user;
+    tx->state = HDLC_TX_FLAG;
+    tx->bits_left = 0;
+    tx->stuff = false;
+    tx->ones = 0;
+    tx->level = true;
+    tx->shift = 0;
+    tx->crc = HDLC_CRC_INIT;
+    tx->len = 0;
+    tx->flags_left = HDLC_PREAMBLE_FLAGS;
+    tx->wait_bits = 0;
+    tx->bits = 0;
+    tx->bytes = 0;
+    tx->packets = 0;
+}
+
+/**
+ * @brief Carga en shift lo próximo a mandar: flag, byte de datos o FCS.
+ *
+ * @param tx Transmisor.
+ */
+static void txLoad(HdlcTx *tx)
+{
+    uint8_t byte;
+
+    switch (tx->state)
+    {
+    case HDLC_TX_FLAG:
+    {
+        size_t avail = (tx->avail != NULL) ? tx->avail(tx->user) : 0;
+        if (tx->flags_left == 0 && avail > 0
+            && (avail >= HDLC_MAX_PAYLOAD || tx->wait_bits >= HDLC_HOLD_BITS)
+            && tx->pull(tx->user, &byte))
+        {
+            // the flag just sent opens the packet
+            tx->state = HDLC_TX_DATA;
+            tx->crc = HDLC_CRC_INIT;
+            tx->len = 0;
+            tx->wait_bits = 0;
+            tx->ones = 0;
+            break;
+        }
+        if (tx->flags_left > 0)
+        {
+            tx->flags_left--;
+        }
+        else if (avail > 0 && tx->wait_bits < HDLC_HOLD_BITS)
+        {
+            tx->wait_bits += 8u;
+        }
+        tx->shift = HDLC_FLAG;
+        tx->bits_left = 8;
+        tx->stuff = false;
+        return;
+    }
+
+    case HDLC_TX_DATA:
+        if (tx->len < HDLC_MAX_PAYLOAD && tx->pull(tx->user, &byte))
+        {
+            break;
+        }
+        // out of bytes or full: FCS, low byte first
+        tx->shift = tx->crc ^ 0xFFFFu;
+        tx->bits_left = 16;
+        tx->stuff = true;
+        tx->state = HDLC_TX_FCS;
+        return;
+
+    default: // HDLC_TX_FCS sent: closing flag
+        tx->packets++;
+        tx->state = HDLC_TX_FLAG;
+        tx->shift = HDLC_FLAG;
+        tx->bits_left = 8;
+        tx->stuff = false;
+        return;
+    }
+
+    tx->crc = Hdlc_Crc16(tx->crc, byte);
+    tx->len++;
+    tx->bytes++;
+    tx->shift = byte;
+    tx->bits_left = 8;
+    tx->stuff = true;
+}
+
+/**
+ * @brief Próximo nivel de la línea (true = mark); llamar una vez por período de bit.
+ *
+ * @param tx Transmisor.
+ * @return Nivel a modular.
+ */
+bool HdlcTx_NextBit(HdlcTx *tx)
+{
+    tx->bits++;
+
+    bool bit;
+    if (tx->stuff && tx->ones == 5)
+    {
+        bit = false;        // stuffed zero, shift stays put
+        tx->ones = 0;
+    }
+    else
+    {
+        if (tx->bits_left == 0)
+        {
+            txLoad(tx);
+        }
+        bit = tx->shift & 1u;
+        tx->shift >>= 1;
+        tx->bits_left--;
+        if (tx->stuff)
+        {
+            tx->ones = bit ? tx->ones + 1u : 0u;
+        }
+    }
+
+    // NRZI: a zero toggles the tone, a one keeps it
+    if (!bit)
+    {
+        tx->level = !tx->level;
+    }
+    return tx->level;
+}
+
+/**
+ * @brief Indica si hay un paquete en el aire (datos o FCS, no flags).
+ *
+ * @param tx Transmisor.
+ * @return True entre el flag de apertura y el de cierre.
+ */
+bool HdlcTx_Busy(const HdlcTx *tx)
+{
+    return tx->state != HDLC_TX_FLAG;
+}
+
+/**
+ * @brief Inicializa el receptor buscando flag.
+ *
+ * @param rx Receptor.
+ */
+void HdlcRx_Init(HdlcRx *rx)
+{
+    rx->level = true;
+    rx->in_frame = false;
+    rx->ones = 0;
+    rx->bit_cnt = 0;
+    rx->byte = 0;
+    rx->len = 0;
+    rx->payload_len = 0;
+    rx->packets = 0;
+    rx->crc_errors = 0;
+    rx->aborts = 0;
+}
+
+/**
+ * @brief Cierra la trama en curso al recibir un flag.
+ *
+ * Los 7 primeros bits del flag (0111111) ya entraron como datos, así que una
+ * trama que terminó en un límite de byte tiene bit_cnt == 7.
+ *
+ * @param rx Receptor.
+ * @return True si la trama era un paquete válido.
+ */
+static bool rxClose(HdlcRx *rx)
+{
+    if (!rx->in_frame || rx->len == 0)
+    {
+        return false;   // idle flags
+    }
+    if (rx->bit_cnt == 7 && rx->len > 2)
+    {
+        uint16_t crc = HDLC_CRC_INIT;
+        for (uint16_t i = 0; i < rx->len; i++)
+        {
+            crc = Hdlc_Crc16(crc, rx->buf[i]);
+        }
+        if (crc == HDLC_CRC_GOOD)
+        {
+            rx->payload_len = rx->len - 2u;
+            rx->packets++;
+            return true;
+        }
+    }
+    rx->crc_errors++;
+    return false;
+}
+
+/**
+ * @brief Entrega un nivel de línea decidido por el demodulador.
+ *
+ * @param rx Receptor.
+ * @param level Nivel del bit (true = mark).
+ * @return True si terminó un paquete válido (rx->payload_len bytes en rx->buf).
+ */
+bool HdlcRx_PushBit(HdlcRx *rx, bool level)
+{
+    bool bit = (level == rx->level);    // NRZI: no change is a one
+    rx->level = level;
+
+    if (bit)
+    {
+        if (++rx->ones >= 7)
+        {
+            // abort (or idle mark): drop the frame and hunt for a flag
+            if (rx->in_frame && rx->len > 0)
+            {
+                rx->aborts++;
+            }
+            rx->in_frame = false;
+            rx->ones = 7;
+            return false;
+        }
+    }
+    else
+    {
+        uint8_t ones = rx->ones;
+        rx->ones = 0;
+        if (ones == 5)
+        {
+            return false;   // stuffed zero
+        }
+        if (ones == 6)
+        {
+            // the flag closes one frame and opens the next; a good payload
+            // stays in buf until the next byte completes
+            bool good = rxClose(rx);
+            rx->in_frame = true;
+            rx->len = 0;
+            rx->bit_cnt = 0;
+            return good;
+        }
+    }
+
+    if (!rx->in_frame)
+    {
+        return false;
+    }
+    rx->byte = (uint8_t)((rx->byte >> 1) | (bit ? 0x80u : 0u));
+    if (++rx->bit_cnt == 8)
+    {
+        rx->bit_cnt = 0;
+        if (rx->len >= sizeof(rx->buf))
+        {
+            rx->aborts++;
+            rx->in_frame = false;
+            return false;
+        }
+        rx->buf[rx->len++] = rx->byte;
+    }
+    return false;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file hdlc.h
+ * @brief Modo paquete sobre el enlace FSK: tramas HDLC como en AX.25/Bell 202.
+ *
+ * Cada paquete va entre flags (0x7E), los bytes salen LSB primero con bit
+ * stuffing (un 0 después de cinco 1 seguidos) y cierra con el FCS de 16 bits
+ * de HDLC (CRC-16/X.25). Sobre la línea va en NRZI: un 0 cambia de tono y un
+ * 1 lo mantiene, así el receptor no depende de la polaridad MARK/SPACE y el
+ * stuffing garantiza una transición al menos cada 6 bits para el reloj.
+ *
+ * A diferencia del modo UART (tx_sched.h) no hay start/stop por byte: el
+ * costo es un flag y el FCS por paquete, más el stuffing (~1.6 % con datos
+ * al azar). Entre paquetes se mandan flags, que mantienen enganchado el
+ * reloj del receptor.
+ *
+ * HdlcTx_NextBit() corre en el contexto del NCO (ISR del DMA), igual que
+ * TxSched_NextBit(). HdlcRx_PushBit() recibe los niveles de línea que decide
+ * demodFSK_ProcessBlockBits(), en el ISR del ADC.
+ */
+
+#ifndef _HDLC_H_
+#define _HDLC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// ---- Perillas de tiempo de compilación ----
+
+/**
+ * @def HDLC_MAX_PAYLOAD
+ * @brief Bytes de datos por paquete como máximo (sin el FCS).
+ */
+#ifndef HDLC_MAX_PAYLOAD
+#define HDLC_MAX_PAYLOAD (64u)
+#endif
+
+/**
+ * @def HDLC_HOLD_BITS
+ * @brief Bits de flag que se espera a juntar HDLC_MAX_PAYLOAD bytes antes de
+ * mandar un paquete más corto. Más espera = paquetes más largos y menos
+ * overhead, a costa de latencia.
+ */
+#ifndef HDLC_HOLD_BITS
+#define HDLC_HOLD_BITS (64u)
+#endif
+
+/**
+ * @def HDLC_PREAMBLE_FLAGS
+ * @brief Flags que se mandan desde HdlcTx_Init() antes del primer paquete,
+ * para que el receptor enganche el reloj de bit.
+ */
+#ifndef HDLC_PREAMBLE_FLAGS
+#define HDLC_PREAMBLE_FLAGS (16u)
+#endif
+
+/**
+ * @def HDLC_FLAG
+ * @brief Delimitador de tramas.
+ */
+#define HDLC_FLAG (0x7Eu)
+
+/**
+ * @def HDLC_CRC_INIT
+ * @brief Valor inicial del CRC-16/X.25.
+ */
+#define HDLC_CRC_INIT (0xFFFFu)
+
+/**
+ * @def HDLC_CRC_GOOD
+ * @brief Resto del CRC calculado sobre datos + FCS cuando no hay errores.
+ */
+#define HDLC_CRC_GOOD (0xF0B8u)
+
+/**
+ * @brief Saca el próximo byte a transmitir (misma firma que TxSched_PullFn).
+ *
+ * @param user Cookie de HdlcTx_Init().
+ * @param byte Destino del byte.
+ * @return True si había un byte, false si la cola está vacía.
+ */
+typedef bool (*HdlcTx_PullFn)(void *user, uint8_t *byte);
+
+/**
+ * @brief Bytes esperando en la cola, para decidir cuándo abrir un paquete.
+ *
+ * @param user Cookie de HdlcTx_Init().
+ * @return Cantidad de bytes que pull puede entregar ya.
+ */
+typedef size_t (*HdlcTx_AvailFn)(void *user);
+
+/**
+ * @brief Estado del transmisor.
+ */
+typedef struct
+{
+    HdlcTx_PullFn pull;         /**< Fuente de bytes. */
+    HdlcTx_AvailFn avail;       /**< Bytes esperando en la fuente. */
+    void *user;                 /**< Cookie para pull y avail. */
+    uint8_t state;              /**< Flag, datos o FCS (privado). */
+    uint8_t bits_left;          /**< Bits pendientes en shift. */
+    bool stuff;                 /**< Los bits de shift llevan stuffing. */
+    uint8_t ones;               /**< Unos seguidos con stuffing. */
+    bool level;                 /**< Tono actual (true = mark). */
+    uint16_t shift;             /**< Byte o FCS en curso, LSB primero. */
+    uint16_t crc;               /**< CRC del paquete en curso. */
+    uint16_t len;               /**< Bytes de datos del paquete en curso. */
+    uint16_t flags_left;        /**< Flags obligatorios antes de abrir. */
+    uint16_t wait_bits;         /**< Bits de flag con datos esperando. */
+    volatile uint32_t bits;     /**< Bits emitidos desde HdlcTx_Init(). */
+    volatile uint32_t bytes;    /**< Bytes de datos emitidos. */
+    volatile uint32_t packets;  /**< Paquetes cerrados. */
+} HdlcTx;
+
+/**
+ * @brief Estado del receptor.
+ */
+typedef struct
+{
+    bool level;                 /**< Último nivel de línea (NRZI). */
+    bool in_frame;              /**< Hubo un flag y no un abort. */
+    uint8_t ones;               /**< Unos seguidos recibidos. */
+    uint8_t bit_cnt;            /**< Bits en byte. */
+    uint8_t byte;               /**< Byte en construcción, LSB primero. */
+    uint16_t len;               /**< Bytes en buf de la trama en curso. */
+    uint16_t payload_len;       /**< Bytes de datos del último paquete válido. */
+    uint8_t buf[HDLC_MAX_PAYLOAD + 2u]; /**< Datos + FCS del paquete en curso. */
+    uint32_t packets;           /**< Paquetes con FCS correcto. */
+    uint32_t crc_errors;        /**< Paquetes descartados por FCS. */
+    uint32_t aborts;            /**< Paquetes cortados (7 unos o demasiado largos). */
+} HdlcRx;
+
+/**
+ * @brief Acumula un byte en el CRC-16/X.25 (polinomio 0x1021 reflejado).
+ *
+ * @param crc CRC parcial (HDLC_CRC_INIT al empezar).
+ * @param byte Byte a acumular.
+ * @return CRC actualizado. El FCS que se transmite es su complemento.
+ */
+uint16_t Hdlc_Crc16(uint16_t crc, uint8_t byte);
+
+/**
+ * @brief Inicializa el transmisor mandando flags.
+ *
+ * @param tx Transmisor.
+ * @param pull Fuente de bytes.
+ * @param avail Bytes esperando en la fuente.
+ * @param user Cookie para pull y avail.
+ */
+void HdlcTx_Init(HdlcTx *tx, HdlcTx_PullFn pull, HdlcTx_AvailFn avail, void *user);
+
+/**
+ * @brief Próximo nivel de la línea (true = mark) para NCO_FskBit(); llamar
+ * una vez por período de bit.
+ *
+ * Abre un paquete cuando hay HDLC_MAX_PAYLOAD bytes esperando o cuando los
+ * que hay ya esperaron HDLC_HOLD_BITS, y lo cierra al llegar a
+ * HDLC_MAX_PAYLOAD o cuando pull se queda sin bytes.
+ *
+ * @param tx Transmisor.
+ * @return Nivel a modular.
+ */
+bool HdlcTx_NextBit(HdlcTx *tx);
+
+/**
+ * @brief Indica si hay un paquete en el aire (datos o FCS, no flags).
+ *
+ * @param tx Transmisor.
+ * @return True entre el flag de apertura y el de cierre.
+ */
+bool HdlcTx_Busy(const HdlcTx *tx);
+
+/**
+ * @brief Inicializa el receptor buscando flag.
+ *
+ * @param rx Receptor.
+ */
+void HdlcRx_Init(HdlcRx *rx);
+
+/**
+ * @brief Entrega un nivel de línea decidido por el demodulador.
+ *
+ * Deshace NRZI y el stuffing, busca flags y chequea el FCS de cada trama.
+ * Las tramas vacías (flags seguidos) se ignoran sin contar errores.
+ *
+ * @param rx Receptor.
+ * @param level Nivel del bit (true = mark).
+ * @return True si terminó un paquete válido: sus rx->payload_len bytes de
+ * datos quedan al principio de rx->buf hasta la próxima llamada.
+ */
+bool HdlcRx_PushBit(HdlcRx *rx, bool level);
+
+#endif // _HDLC_H_
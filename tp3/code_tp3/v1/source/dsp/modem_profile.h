@@ -0,0 +1,80 @@
+/**
+ * @file modem_profile.h
+ * @brief Perfil del módem FSK: baud rate y todas las constantes de tiempo
+ * que se derivan de él.
+ *
+ * Todo el módem está escalado al baud rate: las frecuencias de MARK/SPACE,
+ * la frecuencia de muestreo del ADC, la del DAC y el bit clock. Así el
+ * discriminador (DELAY muestras) y el FIR de fir_coefs.h, que están
+ * normalizados a FS_ADC = MODEM_SAMPLES_PER_BIT * baud, sirven igual para
+ * cualquier perfil sin recalcular coeficientes. Si se cambia
+ * MODEM_SAMPLES_PER_BIT hay que regenerar fir_coefs.h con gen_fir_coefs.py.
+ *
+ * Perfiles soportados (MODEM_BAUD):
+ *   1200: MARK 1200 Hz, SPACE 2200 Hz, ADC 12 kHz, DAC  50 kHz (Bell 202)
+ *   2400: MARK 2400 Hz, SPACE 4400 Hz, ADC 24 kHz, DAC 100 kHz
+ *   4800: MARK 4800 Hz, SPACE 8800 Hz, ADC 48 kHz, DAC 200 kHz
+ */
+
+#ifndef _MODEM_PROFILE_H_
+#define _MODEM_PROFILE_H_
+
+// ---- Perillas de tiempo de compilación ----
+
+/**
+ * @def MODEM_BAUD
+ * @brief Baud rate del módem (1200, 2400 o 4800).
+ */
+#ifndef MODEM_BAUD
+#define MODEM_BAUD 1200u
+#endif
+
+#if (MODEM_BAUD != 1200u) && (MODEM_BAUD != 2400u) && (MODEM_BAUD != 4800u)
+#error "MODEM_BAUD must be 1200, 2400 or 4800"
+#endif
+
+// ---- Constantes derivadas ----
+
+/**
+ * @def MODEM_SAMPLES_PER_BIT
+ * @brief Muestras del ADC por bit (FS_ADC / baud).
+ */
+#define MODEM_SAMPLES_PER_BIT 10
+
+/**
+ * @def MODEM_F_MARK
+ * @brief Frecuencia del '1' en Hz (igual al baud rate).
+ */
+#define MODEM_F_MARK (MODEM_BAUD)
+
+/**
+ * @def MODEM_F_SPACE
+ * @brief Frecuencia del '0' en Hz (11/6 del baud rate, 2200 Hz a 1200 Bd).
+ */
+#define MODEM_F_SPACE ((MODEM_BAUD * 11u) / 6u)
+
+/**
+ * @def MODEM_FS_ADC
+ * @brief Frecuencia de muestreo del ADC en Hz.
+ */
+#define MODEM_FS_ADC (MODEM_BAUD * MODEM_SAMPLES_PER_BIT)
+
+/**
+ * @def MODEM_FS_DAC
+ * @brief Frecuencia de refresco del DAC (NCO) en Hz, 50 kHz a 1200 Bd.
+ *
+ * A 4800 Bd son 200 kHz: con la ISR por muestra del PIT no da el tiempo,
+ * hace falta alimentar el DAC por DMA.
+ */
+#define MODEM_FS_DAC ((MODEM_BAUD * 125u) / 3u)
+
+/**
+ * @def MODEM_DELAY
+ * @brief Retardo del discriminador en muestras del ADC (medio bit).
+ *
+ * Con MARK = baud y SPACE = 11/6 baud, medio bit de retardo deja
+ * cos(2 pi f tau) en -1 para MARK y en ~+0.87 para SPACE.
+ */
+#define MODEM_DELAY (MODEM_SAMPLES_PER_BIT / 2)
+
+#endif // _MODEM_PROFILE_H_
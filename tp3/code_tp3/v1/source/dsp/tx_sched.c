@@ -0,0 +1,112 @@
+/**
+ * @file tx_sched.c
+ * @brief Implementación del planificador de transmisión.
+ */
+
+#include <stddef.h>
+
+#include "tx_sched.h"
+#include "bitstream.h"
+
+/**
+ * @brief Inicializa el planificador en idle.
+ *
+ * @param s Planificador.
+ * @param guard_bits Bits de mark después de cada stop (TX_SCHED_GUARD_BITS).
+ * @param pull Fuente de bytes.
+ * @param user Cookie para pull.
+ */
+void TxSched_Init(TxSched *s, uint8_t guard_bits, TxSched_PullFn pull, void *user)
+{
+    s->pull = pull;
+    s->user = user;
+    s->guard_bits = guard_bits;
+    s->bits_left = 0;
+    s->guard_left = 0;
+    s->shift = 0;
+    s->bits = 0;
+    s->idle_bits = 0;
+    s->bytes = 0;
+    s->last_bits = 0;
+    s->last_bytes = 0;
+}
+
+/**
+ * @brief Próximo bit de la línea (true = mark); llamar una vez por período de bit.
+ *
+ * @param s Planificador.
+ * @return Bit a modular.
+ */
+bool TxSched_NextBit(TxSched *s)
+{
+    s->bits++;
+
+    if (s->bits_left == 0)
+    {
+        if (s->guard_left > 0)
+        {
+            s->guard_left--;
+            return true;
+        }
+        uint8_t byte;
+        if (s->pull == NULL || !s->pull(s->user, &byte))
+        {
+            s->idle_bits++;
+            return true;
+        }
+        s->shift = data_to_uart(byte);
+        s->bits_left = BITSTREAM_SIZE;
+    }
+
+    bool bit = s->shift & 1u;
+    s->shift >>= 1;
+    if (--s->bits_left == 0)
+    {
+        // the stop bit is going out: the byte counts and the guard follows
+        s->bytes++;
+        s->guard_left = s->guard_bits;
+    }
+    return bit;
+}
+
+/**
+ * @brief Indica si hay un frame (o su guarda) en el aire.
+ *
+ * @param s Planificador.
+ * @return True entre el bit de start y el último bit de guarda.
+ */
+bool TxSched_Busy(const TxSched *s)
+{
+    return s->bits_left != 0 || s->guard_left != 0;
+}
+
+/**
+ * @brief Throughput desde la medición anterior, medido con el propio reloj de bit.
+ *
+ * @param s Planificador.
+ * @param baud Tasa de bits de la línea.
+ * @param window_bits Bits mínimos desde la medición anterior.
+ * @param out Resultado; solo se escribe si se devuelve true.
+ * @return True si pasaron al menos window_bits bits.
+ */
+bool TxSched_Measure(TxSched *s, uint32_t baud, uint32_t window_bits, TxSched_Rate *out)
+{
+    // bits and bytes move together in the ISR; read bytes first so a byte
+    // finishing in between only shows up in the next window
+    uint32_t bytes = s->bytes;
+    uint32_t bits = s->bits;
+    uint32_t d_bits = bits - s->last_bits;
+    if (d_bits == 0 || d_bits < window_bits)
+    {
+        return false;
+    }
+    uint32_t d_bytes = bytes - s->last_bytes;
+    s->last_bits = bits;
+    s->last_bytes = bytes;
+
+    out->bytes_per_s = (uint32_t)(((uint64_t)d_bytes * baud) / d_bits);
+    out->line_bytes_per_s = baud / BITSTREAM_SIZE;
+    uint64_t busy = (uint64_t)d_bytes * (BITSTREAM_SIZE + s->guard_bits) * 1000u / d_bits;
+    out->busy_permille = busy > 1000u ? 1000u : (uint32_t)busy;
+    return true;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file tx_sched.h
+ * @brief Planificador de transmisión: arma la secuencia de bits del módem a
+ * partir de una cola de bytes.
+ *
+ * Los bytes salen pegados: frame UART (data_to_uart) más guard_bits bits de
+ * mark extra, y el byte siguiente arranca en el bit inmediato. Solo con la
+ * cola vacía se emite idle (mark), de a un bit, así un byte que llega espera
+ * a lo sumo un período de bit y no un frame de idle entero.
+ *
+ * TxSched_NextBit() corre en el contexto del NCO (ISR del DMA) y saca los
+ * bytes con un callback, sin saber cómo es la cola. Los contadores de bits y
+ * bytes los escribe solo ese lado; TxSched_Measure() los lee desde el loop
+ * principal.
+ */
+
+#ifndef _TX_SCHED_H_
+#define _TX_SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ---- Perillas de tiempo de compilación ----
+
+/**
+ * @def TX_SCHED_GUARD_BITS
+ * @brief Bits de mark agregados después del stop de cada byte (0 = frames pegados).
+ */
+#ifndef TX_SCHED_GUARD_BITS
+#define TX_SCHED_GUARD_BITS (0u)
+#endif
+
+/**
+ * @brief Saca el próximo byte a transmitir.
+ *
+ * @param user Cookie de TxSched_Init().
+ * @param byte Destino del byte.
+ * @return True si había un byte, false si la cola está vacía.
+ */
+typedef bool (*TxSched_PullFn)(void *user, uint8_t *byte);
+
+/**
+ * @brief Estado del planificador.
+ */
+typedef struct
+{
+    TxSched_PullFn pull;        /**< Fuente de bytes. */
+    void *user;                 /**< Cookie para pull. */
+    uint8_t guard_bits;         /**< Mark extra después de cada stop. */
+    uint8_t bits_left;          /**< Bits del frame en curso, 0 = entre frames. */
+    uint8_t guard_left;         /**< Bits de guarda pendientes. */
+    uint16_t shift;             /**< Frame en curso, LSB primero. */
+    volatile uint32_t bits;     /**< Bits emitidos desde TxSched_Init(). */
+    volatile uint32_t idle_bits;/**< De esos, los emitidos con la cola vacía. */
+    volatile uint32_t bytes;    /**< Bytes emitidos completos. */
+    uint32_t last_bits;         /**< Contadores en el último TxSched_Measure(). */
+    uint32_t last_bytes;
+} TxSched;
+
+/**
+ * @brief Resultado de una medición de throughput.
+ */
+typedef struct
+{
+    uint32_t bytes_per_s;       /**< Bytes por segundo logrados en la ventana. */
+    uint32_t line_bytes_per_s;  /**< Tope teórico: baud / BITSTREAM_SIZE. */
+    uint32_t busy_permille;     /**< Fracción de la ventana con datos, en ‰. */
+} TxSched_Rate;
+
+/**
+ * @brief Inicializa el planificador en idle.
+ *
+ * @param s Planificador.
+ * @param guard_bits Bits de mark después de cada stop (TX_SCHED_GUARD_BITS).
+ * @param pull Fuente de bytes.
+ * @param user Cookie para pull.
+ */
+void TxSched_Init(TxSched *s, uint8_t guard_bits, TxSched_PullFn pull, void *user);
+
+/**
+ * @brief Próximo bit de la línea (true = mark); llamar una vez por período de bit.
+ *
+ * @param s Planificador.
+ * @return Bit a modular.
+ */
+bool TxSched_NextBit(TxSched *s);
+
+/**
+ * @brief Indica si hay un frame (o su guarda) en el aire.
+ *
+ * @param s Planificador.
+ * @return True entre el bit de start y el último bit de guarda.
+ */
+bool TxSched_Busy(const TxSched *s);
+
+/**
+ * @brief Throughput desde la medición anterior, medido con el propio reloj de bit.
+ *
+ * No depende de ningún timer: el tiempo transcurrido son los bits emitidos
+ * divididos por baud.
+ *
+ * @param s Planificador.
+ * @param baud Tasa de bits de la línea.
+ * @param window_bits Bits mínimos desde la medición anterior.
+ * @param out Resultado; solo se escribe si se devuelve true.
+ * @return True si pasaron al menos window_bits bits.
+ */
+bool TxSched_Measure(TxSched *s, uint32_t baud, uint32_t window_bits, TxSched_Rate *out);
+
+#endif // _TX_SCHED_H_
@@ -0,0 +1,97 @@
+/**
+ * @file bench_common.h
+ * @brief Utilidades compartidas por los benchmarks de host de este directorio.
+ *
+ * Solo header (funciones static inline), así cada bench sigue compilando con
+ * la misma línea de gcc. Incluir después de definir _POSIX_C_SOURCE.
+ * make_signal() usa data_to_uart() (../dsp/bitstream.c) y gauss() libm.
+ */
+
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../dsp/bitstream.h"
+#include "../dsp/modem_profile.h"
+#include "../drv/hal/NCO.h"
+
+/**
+ * @brief Tiempo monotónico en segundos.
+ */
+static inline double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Muestra gaussiana de media 0 y varianza 1 (Box-Muller sobre rand()).
+ */
+static inline float gauss(void)
+{
+    float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    float u2 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+/**
+ * @brief Escribe n_bits bits iguales del NCO a MODEM_FS_ADC en out[*pos...].
+ */
+static inline void put_bits(NCO_Handle *nco, uint16_t *out, size_t *pos,
+                            bool bit, unsigned n_bits)
+{
+    NCO_FskBit(nco, bit);
+    for (unsigned s = 0; s < n_bits * MODEM_SAMPLES_PER_BIT; s++)
+    {
+        out[(*pos)++] = (uint16_t)NCO_TickQ15(nco);
+    }
+}
+
+/**
+ * @brief Genera una señal FSK limpia a MODEM_FS_ADC, fase continua.
+ *
+ * lead_bits de idle, n_frames frames UART con datos de rand() seguidos de
+ * gap_bits de idle cada uno, y idle hasta completar n_out muestras (de a bit
+ * entero).
+ *
+ * @param payload Si no es NULL recibe los n_frames datos transmitidos.
+ * @return Muestras escritas.
+ */
+static inline size_t make_signal(uint16_t *out, size_t n_out,
+                                 uint16_t *payload, size_t n_frames,
+                                 unsigned lead_bits, unsigned gap_bits)
+{
+    NCO_Handle nco;
+    NCO_InitFixed(&nco, TW32_ROUND(MODEM_F_MARK, MODEM_FS_ADC),
+                  TW32_ROUND(MODEM_F_SPACE, MODEM_FS_ADC), true);
+    size_t pos = 0;
+    put_bits(&nco, out, &pos, true, lead_bits);
+    for (size_t f = 0; f < n_frames; f++)
+    {
+        uint16_t data = (uint16_t)(rand() & BITSTREAM_DATA_MASK);
+        if (payload != NULL)
+        {
+            payload[f] = data;
+        }
+        uint16_t frame = data_to_uart(data);
+        for (unsigned b = 0; b < BITSTREAM_SIZE; b++)
+        {
+            put_bits(&nco, out, &pos, (frame >> b) & 1u, 1);
+        }
+        put_bits(&nco, out, &pos, true, gap_bits);
+    }
+    while (pos + MODEM_SAMPLES_PER_BIT <= n_out)
+    {
+        put_bits(&nco, out, &pos, true, 1);
+    }
+    return pos;
+}
+
+#endif // BENCH_COMMON_H
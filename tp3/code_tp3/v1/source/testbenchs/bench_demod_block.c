@@ -0,0 +1,126 @@
+/**
+ * @file bench_demod_block.c
+ * @brief Benchmark de host: demodFSK por muestra vs demodFSK_ProcessBlock.
+ *
+ * Genera una señal FSK con el NCO directamente a FS_ADC, la demodula por los
+ * dos caminos, verifica que ambos recuperen los mismos frames y reporta
+ * muestras/segundo de cada uno. Con DEMOD_FSK_TIMING_RECOVERY en 1 los
+ * caminos coinciden solo porque la señal es limpia y a la frecuencia exacta;
+ * con 0 coinciden siempre. Compilar desde este directorio con:
+ *   gcc -O3 -Wall -Wextra -std=c11 -o bench_demod_block bench_demod_block.c
+ *       ../dsp/demod_fsk.c ../dsp/bitstream.c ../drv/hal/NCO.c
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../dsp/demod_fsk.h"
+#include "bench_common.h"
+
+#define SAMPLES_PER_BIT MODEM_SAMPLES_PER_BIT
+#define N_FRAMES 8192u
+#define GAP_BITS 11u            // one idle frame between bytes, as app.c
+#define LEAD_BITS 22u           // idle before the first byte
+#define N_SAMPLES ((N_FRAMES * (BITSTREAM_SIZE + GAP_BITS) + LEAD_BITS) \
+                   * SAMPLES_PER_BIT)
+#define DMA_BLOCK 64u           // RX_BLOCK_SIZE in app.c (one DMA half)
+#define MAX_FRAMES (N_FRAMES + 1u)  // + the power-up frame, see main()
+#define RUNS 5
+
+static uint16_t signal[N_SAMPLES];
+static uint16_t payload[N_FRAMES];
+static uint16_t frames_sample[MAX_FRAMES];
+static uint16_t frames_block[MAX_FRAMES];
+static uint16_t frames_sample_ref[MAX_FRAMES];
+static uint16_t frames_block_ref[MAX_FRAMES];
+
+static size_t run_per_sample(void)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < N_SAMPLES; i++)
+    {
+        bitstreamReconstruction(demodFSK(signal[i]));
+        if (isDataReady())
+        {
+            uint16_t frame = retrieveBitstream();
+            if (n < MAX_FRAMES)
+            {
+                frames_sample[n] = frame;
+            }
+            n++;
+        }
+    }
+    return n;
+}
+
+static size_t run_block(void)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < N_SAMPLES; i += DMA_BLOCK)
+    {
+        n += demodFSK_ProcessBlock(&signal[i], DMA_BLOCK, &frames_block[n],
+                                   MAX_FRAMES - n);
+    }
+    return n;
+}
+
+int main(void)
+{
+    make_signal(signal, N_SAMPLES, payload, N_FRAMES, LEAD_BITS, GAP_BITS);
+
+    // Every pass starts from reset and decodes the same frames, the first
+    // one is checked. Throughput is the best pass.
+    double t_sample = 1e9, t_block = 1e9;
+    size_t n_sample = 0, n_block = 0;
+    unsigned repeat_errors = 0;
+    for (int r = 0; r < RUNS; r++)
+    {
+        demodFSK_Reset();
+        demodFSK_ResetBlock();
+        double t0 = now_s();
+        size_t n = run_per_sample();
+        double t = now_s() - t0;
+        repeat_errors += r && (n != n_sample);
+        n_sample = r ? n_sample : n;
+        t_sample = (t < t_sample) ? t : t_sample;
+
+        t0 = now_s();
+        n = run_block();
+        t = now_s() - t0;
+        repeat_errors += r && (n != n_block);
+        n_block = r ? n_block : n;
+        t_block = (t < t_block) ? t : t_block;
+
+        if (r == 0)
+        {
+            // keep the first pass for the check below
+            for (unsigned f = 0; f < MAX_FRAMES; f++)
+            {
+                frames_sample_ref[f] = frames_sample[f];
+                frames_block_ref[f] = frames_block[f];
+            }
+        }
+    }
+
+    // Both paths start from an all-zero FIR: its step response looks like a
+    // start bit and they decode one all-ones frame before the first byte.
+    unsigned errors = repeat_errors;
+    for (unsigned f = 0; f < MAX_FRAMES; f++)
+    {
+        errors += (frames_sample_ref[f] != frames_block_ref[f]);
+        if (f > 0)
+        {
+            errors += (uart_to_data(frames_block_ref[f]) != payload[f - 1]);
+        }
+    }
+
+    printf("frames: per-sample %zu, block %zu, expected %u, mismatches %u\n",
+           n_sample, n_block, MAX_FRAMES, errors);
+    printf("per-sample: %.3f Msamples/s\n", N_SAMPLES / t_sample * 1e-6);
+    printf("block:      %.3f Msamples/s (x%.2f)\n", N_SAMPLES / t_block * 1e-6,
+           t_sample / t_block);
+
+    return (n_block == MAX_FRAMES && n_sample == MAX_FRAMES && !errors) ? 0 : 1;
+}
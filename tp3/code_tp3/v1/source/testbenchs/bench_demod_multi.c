@@ -0,0 +1,165 @@
+/**
+ * @file bench_demod_multi.c
+ * @brief Benchmark de host: DemodFSK_Handle multicanal vs un canal por vez.
+ *
+ * Arma un buffer con DEMOD_FSK_MAX_CH canales FSK entrelazados (cada uno con
+ * sus propios bytes y su propio desfasaje), lo demodula con un único handle y
+ * compara canal por canal contra demodFSK_ProcessBlockQ15(). Reporta muestras
+ * por segundo (sumando canales) de ambos, y del camino de un canal por vez
+ * sobre el buffer entrelazado (desentrelazar cada bloque DMA antes de cada
+ * llamada), que es la alternativa real al handle en el firmware. El handle
+ * no comparte cuentas entre canales, así que lo esperable es x1 contra
+ * ambos (en este host da x0.9-1.0). También demodula el buffer entero en
+ * una sola llamada, más de 65535 muestras por canal, y chequea que pos no se
+ * trunque y que salgan los mismos frames. Compilar desde este directorio con:
+ *   gcc -O3 -Wall -Wextra -std=c11 -o bench_demod_multi bench_demod_multi.c
+ *       ../dsp/demod_fsk.c ../dsp/bitstream.c ../drv/hal/NCO.c
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../dsp/demod_fsk.h"
+#include "bench_common.h"
+
+#define SAMPLES_PER_BIT MODEM_SAMPLES_PER_BIT
+#define N_CH DEMOD_FSK_MAX_CH
+#define N_FRAMES 2048u          // per channel
+#define GAP_BITS 11u
+#define LEAD_BITS 22u
+#define N_SAMPLES ((N_FRAMES * (BITSTREAM_SIZE + GAP_BITS) + LEAD_BITS + 7u) \
+                   * SAMPLES_PER_BIT)
+#define MAX_FRAMES (N_FRAMES + 16u)
+#define DMA_BLOCK 32u           // samples per channel per buffer
+#define RUNS 20           // best of, the host timing is noisy
+
+static uint16_t single[N_CH][N_SAMPLES];
+static uint16_t interleaved[N_SAMPLES * N_CH];
+static uint16_t ref[N_CH][MAX_FRAMES];
+static size_t n_ref[N_CH];
+static DemodFSK_Frame multi[MAX_FRAMES * N_CH];
+static DemodFSK_Frame whole[MAX_FRAMES * N_CH];
+static uint16_t split[DMA_BLOCK];
+
+int main(void)
+{
+    for (unsigned c = 0; c < N_CH; c++)
+    {
+        // a different lead-in per channel so their bits are not aligned
+        make_signal(single[c], N_SAMPLES, NULL, N_FRAMES, LEAD_BITS + c, GAP_BITS);
+        for (size_t i = 0; i < N_SAMPLES; i++)
+        {
+            interleaved[i * N_CH + c] = single[c][i];
+        }
+    }
+
+    // best of RUNS; every run starts from reset so the output is the same
+    double t_single = 1e9, t_split = 1e9, t_multi = 1e9;
+    size_t n_multi = 0;
+    unsigned errors_split = 0, errors_order = 0;
+    DemodFSK_Handle dm;
+    DemodFSK_Init(&dm, N_CH);
+    for (int r = 0; r < RUNS; r++)
+    {
+        // reference: one channel at a time through the single-channel engine
+        double t0 = now_s();
+        for (unsigned c = 0; c < N_CH; c++)
+        {
+            demodFSK_ResetBlock();
+            n_ref[c] = 0;
+            for (size_t i = 0; i < N_SAMPLES; i += DMA_BLOCK)
+            {
+                n_ref[c] += demodFSK_ProcessBlockQ15(&single[c][i], DMA_BLOCK,
+                                                     &ref[c][n_ref[c]],
+                                                     MAX_FRAMES - n_ref[c]);
+            }
+        }
+        double t = now_s() - t0;
+        t_single = (t < t_single) ? t : t_single;
+
+        // same, taking each block out of the interleaved buffer first
+        t0 = now_s();
+        for (unsigned c = 0; c < N_CH; c++)
+        {
+            demodFSK_ResetBlock();
+            size_t got = 0;
+            for (size_t i = 0; i < N_SAMPLES; i += DMA_BLOCK)
+            {
+                for (size_t k = 0; k < DMA_BLOCK; k++)
+                {
+                    split[k] = interleaved[(i + k) * N_CH + c];
+                }
+                got += demodFSK_ProcessBlockQ15(split, DMA_BLOCK, &ref[c][got],
+                                                MAX_FRAMES - got);
+            }
+            errors_split += (got != n_ref[c]);
+        }
+        t = now_s() - t0;
+        t_split = (t < t_split) ? t : t_split;
+
+        DemodFSK_Reset(&dm);
+        n_multi = 0;
+        t0 = now_s();
+        for (size_t i = 0; i < N_SAMPLES; i += DMA_BLOCK)
+        {
+            size_t got = DemodFSK_Process(&dm, &interleaved[i * N_CH], DMA_BLOCK,
+                                          &multi[n_multi],
+                                          MAX_FRAMES * N_CH - n_multi);
+            // arrival order inside the block
+            for (size_t k = 1; k < got; k++)
+            {
+                errors_order += (multi[n_multi + k].pos < multi[n_multi + k - 1].pos);
+            }
+            n_multi += got;
+        }
+        t = now_s() - t0;
+        t_multi = (t < t_multi) ? t : t_multi;
+    }
+
+    // whole buffer in one call: pos goes past 16 bits and must keep the order
+    DemodFSK_Reset(&dm);
+    size_t n_whole = DemodFSK_Process(&dm, interleaved, N_SAMPLES, whole,
+                                      MAX_FRAMES * N_CH);
+    unsigned errors_whole = (n_whole != n_multi) || (n_whole == 0) ||
+                            (whole[n_whole - 1].pos <= UINT16_MAX);
+    size_t seen_whole[N_CH] = {0};
+    for (size_t f = 0; f < n_whole; f++)
+    {
+        unsigned c = whole[f].ch;
+        errors_whole += (seen_whole[c] >= n_ref[c]) ||
+                        (whole[f].frame != ref[c][seen_whole[c]]) ||
+                        ((f > 0) && (whole[f].pos < whole[f - 1].pos));
+        seen_whole[c]++;
+    }
+    printf("one call, %u samples per channel: %zu frames, last at %lu\n",
+           (unsigned)N_SAMPLES, n_whole,
+           n_whole ? (unsigned long)whole[n_whole - 1].pos : 0ul);
+
+    // split the multi-channel output back per channel and compare
+    unsigned errors = errors_split + errors_order + errors_whole;
+    size_t seen[N_CH] = {0};
+    for (size_t f = 0; f < n_multi; f++)
+    {
+        unsigned c = multi[f].ch;
+        errors += (seen[c] >= n_ref[c]) ||
+                  (multi[f].frame != ref[c][seen[c]]);
+        seen[c]++;
+    }
+    for (unsigned c = 0; c < N_CH; c++)
+    {
+        errors += (seen[c] != n_ref[c]);
+        printf("ch %u: %zu frames, reference %zu\n", c, seen[c], n_ref[c]);
+    }
+
+    double total = (double)N_SAMPLES * N_CH;
+    printf("mismatches %u\n", errors);
+    printf("single-channel x%u: %.3f Msamples/s\n", N_CH,
+           total / t_single * 1e-6);
+    printf("deinterleave + x%u: %.3f Msamples/s\n", N_CH,
+           total / t_split * 1e-6);
+    printf("handle, %u ch:      %.3f Msamples/s (x%.2f, x%.2f)\n", N_CH,
+           total / t_multi * 1e-6, t_single / t_multi, t_split / t_multi);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file bench_demod_q15.c
+ * @brief Benchmark de host: motor por bloques float vs punto fijo (Q15).
+ *
+ * Genera vectores FSK con distintas atenuaciones y niveles de ruido, los
+ * demodula con demodFSK_ProcessBlockF32() y demodFSK_ProcessBlockQ15(),
+ * exige que ambos entreguen exactamente los mismos frames y reporta ns y
+ * ciclos (TSC en x86) por muestra. Compilar desde este directorio con:
+ *   gcc -O3 -Wall -Wextra -std=c11 -o bench_demod_q15 bench_demod_q15.c
+ *       ../dsp/demod_fsk.c ../dsp/bitstream.c ../drv/hal/NCO.c -lm
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#else
+#define CYCLES() 0ull
+#endif
+
+#include "../dsp/demod_fsk.h"
+#include "bench_common.h"
+
+#define SAMPLES_PER_BIT MODEM_SAMPLES_PER_BIT
+#define N_FRAMES 4096u
+#define GAP_BITS 11u
+#define LEAD_BITS 22u
+#define N_SAMPLES ((N_FRAMES * (BITSTREAM_SIZE + GAP_BITS) + LEAD_BITS) \
+                   * SAMPLES_PER_BIT)
+#define MAX_FRAMES (N_FRAMES + 16u)
+#define DMA_BLOCK 32u
+
+typedef struct
+{
+    const char *name;
+    float gain;         // channel attenuation
+    float noise_rms;    // AWGN in ADC counts
+} vector_t;
+
+static const vector_t vectors[] =
+{
+    { "clean",        1.00f,   0.0f },
+    { "atten -12dB",  0.25f,   0.0f },
+    { "noise 60 rms", 1.00f,  60.0f },
+    { "atten+noise",  0.25f,  40.0f },
+    { "low level",    0.02f,   4.0f },
+};
+
+static uint16_t clean[N_SAMPLES];
+static uint16_t signal[N_SAMPLES];
+static uint16_t frames_f32[MAX_FRAMES];
+static uint16_t frames_q15[MAX_FRAMES];
+
+static void apply_channel(const vector_t *v)
+{
+    for (size_t i = 0; i < N_SAMPLES; i++)
+    {
+        float y = 2048.0f + v->gain * ((float)clean[i] - 2048.0f)
+                + v->noise_rms * gauss();
+        y = (y < 0.0f) ? 0.0f : (y > 4095.0f) ? 4095.0f : y;
+        signal[i] = (uint16_t)lrintf(y);
+    }
+}
+
+typedef size_t (*engine_t)(const uint16_t *, size_t, uint16_t *, size_t);
+
+static size_t run(engine_t engine, uint16_t *frames, double *secs,
+                  unsigned long long *cycles)
+{
+    size_t n = 0;
+    demodFSK_ResetBlock();
+    double t0 = now_s();
+    unsigned long long c0 = CYCLES();
+    for (size_t i = 0; i < N_SAMPLES; i += DMA_BLOCK)
+    {
+        n += engine(&signal[i], DMA_BLOCK, &frames[n], MAX_FRAMES - n);
+    }
+    *cycles = CYCLES() - c0;
+    *secs = now_s() - t0;
+    return n;
+}
+
+int main(void)
+{
+    srand(1);
+    make_signal(clean, N_SAMPLES, NULL, N_FRAMES, LEAD_BITS, GAP_BITS);
+
+    int failed = 0;
+    printf("%-14s %7s %7s %5s %11s %11s %12s %12s\n", "vector", "f32",
+           "q15", "diff", "f32 ns/smp", "q15 ns/smp", "f32 cyc/smp",
+           "q15 cyc/smp");
+    for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++)
+    {
+        apply_channel(&vectors[v]);
+
+        double t_f32, t_q15;
+        unsigned long long c_f32, c_q15;
+        size_t n_f32 = run(demodFSK_ProcessBlockF32, frames_f32, &t_f32,
+                           &c_f32);
+        size_t n_q15 = run(demodFSK_ProcessBlockQ15, frames_q15, &t_q15,
+                           &c_q15);
+
+        unsigned diff = (n_f32 != n_q15);
+        for (size_t f = 0; f < n_f32 && f < n_q15; f++)
+        {
+            diff += (frames_f32[f] != frames_q15[f]);
+        }
+        failed |= (diff != 0);
+
+        printf("%-14s %7zu %7zu %5u %11.2f %11.2f %12.1f %12.1f\n",
+               vectors[v].name, n_f32, n_q15, diff,
+               t_f32 / N_SAMPLES * 1e9, t_q15 / N_SAMPLES * 1e9,
+               (double)c_f32 / N_SAMPLES, (double)c_q15 / N_SAMPLES);
+    }
+    return failed;
+}
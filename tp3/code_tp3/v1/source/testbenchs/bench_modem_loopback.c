@@ -0,0 +1,325 @@
+/**
+ * @file bench_modem_loopback.c
+ * @brief Loopback de host del módem completo: BER vs SNR, pérdidas de sync
+ * y velocidad del demodulador, en CSV.
+ *
+ * Cadena: data_to_uart -> NCO_FillBlock a FS (MODEM_FS_DAC, bit clock a
+ * MODEM_BAUD)
+ * -> remuestreo lineal a la frecuencia del ADC -> atenuación + AWGN +
+ * cuantización a 12 bits -> demodulador -> deformat/uart_to_data.
+ *
+ * Cada frame transmitido tiene una ventana de llegada; un frame decodificado
+ * fuera de toda ventana es espurio y una ventana sin frame es una pérdida.
+ * Ambos cuentan como pérdida de sync y una pérdida suma todos sus bits de
+ * datos como errados.
+ * Al arrancar con el FIR en cero siempre aparece un espurio (el escalón de
+ * entrada parece un bit de start), así que el piso de la columna es 1.
+ * La velocidad se mide demodulando en bloques de DMA_BLOCK como app.c; para
+ * las ventanas se repite la demodulación de a una muestra, así cada frame
+ * queda marcado en la muestra en que terminó. Si las dos pasadas no dan los
+ * mismos frames se avisa por stderr y sale con código 1.
+ *
+ * Uso: bench_modem_loopback [sample|f32|q15] [gap_bits] [gain]
+ *   sample: demodFSK() + bitstreamReconstruction() (camino de app.c v1)
+ *   f32/q15: demodFSK_ProcessBlockF32()/Q15()
+ * Se barre el SNR a MODEM_FS_ADC, al ritmo real del PIT (redondeado a ticks
+ * del bus) y con +-2.5 % de error de reloj.
+ *
+ * Compilar desde este directorio con:
+ *   gcc -O3 -Wall -Wextra -std=c11 -o bench_modem_loopback
+ *       bench_modem_loopback.c ../dsp/demod_fsk.c ../dsp/bitstream.c
+ *       ../drv/hal/NCO.c -lm
+ * Agregar -DMODEM_BAUD=2400 o -DMODEM_BAUD=4800 para los otros perfiles.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../dsp/demod_fsk.h"
+#include "../drv/mcal/pit.h"
+#include "bench_common.h"
+
+#define BAUD MODEM_BAUD
+#define N_FRAMES 2000u
+#define LEAD_BITS 22u
+#define MAX_GAP_BITS 64u
+#define DMA_BLOCK 64u           // RX_BLOCK_SIZE in app.c (one DMA half)
+#define DAC_HALF 128u           // DAC_BUFFER_SIZE / 2 in app.c
+#define ADC_AMP 2047.0f         // NCO output swing around 2048
+#define MAX_TX_SAMPLES (((N_FRAMES * (BITSTREAM_SIZE + MAX_GAP_BITS) \
+                         + 2u * LEAD_BITS) * (uint64_t)FS) / BAUD + 1u)
+#define MAX_RX_SAMPLES (MAX_TX_SAMPLES / 4u + 1u)  // FS_ADC >= FS / 4.2
+#define MAX_FRAMES (2u * N_FRAMES)
+
+typedef size_t (*engine_t)(const uint16_t *, size_t, uint16_t *, size_t);
+
+static uint16_t tx[MAX_TX_SAMPLES];
+static float rx_clean[MAX_RX_SAMPLES];
+static uint16_t rx[MAX_RX_SAMPLES];
+static uint16_t payload[N_FRAMES];
+static size_t frame_start[N_FRAMES + 1];    // in rx samples
+
+typedef struct
+{
+    uint16_t frame;
+    size_t t;       // rx samples consumed when the frame completed
+} rx_frame_t;
+static rx_frame_t decoded[MAX_FRAMES];
+static uint16_t timed[MAX_FRAMES];
+static size_t stamp_mismatch;
+
+/**
+ * @brief Camino por muestra de app.c v1 con la interfaz de los motores por
+ * bloques, para medirlo igual que a ellos.
+ */
+static size_t per_sample(const uint16_t *samples, size_t n, uint16_t *frames,
+                         size_t max_frames)
+{
+    size_t n_frames = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        bitstreamReconstruction(demodFSK(samples[i]));
+        if (isDataReady())
+        {
+            uint16_t frame = retrieveBitstream();
+            if (n_frames < max_frames)
+            {
+                frames[n_frames++] = frame;
+            }
+        }
+    }
+    return n_frames;
+}
+
+/**
+ * @brief Fuente de bits del transmisor para NCO_FillBlock().
+ */
+typedef struct
+{
+    size_t bit;         // bits entregados
+    unsigned gap_bits;
+    uint16_t frame;
+} tx_bits_t;
+
+static bool tx_next_bit(void *user)
+{
+    tx_bits_t *t = user;
+    size_t bit = t->bit++;
+    if (bit < LEAD_BITS)
+    {
+        return true;    // idle
+    }
+    size_t f = (bit - LEAD_BITS) / (BITSTREAM_SIZE + t->gap_bits);
+    size_t b = (bit - LEAD_BITS) % (BITSTREAM_SIZE + t->gap_bits);
+    if (f >= N_FRAMES || b >= BITSTREAM_SIZE)
+    {
+        return true;
+    }
+    if (b == 0)
+    {
+        t->frame = data_to_uart(payload[f]);
+    }
+    return (t->frame >> b) & 1u;
+}
+
+/**
+ * @brief Modula todos los frames a FS con el bit clock a BAUD, de a medio
+ * buffer del DAC como en app.c.
+ *
+ * @return Cantidad de muestras del DAC.
+ */
+static size_t transmit(unsigned gap_bits)
+{
+    NCO_Handle nco;
+    NCO_InitFixed(&nco, K_MARK, K_SPACE, true);
+    tx_bits_t bits = { .bit = 0, .gap_bits = gap_bits, .frame = BITSTREAM_IDLE };
+    NCO_BitClock clk;
+    NCO_BitClockInit(&clk, BAUD, FS, tx_next_bit, &bits);
+
+    size_t n_bits = LEAD_BITS + N_FRAMES * (BITSTREAM_SIZE + gap_bits)
+                  + LEAD_BITS;
+    size_t n = (size_t)(((uint64_t)n_bits * FS) / BAUD);
+    for (size_t i = 0; i < n; i += DAC_HALF)
+    {
+        size_t len = (n - i < DAC_HALF) ? n - i : DAC_HALF;
+        NCO_FillBlock(&nco, &clk, &tx[i], len);
+    }
+    return n;
+}
+
+/**
+ * @brief Remuestrea la salida del DAC a fs_rx (interpolación lineal).
+ *
+ * @return Cantidad de muestras del ADC.
+ */
+static size_t resample(size_t n_tx, double fs_rx, unsigned gap_bits)
+{
+    double step = (double)FS / fs_rx;
+    size_t n = (size_t)((n_tx - 1) / step);
+    for (size_t i = 0; i < n; i++)
+    {
+        double pos = i * step;
+        size_t k = (size_t)pos;
+        float frac = (float)(pos - k);
+        rx_clean[i] = (1.0f - frac) * (tx[k] - 2048.0f)
+                    + frac * (tx[k + 1] - 2048.0f);
+    }
+    for (size_t f = 0; f <= N_FRAMES; f++)
+    {
+        double bit = LEAD_BITS + (double)f * (BITSTREAM_SIZE + gap_bits);
+        frame_start[f] = (size_t)(bit * fs_rx / BAUD);
+    }
+    return n;
+}
+
+static void channel(size_t n, float gain, float snr_db)
+{
+    // snr relative to the attenuated sine power, ADC_AMP^2 * gain^2 / 2
+    float sigma = isinf(snr_db) ? 0.0f :
+                  ADC_AMP * gain / sqrtf(2.0f * powf(10.0f, snr_db / 10.0f));
+    for (size_t i = 0; i < n; i++)
+    {
+        float y = 2048.0f + gain * rx_clean[i] + sigma * gauss();
+        y = (y < 0.0f) ? 0.0f : (y > 4095.0f) ? 4095.0f : y;
+        rx[i] = (uint16_t)lrintf(y);
+    }
+}
+
+static void run_point(engine_t engine, size_t n, float gain, float snr_db,
+                      double fs_rx)
+{
+    size_t n_timed = 0, n_dec = 0;
+
+    channel(n, gain, snr_db);
+    n -= n % DMA_BLOCK;
+
+    // timed pass, in DMA blocks as app.c
+    demodFSK_ResetBlock();
+    demodFSK_Reset();
+    double t0 = now_s();
+    for (size_t i = 0; i < n; i += DMA_BLOCK)
+    {
+        n_timed += engine(&rx[i], DMA_BLOCK, &timed[n_timed],
+                          MAX_FRAMES - n_timed);
+    }
+    double t = now_s() - t0;
+
+    // Same input one sample per call, so each frame is stamped with the
+    // sample that completed it: a block stamp is up to DMA_BLOCK late, more
+    // than the half-frame margin of the windows below. The engines keep all
+    // their state between calls and must decode the same frames.
+    demodFSK_ResetBlock();
+    demodFSK_Reset();
+    for (size_t i = 0; i < n; i++)
+    {
+        uint16_t frame;
+        if (engine(&rx[i], 1, &frame, 1) && n_dec < MAX_FRAMES)
+        {
+            decoded[n_dec].frame = frame;
+            decoded[n_dec].t = i + 1;
+            n_dec++;
+        }
+    }
+    bool same = (n_dec == n_timed);
+    for (size_t k = 0; same && k < n_dec; k++)
+    {
+        same = (decoded[k].frame == timed[k]);
+    }
+    if (!same)
+    {
+        fprintf(stderr, "snr %.1f fs_rx %.2f: %zu frames by block, %zu by "
+                "sample\n", snr_db, fs_rx, n_timed, n_dec);
+        stamp_mismatch++;
+    }
+
+    // Frame f is expected to complete between half a frame after its start
+    // bit and half a frame after the next one starts.
+    const size_t half = (size_t)((BITSTREAM_SIZE * fs_rx) / (2 * BAUD));
+    size_t bit_errors = 0, lost = 0, spurious = 0;
+    size_t framing = 0, parity = 0;
+    size_t d = 0;
+    for (size_t f = 0; f < N_FRAMES; f++)
+    {
+        size_t lo = frame_start[f] + half;
+        size_t hi = frame_start[f + 1] + half;
+        bool got = false;
+        for (; d < n_dec && decoded[d].t < hi; d++)
+        {
+            if (decoded[d].t < lo || got)
+            {
+                spurious++;
+                continue;
+            }
+            got = true;
+            uint16_t fr = decoded[d].frame;
+            uint16_t data = uart_to_data(fr);
+            bit_errors += __builtin_popcount(data ^ payload[f]);
+            framing += ((fr & 1u) != 0) || !uart_framing_ok(fr);
+            parity += !uart_parity_ok(fr);
+        }
+        if (!got)
+        {
+            lost++;
+            bit_errors += BITSTREAM_DATA_BITS;
+        }
+    }
+    spurious += n_dec - d;
+
+    printf("%.1f,%.2f,%.3f,%u,%zu,%.3e,%zu,%zu,%zu,%zu,%.3f\n",
+           snr_db, fs_rx, gain, N_FRAMES, bit_errors,
+           (double)bit_errors / ((double)BITSTREAM_DATA_BITS * N_FRAMES), lost, spurious, framing,
+           parity, n / t * 1e-6);
+}
+
+int main(int argc, char *argv[])
+{
+    engine_t engine = demodFSK_ProcessBlock;
+    if (argc > 1 && !strcmp(argv[1], "sample"))
+    {
+        engine = per_sample;
+    }
+    else if (argc > 1 && !strcmp(argv[1], "f32"))
+    {
+        engine = demodFSK_ProcessBlockF32;
+    }
+    else if (argc > 1 && !strcmp(argv[1], "q15"))
+    {
+        engine = demodFSK_ProcessBlockQ15;
+    }
+    unsigned gap_bits = (argc > 2) ? (unsigned)atoi(argv[2]) : 4u;
+    gap_bits = (gap_bits > MAX_GAP_BITS) ? MAX_GAP_BITS : gap_bits;
+    float gain = (argc > 3) ? (float)atof(argv[3]) : 0.5f;
+
+    srand(1);
+    for (size_t f = 0; f < N_FRAMES; f++)
+    {
+        payload[f] = (uint16_t)(rand() & BITSTREAM_DATA_MASK);
+    }
+    size_t n_tx = transmit(gap_bits);
+
+    // FS_ADC, the rounded PIT period and a +-2.5 % clock error
+    const double fs_rx[] =
+    {
+        MODEM_FS_ADC,
+        (double)SYS_BUS_CLK / (PIT_TICKS_FROM_HZ(MODEM_FS_ADC) + 1u),
+        MODEM_FS_ADC * 0.975,
+        MODEM_FS_ADC * 1.025
+    };
+    const float snr_db[] = { INFINITY, 20, 16, 12, 10, 8, 6, 4, 2, 0 };
+
+    printf("snr_db,fs_rx,gain,frames,bit_errors,ber,lost,spurious,"
+           "framing_err,parity_err,demod_msps\n");
+    for (size_t r = 0; r < sizeof(fs_rx) / sizeof(fs_rx[0]); r++)
+    {
+        size_t n = resample(n_tx, fs_rx[r], gap_bits);
+        for (size_t s = 0; s < sizeof(snr_db) / sizeof(snr_db[0]); s++)
+        {
+            run_point(engine, n, gain, snr_db[s], fs_rx[r]);
+        }
+    }
+    return stamp_mismatch ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+/**
+ * @file bench_nco_lut.c
+ * @brief Benchmark de host: pureza espectral y costo de la LUT del NCO.
+ *
+ * Genera los tonos MARK y SPACE a MODEM_FS_DAC con NCO_FillBlock(), los pasa
+ * por una ventana Blackman-Harris de 4 términos y una FFT, y reporta el peor
+ * de los dos tonos:
+ *   - SFDR: portadora contra el espurio más alto fuera del lóbulo principal.
+ *   - THD: potencia de los armónicos 2 a 10 (plegados a [0, FS/2]) contra la
+ *     portadora.
+ * Además mide ns por muestra de NCO_FillBlock() con bits aleatorios.
+ *
+ * La LUT se elige en tiempo de compilación, así que cada ejecución imprime
+ * una fila CSV de una combinación (sin encabezado con "-q"):
+ *   quarter,lut_bits,interp,phase_bits,table_bytes,sfdr_dbc,thd_dbc,ns_per_sample
+ * bench_nco_lut.sh compila y corre todas las combinaciones.
+ *
+ * Compilar desde este directorio con:
+ *   gcc -O3 -Wall -Wextra -std=c11 -o bench_nco_lut bench_nco_lut.c
+ *       ../drv/hal/NCO.c -lm
+ * Agregar -DLUT_BITS=n -DLUT_QUARTER=1 -DNCO_INTERP=1 -DNCO_PHASE_BITS=n
+ * para las otras tablas.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../drv/hal/NCO.h"
+#include "../drv/hal/SinLutQ15.h"
+#include "bench_common.h"
+
+#define FFT_BITS 16u
+#define FFT_N (1u << FFT_BITS)
+#define LOBE_BINS 6u            // BH4 main lobe is +-4 bins, plus margin
+#define N_HARMONICS 10u
+#define TIME_BLOCK 128u         // DAC_HALF in app.c
+#define TIME_SAMPLES (1u << 22)
+#define RUNS 5
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static uint16_t tone[FFT_N];
+static double re[FFT_N];
+static double im[FFT_N];
+static double power[FFT_N / 2 + 1];
+static uint16_t scratch[TIME_BLOCK];
+
+static bool constant_bit(void *user)
+{
+    return *(const bool *)user;
+}
+
+static bool random_bit(void *user)
+{
+    uint32_t *state = user;
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 31) != 0u;
+}
+
+static void fft(double *xr, double *xi, unsigned n)
+{
+    for (unsigned i = 1, j = 0; i < n; i++)
+    {
+        unsigned bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j)
+        {
+            double t = xr[i]; xr[i] = xr[j]; xr[j] = t;
+            t = xi[i]; xi[i] = xi[j]; xi[j] = t;
+        }
+    }
+    for (unsigned len = 2; len <= n; len <<= 1)
+    {
+        const double ang = -2.0 * M_PI / len;
+        for (unsigned i = 0; i < n; i += len)
+        {
+            for (unsigned k = 0; k < len / 2; k++)
+            {
+                const double wr = cos(ang * k);
+                const double wi = sin(ang * k);
+                const unsigned a = i + k;
+                const unsigned b = a + len / 2;
+                const double tr = xr[b] * wr - xi[b] * wi;
+                const double ti = xr[b] * wi + xi[b] * wr;
+                xr[b] = xr[a] - tr;
+                xi[b] = xi[a] - ti;
+                xr[a] += tr;
+                xi[a] += ti;
+            }
+        }
+    }
+}
+
+// Energy in +-LOBE_BINS around bin (already folded to [0, N/2]).
+static double lobe_power(unsigned bin)
+{
+    double sum = 0.0;
+    for (int k = (int)bin - (int)LOBE_BINS; k <= (int)(bin + LOBE_BINS); k++)
+    {
+        if (k >= 0 && k <= (int)(FFT_N / 2))
+        {
+            sum += power[k];
+        }
+    }
+    return sum;
+}
+
+static unsigned fold_bin(double f)
+{
+    f = fmod(f, (double)FS);
+    if (f > FS / 2.0)
+    {
+        f = FS - f;
+    }
+    return (unsigned)lround(f * FFT_N / FS);
+}
+
+static void measure_tone(bool bit, double *sfdr_dbc, double *thd_dbc)
+{
+    NCO_Handle nco;
+    NCO_BitClock clk;
+    NCO_InitFixed(&nco, K_MARK, K_SPACE, bit);
+    NCO_BitClockInit(&clk, MODEM_BAUD, FS, constant_bit, &bit);
+    NCO_FillBlock(&nco, &clk, tone, FFT_N);
+
+    for (unsigned i = 0; i < FFT_N; i++)
+    {
+        const double x = 2.0 * M_PI * i / FFT_N;
+        const double w = 0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2 * x)
+                       - 0.01168 * cos(3 * x);
+        re[i] = ((double)tone[i] - LUT_DAC_MAX / 2.0) * w;
+        im[i] = 0.0;
+    }
+    fft(re, im, FFT_N);
+    for (unsigned k = 0; k <= FFT_N / 2; k++)
+    {
+        power[k] = re[k] * re[k] + im[k] * im[k];
+    }
+
+    const double f0 = bit ? MODEM_F_MARK : MODEM_F_SPACE;
+    const unsigned carrier_bin = fold_bin(f0);
+    const double carrier = lobe_power(carrier_bin);
+
+    double spur = 0.0;
+    for (unsigned k = LOBE_BINS + 1u; k <= FFT_N / 2; k++)   // skip DC
+    {
+        if ((k + LOBE_BINS >= carrier_bin) && (k <= carrier_bin + LOBE_BINS))
+        {
+            continue;
+        }
+        if (power[k] > spur)
+        {
+            spur = power[k];
+        }
+    }
+
+    double harmonics = 0.0;
+    for (unsigned h = 2; h <= N_HARMONICS; h++)
+    {
+        const unsigned bin = fold_bin(f0 * h);
+        if (bin > LOBE_BINS && (bin + LOBE_BINS < carrier_bin
+                                || bin > carrier_bin + LOBE_BINS))
+        {
+            harmonics += lobe_power(bin);
+        }
+    }
+
+    // Carrier peak bin against spur peak bin; lobe sums for THD.
+    *sfdr_dbc = 10.0 * log10(power[carrier_bin] / (spur + 1e-30));
+    *thd_dbc = 10.0 * log10((harmonics + 1e-30) / carrier);
+}
+
+static double time_fill(void)
+{
+    uint32_t state = 12345u;
+    NCO_Handle nco;
+    NCO_BitClock clk;
+    NCO_InitFixed(&nco, K_MARK, K_SPACE, true);
+    NCO_BitClockInit(&clk, MODEM_BAUD, FS, random_bit, &state);
+
+    double best = 1e30;
+    volatile uint16_t sink = 0;
+    for (int r = 0; r < RUNS; r++)
+    {
+        const double t0 = now_s();
+        for (unsigned i = 0; i < TIME_SAMPLES; i += TIME_BLOCK)
+        {
+            NCO_FillBlock(&nco, &clk, scratch, TIME_BLOCK);
+            sink ^= scratch[TIME_BLOCK - 1u];
+        }
+        const double dt = now_s() - t0;
+        if (dt < best)
+        {
+            best = dt;
+        }
+    }
+    (void)sink;
+    return best * 1e9 / TIME_SAMPLES;
+}
+
+int main(int argc, char *argv[])
+{
+    const bool quiet = (argc > 1) && (strcmp(argv[1], "-q") == 0);
+
+#if LUT_QUARTER
+    const size_t table_bytes = sizeof(SINE_Q15_QUARTER);
+#else
+    const size_t table_bytes = sizeof(SINE_Q15);
+#endif
+
+    double sfdr_mark, thd_mark, sfdr_space, thd_space;
+    measure_tone(true, &sfdr_mark, &thd_mark);
+    measure_tone(false, &sfdr_space, &thd_space);
+    const double ns = time_fill();
+
+    if (!quiet)
+    {
+        printf("quarter,lut_bits,interp,phase_bits,table_bytes,"
+               "sfdr_dbc,thd_dbc,ns_per_sample\n");
+    }
+    printf("%u,%u,%u,%u,%zu,%.1f,%.1f,%.2f\n",
+           (unsigned)LUT_QUARTER, (unsigned)LUT_BITS, (unsigned)NCO_INTERP,
+           (unsigned)NCO_PHASE_BITS, table_bytes,
+           fmin(sfdr_mark, sfdr_space), fmax(thd_mark, thd_space), ns);
+    return 0;
+}
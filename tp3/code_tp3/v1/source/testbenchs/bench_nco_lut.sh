@@ -0,0 +1,26 @@
+#!/bin/sh
+# Compila y corre bench_nco_lut.c para todas las combinaciones de LUT y
+# junta las filas en un solo CSV. Correr desde este directorio:
+#   ./bench_nco_lut.sh [CFLAGS extra, p. ej. -DMODEM_BAUD=2400] > nco_lut.csv
+
+set -e
+
+CC=${CC:-gcc}
+BIN=${TMPDIR:-/tmp}/bench_nco_lut.$$
+trap 'rm -f "$BIN"' EXIT
+
+echo "quarter,lut_bits,interp,phase_bits,table_bytes,sfdr_dbc,thd_dbc,ns_per_sample"
+for quarter in 0 1; do
+    for bits in 6 7 8 9 10; do
+        for interp in 0 1; do
+            for phase in 12 16 32; do
+                [ "$phase" -ge "$bits" ] || continue
+                "$CC" -O3 -Wall -Wextra -std=c11 "$@" \
+                    -DLUT_QUARTER=$quarter -DLUT_BITS=$bits \
+                    -DNCO_INTERP=$interp -DNCO_PHASE_BITS=$phase \
+                    -o "$BIN" bench_nco_lut.c ../drv/hal/NCO.c -lm
+                "$BIN" -q
+            done
+        done
+    done
+done
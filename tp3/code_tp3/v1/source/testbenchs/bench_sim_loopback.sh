@@ -0,0 +1,32 @@
+#!/bin/sh
+# Compila bench_sim_loopback.c para los tres perfiles de baud, en modo UART
+# y en modo paquete (HDLC), corre el loopback sin ruido (falla si se pierde
+# o se erra un byte) y después barre el SNR. Junta todas las filas en un solo CSV. Correr desde este directorio:
+#   ./bench_sim_loopback.sh [bytes] > sim_loopback.csv
+
+set -e
+
+CC=${CC:-gcc}
+BYTES=${1:-200}
+BIN=${TMPDIR:-/tmp}/bench_sim_loopback.$$
+trap 'rm -f "$BIN"' EXIT
+
+echo "baud,bytes,gap_bits,snr_db,ok,errors,lost,virtual_s,wall_s,speedup,throughput_Bps,line_Bps,lat_avg_ms,lat_max_ms,reg_traps,irqs,dma_minor_loops,adc_conversions,missing_isr,packet,bad_packets,rx_overflow"
+for packet in 0 1; do
+for baud in 1200 2400 4800; do
+    "$CC" -O2 -std=gnu11 -no-pie -include sim/k64sim_cmsis.h \
+        -Wall -Wextra -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast \
+        -I ../../SDK/CMSIS -I ../../SDK/startup -I ../drv/mcal \
+        -DCPU_MK64FN1M0VLL12 -DMODEM_BAUD=$baud -DMODEM_PACKET=$packet -o "$BIN" \
+        bench_sim_loopback.c sim/k64sim.c sim/sim_*.c \
+        ../drv/mcal/pit.c ../drv/mcal/dma.c ../drv/mcal/ADC.c \
+        ../drv/mcal/DAC.c ../drv/mcal/gpio.c ../drv/mcal/UART.c \
+        ../drv/mcal/UART_strings.c ../drv/hal/NCO.c \
+        ../dsp/demod_fsk.c ../dsp/bitstream.c ../dsp/frame_fifo.c \
+        ../dsp/tx_sched.c ../dsp/hdlc.c -lm
+    "$BIN" -q "$BYTES"
+    for snr in 20 15 10 6; do
+        "$BIN" -q "$BYTES" 0 $snr || true
+    done
+done
+done
@@ -0,0 +1,622 @@
+/**
+ * @file k64sim.c
+ * @brief Núcleo del simulador: mapeo de registros, trampas de acceso, reloj
+ * virtual, NVIC y SysTick.
+ *
+ * Un memfd respalda los registros dos veces: en las direcciones reales del
+ * K64 (lo que ve el firmware) y en un alias que usan los modelos. Las páginas
+ * de los periféricos modelados del primer mapeo no tienen permisos. Un
+ * acceso del firmware cae en SIGSEGV: se corre el hook de lectura, se abre la
+ * página y se prende el Trap Flag, así la instrucción se ejecuta sola y cae en
+ * SIGTRAP, donde se vuelve a cerrar la página y se corre el hook de
+ * escritura. Solo x86-64 Linux (REG_ERR/REG_EFL del ucontext).
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "k64sim_internal.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+#define PERIPH_PAGES    (K64SIM_PERIPH_SIZE / K64SIM_PAGE)
+#define N_PAGES         (PERIPH_PAGES + 1u)     // + the PPB page
+#define TOTAL_SIZE      (K64SIM_PERIPH_SIZE + K64SIM_PPB_SIZE)
+#define EFLAGS_TF       (0x100)
+#define PF_WRITE        (0x2)                   // page fault error code, W/R bit
+
+#define N_IRQ           (86u)
+#define N_IRQ_WORDS     ((N_IRQ + 31u) / 32u)
+
+#define SYST_CSR        (0xE000E010u)
+#define SYST_RVR        (0xE000E014u)
+#define SYST_CVR        (0xE000E018u)
+#define NVIC_ISER0      (0xE000E100u)
+#define NVIC_ICER0      (0xE000E180u)
+#define NVIC_ISPR0      (0xE000E200u)
+#define NVIC_ICPR0      (0xE000E280u)
+#define NVIC_IPR0       (0xE000E400u)
+#define SCB_ICSR        (0xE000ED04u)
+#define SCB_SHPR_SYSTICK (0xE000ED23u)          // SHPR3[31:24]
+#define NVIC_STIR       (0xE000EF00u)
+
+#define ICSR_PENDSTSET  (1u << 26)
+#define ICSR_PENDSTCLR  (1u << 25)
+
+/*******************************************************************************
+ * Vector table
+ ******************************************************************************/
+
+// Device IRQs in IRQn order, as in startup_mk64f12.c
+#define K64SIM_IRQ_LIST(X) \
+    X(DMA0) X(DMA1) X(DMA2) X(DMA3) X(DMA4) X(DMA5) X(DMA6) X(DMA7) \
+    X(DMA8) X(DMA9) X(DMA10) X(DMA11) X(DMA12) X(DMA13) X(DMA14) X(DMA15) \
+    X(DMA_Error) X(MCM) X(FTFE) X(Read_Collision) X(LVD_LVW) X(LLWU) \
+    X(WDOG_EWM) X(RNG) X(I2C0) X(I2C1) X(SPI0) X(SPI1) X(I2S0_Tx) X(I2S0_Rx) \
+    X(UART0_LON) X(UART0_RX_TX) X(UART0_ERR) X(UART1_RX_TX) X(UART1_ERR) \
+    X(UART2_RX_TX) X(UART2_ERR) X(UART3_RX_TX) X(UART3_ERR) X(ADC0) X(CMP0) \
+    X(CMP1) X(FTM0) X(FTM1) X(FTM2) X(CMT) X(RTC) X(RTC_Seconds) X(PIT0) \
+    X(PIT1) X(PIT2) X(PIT3) X(PDB0) X(USB0) X(USBDCD) X(Reserved71) X(DAC0) \
+    X(MCG) X(LPTMR0) X(PORTA) X(PORTB) X(PORTC) X(PORTD) X(PORTE) X(SWI) \
+    X(SPI2) X(UART4_RX_TX) X(UART4_ERR) X(UART5_RX_TX) X(UART5_ERR) X(CMP2) \
+    X(FTM3) X(DAC1) X(ADC1) X(I2C2) X(CAN0_ORed_Message_buffer) \
+    X(CAN0_Bus_Off) X(CAN0_Error) X(CAN0_Tx_Warning) X(CAN0_Rx_Warning) \
+    X(CAN0_Wake_Up) X(SDHC) X(ENET_1588_Timer) X(ENET_Transmit) \
+    X(ENET_Receive) X(ENET_Error)
+
+// Weak: a handler the firmware does not define resolves to NULL
+#define DECLARE_ISR(name) void name##_IRQHandler(void) __attribute__((weak));
+K64SIM_IRQ_LIST(DECLARE_ISR)
+void SysTick_Handler(void) __attribute__((weak));
+
+#define ISR_ENTRY(name) name##_IRQHandler,
+static void (*const vectors[])(void) = { K64SIM_IRQ_LIST(ISR_ENTRY) };
+
+_Static_assert(sizeof(vectors) / sizeof(vectors[0]) == N_IRQ, "vector table out of sync with IRQn_Type");
+
+/*******************************************************************************
+ * State
+ ******************************************************************************/
+
+volatile uint32_t k64sim_primask;
+k64sim_stats_t k64sim_counters;
+
+static const k64sim_model_t *const models[] =
+{
+    &k64sim_nvic_model,
+    &k64sim_pit_model,
+    &k64sim_dma_model,
+    &k64sim_adc_model,
+    &k64sim_dac_model,
+    &k64sim_ftm_model,
+    &k64sim_uart_model,
+    &k64sim_gpio_model,
+};
+#define N_MODELS (sizeof(models) / sizeof(models[0]))
+
+static uint8_t *alias_base;
+static const k64sim_trap_t *page_trap[N_PAGES];
+static k64sim_time_t now_t;
+static bool initialized;
+static bool in_isr;
+
+// Access in flight between SIGSEGV and SIGTRAP
+static struct
+{
+    bool active;
+    bool write;
+    uint32_t addr;
+    uint32_t old;
+    const k64sim_trap_t *trap;
+} pending;
+
+static uint32_t nvic_enabled[N_IRQ_WORDS];
+static uint32_t nvic_pending[N_IRQ_WORDS];
+static bool systick_pending;
+static k64sim_time_t systick_next = K64SIM_NEVER;
+
+/*******************************************************************************
+ * Address helpers
+ ******************************************************************************/
+
+static int page_index(uint32_t addr)
+{
+    if (addr >= K64SIM_PERIPH_BASE && addr - K64SIM_PERIPH_BASE < K64SIM_PERIPH_SIZE)
+    {
+        return (int)((addr - K64SIM_PERIPH_BASE) / K64SIM_PAGE);
+    }
+    if (addr >= K64SIM_PPB_BASE && addr - K64SIM_PPB_BASE < K64SIM_PPB_SIZE)
+    {
+        return (int)PERIPH_PAGES;
+    }
+    return -1;
+}
+
+static void *page_view(int idx)
+{
+    return idx < (int)PERIPH_PAGES
+        ? (void *)(uintptr_t)(K64SIM_PERIPH_BASE + (uint32_t)idx * K64SIM_PAGE)
+        : (void *)(uintptr_t)K64SIM_PPB_BASE;
+}
+
+void *k64sim_alias(uint32_t addr)
+{
+    if (addr >= K64SIM_PERIPH_BASE && addr - K64SIM_PERIPH_BASE < K64SIM_PERIPH_SIZE)
+    {
+        return alias_base + (addr - K64SIM_PERIPH_BASE);
+    }
+    if (addr >= K64SIM_PPB_BASE && addr - K64SIM_PPB_BASE < K64SIM_PPB_SIZE)
+    {
+        return alias_base + K64SIM_PERIPH_SIZE + (addr - K64SIM_PPB_BASE);
+    }
+    return NULL;
+}
+
+static uint32_t load(const volatile void *p, unsigned size)
+{
+    switch (size)
+    {
+        case 1: return *(const volatile uint8_t *)p;
+        case 2: return *(const volatile uint16_t *)p;
+        default: return *(const volatile uint32_t *)p;
+    }
+}
+
+static void store(volatile void *p, uint32_t value, unsigned size)
+{
+    switch (size)
+    {
+        case 1: *(volatile uint8_t *)p = (uint8_t)value; break;
+        case 2: *(volatile uint16_t *)p = (uint16_t)value; break;
+        default: *(volatile uint32_t *)p = value; break;
+    }
+}
+
+static inline uint32_t alias_word(uint32_t addr)
+{
+    return *(volatile uint32_t *)k64sim_alias(addr & ~3u);
+}
+
+static inline void alias_set(uint32_t addr, uint32_t value)
+{
+    *(volatile uint32_t *)k64sim_alias(addr) = value;
+}
+
+uint32_t k64sim_bus_read(uint32_t addr, unsigned size)
+{
+    void *p = k64sim_alias(addr);
+    if (p == NULL)
+    {
+        return load((const void *)(uintptr_t)addr, size);
+    }
+    const k64sim_trap_t *trap = page_trap[page_index(addr)];
+    if (trap && trap->read)
+    {
+        trap->read(addr);
+    }
+    return load(p, size);
+}
+
+void k64sim_bus_write(uint32_t addr, uint32_t value, unsigned size)
+{
+    void *p = k64sim_alias(addr);
+    if (p == NULL)
+    {
+        store((void *)(uintptr_t)addr, value, size);
+        return;
+    }
+    const uint32_t old = alias_word(addr);
+    store(p, value, size);
+    const k64sim_trap_t *trap = page_trap[page_index(addr)];
+    if (trap && trap->write)
+    {
+        trap->write(addr, old, alias_word(addr));
+    }
+}
+
+/*******************************************************************************
+ * Access traps
+ ******************************************************************************/
+
+static void on_segv(int sig, siginfo_t *si, void *ctx)
+{
+    (void)sig;
+    ucontext_t *uc = ctx;
+    const uintptr_t a = (uintptr_t)si->si_addr;
+    const int idx = (a > UINT32_MAX) ? -1 : page_index((uint32_t)a);
+    const k64sim_trap_t *trap = (idx < 0) ? NULL : page_trap[idx];
+
+    if (trap == NULL || pending.active)
+    {
+        // A real crash: let it happen again with the default action
+        signal(SIGSEGV, SIG_DFL);
+        return;
+    }
+
+    pending.active = true;
+    pending.addr = (uint32_t)a;
+    pending.write = (uc->uc_mcontext.gregs[REG_ERR] & PF_WRITE) != 0;
+    pending.trap = trap;
+    pending.old = alias_word(pending.addr);
+    if (!pending.write && trap->read)
+    {
+        trap->read(pending.addr);
+    }
+    k64sim_counters.reg_traps++;
+
+    mprotect(page_view(idx), K64SIM_PAGE, PROT_READ | PROT_WRITE);
+    uc->uc_mcontext.gregs[REG_EFL] |= EFLAGS_TF;
+}
+
+static void on_trap(int sig, siginfo_t *si, void *ctx)
+{
+    (void)sig;
+    (void)si;
+    ucontext_t *uc = ctx;
+    if (!pending.active)
+    {
+        signal(SIGTRAP, SIG_DFL);
+        return;
+    }
+    uc->uc_mcontext.gregs[REG_EFL] &= ~EFLAGS_TF;
+    mprotect(page_view(page_index(pending.addr)), K64SIM_PAGE, PROT_NONE);
+    pending.active = false;
+
+    const uint32_t now_word = alias_word(pending.addr);
+    if ((pending.write || now_word != pending.old) && pending.trap->write)
+    {
+        pending.trap->write(pending.addr, pending.old, now_word);
+    }
+}
+
+/*******************************************************************************
+ * NVIC, SysTick and ISR dispatch
+ ******************************************************************************/
+
+static void nvic_sync(void)
+{
+    for (unsigned k = 0; k < N_IRQ_WORDS; k++)
+    {
+        alias_set(NVIC_ISER0 + 4u * k, nvic_enabled[k]);
+        alias_set(NVIC_ICER0 + 4u * k, nvic_enabled[k]);
+        alias_set(NVIC_ISPR0 + 4u * k, nvic_pending[k]);
+        alias_set(NVIC_ICPR0 + 4u * k, nvic_pending[k]);
+    }
+    uint32_t icsr = alias_word(SCB_ICSR) & ~(ICSR_PENDSTSET | ICSR_PENDSTCLR);
+    alias_set(SCB_ICSR, icsr | (systick_pending ? ICSR_PENDSTSET : 0u));
+}
+
+void k64sim_irq_raise(IRQn_Type irq)
+{
+    if (irq == SysTick_IRQn)
+    {
+        systick_pending = true;
+    }
+    else if (irq >= 0 && (unsigned)irq < N_IRQ)
+    {
+        nvic_pending[irq / 32] |= 1u << (irq % 32);
+    }
+    nvic_sync();
+}
+
+static unsigned irq_priority(int irq)
+{
+    const uint8_t *ip = k64sim_alias(irq < 0 ? SCB_SHPR_SYSTICK : NVIC_IPR0 + (uint32_t)irq);
+    return *ip >> (8 - __NVIC_PRIO_BITS);
+}
+
+// Runs pending ISRs to completion, highest priority (lowest value) first
+static void dispatch(void)
+{
+    if (in_isr)
+    {
+        return;
+    }
+    in_isr = true;
+    while (!k64sim_primask)
+    {
+        int best = -2;
+        unsigned best_prio = ~0u;
+        if (systick_pending)
+        {
+            best = -1;
+            best_prio = irq_priority(-1);
+        }
+        for (unsigned i = 0; i < N_IRQ; i++)
+        {
+            if ((nvic_pending[i / 32] & nvic_enabled[i / 32]) & (1u << (i % 32)))
+            {
+                const unsigned prio = irq_priority((int)i);
+                if (prio < best_prio)
+                {
+                    best = (int)i;
+                    best_prio = prio;
+                }
+            }
+        }
+        if (best == -2)
+        {
+            break;
+        }
+
+        void (*isr)(void);
+        if (best < 0)
+        {
+            systick_pending = false;
+            isr = SysTick_Handler;
+        }
+        else
+        {
+            nvic_pending[best / 32] &= ~(1u << (best % 32));
+            isr = vectors[best];
+            if (isr == NULL)
+            {
+                // Real hardware would spin in the default handler
+                nvic_enabled[best / 32] &= ~(1u << (best % 32));
+                k64sim_counters.missing_isr++;
+                fprintf(stderr, "k64sim: IRQ %d enabled without a handler, disabled\n", best);
+            }
+        }
+        nvic_sync();
+        if (isr)
+        {
+            k64sim_counters.irqs++;
+            isr();
+        }
+    }
+    in_isr = false;
+}
+
+static k64sim_time_t systick_period(void)
+{
+    const uint32_t load_val = alias_word(SYST_RVR) & SysTick_LOAD_RELOAD_Msk;
+    return (k64sim_time_t)load_val + 1u;
+}
+
+static void systick_restart(void)
+{
+    const uint32_t csr = alias_word(SYST_CSR);
+    systick_next = (csr & SysTick_CTRL_ENABLE_Msk) ? now_t + systick_period() : K64SIM_NEVER;
+}
+
+static void ppb_read(uint32_t addr)
+{
+    if ((addr & ~3u) == SYST_CVR && systick_next != K64SIM_NEVER)
+    {
+        // Counts down from LOAD to 0, one per core cycle
+        alias_set(SYST_CVR, (uint32_t)(systick_next - now_t - 1u) & SysTick_VAL_CURRENT_Msk);
+    }
+}
+
+static void ppb_write(uint32_t addr, uint32_t old_word, uint32_t new_word)
+{
+    const uint32_t word = addr & ~3u;
+
+    if (word >= NVIC_ISER0 && word < NVIC_ISER0 + 4u * N_IRQ_WORDS)
+    {
+        nvic_enabled[(word - NVIC_ISER0) / 4u] |= new_word;
+    }
+    else if (word >= NVIC_ICER0 && word < NVIC_ICER0 + 4u * N_IRQ_WORDS)
+    {
+        nvic_enabled[(word - NVIC_ICER0) / 4u] &= ~new_word;
+    }
+    else if (word >= NVIC_ISPR0 && word < NVIC_ISPR0 + 4u * N_IRQ_WORDS)
+    {
+        nvic_pending[(word - NVIC_ISPR0) / 4u] |= new_word;
+    }
+    else if (word >= NVIC_ICPR0 && word < NVIC_ICPR0 + 4u * N_IRQ_WORDS)
+    {
+        nvic_pending[(word - NVIC_ICPR0) / 4u] &= ~new_word;
+    }
+    else if (word == NVIC_STIR)
+    {
+        const uint32_t irq = new_word & 0x1FFu;
+        if (irq < N_IRQ)
+        {
+            nvic_pending[irq / 32] |= 1u << (irq % 32);
+        }
+    }
+    else if (word == SCB_ICSR)
+    {
+        if (new_word & ICSR_PENDSTSET)
+        {
+            systick_pending = true;
+        }
+        if (new_word & ICSR_PENDSTCLR)
+        {
+            systick_pending = false;
+        }
+    }
+    else if (word == SYST_CSR)
+    {
+        if ((old_word ^ new_word) & SysTick_CTRL_ENABLE_Msk)
+        {
+            systick_restart();
+        }
+        return;
+    }
+    else if (word == SYST_CVR)
+    {
+        // Any write clears the counter and COUNTFLAG
+        alias_set(SYST_CVR, 0u);
+        alias_set(SYST_CSR, alias_word(SYST_CSR) & ~SysTick_CTRL_COUNTFLAG_Msk);
+        systick_restart();
+        return;
+    }
+    else
+    {
+        return;     // IPR, SHPR, CPACR, ...: plain memory
+    }
+    nvic_sync();
+}
+
+static void nvic_reset(void)
+{
+    memset(nvic_enabled, 0, sizeof(nvic_enabled));
+    memset(nvic_pending, 0, sizeof(nvic_pending));
+    systick_pending = false;
+    systick_next = K64SIM_NEVER;
+    nvic_sync();
+}
+
+static k64sim_time_t nvic_next_event(void)
+{
+    return systick_next;
+}
+
+static void nvic_run(k64sim_time_t now)
+{
+    if (systick_next > now)
+    {
+        return;
+    }
+    const uint32_t csr = alias_word(SYST_CSR);
+    alias_set(SYST_CSR, csr | SysTick_CTRL_COUNTFLAG_Msk);
+    if (csr & SysTick_CTRL_TICKINT_Msk)
+    {
+        k64sim_irq_raise(SysTick_IRQn);
+    }
+    systick_next += systick_period();
+}
+
+static const k64sim_trap_t nvic_traps[] =
+{
+    { K64SIM_PPB_BASE, K64SIM_PPB_SIZE, ppb_read, ppb_write },
+    { 0 }
+};
+
+const k64sim_model_t k64sim_nvic_model =
+{
+    "nvic", nvic_reset, nvic_next_event, nvic_run, nvic_traps
+};
+
+/*******************************************************************************
+ * Public API
+ ******************************************************************************/
+
+int k64sim_init(void)
+{
+    static int probe;
+    if (initialized)
+    {
+        return 0;
+    }
+    if ((uintptr_t)&probe > UINT32_MAX)
+    {
+        fprintf(stderr, "k64sim: data above 4 GiB, DMA addresses would not fit; build with -no-pie\n");
+        return -2;
+    }
+
+    const int fd = memfd_create("k64sim", 0);
+    if (fd < 0 || ftruncate(fd, TOTAL_SIZE) != 0)
+    {
+        perror("k64sim: memfd");
+        return -1;
+    }
+    alias_base = mmap(NULL, TOTAL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    void *periph = mmap((void *)(uintptr_t)K64SIM_PERIPH_BASE, K64SIM_PERIPH_SIZE,
+                        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+    void *ppb = mmap((void *)(uintptr_t)K64SIM_PPB_BASE, K64SIM_PPB_SIZE,
+                     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED_NOREPLACE, fd,
+                     K64SIM_PERIPH_SIZE);
+    close(fd);
+    if (alias_base == MAP_FAILED
+        || periph != (void *)(uintptr_t)K64SIM_PERIPH_BASE
+        || ppb != (void *)(uintptr_t)K64SIM_PPB_BASE)
+    {
+        fprintf(stderr, "k64sim: cannot map the register space at its K64 addresses\n");
+        return -1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_flags = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_sigaction = on_segv;
+    sigaction(SIGSEGV, &sa, NULL);
+    sa.sa_sigaction = on_trap;
+    sigaction(SIGTRAP, &sa, NULL);
+
+    now_t = 0;
+    k64sim_primask = 0;
+    memset(&k64sim_counters, 0, sizeof(k64sim_counters));
+    for (unsigned m = 0; m < N_MODELS; m++)
+    {
+        models[m]->reset();
+        for (const k64sim_trap_t *t = models[m]->traps; t && t->size; t++)
+        {
+            for (uint32_t off = 0; off < t->size; off += K64SIM_PAGE)
+            {
+                const int idx = page_index(t->base + off);
+                if (idx < 0)
+                {
+                    continue;
+                }
+                page_trap[idx] = t;
+                mprotect(page_view(idx), K64SIM_PAGE, PROT_NONE);
+            }
+        }
+    }
+
+    initialized = true;
+    return 0;
+}
+
+k64sim_time_t k64sim_now(void)
+{
+    return now_t;
+}
+
+void k64sim_run_until(k64sim_time_t t)
+{
+    dispatch();
+    for (;;)
+    {
+        k64sim_time_t next = K64SIM_NEVER;
+        for (unsigned m = 0; m < N_MODELS; m++)
+        {
+            const k64sim_time_t n = models[m]->next_event();
+            if (n < next)
+            {
+                next = n;
+            }
+        }
+        if (next > t)
+        {
+            break;
+        }
+        if (next > now_t)
+        {
+            now_t = next;
+        }
+        for (unsigned m = 0; m < N_MODELS; m++)
+        {
+            models[m]->run(now_t);
+        }
+        dispatch();
+    }
+    if (t > now_t)
+    {
+        now_t = t;
+    }
+}
+
+void k64sim_run(k64sim_time_t dt)
+{
+    k64sim_run_until(now_t + dt);
+}
+
+const k64sim_stats_t *k64sim_stats(void)
+{
+    return &k64sim_counters;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file k64sim.h
+ * @brief Simulador de periféricos del MK64F12 a nivel registro, para correr
+ * los drivers sin cambios en una PC con Linux x86-64.
+ *
+ * Los bloques de registros se mapean en sus direcciones reales (0x40000000 y
+ * la página del NVIC en 0xE000E000), así que ADC0, DMA0, PIT, etc. de
+ * MK64F12.h apuntan a memoria del proceso. Las páginas de los periféricos
+ * modelados quedan sin permisos: cada acceso del firmware cae en SIGSEGV, el
+ * simulador deja pasar esa instrucción con un paso simple (SIGTRAP) y después
+ * aplica el efecto del registro (W1C, SERQ/CINT del DMA, escritura de D en la
+ * UART, ...). Los modelos escriben por un segundo mapeo sin protección.
+ *
+ * Modelos: PIT, eDMA + DMAMUX (TCDs, scatter-gather, links), ADC0/1
+ * (disparo por software, por PIT vía SIM_SOPT7, calibración), DAC0/1 (con
+ * buffer), FTM0-3 (contador, PWM, output compare, input capture, DMA),
+ * UART0-5 (FIFOs a la velocidad de línea), GPIO/PORT (IRQs por flanco),
+ * NVIC y SysTick.
+ *
+ * El tiempo es virtual, en ciclos del core (K64SIM_CORE_HZ): solo avanza
+ * dentro de k64sim_run_until(), que también despacha las interrupciones (sin
+ * anidar, cada ISR corre hasta el final). El código de main no consume
+ * tiempo: el banco decide cuánto corre el reloj entre llamadas a App_Run().
+ * Las esperas activas que dependen del tiempo se resuelven al leer el
+ * registro: la calibración del ADC termina al escribir CAL y una UART con la
+ * FIFO llena vacía un carácter cuando se lee S1.
+ *
+ * Límites: no hay PDB, modo up-down ni combine en el FTM, ni modulación del
+ * DAC por PDB. Las direcciones que maneja el DMA tienen que caber en 32 bits,
+ * por eso el binario se compila con -no-pie.
+ *
+ * Compilar los drivers con -include sim/k64sim_cmsis.h para reemplazar los
+ * intrínsecos de ARM de cmsis_gcc.h, ver bench_sim_loopback.c.
+ */
+
+#ifndef _K64SIM_H_
+#define _K64SIM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @def K64SIM_CORE_HZ
+ * @brief Reloj del core (y de UART0/1, SysTick); el bus es la mitad.
+ */
+#define K64SIM_CORE_HZ (100000000ull)
+
+/**
+ * @def K64SIM_BUS_HZ
+ * @brief Reloj del bus (PIT, ADC, FTM, UART2-5).
+ */
+#define K64SIM_BUS_HZ (K64SIM_CORE_HZ / 2u)
+
+/**
+ * @def K64SIM_US(us)
+ * @brief Microsegundos a ciclos del core.
+ */
+#define K64SIM_US(us) ((k64sim_time_t)(us) * (K64SIM_CORE_HZ / 1000000u))
+
+/**
+ * @brief Tiempo virtual en ciclos del core desde k64sim_init().
+ */
+typedef uint64_t k64sim_time_t;
+
+/**
+ * @brief Contadores del simulador.
+ */
+typedef struct
+{
+    uint64_t reg_traps;         /**< Accesos del firmware a registros modelados. */
+    uint64_t irqs;              /**< ISRs despachadas (incluye SysTick). */
+    uint64_t dma_minor_loops;   /**< Loops menores ejecutados por el eDMA. */
+    uint64_t adc_conversions;   /**< Conversiones terminadas (ADC0 + ADC1). */
+    uint64_t uart_stalls;       /**< Caracteres vaciados por una espera activa sobre S1. */
+    uint64_t missing_isr;       /**< IRQs habilitadas sin handler definido. */
+} k64sim_stats_t;
+
+/**
+ * @brief Entrada analógica del ADC.
+ *
+ * @param adc 0 o 1.
+ * @param channel Canal ADCH de SC1.
+ * @param t Instante de muestreo.
+ * @param user Cookie de k64sim_adc_input().
+ * @return Tensión relativa a VREFH, de 0 a 1 (se satura).
+ */
+typedef double (*k64sim_analog_fn)(uint8_t adc, uint8_t channel, k64sim_time_t t, void *user);
+
+/**
+ * @brief Observador de escrituras al DAC (firmware o DMA).
+ */
+typedef void (*k64sim_dac_fn)(uint8_t dac, uint16_t code, k64sim_time_t t, void *user);
+
+/**
+ * @brief Observador de bytes que salen por una UART (al terminar el stop bit).
+ */
+typedef void (*k64sim_uart_fn)(uint8_t uart, uint16_t data, k64sim_time_t t, void *user);
+
+/**
+ * @brief Observador de cambios en salidas GPIO.
+ */
+typedef void (*k64sim_gpio_fn)(uint8_t port, uint8_t pin, bool level, k64sim_time_t t, void *user);
+
+/**
+ * @brief Mapea los registros, instala los handlers de señales y resetea los modelos.
+ *
+ * Por defecto la entrada de ADC0 y ADC1 es la salida de DAC0 (loopback).
+ *
+ * @return 0 si éxito, <0 si no se pudo mapear (otro mapeo en 0x40000000 o
+ * binario PIE con datos fuera de los 32 bits).
+ */
+int k64sim_init(void);
+
+/**
+ * @brief Tiempo virtual actual.
+ */
+k64sim_time_t k64sim_now(void);
+
+/**
+ * @brief Avanza el reloj hasta t procesando eventos e interrupciones.
+ *
+ * @param t Instante absoluto; si ya pasó solo despacha las IRQs pendientes.
+ */
+void k64sim_run_until(k64sim_time_t t);
+
+/**
+ * @brief Avanza el reloj dt ciclos del core.
+ */
+void k64sim_run(k64sim_time_t dt);
+
+/**
+ * @brief Contadores acumulados desde k64sim_init().
+ */
+const k64sim_stats_t *k64sim_stats(void);
+
+/**
+ * @brief Cambia la fuente analógica de un ADC.
+ *
+ * @param adc 0 o 1.
+ * @param fn Función de entrada, NULL para volver al loopback con DAC0.
+ * @param user Cookie para fn.
+ */
+void k64sim_adc_input(uint8_t adc, k64sim_analog_fn fn, void *user);
+
+/**
+ * @brief Salida actual de un DAC, de 0 a 1 (0 con el DAC apagado).
+ */
+double k64sim_dac_level(uint8_t dac);
+
+/**
+ * @brief Registra un observador para las escrituras a DAC0/DAC1 (NULL para quitarlo).
+ */
+void k64sim_dac_watch(k64sim_dac_fn fn, void *user);
+
+/**
+ * @brief Encola bytes para que lleguen por RX a la velocidad de línea.
+ *
+ * @return Bytes encolados (menos que len si la cola del simulador se llena).
+ */
+size_t k64sim_uart_rx(uint8_t uart, const uint8_t *data, size_t len);
+
+/**
+ * @brief Registra un observador para los bytes transmitidos (NULL para quitarlo).
+ */
+void k64sim_uart_tx_watch(k64sim_uart_fn fn, void *user);
+
+/**
+ * @brief Fija el nivel externo de un pin; dispara la IRQ/DMA del PORT si corresponde.
+ *
+ * @param port 0 (PTA) a 4 (PTE).
+ * @param pin 0 a 31.
+ * @param level Nivel lógico.
+ */
+void k64sim_gpio_input(uint8_t port, uint8_t pin, bool level);
+
+/**
+ * @brief Nivel actual de un pin (PDOR si es salida, el externo si es entrada).
+ */
+bool k64sim_gpio_level(uint8_t port, uint8_t pin);
+
+/**
+ * @brief Registra un observador para las salidas GPIO (NULL para quitarlo).
+ */
+void k64sim_gpio_watch(k64sim_gpio_fn fn, void *user);
+
+/**
+ * @brief Flanco en la entrada de un canal de FTM (input capture).
+ *
+ * Si el canal está en input capture con ese flanco, captura CNT en CnV y
+ * levanta CHF (IRQ o DMA según CnSC).
+ */
+void k64sim_ftm_edge(uint8_t ftm, uint8_t ch, bool rising);
+
+/**
+ * @brief Nivel de la salida PWM (edge-aligned) de un canal de FTM.
+ */
+bool k64sim_ftm_output(uint8_t ftm, uint8_t ch);
+
+#endif // _K64SIM_H_
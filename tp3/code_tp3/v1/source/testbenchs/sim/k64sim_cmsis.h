@@ -0,0 +1,108 @@
+/**
+ * @file k64sim_cmsis.h
+ * @brief Reemplazo de host para cmsis_gcc.h.
+ *
+ * Se incluye antes que todo con -include: define el guard __CMSIS_GCC_H, así
+ * que core_cm4.h toma de acá los atributos del compilador y los intrínsecos
+ * (sin assembler de ARM). __disable_irq()/__enable_irq() enmascaran el
+ * despacho de interrupciones del simulador.
+ */
+
+#ifndef __CMSIS_GCC_H
+#define __CMSIS_GCC_H
+
+// Este header entra antes que cualquier header del sistema: k64sim.c
+// necesita memfd_create() y los REG_* del ucontext
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+
+#define __ASM                   __asm
+#define __INLINE                inline
+#define __STATIC_INLINE         static inline
+#define __STATIC_FORCEINLINE    __attribute__((always_inline)) static inline
+#define __NO_RETURN             __attribute__((__noreturn__))
+#define __USED                  __attribute__((used))
+#define __WEAK                  __attribute__((weak))
+#define __PACKED                __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT         struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION          union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)            __attribute__((aligned(x)))
+#define __RESTRICT              __restrict
+
+#define __UNALIGNED_UINT16_READ(addr)       (*(const uint16_t *)(const void *)(addr))
+#define __UNALIGNED_UINT16_WRITE(addr, val) ((void)(*(uint16_t *)(void *)(addr) = (val)))
+#define __UNALIGNED_UINT32_READ(addr)       (*(const uint32_t *)(const void *)(addr))
+#define __UNALIGNED_UINT32_WRITE(addr, val) ((void)(*(uint32_t *)(void *)(addr) = (val)))
+
+/**
+ * @brief PRIMASK simulado: con 1 k64sim_run_until() no despacha IRQs.
+ */
+extern volatile uint32_t k64sim_primask;
+
+__STATIC_FORCEINLINE void __enable_irq(void) { k64sim_primask = 0u; }
+__STATIC_FORCEINLINE void __disable_irq(void) { k64sim_primask = 1u; }
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void) { return k64sim_primask; }
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t pm) { k64sim_primask = pm & 1u; }
+__STATIC_FORCEINLINE uint32_t __get_BASEPRI(void) { return 0u; }
+__STATIC_FORCEINLINE void __set_BASEPRI(uint32_t bp) { (void)bp; }
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void) { return 0u; }
+__STATIC_FORCEINLINE uint32_t __get_FPSCR(void) { return 0u; }
+__STATIC_FORCEINLINE void __set_FPSCR(uint32_t fpscr) { (void)fpscr; }
+
+#define __NOP()     ((void)0)
+#define __WFI()     ((void)0)
+#define __WFE()     ((void)0)
+#define __SEV()     ((void)0)
+#define __BKPT(v)   __builtin_trap()
+
+__STATIC_FORCEINLINE void __ISB(void) { __sync_synchronize(); }
+__STATIC_FORCEINLINE void __DSB(void) { __sync_synchronize(); }
+__STATIC_FORCEINLINE void __DMB(void) { __sync_synchronize(); }
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t v) { return __builtin_bswap32(v); }
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t v)
+{
+    return ((v & 0xFF00FF00u) >> 8) | ((v & 0x00FF00FFu) << 8);
+}
+__STATIC_FORCEINLINE int16_t __REVSH(int16_t v) { return (int16_t)__builtin_bswap16((uint16_t)v); }
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t v, uint32_t n)
+{
+    n &= 31u;
+    return n ? (v >> n) | (v << (32u - n)) : v;
+}
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t v)
+{
+    uint32_t r = 0u;
+    for (int i = 0; i < 32; i++, v >>= 1)
+    {
+        r = (r << 1) | (v & 1u);
+    }
+    return r;
+}
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t v) { return v ? (uint8_t)__builtin_clz(v) : 32u; }
+
+__STATIC_FORCEINLINE int32_t __SSAT(int32_t val, uint32_t sat)
+{
+    const int32_t max = (int32_t)((1u << (sat - 1u)) - 1u);
+    const int32_t min = -1 - max;
+    return val > max ? max : (val < min ? min : val);
+}
+__STATIC_FORCEINLINE uint32_t __USAT(int32_t val, uint32_t sat)
+{
+    const uint32_t max = (1u << sat) - 1u;
+    return val < 0 ? 0u : ((uint32_t)val > max ? max : (uint32_t)val);
+}
+
+// Single core, no preemption inside main code: exclusives always succeed
+__STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t *addr) { return *addr; }
+__STATIC_FORCEINLINE uint32_t __STREXW(uint32_t v, volatile uint32_t *addr) { *addr = v; return 0u; }
+__STATIC_FORCEINLINE uint16_t __LDREXH(volatile uint16_t *addr) { return *addr; }
+__STATIC_FORCEINLINE uint32_t __STREXH(uint16_t v, volatile uint16_t *addr) { *addr = v; return 0u; }
+__STATIC_FORCEINLINE uint8_t __LDREXB(volatile uint8_t *addr) { return *addr; }
+__STATIC_FORCEINLINE uint32_t __STREXB(uint8_t v, volatile uint8_t *addr) { *addr = v; return 0u; }
+__STATIC_FORCEINLINE void __CLREX(void) {}
+
+#endif // __CMSIS_GCC_H
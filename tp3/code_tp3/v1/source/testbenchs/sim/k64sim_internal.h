@@ -0,0 +1,126 @@
+/**
+ * @file k64sim_internal.h
+ * @brief Interfaz entre el núcleo del simulador (k64sim.c) y los modelos de periféricos.
+ */
+
+#ifndef _K64SIM_INTERNAL_H_
+#define _K64SIM_INTERNAL_H_
+
+#include "k64sim.h"
+#include "MK64F12.h"
+
+#define K64SIM_PERIPH_BASE  (0x40000000u)   // AIPS0/AIPS1 + GPIO
+#define K64SIM_PERIPH_SIZE  (0x00100000u)
+#define K64SIM_PPB_BASE     (0xE000E000u)   // SysTick, NVIC, SCB
+#define K64SIM_PPB_SIZE     (0x00001000u)
+#define K64SIM_PAGE         (0x1000u)
+
+#define K64SIM_NEVER        (UINT64_MAX)
+
+/**
+ * @brief Ciclos del core por ciclo del bus.
+ */
+#define K64SIM_BUS_DIV      ((k64sim_time_t)(K64SIM_CORE_HZ / K64SIM_BUS_HZ))
+
+/**
+ * @brief Vista sin protección de una dirección de registro (para los modelos).
+ */
+void *k64sim_alias(uint32_t addr);
+
+/**
+ * @def K64SIM_REGS(type, base)
+ * @brief Bloque de registros visto por un modelo, p. ej. K64SIM_REGS(PIT_Type, PIT_BASE).
+ */
+#define K64SIM_REGS(type, base) ((type *)k64sim_alias(base))
+
+/**
+ * @def K64SIM_RO32(reg)
+ * @brief Escritura desde el modelo a un registro de solo lectura (__I) de 32 bits.
+ */
+#define K64SIM_RO32(reg) (*(volatile uint32_t *)&(reg))
+
+/**
+ * @def K64SIM_RO8(reg)
+ * @brief Ídem para registros de 8 bits (UART).
+ */
+#define K64SIM_RO8(reg) (*(volatile uint8_t *)&(reg))
+
+/**
+ * @brief Hooks de un rango de registros atrapado (múltiplo de K64SIM_PAGE).
+ *
+ * read corre antes de que la instrucción lea addr; write corre después de
+ * que escribió, con la palabra alineada que contiene addr antes y después.
+ * Cualquiera puede ser NULL.
+ */
+typedef struct
+{
+    uint32_t base;
+    uint32_t size;
+    void (*read)(uint32_t addr);
+    void (*write)(uint32_t addr, uint32_t old_word, uint32_t new_word);
+} k64sim_trap_t;
+
+/**
+ * @brief Un modelo de periférico.
+ */
+typedef struct
+{
+    const char *name;
+    void (*reset)(void);                /**< Valores de reset en los registros. */
+    k64sim_time_t (*next_event)(void);  /**< Próximo evento absoluto o K64SIM_NEVER. */
+    void (*run)(k64sim_time_t now);     /**< Procesa los eventos que vencen en now. */
+    const k64sim_trap_t *traps;         /**< Rangos atrapados, terminados en size 0. */
+} k64sim_model_t;
+
+extern const k64sim_model_t k64sim_nvic_model;
+extern const k64sim_model_t k64sim_pit_model;
+extern const k64sim_model_t k64sim_dma_model;
+extern const k64sim_model_t k64sim_adc_model;
+extern const k64sim_model_t k64sim_dac_model;
+extern const k64sim_model_t k64sim_ftm_model;
+extern const k64sim_model_t k64sim_uart_model;
+extern const k64sim_model_t k64sim_gpio_model;
+
+extern k64sim_stats_t k64sim_counters;
+
+/**
+ * @brief Marca una IRQ como pendiente (IRQn >= 0, o SysTick_IRQn).
+ */
+void k64sim_irq_raise(IRQn_Type irq);
+
+/**
+ * @brief Lectura del bus como la haría el eDMA (registros con sus hooks, o RAM del proceso).
+ */
+uint32_t k64sim_bus_read(uint32_t addr, unsigned size);
+
+/**
+ * @brief Escritura del bus como la haría el eDMA.
+ */
+void k64sim_bus_write(uint32_t addr, uint32_t value, unsigned size);
+
+/**
+ * @brief Un periférico pide servicio al eDMA con su fuente del DMAMUX.
+ */
+void k64sim_dma_request(uint8_t source);
+
+/**
+ * @brief Disparo periódico del PIT para el canal ch (0-3) del DMAMUX.
+ */
+void k64sim_dma_trigger(uint8_t ch);
+
+/**
+ * @brief Timeout del canal ch del PIT, para los disparos de ADC por SIM_SOPT7.
+ */
+void k64sim_adc_pit_trigger(uint8_t ch);
+
+/**
+ * @brief Código del DAC que ve el pin (0 a 4095), 0 si está apagado.
+ */
+uint16_t k64sim_dac_code(uint8_t dac);
+
+/**
+ * @brief Avisa a los observadores que cambió un dato del DAC.
+ */
+void k64sim_dac_written(uint8_t dac);
+
+#endif // _K64SIM_INTERNAL_H_
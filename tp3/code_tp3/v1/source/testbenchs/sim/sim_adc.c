@@ -0,0 +1,282 @@
+/**
+ * @file sim_adc.c
+ * @brief Modelo de ADC0/ADC1: disparo por software (SC1A) o por PIT vía
+ * SIM_SOPT7, tiempo de conversión según CFG1/CFG2/SC3, promediado, modo
+ * continuo, COCO que se limpia al leer R, IRQ y pedido de DMA.
+ *
+ * La entrada se muestrea al empezar la conversión. La calibración termina
+ * apenas se escribe CAL. No hay PDB, comparación (ACFE) ni modo diferencial.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "k64sim_internal.h"
+
+#define N_ADC               (2u)
+#define ADCH_DISABLED       (0x1Fu)
+#define ADACK_CORE_CYCLES   (19u)       // ~5.2 MHz asynchronous clock
+#define PIT_TRGSEL_FIRST    (4u)        // SOPT7 ADCxTRGSEL = 4 + PIT channel
+
+static const uint32_t adc_base[N_ADC] = { ADC0_BASE, ADC1_BASE };
+static const IRQn_Type adc_irq[N_ADC] = { ADC0_IRQn, ADC1_IRQn };
+
+/**
+ * @brief Conversión en curso de cada ADC.
+ */
+static struct
+{
+    k64sim_time_t done_at;  /**< Fin de la conversión o K64SIM_NEVER. */
+    k64sim_time_t length;   /**< Duración, para el modo continuo. */
+    uint8_t index;          /**< SC1A (0) o SC1B (1). */
+    uint16_t code;          /**< Resultado ya muestreado. */
+} conv[N_ADC];
+
+static k64sim_analog_fn input_fn[N_ADC];
+static void *input_user[N_ADC];
+
+static inline ADC_Type *adc_regs(uint8_t adc)
+{
+    return K64SIM_REGS(ADC_Type, adc_base[adc]);
+}
+
+static double loopback(uint8_t adc, uint8_t channel, k64sim_time_t t, void *user)
+{
+    (void)adc;
+    (void)channel;
+    (void)t;
+    (void)user;
+    return k64sim_dac_level(0);
+}
+
+void k64sim_adc_input(uint8_t adc, k64sim_analog_fn fn, void *user)
+{
+    if (adc < N_ADC)
+    {
+        input_fn[adc] = fn ? fn : loopback;
+        input_user[adc] = user;
+    }
+}
+
+/**
+ * @brief Duración de una conversión en ciclos del core.
+ */
+static k64sim_time_t conversion_time(const ADC_Type *a)
+{
+    static const uint8_t lst_extra[4] = { 20, 12, 6, 2 };
+    const uint32_t cfg1 = a->CFG1;
+    const uint32_t cfg2 = a->CFG2;
+    const uint32_t sc3 = a->SC3;
+
+    k64sim_time_t adck;
+    switch ((cfg1 & ADC_CFG1_ADICLK_MASK) >> ADC_CFG1_ADICLK_SHIFT)
+    {
+        case 1: adck = 2u * K64SIM_BUS_DIV; break;
+        case 3: adck = ADACK_CORE_CYCLES; break;
+        default: adck = K64SIM_BUS_DIV; break;
+    }
+    adck <<= (cfg1 & ADC_CFG1_ADIV_MASK) >> ADC_CFG1_ADIV_SHIFT;
+
+    const uint32_t mode = (cfg1 & ADC_CFG1_MODE_MASK) >> ADC_CFG1_MODE_SHIFT;
+    uint32_t cycles = (mode == 3u) ? 25u : 20u;
+    if (cfg1 & ADC_CFG1_ADLSMP_MASK)
+    {
+        cycles += lst_extra[(cfg2 & ADC_CFG2_ADLSTS_MASK) >> ADC_CFG2_ADLSTS_SHIFT];
+    }
+    if (cfg2 & ADC_CFG2_ADHSC_MASK)
+    {
+        cycles += 2u;
+    }
+    const uint32_t avg = (sc3 & ADC_SC3_AVGE_MASK) ? 4u << ((sc3 & ADC_SC3_AVGS_MASK) >> ADC_SC3_AVGS_SHIFT) : 1u;
+
+    return adck * (3u + avg * cycles);
+}
+
+static uint16_t quantize(const ADC_Type *a, double v)
+{
+    static const uint32_t full_scale[4] = { 255u, 4095u, 1023u, 65535u };
+    const uint32_t fs = full_scale[(a->CFG1 & ADC_CFG1_MODE_MASK) >> ADC_CFG1_MODE_SHIFT];
+    if (!(v > 0.0))
+    {
+        return 0;
+    }
+    if (v >= 1.0)
+    {
+        return (uint16_t)fs;
+    }
+    return (uint16_t)lround(v * fs);
+}
+
+static void start(uint8_t adc, uint8_t index)
+{
+    ADC_Type *a = adc_regs(adc);
+    const uint8_t ch = (uint8_t)((a->SC1[index] & ADC_SC1_ADCH_MASK) >> ADC_SC1_ADCH_SHIFT);
+    if (ch == ADCH_DISABLED)
+    {
+        conv[adc].done_at = K64SIM_NEVER;
+        return;
+    }
+    const k64sim_time_t now = k64sim_now();
+    conv[adc].index = index;
+    conv[adc].length = conversion_time(a);
+    conv[adc].done_at = now + conv[adc].length;
+    conv[adc].code = quantize(a, input_fn[adc](adc, ch, now, input_user[adc]));
+}
+
+static void calibrate(ADC_Type *a)
+{
+    // Typical values from the reference manual's calibration example
+    a->OFS = 0x0004u;
+    a->CLPD = 0x0Au; a->CLPS = 0x20u; a->CLP4 = 0x200u; a->CLP3 = 0x100u;
+    a->CLP2 = 0x80u; a->CLP1 = 0x40u; a->CLP0 = 0x20u;
+    a->CLMD = 0x0Au; a->CLMS = 0x20u; a->CLM4 = 0x200u; a->CLM3 = 0x100u;
+    a->CLM2 = 0x80u; a->CLM1 = 0x40u; a->CLM0 = 0x20u;
+    a->SC3 &= ~(ADC_SC3_CAL_MASK | ADC_SC3_CALF_MASK);
+    a->SC1[0] |= ADC_SC1_COCO_MASK;
+}
+
+void k64sim_adc_pit_trigger(uint8_t ch)
+{
+    const uint32_t sopt7 = K64SIM_REGS(SIM_Type, SIM_BASE)->SOPT7;
+    for (uint8_t adc = 0; adc < N_ADC; adc++)
+    {
+        const uint32_t cfg = sopt7 >> (8u * adc);   // ADC1 fields sit 8 bits above ADC0's
+        if (!(cfg & SIM_SOPT7_ADC0ALTTRGEN_MASK)
+            || (cfg & SIM_SOPT7_ADC0TRGSEL_MASK) != PIT_TRGSEL_FIRST + ch
+            || !(adc_regs(adc)->SC2 & ADC_SC2_ADTRG_MASK)
+            || conv[adc].done_at != K64SIM_NEVER)
+        {
+            continue;
+        }
+        start(adc, (cfg & SIM_SOPT7_ADC0PRETRGSEL_MASK) ? 1u : 0u);
+    }
+}
+
+static int adc_index(uint32_t addr, uint32_t *ofs)
+{
+    for (uint8_t adc = 0; adc < N_ADC; adc++)
+    {
+        if (addr - adc_base[adc] < K64SIM_PAGE)
+        {
+            *ofs = (addr - adc_base[adc]) & ~3u;
+            return adc;
+        }
+    }
+    return -1;
+}
+
+static void adc_read(uint32_t addr)
+{
+    uint32_t ofs;
+    const int adc = adc_index(addr, &ofs);
+    if (adc >= 0 && (ofs == 0x10u || ofs == 0x14u))
+    {
+        // Reading Rn clears COCO in SC1n
+        adc_regs((uint8_t)adc)->SC1[(ofs - 0x10u) / 4u] &= ~ADC_SC1_COCO_MASK;
+    }
+}
+
+static void adc_write(uint32_t addr, uint32_t old_word, uint32_t new_word)
+{
+    (void)old_word;
+    uint32_t ofs;
+    const int adc = adc_index(addr, &ofs);
+    if (adc < 0)
+    {
+        return;
+    }
+    ADC_Type *a = adc_regs((uint8_t)adc);
+
+    switch (ofs)
+    {
+        case 0x00:
+        case 0x04:
+        {
+            // Any SC1n write aborts the conversion and clears COCO
+            const uint8_t index = (uint8_t)(ofs / 4u);
+            a->SC1[index] = new_word & ~ADC_SC1_COCO_MASK;
+            if (conv[adc].index == index)
+            {
+                conv[adc].done_at = K64SIM_NEVER;
+            }
+            if (index == 0 && !(a->SC2 & ADC_SC2_ADTRG_MASK))
+            {
+                start((uint8_t)adc, 0);
+            }
+            break;
+        }
+        case 0x24:
+            if (new_word & ADC_SC3_CAL_MASK)
+            {
+                calibrate(a);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void adc_reset(void)
+{
+    for (uint8_t adc = 0; adc < N_ADC; adc++)
+    {
+        ADC_Type *a = adc_regs(adc);
+        memset(a, 0, sizeof(*a));
+        a->SC1[0] = ADCH_DISABLED;
+        a->SC1[1] = ADCH_DISABLED;
+        a->OFS = 0x0004u;
+        a->PG = 0x8200u;
+        a->MG = 0x8200u;
+        conv[adc].done_at = K64SIM_NEVER;
+        input_fn[adc] = loopback;
+        input_user[adc] = NULL;
+    }
+}
+
+static k64sim_time_t adc_next_event(void)
+{
+    return conv[0].done_at < conv[1].done_at ? conv[0].done_at : conv[1].done_at;
+}
+
+static void adc_run(k64sim_time_t now)
+{
+    for (uint8_t adc = 0; adc < N_ADC; adc++)
+    {
+        if (conv[adc].done_at > now)
+        {
+            continue;
+        }
+        ADC_Type *a = adc_regs(adc);
+        const uint8_t index = conv[adc].index;
+        conv[adc].done_at = K64SIM_NEVER;
+
+        K64SIM_RO32(a->R[index]) = conv[adc].code;
+        a->SC1[index] |= ADC_SC1_COCO_MASK;
+        k64sim_counters.adc_conversions++;
+
+        if ((a->SC3 & ADC_SC3_ADCO_MASK) && !(a->SC2 & ADC_SC2_ADTRG_MASK))
+        {
+            start(adc, index);
+        }
+        if (a->SC1[index] & ADC_SC1_AIEN_MASK)
+        {
+            k64sim_irq_raise(adc_irq[adc]);
+        }
+        if (a->SC2 & ADC_SC2_DMAEN_MASK)
+        {
+            k64sim_dma_request((uint8_t)(40u + adc));
+        }
+    }
+}
+
+static const k64sim_trap_t adc_traps[] =
+{
+    { ADC0_BASE, K64SIM_PAGE, adc_read, adc_write },
+    { ADC1_BASE, K64SIM_PAGE, adc_read, adc_write },
+    { 0 }
+};
+
+const k64sim_model_t k64sim_adc_model =
+{
+    "adc", adc_reset, adc_next_event, adc_run, adc_traps
+};
@@ -0,0 +1,183 @@
+/**
+ * @file sim_dac.c
+ * @brief Modelo de DAC0/DAC1: dato directo o buffer de 16 palabras con
+ * puntero de lectura, disparo por software (DACSWTRG), flags de tope/fondo/
+ * watermark con IRQ y pedido de DMA.
+ *
+ * El disparo por hardware (PDB) y el modo swing del buffer no están
+ * modelados; swing avanza como el modo normal.
+ */
+
+#include <string.h>
+
+#include "k64sim_internal.h"
+
+#define N_DAC               (2u)
+#define DAC_OFS_SR          (0x20u)
+#define DAC_BFMD_ONETIME    (2u)
+
+static const uint32_t dac_base[N_DAC] = { DAC0_BASE, DAC1_BASE };
+static const IRQn_Type dac_irq[N_DAC] = { DAC0_IRQn, DAC1_IRQn };
+
+static uint16_t last_code[N_DAC];
+static k64sim_dac_fn watch_fn;
+static void *watch_user;
+
+static inline DAC_Type *dac_regs(uint8_t dac)
+{
+    return K64SIM_REGS(DAC_Type, dac_base[dac]);
+}
+
+uint16_t k64sim_dac_code(uint8_t dac)
+{
+    const DAC_Type *d = dac_regs(dac);
+    if (!(d->C0 & DAC_C0_DACEN_MASK))
+    {
+        return 0;
+    }
+    uint8_t rp = 0;
+    if (d->C1 & DAC_C1_DACBFEN_MASK)
+    {
+        rp = (uint8_t)((d->C2 & DAC_C2_DACBFRP_MASK) >> DAC_C2_DACBFRP_SHIFT);
+    }
+    return (uint16_t)(d->DAT[rp].DATL | ((d->DAT[rp].DATH & 0x0Fu) << 8));
+}
+
+double k64sim_dac_level(uint8_t dac)
+{
+    return dac < N_DAC ? k64sim_dac_code(dac) / 4095.0 : 0.0;
+}
+
+void k64sim_dac_watch(k64sim_dac_fn fn, void *user)
+{
+    watch_fn = fn;
+    watch_user = user;
+}
+
+void k64sim_dac_written(uint8_t dac)
+{
+    last_code[dac] = k64sim_dac_code(dac);
+    if (watch_fn)
+    {
+        watch_fn(dac, last_code[dac], k64sim_now(), watch_user);
+    }
+}
+
+/**
+ * @brief Avanza el puntero de lectura del buffer y levanta los flags.
+ */
+static void buffer_step(uint8_t dac)
+{
+    DAC_Type *d = dac_regs(dac);
+    const uint8_t c1 = d->C1;
+    if (!(c1 & DAC_C1_DACBFEN_MASK))
+    {
+        return;
+    }
+    const uint8_t up = (uint8_t)((d->C2 & DAC_C2_DACBFUP_MASK) >> DAC_C2_DACBFUP_SHIFT);
+    uint8_t rp = (uint8_t)((d->C2 & DAC_C2_DACBFRP_MASK) >> DAC_C2_DACBFRP_SHIFT);
+    const uint8_t mode = (uint8_t)((c1 & DAC_C1_DACBFMD_MASK) >> DAC_C1_DACBFMD_SHIFT);
+    const uint8_t wm = (uint8_t)((c1 & DAC_C1_DACBFWM_MASK) >> DAC_C1_DACBFWM_SHIFT);
+
+    uint8_t flags = 0;
+    if (rp >= up)
+    {
+        if (mode == DAC_BFMD_ONETIME)
+        {
+            return;
+        }
+        rp = 0;
+        flags |= DAC_SR_DACBFRPTF_MASK;
+    }
+    else
+    {
+        rp++;
+        if (rp == up)
+        {
+            flags |= DAC_SR_DACBFRPBF_MASK;
+        }
+        if (up >= wm + 1u && rp == up - (wm + 1u))
+        {
+            flags |= DAC_SR_DACBFWMF_MASK;
+        }
+    }
+    d->C2 = (uint8_t)((d->C2 & ~DAC_C2_DACBFRP_MASK) | DAC_C2_DACBFRP(rp));
+    d->SR |= flags;
+
+    // C0 bits 2:0 enable the same flags as SR bits 2:0
+    if (flags & d->C0 & (DAC_C0_DACBWIEN_MASK | DAC_C0_DACBTIEN_MASK | DAC_C0_DACBBIEN_MASK))
+    {
+        if (c1 & DAC_C1_DMAEN_MASK)
+        {
+            k64sim_dma_request((uint8_t)(45u + dac));
+        }
+        else
+        {
+            k64sim_irq_raise(dac_irq[dac]);
+        }
+    }
+    k64sim_dac_written(dac);
+}
+
+static void dac_write(uint32_t addr, uint32_t old_word, uint32_t new_word)
+{
+    const uint8_t dac = (addr - DAC0_BASE < K64SIM_PAGE) ? 0u : 1u;
+    DAC_Type *d = dac_regs(dac);
+    const uint32_t ofs = addr - dac_base[dac];
+
+    if ((ofs & ~3u) == DAC_OFS_SR)
+    {
+        // SR flags clear by writing 0; C0 DACSWTRG is write-only and advances the buffer
+        d->SR = (uint8_t)(old_word & new_word);
+        const uint8_t c0 = d->C0;
+        if (c0 & DAC_C0_DACSWTRG_MASK)
+        {
+            d->C0 = c0 & ~DAC_C0_DACSWTRG_MASK;
+            if (c0 & DAC_C0_DACTRGSEL_MASK)
+            {
+                buffer_step(dac);
+                return;
+            }
+        }
+    }
+    if (k64sim_dac_code(dac) != last_code[dac] || ofs < DAC_OFS_SR)
+    {
+        k64sim_dac_written(dac);
+    }
+}
+
+static void dac_reset(void)
+{
+    for (uint8_t dac = 0; dac < N_DAC; dac++)
+    {
+        DAC_Type *d = dac_regs(dac);
+        memset(d, 0, sizeof(*d));
+        d->SR = DAC_SR_DACBFRPTF_MASK;
+        d->C2 = DAC_C2_DACBFUP_MASK;
+        last_code[dac] = 0;
+    }
+    watch_fn = NULL;
+    watch_user = NULL;
+}
+
+static k64sim_time_t dac_next_event(void)
+{
+    return K64SIM_NEVER;
+}
+
+static void dac_run(k64sim_time_t now)
+{
+    (void)now;
+}
+
+static const k64sim_trap_t dac_traps[] =
+{
+    { DAC0_BASE, K64SIM_PAGE, NULL, dac_write },
+    { DAC1_BASE, K64SIM_PAGE, NULL, dac_write },
+    { 0 }
+};
+
+const k64sim_model_t k64sim_dac_model =
+{
+    "dac", dac_reset, dac_next_event, dac_run, dac_traps
+};
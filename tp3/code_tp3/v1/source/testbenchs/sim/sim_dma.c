@@ -0,0 +1,513 @@
+/**
+ * @file sim_dma.c
+ * @brief Modelo del eDMA + DMAMUX.
+ *
+ * Las transferencias no consumen tiempo virtual: un pedido del periférico
+ * corre el loop menor completo en el momento. Soporta SOFF/DOFF, SMOD/DMOD,
+ * tamaños distintos de fuente y destino, minor loop mapping (EMLM + MLOFF),
+ * SLAST/DLAST, scatter-gather (ESG), INTHALF/INTMAJOR, DREQ, links de canal
+ * por loop menor y mayor, y el modo trigger del DMAMUX (canales 0-3 con el
+ * PIT). Detecta errores de alineación, de NBYTES y de descriptor de
+ * scatter-gather desalineado.
+ */
+
+#include <string.h>
+
+#include "k64sim_internal.h"
+
+#define N_CH                (DMAMUX_CHCFG_COUNT)
+#define SRC_ALWAYS_FIRST    (58u)
+#define MAX_UNIT            (32u)
+
+#define DMA_OFS_CMD_LO      (0x18u)     // CEEI, SEEI, CERQ, SERQ
+#define DMA_OFS_CMD_HI      (0x1Cu)     // CDNE, SSRT, CERR, CINT
+#define DMA_OFS_ERQ         (0x0Cu)
+#define DMA_OFS_INT         (0x24u)
+#define DMA_OFS_ERR         (0x2Cu)
+#define DMA_OFS_TCD         (0x1000u)
+#define DMA_OFS_TCD_CSR     (0x1Cu)
+
+#define CMD_NOP             (0x80u)
+#define CMD_ALL             (0x40u)
+
+#define READY_REQ           (1u << 0)   // hardware request, needs ERQ
+#define READY_START         (1u << 1)   // TCD START / SSRT / link, ignores ERQ
+
+/**
+ * @brief Pedido de un periférico esperando el disparo del PIT (modo trigger).
+ */
+static bool request[N_CH];
+
+/**
+ * @brief Loops menores pendientes de correr, READY_* por canal.
+ */
+static uint8_t ready[N_CH];
+
+static inline DMA_Type *dma(void)
+{
+    return K64SIM_REGS(DMA_Type, DMA_BASE);
+}
+
+static inline DMAMUX_Type *mux(void)
+{
+    return K64SIM_REGS(DMAMUX_Type, DMAMUX_BASE);
+}
+
+static inline uint8_t mux_source(uint8_t ch)
+{
+    return (uint8_t)((mux()->CHCFG[ch] & DMAMUX_CHCFG_SOURCE_MASK) >> DMAMUX_CHCFG_SOURCE_SHIFT);
+}
+
+static inline bool mux_enabled(uint8_t ch)
+{
+    return (mux()->CHCFG[ch] & DMAMUX_CHCFG_ENBL_MASK) != 0;
+}
+
+static inline bool mux_trig(uint8_t ch)
+{
+    return (mux()->CHCFG[ch] & DMAMUX_CHCFG_TRIG_MASK) != 0;
+}
+
+static inline bool erq(uint8_t ch)
+{
+    return (dma()->ERQ & (1u << ch)) != 0;
+}
+
+static uint32_t next_addr(uint32_t addr, int32_t off, uint8_t mod)
+{
+    if (mod == 0)
+    {
+        return addr + (uint32_t)off;
+    }
+    // Circular buffer of 2^mod bytes: the upper bits stay put
+    const uint32_t mask = (1u << mod) - 1u;
+    return (addr & ~mask) | ((addr + (uint32_t)off) & mask);
+}
+
+static void raise_error(uint8_t ch, uint32_t es_bits)
+{
+    DMA_Type *d = dma();
+    K64SIM_RO32(d->ES) = DMA_ES_VLD_MASK | DMA_ES_ERRCHN(ch) | es_bits;
+    d->ERR |= 1u << ch;
+    d->ERQ &= ~(1u << ch);
+    if (d->EEI & (1u << ch))
+    {
+        k64sim_irq_raise(DMA_Error_IRQn);
+    }
+}
+
+static void raise_int(uint8_t ch)
+{
+    dma()->INT |= 1u << ch;
+    k64sim_irq_raise((IRQn_Type)(DMA0_IRQn + ch));
+}
+
+static void major_done(uint8_t ch)
+{
+    DMA_Type *d = dma();
+    const uint16_t csr = d->TCD[ch].CSR;
+
+    d->TCD[ch].SADDR += d->TCD[ch].SLAST;
+    if (csr & DMA_CSR_ESG_MASK)
+    {
+        const uint32_t next = d->TCD[ch].DLAST_SGA;
+        if (next & 31u)
+        {
+            raise_error(ch, DMA_ES_SGE_MASK);
+            return;
+        }
+        // The next descriptor replaces the whole TCD, DONE stays clear
+        memcpy((void *)&d->TCD[ch], (const void *)(uintptr_t)next, sizeof(d->TCD[ch]));
+    }
+    else
+    {
+        d->TCD[ch].DADDR += d->TCD[ch].DLAST_SGA;
+        d->TCD[ch].CITER_ELINKNO = d->TCD[ch].BITER_ELINKNO;
+        d->TCD[ch].CSR = csr | DMA_CSR_DONE_MASK;
+    }
+
+    if (csr & DMA_CSR_INTMAJOR_MASK)
+    {
+        raise_int(ch);
+    }
+    if (csr & DMA_CSR_DREQ_MASK)
+    {
+        d->ERQ &= ~(1u << ch);
+    }
+    if (csr & DMA_CSR_MAJORELINK_MASK)
+    {
+        ready[(csr & DMA_CSR_MAJORLINKCH_MASK) >> DMA_CSR_MAJORLINKCH_SHIFT] |= READY_START;
+    }
+}
+
+static void minor_loop(uint8_t ch)
+{
+    DMA_Type *d = dma();
+    d->TCD[ch].CSR &= ~(DMA_CSR_START_MASK | DMA_CSR_DONE_MASK);
+
+    const uint16_t attr = d->TCD[ch].ATTR;
+    const uint32_t ssize = 1u << ((attr & DMA_ATTR_SSIZE_MASK) >> DMA_ATTR_SSIZE_SHIFT);
+    const uint32_t dsize = 1u << ((attr & DMA_ATTR_DSIZE_MASK) >> DMA_ATTR_DSIZE_SHIFT);
+    const uint8_t smod = (uint8_t)((attr & DMA_ATTR_SMOD_MASK) >> DMA_ATTR_SMOD_SHIFT);
+    const uint8_t dmod = (uint8_t)((attr & DMA_ATTR_DMOD_MASK) >> DMA_ATTR_DMOD_SHIFT);
+
+    // NBYTES and the minor loop offset depend on CR[EMLM]
+    const uint32_t raw = d->TCD[ch].NBYTES_MLNO;
+    uint32_t nbytes = raw;
+    int32_t mloff = 0;
+    bool smloe = false, dmloe = false;
+    if (d->CR & DMA_CR_EMLM_MASK)
+    {
+        smloe = (raw & DMA_NBYTES_MLOFFYES_SMLOE_MASK) != 0;
+        dmloe = (raw & DMA_NBYTES_MLOFFYES_DMLOE_MASK) != 0;
+        if (smloe || dmloe)
+        {
+            nbytes = raw & DMA_NBYTES_MLOFFYES_NBYTES_MASK;
+            mloff = (int32_t)(raw << 2) >> 12;     // 20-bit signed field at 29:10
+        }
+        else
+        {
+            nbytes = raw & DMA_NBYTES_MLOFFNO_NBYTES_MASK;
+        }
+    }
+
+    uint32_t saddr = d->TCD[ch].SADDR;
+    uint32_t daddr = d->TCD[ch].DADDR;
+    const int32_t soff = (int16_t)d->TCD[ch].SOFF;
+    const int32_t doff = (int16_t)d->TCD[ch].DOFF;
+    if (ssize > MAX_UNIT || dsize > MAX_UNIT || (saddr & (ssize - 1u)) || (soff & (int32_t)(ssize - 1u)))
+    {
+        raise_error(ch, DMA_ES_SAE_MASK);
+        return;
+    }
+    if ((daddr & (dsize - 1u)) || (doff & (int32_t)(dsize - 1u)))
+    {
+        raise_error(ch, DMA_ES_DAE_MASK);
+        return;
+    }
+    if (nbytes == 0 || nbytes % ssize || nbytes % dsize)
+    {
+        raise_error(ch, DMA_ES_NCE_MASK);
+        return;
+    }
+
+    // Source reads go through a small buffer so SSIZE != DSIZE works
+    uint8_t buf[2 * MAX_UNIT];
+    uint32_t fill = 0;
+    for (uint32_t left = nbytes; left; left -= ssize)
+    {
+        for (uint32_t i = 0; i < ssize; i += 4u)
+        {
+            const unsigned w = ssize < 4u ? ssize : 4u;
+            const uint32_t v = k64sim_bus_read(saddr + i, w);
+            memcpy(&buf[fill + i], &v, w);
+        }
+        fill += ssize;
+        saddr = next_addr(saddr, soff, smod);
+        while (fill >= dsize)
+        {
+            for (uint32_t i = 0; i < dsize; i += 4u)
+            {
+                const unsigned w = dsize < 4u ? dsize : 4u;
+                uint32_t v = 0;
+                memcpy(&v, &buf[i], w);
+                k64sim_bus_write(daddr + i, v, w);
+            }
+            memmove(buf, &buf[dsize], fill - dsize);
+            fill -= dsize;
+            daddr = next_addr(daddr, doff, dmod);
+        }
+    }
+    if (smloe)
+    {
+        saddr += (uint32_t)mloff;
+    }
+    if (dmloe)
+    {
+        daddr += (uint32_t)mloff;
+    }
+    d->TCD[ch].SADDR = saddr;
+    d->TCD[ch].DADDR = daddr;
+    k64sim_counters.dma_minor_loops++;
+
+    // CITER: with ELINK the count shrinks to 9 bits and LINKCH sits above it
+    const uint16_t citer = d->TCD[ch].CITER_ELINKNO;
+    const bool elink = (citer & DMA_CITER_ELINKYES_ELINK_MASK) != 0;
+    const uint16_t cmask = elink ? DMA_CITER_ELINKYES_CITER_MASK : DMA_CITER_ELINKNO_CITER_MASK;
+    const uint16_t count = (uint16_t)((citer & cmask) - 1u) & cmask;
+    d->TCD[ch].CITER_ELINKNO = (uint16_t)((citer & ~cmask) | count);
+
+    if (count == 0)
+    {
+        major_done(ch);
+        return;
+    }
+    const uint16_t biter = d->TCD[ch].BITER_ELINKNO & cmask;
+    if ((d->TCD[ch].CSR & DMA_CSR_INTHALF_MASK) && count == biter / 2u)
+    {
+        raise_int(ch);
+    }
+    if (elink)
+    {
+        ready[(citer & DMA_CITER_ELINKYES_LINKCH_MASK) >> DMA_CITER_ELINKYES_LINKCH_SHIFT] |= READY_START;
+    }
+}
+
+static inline bool always_on(uint8_t ch)
+{
+    return mux_enabled(ch) && !mux_trig(ch) && mux_source(ch) >= SRC_ALWAYS_FIRST;
+}
+
+/**
+ * @brief Corre los loops menores listos hasta que no quede ninguno.
+ *
+ * No es reentrante: un periférico que pide DMA mientras el eDMA le escribe
+ * (p. ej. la UART con la FIFO de TX) solo marca el canal, y se atiende al
+ * terminar el loop en curso.
+ */
+static void service_pending(void)
+{
+    static bool servicing;
+    if (servicing)
+    {
+        return;
+    }
+    servicing = true;
+
+    DMA_Type *d = dma();
+    for (bool again = true; again; )
+    {
+        again = false;
+        for (uint8_t ch = 0; ch < N_CH; ch++)
+        {
+            if (!(ready[ch] & READY_START) && !((ready[ch] & READY_REQ) && erq(ch)))
+            {
+                continue;
+            }
+            ready[ch] = 0;
+            const uint16_t csr = d->TCD[ch].CSR;
+            minor_loop(ch);
+            again = true;
+
+            // An always-on source keeps asking until the major loop ends;
+            // with scatter-gather, one descriptor per kick
+            const bool reloaded = (csr & DMA_CSR_ESG_MASK)
+                && d->TCD[ch].CITER_ELINKNO == d->TCD[ch].BITER_ELINKNO;
+            if (always_on(ch) && erq(ch) && !reloaded
+                && !(d->TCD[ch].CSR & DMA_CSR_DONE_MASK) && !(d->ERR & (1u << ch)))
+            {
+                ready[ch] |= READY_REQ;
+            }
+        }
+    }
+    servicing = false;
+}
+
+/**
+ * @brief ERQ recién puesto en un canal.
+ */
+static void kick(uint8_t ch)
+{
+    if (always_on(ch))
+    {
+        ready[ch] |= READY_REQ;
+    }
+    service_pending();
+}
+
+void k64sim_dma_request(uint8_t source)
+{
+    for (uint8_t ch = 0; ch < N_CH; ch++)
+    {
+        if (mux_enabled(ch) && mux_source(ch) == source)
+        {
+            if (mux_trig(ch))
+            {
+                request[ch] = true;
+            }
+            else
+            {
+                ready[ch] |= READY_REQ;
+            }
+        }
+    }
+    service_pending();
+}
+
+void k64sim_dma_trigger(uint8_t ch)
+{
+    if (ch >= 4u || !mux_enabled(ch) || !mux_trig(ch))
+    {
+        return;
+    }
+    // Periodic trigger: an always-on source asks once per PIT period,
+    // a peripheral source is let through once if it was waiting
+    if (mux_source(ch) >= SRC_ALWAYS_FIRST || request[ch])
+    {
+        request[ch] = false;
+        ready[ch] |= READY_REQ;
+        service_pending();
+    }
+}
+
+static void command(uint8_t reg_ofs, uint8_t value)
+{
+    DMA_Type *d = dma();
+    if (value & CMD_NOP)
+    {
+        return;
+    }
+    const uint32_t bits = (value & CMD_ALL) ? 0xFFFFu : (1u << (value & 0xFu));
+
+    switch (reg_ofs)
+    {
+        case 0x18: d->EEI &= ~bits; break;
+        case 0x19: d->EEI |= bits; break;
+        case 0x1A: d->ERQ &= ~bits; break;
+        case 0x1B:
+            d->ERQ |= bits;
+            for (uint8_t c = 0; c < N_CH; c++)
+            {
+                if (bits & (1u << c))
+                {
+                    kick(c);
+                }
+            }
+            break;
+        case 0x1C:
+            for (uint8_t c = 0; c < N_CH; c++)
+            {
+                if (bits & (1u << c))
+                {
+                    d->TCD[c].CSR &= ~DMA_CSR_DONE_MASK;
+                }
+            }
+            break;
+        case 0x1D:
+            for (uint8_t c = 0; c < N_CH; c++)
+            {
+                if (bits & (1u << c))
+                {
+                    ready[c] |= READY_START;
+                }
+            }
+            service_pending();
+            break;
+        case 0x1E:
+            d->ERR &= ~bits;
+            if (d->ERR == 0)
+            {
+                K64SIM_RO32(d->ES) = 0;
+            }
+            break;
+        case 0x1F: d->INT &= ~bits; break;
+        default: break;
+    }
+}
+
+static void dma_write(uint32_t addr, uint32_t old_word, uint32_t new_word)
+{
+    DMA_Type *d = dma();
+    const uint32_t ofs = addr - DMA_BASE;
+    const uint32_t word = ofs & ~3u;
+
+    if (word == DMA_OFS_CMD_LO || word == DMA_OFS_CMD_HI)
+    {
+        // Write-only command bytes: run each one written, then read back 0.
+        // Writing 0 is a valid command (channel 0), so the addressed byte always runs.
+        uint8_t bytes[4];
+        memcpy(bytes, &new_word, 4);
+        *(volatile uint32_t *)k64sim_alias(addr & ~3u) = 0;
+        for (uint8_t i = 0; i < 4u; i++)
+        {
+            if (bytes[i] || word + i == ofs)
+            {
+                command((uint8_t)(word + i), bytes[i]);
+            }
+        }
+        return;
+    }
+
+    switch (word)
+    {
+        case DMA_OFS_INT:
+            d->INT = old_word & ~new_word;
+            return;
+        case DMA_OFS_ERR:
+            d->ERR = old_word & ~new_word;
+            return;
+        case DMA_OFS_ERQ:
+            for (uint8_t c = 0; c < N_CH; c++)
+            {
+                if ((new_word & ~old_word) & (1u << c))
+                {
+                    kick(c);
+                }
+            }
+            return;
+        default:
+            break;
+    }
+
+    if (ofs >= DMA_OFS_TCD && ((ofs - DMA_OFS_TCD) & 0x1Cu) == DMA_OFS_TCD_CSR)
+    {
+        const uint8_t ch = (uint8_t)((ofs - DMA_OFS_TCD) / 0x20u);
+        if (ch < N_CH && (d->TCD[ch].CSR & DMA_CSR_START_MASK))
+        {
+            ready[ch] |= READY_START;
+            service_pending();
+        }
+    }
+}
+
+static void dmamux_write(uint32_t addr, uint32_t old_word, uint32_t new_word)
+{
+    (void)old_word;
+    (void)new_word;
+    // Re-routing a channel drops the request it had latched
+    for (uint8_t i = 0; i < 4u; i++)
+    {
+        const uint32_t ch = (addr & ~3u) - DMAMUX_BASE + i;
+        if (ch < N_CH)
+        {
+            request[ch] = false;
+            ready[ch] = 0;
+        }
+    }
+}
+
+static void dma_reset(void)
+{
+    memset(k64sim_alias(DMA_BASE), 0, 2u * K64SIM_PAGE);
+    memset(k64sim_alias(DMAMUX_BASE), 0, DMAMUX_CHCFG_COUNT);
+    memset(request, 0, sizeof(request));
+    memset(ready, 0, sizeof(ready));
+    // DCHPRIn reset to n
+    volatile uint8_t *prio = (volatile uint8_t *)k64sim_alias(DMA_BASE + 0x100u);
+    for (uint8_t ch = 0; ch < N_CH; ch++)
+    {
+        prio[(ch & ~3u) + (3u - (ch & 3u))] = ch;
+    }
+}
+
+static k64sim_time_t dma_next_event(void)
+{
+    return K64SIM_NEVER;
+}
+
+static void dma_run(k64sim_time_t now)
+{
+    (void)now;
+}
+
+static const k64sim_trap_t dma_traps[] =
+{
+    { DMA_BASE, 2u * K64SIM_PAGE, NULL, dma_write },
+    { DMAMUX_BASE, K64SIM_PAGE, NULL, dmamux_write },
+    { 0 }
+};
+
+const k64sim_model_t k64sim_dma_model =
+{
+    "dma", dma_reset, dma_next_event, dma_run, dma_traps
+};
@@ -0,0 +1,388 @@
+/**
+ * @file sim_ftm.c
+ * @brief Modelo de FTM0-FTM3: contador ascendente CNTIN..MOD con reloj del
+ * sistema (CLKS = 1) y prescaler, TOF/TOIE, canales en PWM edge-aligned,
+ * output compare e input capture, CHF con IRQ o pedido de DMA.
+ *
+ * En PWM el nuevo CnV toma efecto en el próximo overflow, como con
+ * FTMEN = 0. No hay conteo up-down (CPWMS), combine, dead-time, fault ni
+ * sincronización por software; CLKS = 2/3 dejan el contador parado.
+ */
+
+#include <string.h>
+
+#include "k64sim_internal.h"
+
+#define N_FTM               (4u)
+#define MAX_CH              (8u)
+
+#define FTM_OFS_SC          (0x00u)
+#define FTM_OFS_CNT         (0x04u)
+#define FTM_OFS_MOD         (0x08u)
+#define FTM_OFS_CTRL_FIRST  (0x0Cu)
+#define FTM_OFS_CTRL_LAST   (0x48u)
+#define FTM_OFS_CNTIN       (0x4Cu)
+#define FTM_OFS_STATUS      (0x50u)
+
+#define CNSC_MODE_MASK      (FTM_CnSC_MSB_MASK | FTM_CnSC_MSA_MASK)
+#define CNSC_EDGE_MASK      (FTM_CnSC_ELSB_MASK | FTM_CnSC_ELSA_MASK)
+
+static const uint32_t ftm_base[N_FTM] = { FTM0_BASE, FTM1_BASE, FTM2_BASE, FTM3_BASE };
+static const IRQn_Type ftm_irq[N_FTM] = { FTM0_IRQn, FTM1_IRQn, FTM2_IRQn, FTM3_IRQn };
+static const uint8_t ftm_channels[N_FTM] = { 8u, 2u, 2u, 8u };
+static const uint8_t ftm_dma_source[N_FTM] = { 20u, 28u, 30u, 32u };
+
+static struct
+{
+    bool running;
+    k64sim_time_t anchor;       /**< Instante en que CNT valía CNTIN en este período. */
+    k64sim_time_t tick;         /**< Ciclos del core por cuenta. */
+    uint16_t frozen_cnt;        /**< CNT con el contador parado. */
+    uint8_t matched;            /**< Canales que ya coincidieron en este período. */
+    uint8_t cnv_pending;        /**< Canales PWM con CnV nuevo esperando el overflow. */
+    uint16_t cnv[MAX_CH];       /**< CnV en uso para las coincidencias. */
+    bool out[MAX_CH];           /**< Salida de los canales en output compare. */
+} ftm[N_FTM];
+
+static inline FTM_Type *ftm_regs(uint8_t n)
+{
+    return K64SIM_REGS(FTM_Type, ftm_base[n]);
+}
+
+static inline bool is_pwm(uint32_t cnsc)
+{
+    return (cnsc & FTM_CnSC_MSB_MASK) != 0;
+}
+
+static inline bool is_capture(uint32_t cnsc)
+{
+    return (cnsc & CNSC_MODE_MASK) == 0;
+}
+
+static uint16_t cntin(uint8_t n)
+{
+    return (uint16_t)ftm_regs(n)->CNTIN;
+}
+
+/**
+ * @brief Cuentas por período: MOD - CNTIN + 1, o 2^16 si MOD < CNTIN.
+ */
+static uint32_t counts(uint8_t n)
+{
+    const FTM_Type *f = ftm_regs(n);
+    const uint16_t mod = (uint16_t)f->MOD;
+    const uint16_t in = (uint16_t)f->CNTIN;
+    return (mod >= in) ? (uint32_t)(mod - in) + 1u : 0x10000u;
+}
+
+static uint16_t cnt_now(uint8_t n)
+{
+    if (!ftm[n].running)
+    {
+        return ftm[n].frozen_cnt;
+    }
+    const k64sim_time_t ticks = (k64sim_now() - ftm[n].anchor) / ftm[n].tick;
+    return (uint16_t)(cntin(n) + ticks % counts(n));
+}
+
+static void flag_channel(uint8_t n, uint8_t ch)
+{
+    FTM_Type *f = ftm_regs(n);
+    const uint32_t cnsc = f->CONTROLS[ch].CnSC | FTM_CnSC_CHF_MASK;
+    f->CONTROLS[ch].CnSC = cnsc;
+    f->STATUS |= 1u << ch;
+    if (cnsc & FTM_CnSC_CHIE_MASK)
+    {
+        if (cnsc & FTM_CnSC_DMA_MASK)
+        {
+            k64sim_dma_request((uint8_t)(ftm_dma_source[n] + ch));
+        }
+        else
+        {
+            k64sim_irq_raise(ftm_irq[n]);
+        }
+    }
+}
+
+/**
+ * @brief Reancla el contador para que valga cnt ahora y recalcula qué canales ya pasaron.
+ */
+static void reanchor(uint8_t n, uint16_t cnt)
+{
+    const FTM_Type *f = ftm_regs(n);
+    const uint32_t clks = (f->SC & FTM_SC_CLKS_MASK) >> FTM_SC_CLKS_SHIFT;
+    const uint16_t in = cntin(n);
+    if ((uint16_t)(cnt - in) >= counts(n))
+    {
+        cnt = in;
+    }
+
+    ftm[n].running = (clks == 1u);
+    ftm[n].frozen_cnt = cnt;
+    ftm[n].tick = K64SIM_BUS_DIV << ((f->SC & FTM_SC_PS_MASK) >> FTM_SC_PS_SHIFT);
+    ftm[n].anchor = k64sim_now() - (k64sim_time_t)(uint16_t)(cnt - in) * ftm[n].tick;
+    ftm[n].matched = 0;
+    for (uint8_t ch = 0; ch < ftm_channels[n]; ch++)
+    {
+        if (ftm[n].cnv[ch] < cnt)
+        {
+            ftm[n].matched |= 1u << ch;
+        }
+    }
+}
+
+static k64sim_time_t match_time(uint8_t n, uint8_t ch)
+{
+    const FTM_Type *f = ftm_regs(n);
+    const uint32_t cnsc = f->CONTROLS[ch].CnSC;
+    const uint16_t in = cntin(n);
+    const uint16_t v = ftm[n].cnv[ch];
+    if (is_capture(cnsc) || (ftm[n].matched & (1u << ch)) || (uint16_t)(v - in) >= counts(n))
+    {
+        return K64SIM_NEVER;
+    }
+    return ftm[n].anchor + (k64sim_time_t)(uint16_t)(v - in) * ftm[n].tick;
+}
+
+static k64sim_time_t overflow_time(uint8_t n)
+{
+    return ftm[n].anchor + (k64sim_time_t)counts(n) * ftm[n].tick;
+}
+
+bool k64sim_ftm_output(uint8_t n, uint8_t ch)
+{
+    if (n >= N_FTM || ch >= ftm_channels[n])
+    {
+        return false;
+    }
+    const uint32_t cnsc = ftm_regs(n)->CONTROLS[ch].CnSC;
+    if (!is_pwm(cnsc))
+    {
+        return ftm[n].out[ch];
+    }
+    // Edge-aligned: high-true (ELSB) is high from CNTIN until the match
+    const bool high = cnt_now(n) < ftm[n].cnv[ch];
+    return (cnsc & FTM_CnSC_ELSA_MASK) ? !high : high;
+}
+
+void k64sim_ftm_edge(uint8_t n, uint8_t ch, bool rising)
+{
+    if (n >= N_FTM || ch >= ftm_channels[n])
+    {
+        return;
+    }
+    FTM_Type *f = ftm_regs(n);
+    const uint32_t cnsc = f->CONTROLS[ch].CnSC;
+    const uint32_t edges = cnsc & CNSC_EDGE_MASK;
+    if (!is_capture(cnsc) || !(edges & (rising ? FTM_CnSC_ELSA_MASK : FTM_CnSC_ELSB_MASK)))
+    {
+        return;
+    }
+    f->CONTROLS[ch].CnV = cnt_now(n);
+    flag_channel(n, ch);
+}
+
+static void output_compare(uint8_t n, uint8_t ch)
+{
+    switch ((ftm_regs(n)->CONTROLS[ch].CnSC & CNSC_EDGE_MASK) >> FTM_CnSC_ELSA_SHIFT)
+    {
+        case 1: ftm[n].out[ch] = !ftm[n].out[ch]; break;   // toggle
+        case 2: ftm[n].out[ch] = false; break;              // clear
+        case 3: ftm[n].out[ch] = true; break;               // set
+        default: break;
+    }
+}
+
+static void ftm_read(uint32_t addr)
+{
+    for (uint8_t n = 0; n < N_FTM; n++)
+    {
+        if (addr - ftm_base[n] < K64SIM_PAGE)
+        {
+            if (((addr - ftm_base[n]) & ~3u) == FTM_OFS_CNT)
+            {
+                ftm_regs(n)->CNT = cnt_now(n);
+            }
+            return;
+        }
+    }
+}
+
+static void ftm_write(uint32_t addr, uint32_t old_word, uint32_t new_word)
+{
+    uint8_t n = 0;
+    while (n < N_FTM && addr - ftm_base[n] >= K64SIM_PAGE)
+    {
+        n++;
+    }
+    if (n == N_FTM)
+    {
+        return;
+    }
+    FTM_Type *f = ftm_regs(n);
+    const uint32_t ofs = (addr - ftm_base[n]) & ~3u;
+
+    if (ofs == FTM_OFS_SC)
+    {
+        // TOF is cleared by writing 0, never set by software
+        const uint16_t cnt = cnt_now(n);
+        f->SC = (new_word & ~FTM_SC_TOF_MASK) | (old_word & new_word & FTM_SC_TOF_MASK);
+        if ((old_word ^ new_word) & (FTM_SC_CLKS_MASK | FTM_SC_PS_MASK))
+        {
+            reanchor(n, cnt);
+        }
+    }
+    else if (ofs == FTM_OFS_CNT)
+    {
+        reanchor(n, cntin(n));          // any write loads CNTIN
+    }
+    else if (ofs == FTM_OFS_MOD || ofs == FTM_OFS_CNTIN)
+    {
+        reanchor(n, ftm[n].running ? cnt_now(n) : ftm[n].frozen_cnt);
+    }
+    else if (ofs >= FTM_OFS_CTRL_FIRST && ofs <= FTM_OFS_CTRL_LAST)
+    {
+        const uint8_t ch = (uint8_t)((ofs - FTM_OFS_CTRL_FIRST) / 8u);
+        if (ch >= ftm_channels[n])
+        {
+            return;
+        }
+        if (((ofs - FTM_OFS_CTRL_FIRST) & 4u) == 0)
+        {
+            // CnSC: CHF is cleared by writing 0
+            f->CONTROLS[ch].CnSC = (new_word & ~FTM_CnSC_CHF_MASK) | (old_word & new_word & FTM_CnSC_CHF_MASK);
+            if (!(f->CONTROLS[ch].CnSC & FTM_CnSC_CHF_MASK))
+            {
+                f->STATUS &= ~(1u << ch);
+            }
+        }
+        else if (is_pwm(f->CONTROLS[ch].CnSC) && ftm[n].running)
+        {
+            ftm[n].cnv_pending |= 1u << ch;
+        }
+        else
+        {
+            ftm[n].cnv[ch] = (uint16_t)new_word;
+            reanchor(n, cnt_now(n));
+        }
+    }
+    else if (ofs == FTM_OFS_STATUS)
+    {
+        // Writing 0 to CHnF clears it, after a read of STATUS
+        const uint32_t keep = old_word & new_word;
+        f->STATUS = keep;
+        for (uint8_t ch = 0; ch < ftm_channels[n]; ch++)
+        {
+            if (!(keep & (1u << ch)))
+            {
+                f->CONTROLS[ch].CnSC &= ~FTM_CnSC_CHF_MASK;
+            }
+        }
+    }
+}
+
+static void ftm_reset(void)
+{
+    memset(ftm, 0, sizeof(ftm));
+    for (uint8_t n = 0; n < N_FTM; n++)
+    {
+        memset(ftm_regs(n), 0, sizeof(FTM_Type));
+        ftm_regs(n)->MODE = FTM_MODE_WPDIS_MASK;
+        ftm[n].tick = K64SIM_BUS_DIV;
+    }
+}
+
+static k64sim_time_t ftm_next_one(uint8_t n)
+{
+    if (!ftm[n].running)
+    {
+        return K64SIM_NEVER;
+    }
+    k64sim_time_t next = overflow_time(n);
+    for (uint8_t ch = 0; ch < ftm_channels[n]; ch++)
+    {
+        const k64sim_time_t t = match_time(n, ch);
+        if (t < next)
+        {
+            next = t;
+        }
+    }
+    return next;
+}
+
+static k64sim_time_t ftm_next_event(void)
+{
+    k64sim_time_t next = K64SIM_NEVER;
+    for (uint8_t n = 0; n < N_FTM; n++)
+    {
+        const k64sim_time_t t = ftm_next_one(n);
+        if (t < next)
+        {
+            next = t;
+        }
+    }
+    return next;
+}
+
+static void ftm_run(k64sim_time_t now)
+{
+    for (uint8_t n = 0; n < N_FTM; n++)
+    {
+        FTM_Type *f = ftm_regs(n);
+        while (ftm_next_one(n) <= now)
+        {
+            // Matches before the overflow, earliest first
+            uint8_t hit = MAX_CH;
+            k64sim_time_t t_hit = overflow_time(n);
+            for (uint8_t ch = 0; ch < ftm_channels[n]; ch++)
+            {
+                const k64sim_time_t t = match_time(n, ch);
+                if (t < t_hit)
+                {
+                    t_hit = t;
+                    hit = ch;
+                }
+            }
+            if (hit < MAX_CH)
+            {
+                ftm[n].matched |= 1u << hit;
+                if (!is_pwm(f->CONTROLS[hit].CnSC))
+                {
+                    output_compare(n, hit);
+                }
+                flag_channel(n, hit);
+                continue;
+            }
+
+            ftm[n].anchor = t_hit;
+            ftm[n].matched = 0;
+            for (uint8_t ch = 0; ch < ftm_channels[n]; ch++)
+            {
+                if (ftm[n].cnv_pending & (1u << ch))
+                {
+                    ftm[n].cnv[ch] = (uint16_t)f->CONTROLS[ch].CnV;
+                }
+            }
+            ftm[n].cnv_pending = 0;
+            f->SC |= FTM_SC_TOF_MASK;
+            if (f->SC & FTM_SC_TOIE_MASK)
+            {
+                k64sim_irq_raise(ftm_irq[n]);
+            }
+        }
+    }
+}
+
+static const k64sim_trap_t ftm_traps[] =
+{
+    { FTM0_BASE, K64SIM_PAGE, ftm_read, ftm_write },
+    { FTM1_BASE, K64SIM_PAGE, ftm_read, ftm_write },
+    { FTM2_BASE, K64SIM_PAGE, ftm_read, ftm_write },
+    { FTM3_BASE, K64SIM_PAGE, ftm_read, ftm_write },
+    { 0 }
+};
+
+const k64sim_model_t k64sim_ftm_model =
+{
+    "ftm", ftm_reset, ftm_next_event, ftm_run, ftm_traps
+};
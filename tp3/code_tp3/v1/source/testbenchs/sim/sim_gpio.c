@@ -0,0 +1,255 @@
+/**
+ * @file sim_gpio.c
+ * @brief Modelo de GPIO (PTA-PTE) y PORT (PORTA-PORTE): PSOR/PCOR/PTOR,
+ * PDIR con el nivel externo en las entradas, ISF por flanco o nivel con IRQ
+ * o pedido de DMA, ISFR/ISF W1C y GPCLR/GPCHR.
+ *
+ * El MUX del PCR no se mira: todo pin se comporta como GPIO. Los filtros
+ * digitales y los pull-ups no están modelados (una entrada arranca en 0).
+ */
+
+#include <string.h>
+
+#include "k64sim_internal.h"
+
+#define N_PORT              (5u)
+#define GPIO_STRIDE         (0x40u)
+
+#define GPIO_OFS_PDOR       (0x00u)
+#define GPIO_OFS_PSOR       (0x04u)
+#define GPIO_OFS_PCOR       (0x08u)
+#define GPIO_OFS_PTOR       (0x0Cu)
+
+#define PORT_OFS_GPCLR      (0x80u)
+#define PORT_OFS_GPCHR      (0x84u)
+#define PORT_OFS_ISFR       (0xA0u)
+
+// PCR[IRQC] values
+#define IRQC_DMA_RISING     (0x1u)
+#define IRQC_DMA_FALLING    (0x2u)
+#define IRQC_DMA_EITHER     (0x3u)
+#define IRQC_IRQ_LOW        (0x8u)
+#define IRQC_IRQ_RISING     (0x9u)
+#define IRQC_IRQ_FALLING    (0xAu)
+#define IRQC_IRQ_EITHER     (0xBu)
+#define IRQC_IRQ_HIGH       (0xCu)
+
+static const uint32_t port_base[N_PORT] = { PORTA_BASE, PORTB_BASE, PORTC_BASE, PORTD_BASE, PORTE_BASE };
+
+static uint32_t external[N_PORT];   /**< Nivel impuesto desde afuera en cada pin. */
+static uint32_t pins[N_PORT];       /**< Nivel actual de cada pin. */
+static k64sim_gpio_fn watch_fn;
+static void *watch_user;
+
+static inline GPIO_Type *gpio_regs(uint8_t port)
+{
+    return K64SIM_REGS(GPIO_Type, PTA_BASE + GPIO_STRIDE * port);
+}
+
+static inline PORT_Type *port_regs(uint8_t port)
+{
+    return K64SIM_REGS(PORT_Type, port_base[port]);
+}
+
+static void set_isf(uint8_t port, uint8_t pin)
+{
+    PORT_Type *p = port_regs(port);
+    const uint32_t irqc = (p->PCR[pin] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT;
+    p->PCR[pin] |= PORT_PCR_ISF_MASK;
+    p->ISFR |= 1u << pin;
+    if (irqc >= IRQC_IRQ_LOW)
+    {
+        k64sim_irq_raise((IRQn_Type)(PORTA_IRQn + port));
+    }
+    else
+    {
+        k64sim_dma_request((uint8_t)(49u + port));
+    }
+}
+
+/**
+ * @brief Evalúa la condición de IRQC de un pin para un cambio de nivel (o solo nivel si old == level).
+ */
+static void check_pin(uint8_t port, uint8_t pin, bool old, bool level)
+{
+    const uint32_t irqc = (port_regs(port)->PCR[pin] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT;
+    const bool rising = !old && level;
+    const bool falling = old && !level;
+    bool hit;
+    switch (irqc)
+    {
+        case IRQC_DMA_RISING:
+        case IRQC_IRQ_RISING:   hit = rising; break;
+        case IRQC_DMA_FALLING:
+        case IRQC_IRQ_FALLING:  hit = falling; break;
+        case IRQC_DMA_EITHER:
+        case IRQC_IRQ_EITHER:   hit = rising || falling; break;
+        case IRQC_IRQ_LOW:      hit = !level; break;
+        case IRQC_IRQ_HIGH:     hit = level; break;
+        default:                hit = false; break;
+    }
+    if (hit)
+    {
+        set_isf(port, pin);
+    }
+}
+
+/**
+ * @brief Recalcula el nivel de los pines de un puerto: PDOR en salidas, el externo en entradas.
+ */
+static void refresh(uint8_t port)
+{
+    GPIO_Type *g = gpio_regs(port);
+    const uint32_t ddr = g->PDDR;
+    const uint32_t now_pins = (g->PDOR & ddr) | (external[port] & ~ddr);
+    const uint32_t changed = now_pins ^ pins[port];
+    pins[port] = now_pins;
+    K64SIM_RO32(g->PDIR) = now_pins;
+
+    for (uint8_t pin = 0; pin < 32u && (changed >> pin); pin++)
+    {
+        if (!(changed & (1u << pin)))
+        {
+            continue;
+        }
+        const bool level = (now_pins >> pin) & 1u;
+        check_pin(port, pin, !level, level);
+        if ((ddr & (1u << pin)) && watch_fn)
+        {
+            watch_fn(port, pin, level, k64sim_now(), watch_user);
+        }
+    }
+}
+
+void k64sim_gpio_input(uint8_t port, uint8_t pin, bool level)
+{
+    if (port >= N_PORT || pin >= 32u)
+    {
+        return;
+    }
+    external[port] = level ? (external[port] | (1u << pin)) : (external[port] & ~(1u << pin));
+    refresh(port);
+}
+
+bool k64sim_gpio_level(uint8_t port, uint8_t pin)
+{
+    return port < N_PORT && pin < 32u && ((pins[port] >> pin) & 1u);
+}
+
+void k64sim_gpio_watch(k64sim_gpio_fn fn, void *user)
+{
+    watch_fn = fn;
+    watch_user = user;
+}
+
+static void gpio_write(uint32_t addr, uint32_t old_word, uint32_t new_word)
+{
+    (void)old_word;
+    const uint8_t port = (uint8_t)((addr - PTA_BASE) / GPIO_STRIDE);
+    if (port >= N_PORT)
+    {
+        return;
+    }
+    GPIO_Type *g = gpio_regs(port);
+
+    // The set/clear/toggle registers act on PDOR and always read 0
+    switch (((addr - PTA_BASE) % GPIO_STRIDE) & ~3u)
+    {
+        case GPIO_OFS_PSOR: g->PDOR |= new_word; g->PSOR = 0; break;
+        case GPIO_OFS_PCOR: g->PDOR &= ~new_word; g->PCOR = 0; break;
+        case GPIO_OFS_PTOR: g->PDOR ^= new_word; g->PTOR = 0; break;
+        default: break;
+    }
+    refresh(port);
+}
+
+static void port_write(uint32_t addr, uint32_t old_word, uint32_t new_word)
+{
+    uint8_t port = 0;
+    while (port < N_PORT && addr - port_base[port] >= K64SIM_PAGE)
+    {
+        port++;
+    }
+    if (port == N_PORT)
+    {
+        return;
+    }
+    PORT_Type *p = port_regs(port);
+    const uint32_t ofs = (addr - port_base[port]) & ~3u;
+
+    if (ofs < PORT_OFS_GPCLR)
+    {
+        // PCR: ISF is write-1-to-clear
+        const uint8_t pin = (uint8_t)(ofs / 4u);
+        const uint32_t isf = old_word & ~new_word & PORT_PCR_ISF_MASK;
+        p->PCR[pin] = (new_word & ~PORT_PCR_ISF_MASK) | isf;
+        p->ISFR = isf ? (p->ISFR | (1u << pin)) : (p->ISFR & ~(1u << pin));
+        if (!isf)
+        {
+            const bool level = (pins[port] >> pin) & 1u;
+            check_pin(port, pin, level, level);     // level modes re-arm at once
+        }
+    }
+    else if (ofs == PORT_OFS_GPCLR || ofs == PORT_OFS_GPCHR)
+    {
+        // Upper half: which pins; lower half: the PCR[15:0] value to write
+        const uint8_t first = (ofs == PORT_OFS_GPCLR) ? 0u : 16u;
+        for (uint8_t i = 0; i < 16u; i++)
+        {
+            if (new_word & (1u << (16u + i)))
+            {
+                p->PCR[first + i] = (p->PCR[first + i] & 0xFFFF0000u) | (new_word & 0xFFFFu);
+            }
+        }
+        *(volatile uint32_t *)k64sim_alias(addr & ~3u) = 0;
+    }
+    else if (ofs == PORT_OFS_ISFR)
+    {
+        const uint32_t cleared = new_word & old_word;
+        p->ISFR = old_word & ~new_word;
+        for (uint8_t pin = 0; pin < 32u; pin++)
+        {
+            if (cleared & (1u << pin))
+            {
+                p->PCR[pin] &= ~PORT_PCR_ISF_MASK;
+                const bool level = (pins[port] >> pin) & 1u;
+                check_pin(port, pin, level, level);
+            }
+        }
+    }
+}
+
+static void gpio_reset(void)
+{
+    memset(k64sim_alias(PTA_BASE), 0, GPIO_STRIDE * N_PORT);
+    for (uint8_t port = 0; port < N_PORT; port++)
+    {
+        memset(port_regs(port), 0, sizeof(PORT_Type));
+        external[port] = 0;
+        pins[port] = 0;
+    }
+    watch_fn = NULL;
+    watch_user = NULL;
+}
+
+static k64sim_time_t gpio_next_event(void)
+{
+    return K64SIM_NEVER;
+}
+
+static void gpio_run(k64sim_time_t now)
+{
+    (void)now;
+}
+
+static const k64sim_trap_t gpio_traps[] =
+{
+    { PTA_BASE, K64SIM_PAGE, NULL, gpio_write },
+    { PORTA_BASE, N_PORT * K64SIM_PAGE, NULL, port_write },
+    { 0 }
+};
+
+const k64sim_model_t k64sim_gpio_model =
+{
+    "gpio", gpio_reset, gpio_next_event, gpio_run, gpio_traps
+};
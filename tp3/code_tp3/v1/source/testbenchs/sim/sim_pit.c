@@ -0,0 +1,182 @@
+/**
+ * @file sim_pit.c
+ * @brief Modelo del PIT: 4 canales descendentes a reloj del bus, TIF W1C,
+ * disparos de DMAMUX (canales 0-3) y de ADC por SIM_SOPT7.
+ *
+ * Sin encadenado de canales (CHN) ni lifetime timer.
+ */
+
+#include "k64sim_internal.h"
+
+#define PIT_CH_BASE(ch)     (PIT_BASE + 0x100u + 0x10u * (ch))
+#define PIT_OFS_LDVAL       (0x0u)
+#define PIT_OFS_CVAL        (0x4u)
+#define PIT_OFS_TCTRL       (0x8u)
+#define PIT_OFS_TFLG        (0xCu)
+
+/**
+ * @brief Próximo timeout de cada canal, o K64SIM_NEVER si está parado.
+ */
+static k64sim_time_t deadline[PIT_TCTRL_COUNT];
+
+/**
+ * @brief Ciclos que faltaban al poner MDIS, para retomar al sacarlo.
+ */
+static k64sim_time_t frozen[PIT_TCTRL_COUNT];
+static bool disabled;
+
+static k64sim_time_t period(uint8_t ch)
+{
+    const PIT_Type *pit = K64SIM_REGS(PIT_Type, PIT_BASE);
+    return ((k64sim_time_t)pit->CHANNEL[ch].LDVAL + 1u) * K64SIM_BUS_DIV;
+}
+
+static void pit_reset(void)
+{
+    PIT_Type *pit = K64SIM_REGS(PIT_Type, PIT_BASE);
+    pit->MCR = PIT_MCR_MDIS_MASK;
+    disabled = true;
+    for (uint8_t ch = 0; ch < PIT_TCTRL_COUNT; ch++)
+    {
+        pit->CHANNEL[ch].LDVAL = 0;
+        K64SIM_RO32(pit->CHANNEL[ch].CVAL) = 0;
+        pit->CHANNEL[ch].TCTRL = 0;
+        pit->CHANNEL[ch].TFLG = 0;
+        deadline[ch] = K64SIM_NEVER;
+        frozen[ch] = K64SIM_NEVER;
+    }
+}
+
+static void pit_read(uint32_t addr)
+{
+    if (addr < PIT_CH_BASE(0))
+    {
+        return;
+    }
+    const uint8_t ch = (uint8_t)((addr - PIT_CH_BASE(0)) / 0x10u);
+    if (ch >= PIT_TCTRL_COUNT || (addr & 0xCu) != PIT_OFS_CVAL)
+    {
+        return;
+    }
+
+    PIT_Type *pit = K64SIM_REGS(PIT_Type, PIT_BASE);
+    k64sim_time_t left = disabled ? frozen[ch] : deadline[ch];
+    if (left == K64SIM_NEVER)
+    {
+        return;     // stopped: CVAL keeps its last value
+    }
+    if (!disabled)
+    {
+        left -= k64sim_now();
+    }
+    // Counts LDVAL..0, one per bus cycle
+    K64SIM_RO32(pit->CHANNEL[ch].CVAL) = (uint32_t)((left + K64SIM_BUS_DIV - 1u) / K64SIM_BUS_DIV - 1u);
+}
+
+static void pit_write(uint32_t addr, uint32_t old_word, uint32_t new_word)
+{
+    PIT_Type *pit = K64SIM_REGS(PIT_Type, PIT_BASE);
+    const k64sim_time_t now = k64sim_now();
+
+    if (addr < PIT_CH_BASE(0))
+    {
+        if ((addr & ~3u) != PIT_BASE)
+        {
+            return;
+        }
+        const bool mdis = (new_word & PIT_MCR_MDIS_MASK) != 0;
+        if (mdis == disabled)
+        {
+            return;
+        }
+        disabled = mdis;
+        for (uint8_t ch = 0; ch < PIT_TCTRL_COUNT; ch++)
+        {
+            if (mdis)
+            {
+                frozen[ch] = (deadline[ch] == K64SIM_NEVER) ? K64SIM_NEVER : deadline[ch] - now;
+                deadline[ch] = K64SIM_NEVER;
+            }
+            else
+            {
+                deadline[ch] = (frozen[ch] == K64SIM_NEVER) ? K64SIM_NEVER : now + frozen[ch];
+            }
+        }
+        return;
+    }
+
+    const uint8_t ch = (uint8_t)((addr - PIT_CH_BASE(0)) / 0x10u);
+    if (ch >= PIT_TCTRL_COUNT)
+    {
+        return;
+    }
+    k64sim_time_t *next = disabled ? &frozen[ch] : &deadline[ch];
+
+    switch (addr & 0xCu)
+    {
+        case PIT_OFS_TCTRL:
+            if ((old_word ^ new_word) & PIT_TCTRL_TEN_MASK)
+            {
+                // TEN 0->1 reloads LDVAL; 1->0 stops the channel
+                if (new_word & PIT_TCTRL_TEN_MASK)
+                {
+                    *next = disabled ? period(ch) : now + period(ch);
+                }
+                else
+                {
+                    *next = K64SIM_NEVER;
+                }
+            }
+            break;
+
+        case PIT_OFS_TFLG:
+            pit->CHANNEL[ch].TFLG = old_word & ~(new_word & PIT_TFLG_TIF_MASK);
+            break;
+
+        default:
+            break;  // LDVAL takes effect on the next reload
+    }
+}
+
+static k64sim_time_t pit_next_event(void)
+{
+    k64sim_time_t next = K64SIM_NEVER;
+    for (uint8_t ch = 0; ch < PIT_TCTRL_COUNT; ch++)
+    {
+        if (deadline[ch] < next)
+        {
+            next = deadline[ch];
+        }
+    }
+    return next;
+}
+
+static void pit_run(k64sim_time_t now)
+{
+    PIT_Type *pit = K64SIM_REGS(PIT_Type, PIT_BASE);
+    for (uint8_t ch = 0; ch < PIT_TCTRL_COUNT; ch++)
+    {
+        while (deadline[ch] <= now)
+        {
+            deadline[ch] += period(ch);
+            pit->CHANNEL[ch].TFLG = PIT_TFLG_TIF_MASK;
+            if (pit->CHANNEL[ch].TCTRL & PIT_TCTRL_TIE_MASK)
+            {
+                k64sim_irq_raise((IRQn_Type)(PIT0_IRQn + ch));
+            }
+            k64sim_dma_trigger(ch);
+            k64sim_adc_pit_trigger(ch);
+        }
+    }
+}
+
+static const k64sim_trap_t pit_traps[] =
+{
+    { PIT_BASE, K64SIM_PAGE, pit_read, pit_write },
+    { 0 }
+};
+
+const k64sim_model_t k64sim_pit_model =
+{
+    "pit", pit_reset, pit_next_event, pit_run, pit_traps
+};
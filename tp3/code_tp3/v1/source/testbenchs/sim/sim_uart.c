@@ -0,0 +1,402 @@
+/**
+ * @file sim_uart.c
+ * @brief Modelo de UART0-UART5: baud rate de BDH/BDL/BRFA, FIFOs de TX y RX
+ * (8 palabras en UART0/1 con PFIFO, 1 en el resto), shifter de TX al ritmo
+ * de la línea, TDRE/TC/RDRF/OR, IRQs y pedidos de DMA (C5 TDMAS/RDMAS).
+ *
+ * Los flags se recalculan con el estado de las FIFOs, sin la secuencia
+ * "leer S1 y después D". Una espera activa sobre S1 (dos lecturas sin que
+ * avance el reloj) vacía un carácter del shifter o trae el próximo de RX en
+ * el momento; cada caso cuenta en uart_stalls.
+ */
+
+#include <string.h>
+
+#include "k64sim_internal.h"
+
+#define N_UART              (6u)
+#define HW_FIFO_DEPTH       (8u)
+#define RX_QUEUE_SIZE       (4096u)
+
+#define UART_OFS_C2         (0x03u)
+#define UART_OFS_S1         (0x04u)
+#define UART_OFS_D          (0x07u)
+#define UART_OFS_CFIFO      (0x11u)
+
+static const uint32_t uart_base[N_UART] =
+{
+    UART0_BASE, UART1_BASE, UART2_BASE, UART3_BASE, UART4_BASE, UART5_BASE
+};
+static const IRQn_Type uart_irq[N_UART] =
+{
+    UART0_RX_TX_IRQn, UART1_RX_TX_IRQn, UART2_RX_TX_IRQn,
+    UART3_RX_TX_IRQn, UART4_RX_TX_IRQn, UART5_RX_TX_IRQn
+};
+// UART4/5 share one DMAMUX source for RX and TX
+static const uint8_t uart_dma_rx[N_UART] = { 2u, 4u, 6u, 8u, 10u, 11u };
+static const uint8_t uart_dma_tx[N_UART] = { 3u, 5u, 7u, 9u, 10u, 11u };
+
+typedef struct
+{
+    uint8_t data[HW_FIFO_DEPTH];
+    uint8_t head;
+    uint8_t count;
+} hw_fifo_t;
+
+static struct
+{
+    hw_fifo_t tx;
+    hw_fifo_t rx;
+    k64sim_time_t tx_done;          /**< Fin del carácter en el shifter o K64SIM_NEVER. */
+    uint8_t tx_shift;               /**< Carácter en el shifter. */
+    k64sim_time_t rx_next;          /**< Llegada del próximo carácter inyectado. */
+    uint8_t queue[RX_QUEUE_SIZE];   /**< Bytes inyectados todavía en la línea. */
+    size_t q_head;
+    size_t q_count;
+    k64sim_time_t last_poll;        /**< Última lectura de S1, para detectar esperas activas. */
+} uart[N_UART];
+
+static k64sim_uart_fn tx_fn;
+static void *tx_user;
+
+static inline UART_Type *uart_regs(uint8_t n)
+{
+    return K64SIM_REGS(UART_Type, uart_base[n]);
+}
+
+static void fifo_push(hw_fifo_t *f, uint8_t v)
+{
+    f->data[(f->head + f->count) % HW_FIFO_DEPTH] = v;
+    f->count++;
+}
+
+static uint8_t fifo_pop(hw_fifo_t *f)
+{
+    const uint8_t v = f->data[f->head];
+    f->head = (uint8_t)((f->head + 1u) % HW_FIFO_DEPTH);
+    f->count--;
+    return v;
+}
+
+static uint8_t tx_depth(uint8_t n)
+{
+    return (n < 2u && (uart_regs(n)->PFIFO & UART_PFIFO_TXFE_MASK)) ? HW_FIFO_DEPTH : 1u;
+}
+
+static uint8_t rx_depth(uint8_t n)
+{
+    return (n < 2u && (uart_regs(n)->PFIFO & UART_PFIFO_RXFE_MASK)) ? HW_FIFO_DEPTH : 1u;
+}
+
+/**
+ * @brief Duración de un carácter en ciclos del core.
+ */
+static k64sim_time_t char_time(uint8_t n)
+{
+    const UART_Type *u = uart_regs(n);
+    const uint32_t sbr = ((u->BDH & UART_BDH_SBR_MASK) << 8) | u->BDL;
+    const uint32_t brfa = u->C4 & UART_C4_BRFA_MASK;
+    // start + 8 or 9 data bits + stop; with PE the parity takes the last data bit
+    uint32_t bits = 10u;
+    if (u->C1 & UART_C1_M_MASK)
+    {
+        bits++;
+    }
+    // UART0/1 run from the core clock, the rest from the bus clock
+    const k64sim_time_t clk_div = (n < 2u) ? 1u : K64SIM_BUS_DIV;
+    const k64sim_time_t t = (k64sim_time_t)bits * 16u * (32u * (sbr ? sbr : 1u) + brfa) * clk_div / 32u;
+    return t ? t : 1u;
+}
+
+/**
+ * @brief Recalcula S1 y los contadores de FIFO y pide IRQ o DMA si corresponde.
+ */
+static void update(uint8_t n)
+{
+    UART_Type *u = uart_regs(n);
+    const uint8_t twfifo = (tx_depth(n) > 1u) ? u->TWFIFO : 0u;
+    const uint8_t rwfifo = (rx_depth(n) > 1u && u->RWFIFO) ? u->RWFIFO : 1u;
+
+    const bool tdre = uart[n].tx.count <= twfifo;
+    const bool tc = uart[n].tx.count == 0 && uart[n].tx_done == K64SIM_NEVER;
+    const bool rdrf = uart[n].rx.count >= rwfifo;
+
+    uint8_t s1 = u->S1 & UART_S1_OR_MASK;
+    s1 |= tdre ? UART_S1_TDRE_MASK : 0u;
+    s1 |= tc ? UART_S1_TC_MASK : 0u;
+    s1 |= rdrf ? UART_S1_RDRF_MASK : 0u;
+    K64SIM_RO8(u->S1) = s1;
+    K64SIM_RO8(u->TCFIFO) = uart[n].tx.count;
+    K64SIM_RO8(u->RCFIFO) = uart[n].rx.count;
+    u->SFIFO = (uint8_t)((uart[n].tx.count == 0 ? UART_SFIFO_TXEMPT_MASK : 0u)
+                        | (uart[n].rx.count == 0 ? UART_SFIFO_RXEMPT_MASK : 0u));
+
+    const uint8_t c2 = u->C2;
+    const uint8_t c5 = u->C5;
+    bool irq = false;
+    if ((c2 & UART_C2_TIE_MASK) && tdre)
+    {
+        if (c5 & UART_C5_TDMAS_MASK)
+        {
+            k64sim_dma_request(uart_dma_tx[n]);
+        }
+        else
+        {
+            irq = true;
+        }
+    }
+    if ((c2 & UART_C2_RIE_MASK) && rdrf)
+    {
+        if (c5 & UART_C5_RDMAS_MASK)
+        {
+            k64sim_dma_request(uart_dma_rx[n]);
+        }
+        else
+        {
+            irq = true;
+        }
+    }
+    if ((c2 & UART_C2_TCIE_MASK) && tc)
+    {
+        irq = true;
+    }
+    if (irq)
+    {
+        k64sim_irq_raise(uart_irq[n]);
+    }
+}
+
+static void tx_load(uint8_t n, k64sim_time_t from)
+{
+    if (uart[n].tx_done == K64SIM_NEVER && uart[n].tx.count)
+    {
+        uart[n].tx_shift = fifo_pop(&uart[n].tx);
+        uart[n].tx_done = from + char_time(n);
+    }
+}
+
+static void tx_finish(uint8_t n)
+{
+    const k64sim_time_t t = uart[n].tx_done;
+    uart[n].tx_done = K64SIM_NEVER;
+    if (tx_fn)
+    {
+        tx_fn(n, uart[n].tx_shift, t, tx_user);
+    }
+    tx_load(n, t);
+}
+
+static void rx_arrive(uint8_t n)
+{
+    UART_Type *u = uart_regs(n);
+    const uint8_t v = uart[n].queue[uart[n].q_head];
+    uart[n].q_head = (uart[n].q_head + 1u) % RX_QUEUE_SIZE;
+    uart[n].q_count--;
+
+    if (u->C2 & UART_C2_RE_MASK)
+    {
+        if (uart[n].rx.count < rx_depth(n))
+        {
+            fifo_push(&uart[n].rx, v);
+        }
+        else
+        {
+            K64SIM_RO8(u->S1) |= UART_S1_OR_MASK;
+        }
+    }
+    uart[n].rx_next = uart[n].q_count ? uart[n].rx_next + char_time(n) : K64SIM_NEVER;
+}
+
+size_t k64sim_uart_rx(uint8_t n, const uint8_t *data, size_t len)
+{
+    if (n >= N_UART)
+    {
+        return 0;
+    }
+    size_t i = 0;
+    for (; i < len && uart[n].q_count < RX_QUEUE_SIZE; i++)
+    {
+        uart[n].queue[(uart[n].q_head + uart[n].q_count) % RX_QUEUE_SIZE] = data[i];
+        uart[n].q_count++;
+    }
+    if (uart[n].rx_next == K64SIM_NEVER && uart[n].q_count)
+    {
+        uart[n].rx_next = k64sim_now() + char_time(n);
+    }
+    return i;
+}
+
+void k64sim_uart_tx_watch(k64sim_uart_fn fn, void *user)
+{
+    tx_fn = fn;
+    tx_user = user;
+}
+
+static int uart_index(uint32_t addr)
+{
+    for (uint8_t n = 0; n < N_UART; n++)
+    {
+        if (addr - uart_base[n] < K64SIM_PAGE)
+        {
+            return n;
+        }
+    }
+    return -1;
+}
+
+static void uart_read(uint32_t addr)
+{
+    const int n = uart_index(addr);
+    if (n < 0)
+    {
+        return;
+    }
+    UART_Type *u = uart_regs((uint8_t)n);
+    const uint32_t ofs = addr - uart_base[n];
+    const k64sim_time_t now = k64sim_now();
+
+    if (ofs == UART_OFS_S1)
+    {
+        // Polled twice at the same instant: main code is spinning on S1
+        if (uart[n].last_poll == now)
+        {
+            if (!(u->S1 & UART_S1_TDRE_MASK) && uart[n].tx_done != K64SIM_NEVER)
+            {
+                uart[n].tx_done = now;
+                tx_finish((uint8_t)n);
+                k64sim_counters.uart_stalls++;
+            }
+            else if (!(u->S1 & UART_S1_RDRF_MASK) && uart[n].q_count && (u->C2 & UART_C2_RE_MASK))
+            {
+                rx_arrive((uint8_t)n);
+                k64sim_counters.uart_stalls++;
+            }
+            update((uint8_t)n);
+        }
+        uart[n].last_poll = now;
+    }
+    else if (ofs == UART_OFS_D)
+    {
+        if (uart[n].rx.count)
+        {
+            u->D = fifo_pop(&uart[n].rx);
+        }
+        K64SIM_RO8(u->S1) &= ~UART_S1_OR_MASK;
+        update((uint8_t)n);
+    }
+}
+
+static void uart_write(uint32_t addr, uint32_t old_word, uint32_t new_word)
+{
+    (void)old_word;
+    (void)new_word;
+    const int n = uart_index(addr);
+    if (n < 0)
+    {
+        return;
+    }
+    UART_Type *u = uart_regs((uint8_t)n);
+    const uint32_t ofs = addr - uart_base[n];
+
+    if (ofs == UART_OFS_D)
+    {
+        if ((u->C2 & UART_C2_TE_MASK) && uart[n].tx.count < tx_depth((uint8_t)n))
+        {
+            fifo_push(&uart[n].tx, u->D);
+            tx_load((uint8_t)n, k64sim_now());
+        }
+    }
+    else if (ofs == UART_OFS_CFIFO)
+    {
+        const uint8_t cfifo = u->CFIFO;
+        if (cfifo & UART_CFIFO_TXFLUSH_MASK)
+        {
+            uart[n].tx.count = 0;
+        }
+        if (cfifo & UART_CFIFO_RXFLUSH_MASK)
+        {
+            uart[n].rx.count = 0;
+        }
+        u->CFIFO = cfifo & ~(UART_CFIFO_TXFLUSH_MASK | UART_CFIFO_RXFLUSH_MASK);
+    }
+    else if (ofs == UART_OFS_S1)
+    {
+        return;     // read-only
+    }
+    update((uint8_t)n);
+}
+
+static void uart_reset(void)
+{
+    memset(uart, 0, sizeof(uart));
+    for (uint8_t n = 0; n < N_UART; n++)
+    {
+        UART_Type *u = uart_regs(n);
+        memset(u, 0, sizeof(*u));
+        u->BDL = 0x04u;
+        u->RWFIFO = 1u;
+        // PFIFO sizes: 8 words on UART0/1, 1 on the rest
+        u->PFIFO = (n < 2u) ? (uint8_t)(UART_PFIFO_TXFIFOSIZE(2) | UART_PFIFO_RXFIFOSIZE(2)) : 0u;
+        uart[n].tx_done = K64SIM_NEVER;
+        uart[n].rx_next = K64SIM_NEVER;
+        uart[n].last_poll = K64SIM_NEVER;
+        update(n);
+    }
+    tx_fn = NULL;
+    tx_user = NULL;
+}
+
+static k64sim_time_t uart_next_event(void)
+{
+    k64sim_time_t next = K64SIM_NEVER;
+    for (uint8_t n = 0; n < N_UART; n++)
+    {
+        if (uart[n].tx_done < next)
+        {
+            next = uart[n].tx_done;
+        }
+        if (uart[n].rx_next < next)
+        {
+            next = uart[n].rx_next;
+        }
+    }
+    return next;
+}
+
+static void uart_run(k64sim_time_t now)
+{
+    for (uint8_t n = 0; n < N_UART; n++)
+    {
+        bool changed = false;
+        while (uart[n].tx_done <= now)
+        {
+            tx_finish(n);
+            changed = true;
+        }
+        while (uart[n].rx_next <= now)
+        {
+            rx_arrive(n);
+            changed = true;
+        }
+        if (changed)
+        {
+            update(n);
+        }
+    }
+}
+
+static const k64sim_trap_t uart_traps[] =
+{
+    { UART0_BASE, K64SIM_PAGE, uart_read, uart_write },
+    { UART1_BASE, K64SIM_PAGE, uart_read, uart_write },
+    { UART2_BASE, K64SIM_PAGE, uart_read, uart_write },
+    { UART3_BASE, K64SIM_PAGE, uart_read, uart_write },
+    { UART4_BASE, K64SIM_PAGE, uart_read, uart_write },
+    { UART5_BASE, K64SIM_PAGE, uart_read, uart_write },
+    { 0 }
+};
+
+const k64sim_model_t k64sim_uart_model =
+{
+    "uart", uart_reset, uart_next_event, uart_run, uart_traps
+};
@@ -25,48 +25,62 @@
 #include "drv/mcal/DAC.h"
 #include "drv/mcal/DECODE_V2.h"
 #include "drv/mcal/bitstream.h"
+#include "drv/mcal/tx_sched.h"
 
 #define PARITY UART_PARITY_ODD
 
 #define RX_BUFFER_SIZE 2048
-#define TX_BUFFER_SIZE 2048
+#define TX_BUFFER_SIZE 2048 // potencia de 2: anillo del DMA de RX de la UART, el modulador lee en el lugar
+
+// TX por PWM: 1 = el DMA escribe el CnV del FTM0 en cada período,
+// 0 = ISR del PIT por muestra (camino original)
+#ifndef TX_PWM_DMA
+#define TX_PWM_DMA 1
+#endif
+
+#define PWM_BUFFER_SIZE 256                     // ping-pong, 2 x 2.56 ms @ 50 kHz
+#define PWM_HALF (PWM_BUFFER_SIZE / 2)
+#define PWM_STREAM_MOD ((SYS_BUS_CLK / FS) - 1) // un período de PWM por muestra del NCO
+#define PWM_DMA_CH 0
+#define MODEM_BAUD DECODE_BAUD // TX a la misma velocidad que decodifica el RX (DECODE_V2.h)
+#define TX_RATE_WINDOW MODEM_BAUD // bits por medición de throughput (1 s de línea)
+#if !UART_DMA
+#error "app.c necesita UART_DMA: el modulador lee en el lugar el anillo del DMA de RX"
+#endif
 /*******************************************************************************
  * FILE SCOPE VARIABLES
  ******************************************************************************/
 
- static unsigned char idle_counter = 0;
-		static bool last_byte_idle = false;
-
-		
 static bool bit_stream[11];
 static uint16_t data_stream[20];
 static bool finished = 0;
 
-// Circular buffer for transmission data
-static char tx_buffer[TX_BUFFER_SIZE];
-static volatile size_t tx_head = 0; 
-static volatile size_t tx_tail = 0;
-
-static char rx_line[2048];
+// Circular buffer for transmission data: lo llena el DMA de RX de la UART
+// (UART_DmaInit), el head sale del propio DMA
+static volatile uint8_t tx_buffer[TX_BUFFER_SIZE];
+static uint32_t tx_tail = 0; // índice libre, solo lo mueve tx_pull
 
 static NCO_Handle nco_handle;
 
-static char received_data[2048];
-
 
 // Bitstream de datos enviados por el DAC
-static bool idle_sending_bitstream[11];
 static bool idle_reciving_bitstream[11];
-static bool sending_bitstream[11]; // 11?
 
 // Bitstream de datos recibidos por el ADC
 static bool reciving_bitstream[11]; // 11?
 
+#if TX_PWM_DMA
+// CnV pre-renderizados; el DMA recorre el buffer en círculo
+static uint16_t pwm_buffer[PWM_BUFFER_SIZE] __attribute__((aligned(4)));
+static NCO_BitClock tx_bit_clock;
+#else
 static uint16_t lut_value;
-static size_t bit_cnt;
+#endif
 static size_t cnt;
-static bool initiate_send = false;
-static bool sending_data = false;
+
+// Los bytes de tx_buffer salen pegados; idle solo con la cola vacía
+static TxSched tx_sched;
+static TxSched_Rate tx_rate; // última medición, para ver desde el debugger
 
 /*******************************************************************************
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
@@ -74,8 +88,16 @@ static bool sending_data = false;
 
 static void delayLoop(uint32_t veces);
 bool validateBitStream(bool* in);
+static bool NCO_NextBit(void *user);
+static bool tx_pull(void *user, uint8_t *byte);
+static void uart_put(char c);
+#if TX_PWM_DMA
+static void dma_pwm_half_cb(void *user);
+static void dma_pwm_major_cb(void *user);
+#else
 static void NCO_ISRLut(void* user);
 static void NCO_ISRBit(void *user);
+#endif
 
 /*******************************************************************************
  *******************************************************************************
@@ -87,11 +109,15 @@ void finishedReading(void);
 void clearFinished(void);
 void uint16_to_bin(uint16_t value, char *out, size_t out_len);
 
+#if !DECODE_IC_DMA
 static void ftm_cb(void* user);
+#endif
 /* Función que se llama 1 vez, al comienzo del programa */
 void App_Init (void)
 {
 	UART_Init(UART_PARITY_ODD);
+	DMA_Init();
+	UART_DmaInit(tx_buffer, TX_BUFFER_SIZE);
 	
 	CMP_Init();
 	FTM_Init();
@@ -105,6 +131,7 @@ void App_Init (void)
 	gpioMode(PORTNUM2PIN(PB,3), OUTPUT);
 	gpioWrite(PORTNUM2PIN(PB,3), 0);
 
+#if !DECODE_IC_DMA
 	pit_cfg_t pit_cfg =
  	 {
 		.ch = 2,
@@ -116,7 +143,40 @@ void App_Init (void)
  	 };
 	PIT_Config(&pit_cfg);
 	PIT_Stop(2);
+#endif
+
+	NCO_InitFixed(&nco_handle, K_MARK, K_SPACE, true);
+	TxSched_Init(&tx_sched, TX_SCHED_GUARD_BITS, tx_pull, NULL);
+
+#if TX_PWM_DMA
+	// El NCO renderiza el buffer entero de antemano; desde acá lo rellenan los
+	// callbacks de mitad y fin del DMA, pedido por el match del canal del FTM.
+	NCO_BitClockInit(&tx_bit_clock, MODEM_BAUD, FS, NCO_NextBit, NULL);
+	NCO_FillPWMBlock(&nco_handle, &tx_bit_clock, pwm_buffer, PWM_BUFFER_SIZE, PWM_STREAM_MOD);
 
+	DMA_Init();
+	dma_cfg_t dma_pwm_cfg =
+	{
+		.ch = PWM_DMA_CH,
+		.request_src = DMA_REQ_FTM0CH0,
+		.saddr = pwm_buffer,
+		.daddr = (void *)PWM_getDutyRegister(),
+		.elem_size = sizeof(uint16_t),
+		.soff = sizeof(uint16_t),
+		.doff = 0,
+		.major_count = PWM_BUFFER_SIZE,
+		.slast = -(int32_t)sizeof(pwm_buffer),
+		.dlast = 0,
+		.int_major = true,
+		.on_major = dma_pwm_major_cb,
+		.int_half = true,
+		.on_half = dma_pwm_half_cb,
+		.user = NULL
+	};
+	DMA_Config(&dma_pwm_cfg);
+	DMA_Start(PWM_DMA_CH);
+	PWM_StartStream(PWM_STREAM_MOD);
+#else
 	pit_cfg_t pit_cfg_lut =
     {
         .ch = 0,
@@ -141,8 +201,14 @@ void App_Init (void)
     };
 
     PIT_Config(&pit_cfg_bit);
-	
-	NCO_InitFixed(&nco_handle, K_MARK, K_SPACE, true);
+#endif
+
+#if DECODE_IC_DMA
+	// Las capturas del FTM3 CH5 van por DMA a un ring; el decodificador corre
+	// en la ISR de mitad/fin del DMA y deja frames enteros en una cola.
+	DMA_Init(); // no hace nada si ya lo inicializó el TX
+	DECODE_Init();
+#endif
 
     // DAC
     DAC_Init();
@@ -150,7 +216,6 @@ void App_Init (void)
 	// Inicializo los bitstreams en idle
     for (int i = 0; i < 11; i++)
     {
-        idle_sending_bitstream[i] = true;
         idle_reciving_bitstream[i] = 0;
     }
 
@@ -160,51 +225,24 @@ void App_Init (void)
 void App_Run (void)
 {
 
-    UART_Poll();
-    int r = UART_ReceiveString(rx_line, sizeof(rx_line));
-
-		if (r > 0)
-		{
-			// Queue all the recieved characters on the ring buffer
-			for (int i = 0; i < r; i++)
-			{
-				size_t next_head = (tx_head + 1) % TX_BUFFER_SIZE;
-
-				if (next_head != tx_tail)
-				{
-					tx_buffer[tx_head] = rx_line[i];
-					tx_head = next_head;
-				}
-			}
-
-		}
-
-		// If we aren't recieving data, send whats in the buffer
-		if (!sending_data && tx_head != tx_tail)
-    {
-        if (idle_counter == 4){
-            last_byte_idle = true;
-            idle_counter = 0;
-        }
-		
-        if (last_byte_idle)
-        {
-            format_bitstream(tx_buffer[tx_tail], sending_bitstream);
-            tx_tail = (tx_tail + 1) % TX_BUFFER_SIZE;
-
-            initiate_send = true;
-            sending_data = true;
-
-        }
-
-
-    }
+		// Lo que llega por la UART ya está en tx_buffer (DMA) y el planificador
+		// lo saca desde la ISR del NCO: acá no se copia nada
+		TxSched_Measure(&tx_sched, MODEM_BAUD, TX_RATE_WINDOW, &tx_rate);
 
     UART_Poll();
 
 
 //--------------------------------------------------------------------
 //--------------------------------------------------------------------
+#if DECODE_IC_DMA
+	while (DECODE_GetFrame(bit_stream))
+	{
+		if(validateBitStream(bit_stream))
+		{
+			uart_put(deformat_bitstream(bit_stream));
+		}
+	}
+#else
 	if (bitStartDetected())
 	{
 
@@ -227,12 +265,10 @@ void App_Run (void)
 
 		//bool fake[11] = {0,1,1,0,0,1,1,1,0,0,1};
 		 // placeholder
-		//received_data[1] = 0;
 		//bool bit_stream1[] = {0,1,1,0,1,0,1,1,0,0,1};
-		received_data[0] = deformat_bitstream(bit_stream);
 		if(validateBitStream(bit_stream))
 		{
-			UART_SendString(received_data);
+			uart_put(deformat_bitstream(bit_stream));
 		}
 
 
@@ -241,6 +277,7 @@ void App_Run (void)
 	{
 		k=0;
 	}
+#endif
 
 }
 
@@ -297,39 +334,50 @@ void uint16_to_bin(uint16_t value, char *out, size_t out_len){
     out[total_bits] = '\0';
 }
 
-static void NCO_ISRBit(void* user)
+// Fuente de bits del NCO: idle o el frame en curso, uno por período de bit
+static bool NCO_NextBit(void* user)
 {
-    // Flag de reset de Contador de bits enviados (Redundancia para seguridad)
-    if (initiate_send)
+    return TxSched_NextBit(&tx_sched);
+}
+
+// Lado consumidor de tx_buffer, corre en el contexto del NCO
+static bool tx_pull(void *user, uint8_t *byte)
+{
+    if (UART_RxRingPending(&tx_tail) == 0)
     {
-        bit_cnt = 0;
-        initiate_send = false;
+        return false;
     }
+    *byte = tx_buffer[tx_tail & (TX_BUFFER_SIZE - 1)];
+    tx_tail++;
+    return true;
+}
 
-    // Decidir si envio en idle o si envio datos
-    if (sending_data)
+// Byte demodulado directo al buffer TX de la UART (se pierde si está lleno)
+static void uart_put(char c)
+{
+    char *dst;
+    if (UART_TxReserve(&dst) > 0)
     {
-        NCO_FskBit(&nco_handle, sending_bitstream[bit_cnt]);
+        *dst = c;
+        UART_TxCommit(1);
     }
-    else
-    {
+}
 
-        NCO_FskBit(&nco_handle, idle_sending_bitstream[bit_cnt]);
-        if (!last_byte_idle){
-            idle_counter++;
-        }
-    }
+#if TX_PWM_DMA
+// El DMA ya pasó la primera mitad: se renderiza de nuevo mientras toca la segunda
+static void dma_pwm_half_cb(void *user)
+{
+    NCO_FillPWMBlock(&nco_handle, &tx_bit_clock, &pwm_buffer[0], PWM_HALF, PWM_STREAM_MOD);
+}
 
-    bit_cnt++;
-    // Se setearon bit_cnt bits en el NCO.
-    if (bit_cnt == 11)
-    {
-        if (sending_data){
-            last_byte_idle = false;
-        }
-        sending_data = false;
-        bit_cnt = 0;
-    }
+static void dma_pwm_major_cb(void *user)
+{
+    NCO_FillPWMBlock(&nco_handle, &tx_bit_clock, &pwm_buffer[PWM_HALF], PWM_HALF, PWM_STREAM_MOD);
+}
+#else
+static void NCO_ISRBit(void* user)
+{
+    NCO_FskBit(&nco_handle, NCO_NextBit(user));
 }
 
 static void NCO_ISRLut(void* user)
@@ -339,8 +387,10 @@ static void NCO_ISRLut(void* user)
     PWM_setDuty(NCO2PWM(lut_value));
 
 }
+#endif
 
 
+#if !DECODE_IC_DMA
 static void ftm_cb(void* user)
 {
 	//gpioToggle(PORTNUM2PIN(PB,3));
@@ -359,6 +409,7 @@ static void ftm_cb(void* user)
 	}
 	//gpioToggle(PORTNUM2PIN(PB,3));
 }
+#endif
 
 bool finishStatus(void)
 {
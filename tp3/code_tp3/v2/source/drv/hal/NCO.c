@@ -1,8 +1,8 @@
 #include "NCO.h"
-#include "sinLutQ15.h"   // SINE_Q15[LUT_SIZE], LUT_BITS/LUT_SIZE
+#include "SinLutQ15.h"   // SINE_Q15[LUT_SIZE], LUT_BITS/LUT_SIZE
 
 #define NCO_PHASE_FRAC_BITS   (NCO_PHASE_BITS - LUT_BITS)
-#define NCO_PHASE_FRAC_MASK   ((NCO_PHASE_FRAC_BITS >= NCO_PHASE_BOT) ? 0xFFFFFFFFu : ((1u << NCO_PHASE_FRAC_BITS) - 1u))
+#define NCO_PHASE_FRAC_MASK   ((NCO_PHASE_FRAC_BITS >= NCO_PHASE_BITS) ? 0xFFFFFFFFu : ((1u << NCO_PHASE_FRAC_BITS) - 1u))
 
 void NCO_InitFixed(NCO_Handle* nco, uint32_t K_mark, uint32_t K_space, bool K_init_is_mark)
 {
@@ -12,13 +12,13 @@ void NCO_InitFixed(NCO_Handle* nco, uint32_t K_mark, uint32_t K_space, bool K_in
     nco->K      = K_init_is_mark ? K_mark : K_space;
 }
 
-int16_t NCO_TickQ15(NCO_Handle* nco)
+// LUT lookup shared by NCO_TickQ15 and the block renderers.
+static inline int16_t nco_lut(uint32_t phase)
 {
-    nco->phase += nco->K;  // wraps naturally
-    const uint32_t idx = nco->phase >> NCO_PHASE_FRAC_BITS;
+    const uint32_t idx = phase >> NCO_PHASE_FRAC_BITS;
 
 #if defined(NCO_ENABLE_LERP)
-    const uint32_t frac = nco->phase & NCO_PHASE_FRAC_MASK;
+    const uint32_t frac = phase & NCO_PHASE_FRAC_MASK;
     const int32_t  a    = (int32_t)SINE_Q15[idx];
     const int32_t  b    = (int32_t)SINE_Q15[(idx + 1u) & (LUT_SIZE - 1u)];
     const int32_t  diff = b - a;
@@ -28,6 +28,13 @@ int16_t NCO_TickQ15(NCO_Handle* nco)
     return SINE_Q15[idx];
 #endif
 }
+
+int16_t NCO_TickQ15(NCO_Handle* nco)
+{
+    nco->phase += nco->K;  // wraps naturally
+    return nco_lut(nco->phase);
+}
+
 // Innecesario si utilizamos un DAC de 16 bits
 // uint16_t NCO_Q15ToDAC12(int16_t q15, uint16_t dac_mid, uint16_t dac_amp)
 // {
@@ -42,11 +49,47 @@ int16_t NCO_TickQ15(NCO_Handle* nco)
 uint16_t NCO_Q15ToPWMDutyMOD(int16_t q15, uint16_t mod)
 {
     uint32_t u = (uint32_t)((int32_t)q15 + 32768);                  // [0..65535]
-    uint32_t duty = ((uint64_t)u * (uint64_t)mod + 32767u) / 65535u; // round
+    uint32_t duty = (u * (uint32_t)mod + 32767u) / 65535u; // round, fits in 32 bits
     if (duty > mod) duty = mod;
     return (uint16_t)duty;
 }
 
+void NCO_BitClockInit(NCO_BitClock* clk, uint32_t baud, uint32_t fs,
+                      NCO_BitCb next_bit, void* user)
+{
+    clk->step     = TW32_ROUND(baud, fs);
+    clk->phase    = 0u - clk->step;    // wraps on the first sample
+    clk->next_bit = next_bit;
+    clk->user     = user;
+}
+
+void NCO_FillPWMBlock(NCO_Handle* nco, NCO_BitClock* bits, uint16_t* out,
+                      size_t n, uint16_t mod)
+{
+    uint32_t phase = nco->phase;
+    uint32_t K = nco->K;
+    uint32_t bit_phase = bits->phase;
+    const uint32_t step = bits->step;
+    const uint16_t span = (uint16_t)(mod - 2u);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        bit_phase += step;
+        if (bit_phase < step)   // the bit clock wrapped: new bit on this sample
+        {
+            K = bits->next_bit(bits->user) ? nco->K_mark : nco->K_space;
+        }
+        phase += K;
+        // LUT holds 12-bit DAC codes centered at 2048, move them to Q15
+        const int16_t q15 = (int16_t)(((int32_t)nco_lut(phase) - 2048) * 16);
+        out[i] = (uint16_t)(NCO_Q15ToPWMDutyMOD(q15, span) + 1u);
+    }
+
+    nco->phase = phase;
+    nco->K = K;
+    bits->phase = bit_phase;
+}
+
 // Se llama una vez al inicio del programa
 void NCO_main_initialization(NCO_Handle* nco){
     NCO_InitFixed(nco, K_MARK, K_SPACE, true);
@@ -1,4 +1,5 @@
 #pragma once
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -27,6 +28,20 @@ typedef struct {
     uint32_t K_space;   // precomputed SPACE tuning word
 } NCO_Handle;
 
+// Bit source for the block renderers: returns the next bit (1=MARK, 0=SPACE).
+// Called once per bit period, from whatever context renders the block.
+typedef bool (*NCO_BitCb)(void *user);
+
+// Bit clock for the block renderers: a second phase accumulator that wraps
+// once per bit, so bit edges land on the right sample even if FS / baud is
+// not an integer.
+typedef struct {
+    uint32_t  phase;    // bit clock accumulator
+    uint32_t  step;     // TW32_ROUND(baud, fs)
+    NCO_BitCb next_bit; // bit source
+    void     *user;     // cookie for next_bit
+} NCO_BitClock;
+
 /* ------------ Core ------------ */
 
 // Initialize with precomputed tuning words. K_init_is_mark selects start tone.
@@ -56,6 +71,20 @@ static inline uint16_t NCO_TickPWMDutyMOD(NCO_Handle* nco, uint16_t mod) {
     return NCO_Q15ToPWMDutyMOD(NCO_TickQ15(nco), mod);
 }
 
+/* -------- Block rendering -------- */
+
+// Bit clock at baud for an NCO running at fs. The first bit is requested on
+// the first rendered sample.
+void NCO_BitClockInit(NCO_BitClock* clk, uint32_t baud, uint32_t fs,
+                      NCO_BitCb next_bit, void* user);
+
+// Render n FTM CnV values (one per PWM period) for a PWM with modulus mod.
+// Same waveform as NCO_TickQ15 + NCO_FskBit on every bit edge, scaled with
+// NCO_Q15ToPWMDutyMOD. Values stay in [1, mod - 1]: with CnV = 0 or above
+// MOD the channel never matches and a DMA paced by it would stall.
+void NCO_FillPWMBlock(NCO_Handle* nco, NCO_BitClock* bits, uint16_t* out,
+                      size_t n, uint16_t mod);
+
 /* -------------- FSK -------------- */
 
 // Switch tones on bit boundary; preserves phase continuity.
@@ -5,12 +5,54 @@
  *      Author: Facundo Juli
  */
 
+#include <stddef.h>
+
 #include "drv/mcal/DECODE_V2.h"
 #include "drv/mcal/FTM.h"
+#if DECODE_IC_DMA
+#include "drv/mcal/dma.h"
+#endif
 
 #define CONT_MAX 12 
 static bool reading = 0;
 
+#if DECODE_IC_DMA
+// Todo en ticks del FTM3. Con ambos flancos cada captura cierra un
+// semiperíodo: 1302 ticks en mark y 710 en space a 3.125 MHz.
+#define HP_MARK (DECODE_IC_CLK_HZ / (2u * DECODE_F_MARK))
+#define HP_SPACE (DECODE_IC_CLK_HZ / (2u * DECODE_F_SPACE))
+#define HP_THRESHOLD (DECODE_IC_CLK_HZ / (DECODE_F_MARK + DECODE_F_SPACE)) // a la frecuencia media
+#define RING_HALF (DECODE_RING_SIZE / 2)
+
+static volatile uint16_t ic_ring[DECODE_RING_SIZE] __attribute__((aligned(4)));
+
+// Frames empaquetados como data_to_uart (bit 0 = start); productor: ISR del DMA
+static volatile uint16_t frame_queue[DECODE_QUEUE_SIZE];
+static volatile uint32_t queue_head;
+static volatile uint32_t queue_tail;
+static volatile uint32_t dropped;
+
+// Tiempo de captura desenrollado a 32 bits (el FTM3 corre libre de 0 a 0xFFFF)
+static uint16_t last_capture;
+static uint32_t now;
+static bool have_capture;
+
+static uint16_t prev_hp;
+
+static bool in_frame;
+
+static uint32_t frame_t0;
+static uint32_t bit_idx;
+static uint32_t bit_start;      // ventana del bit actual: [bit_start, bit_end)
+static uint32_t bit_end;
+static uint32_t acc;            // semiciclos dentro de la ventana, Q16
+static uint32_t weight;         // ticks de la ventana cubiertos por capturas
+static uint16_t frame;
+
+static void dma_ic_half_cb(void *user);
+static void dma_ic_major_cb(void *user);
+#endif
+
 void clearReadingFlag(void) //Should be called when reading finished
 {
 	reading = 0;
@@ -53,3 +95,199 @@ bool bitStartDetected(void)
 	// 833us(1-1/Nbits) < Tt < 833us
 	
 }
+
+#if DECODE_IC_DMA
+void DECODE_Init(void)
+{
+	dma_cfg_t dma_ic_cfg =
+	{
+		.ch = DECODE_DMA_CH,
+		.request_src = DMA_REQ_FTM3CH5,
+		.saddr = (void *)&FTM3->CONTROLS[FTM_CH_5].CnV,
+		.daddr = (void *)ic_ring,
+		.elem_size = sizeof(uint16_t),
+		.soff = 0,
+		.doff = sizeof(uint16_t),
+		.major_count = DECODE_RING_SIZE,
+		.slast = 0,
+		.dlast = -(int32_t)sizeof(ic_ring),
+		.int_major = true,
+		.on_major = dma_ic_major_cb,
+		.int_half = true,
+		.on_half = dma_ic_half_cb,
+		.user = NULL
+	};
+	have_capture = false;
+	in_frame = false;
+	prev_hp = HP_MARK;
+	DMA_Config(&dma_ic_cfg);
+	DMA_Start(DECODE_DMA_CH);
+}
+
+bool DECODE_GetFrame(bool bits[DECODE_FRAME_BITS])
+{
+	if (queue_tail == queue_head)
+	{
+		return false;
+	}
+	uint16_t f = frame_queue[queue_tail % DECODE_QUEUE_SIZE];
+	queue_tail++;
+	for (uint32_t i = 0; i < DECODE_FRAME_BITS; i++)
+	{
+		bits[i] = (f >> i) & 1u;
+	}
+	return true;
+}
+
+uint32_t DECODE_GetDropped(void)
+{
+	return dropped;
+}
+
+// Fin del bit k contado desde el flanco de start, sin acumular redondeo
+static uint32_t bit_edge(uint32_t k)
+{
+	return frame_t0 + (k * DECODE_IC_CLK_HZ + DECODE_BAUD / 2u) / DECODE_BAUD;
+}
+
+static void close_bit(void)
+{
+	// Frecuencia media del bit (semiciclos / tiempo) contra la media entre tonos
+	bool bit = (uint64_t)acc * HP_THRESHOLD < ((uint64_t)weight << 16);
+	acc = 0;
+	weight = 0;
+
+	if (bit_idx == 0 && bit)
+	{
+		in_frame = false; // el start no era space: falso arranque
+		return;
+	}
+	frame |= (uint16_t)bit << bit_idx;
+	bit_idx++;
+	if (bit_idx == DECODE_FRAME_BITS)
+	{
+		if (queue_head - queue_tail < DECODE_QUEUE_SIZE)
+		{
+			frame_queue[queue_head % DECODE_QUEUE_SIZE] = frame;
+			queue_head++;
+		}
+		else
+		{
+			dropped++;
+		}
+		in_frame = false;
+		return;
+	}
+	bit_start = bit_end;
+	bit_end = bit_edge(bit_idx + 1u);
+}
+
+// Reparte el semiperíodo [from, to) entre las ventanas de bit que toca
+static void feed(uint32_t from, uint32_t to, uint16_t hp)
+{
+	while (in_frame)
+	{
+		uint32_t a = ((int32_t)(from - bit_start) > 0) ? from : bit_start;
+		if ((int32_t)(to - bit_end) < 0)
+		{
+			if ((int32_t)(to - a) > 0)
+			{
+				acc += ((to - a) << 16) / hp;
+				weight += to - a;
+			}
+			return;
+		}
+		if ((int32_t)(bit_end - a) > 0)
+		{
+			acc += ((bit_end - a) << 16) / hp;
+			weight += bit_end - a;
+		}
+		close_bit();
+	}
+}
+
+// Parte en space de un semiperíodo que arrancó en mark. Con fase continua
+// mark/HP_MARK + space/HP_SPACE = 1 y mark + space = hp.
+static uint32_t space_part(uint16_t hp)
+{
+	if (hp <= HP_SPACE)
+	{
+		return hp;
+	}
+	if (hp >= HP_MARK)
+	{
+		return 0;
+	}
+	return HP_SPACE * (HP_MARK - hp) / (HP_MARK - HP_SPACE);
+}
+
+static void start_frame(uint32_t t0)
+{
+	in_frame = true;
+	frame = 0;
+	bit_idx = 0;
+	acc = 0;
+	weight = 0;
+	frame_t0 = t0;
+	bit_start = t0;
+	bit_end = bit_edge(1u);
+}
+
+static void decode_capture(uint16_t capture)
+{
+	uint16_t hp = (uint16_t)(capture - last_capture);
+	last_capture = capture;
+	if (!have_capture || hp == 0)
+	{
+		have_capture = true;
+		return;
+	}
+	now += hp;
+	uint16_t before = prev_hp;
+	prev_hp = hp;
+
+	if (in_frame)
+	{
+		feed(now - hp, now, hp);
+		if (in_frame)
+		{
+			return;
+		}
+		// frames pegados: el start del próximo puede estar en este mismo semiperíodo
+	}
+	if (hp >= HP_THRESHOLD)
+	{
+		return;
+	}
+
+	// Primer semiperíodo corto: el flanco de start cae adentro de este o, si
+	// este ya es space entero, adentro del anterior. Un falso arranque por un
+	// glitch se descarta al promediar el bit de start.
+	uint32_t t0 = now - space_part(hp);
+	if (hp <= HP_SPACE)
+	{
+		t0 = now - hp - space_part(before);
+	}
+	start_frame(t0);
+	feed(t0, now, hp);
+}
+
+static void dma_ic_half_cb(void *user)
+{
+	(void)user;
+	// el DMA está llenando la segunda mitad: la primera es estable
+	for (uint32_t i = 0; i < RING_HALF; i++)
+	{
+		decode_capture(ic_ring[i]);
+	}
+}
+
+static void dma_ic_major_cb(void *user)
+{
+	(void)user;
+	for (uint32_t i = RING_HALF; i < DECODE_RING_SIZE; i++)
+	{
+		decode_capture(ic_ring[i]);
+	}
+}
+#endif
@@ -10,11 +10,40 @@
 #ifndef DRV_MCAL_DECODE_V2_H_
 #define DRV_MCAL_DECODE_V2_H_
 
+// RX por input capture: 1 = el DMA copia cada captura del FTM3 CH5 a un ring
+// y el decodificador promedia los semiperíodos de cada bit, 0 = ISR por
+// flanco + PIT ch2 que muestrea una frecuencia por bit (camino original)
+#ifndef DECODE_IC_DMA
+#define DECODE_IC_DMA 1
+#endif
+
+#ifndef DECODE_BAUD
+#define DECODE_BAUD 1200u
+#endif
+#define DECODE_F_MARK 1200u
+#define DECODE_F_SPACE 2200u
+
+#define DECODE_IC_CLK_HZ (50000000u / 16u) // bus / FTM3 prescaler (IC_Init)
+#define DECODE_DMA_CH 1
+#define DECODE_RING_SIZE 64                // capturas; IRQ del DMA cada mitad
+#define DECODE_FRAME_BITS 11u              // start + 8 datos + paridad + stop
+#define DECODE_QUEUE_SIZE 32               // frames decodificados sin leer
+
 void setReadingFlag(void);
 void clearReadingFlag(void);
 bool getReadingFlag(void);
 uint8_t processBit(void);
 bool bitStartDetected(void);
 
+#if DECODE_IC_DMA
+// Arma el DMA del ring de capturas. Llamar después de DMA_Init y FTM_Init.
+void DECODE_Init(void);
+
+// Saca el frame más viejo como bits (bits[0] = start). false si no hay.
+bool DECODE_GetFrame(bool bits[DECODE_FRAME_BITS]);
+
+// Frames descartados con la cola llena.
+uint32_t DECODE_GetDropped(void);
+#endif
 
 #endif /* DRV_MCAL_DECODE_V2_H_ */
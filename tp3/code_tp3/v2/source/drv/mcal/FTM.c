@@ -116,6 +116,30 @@ void PWM_setDuty(char duty)
 	FTM_SetCounter(FTM0, 0, PWM_duty);  //change DC
 }
 
+// Streaming mode: the CnV of FTM0 CH0 is written by DMA instead of by
+// PWM_setDuty. Each channel match raises a DMA request, the next CnV is
+// loaded at the end of the period (FTMEN = 0), so every PWM period plays one
+// sample. The PWM frequency becomes the sample rate: modulus = bus / FS - 1.
+void PWM_StartStream(uint16_t modulus)
+{
+	PWM_modulus = modulus;
+	FTM_SetModulus(FTM0, PWM_modulus);
+	FTM_SetCounter(FTM0, 0, PWM_modulus / 2);
+	FTM_SetDMAMode(FTM0, 0, true);
+	FTM_SetInterruptMode(FTM0, 0, true);   // with DMA = 1 the flag goes to the DMA, not the NVIC
+}
+
+void PWM_StopStream(void)
+{
+	FTM_SetInterruptMode(FTM0, 0, false);
+	FTM_SetDMAMode(FTM0, 0, false);
+}
+
+volatile void *PWM_getDutyRegister(void)
+{
+	return &FTM0->CONTROLS[0].CnV;
+}
+
 uint8_t NCO2PWM(uint16_t lut)
 {
     const uint16_t MAX12 = (1u<<12) - 1u; // 4095
@@ -175,6 +199,9 @@ void IC_Init (void)
 	FTM_SetWorkingMode(FTM3,FTM_CH_5,FTM_mInputCapture);   // Select IC Function
 	FTM_SetInputCaptureEdge (FTM3, FTM_CH_5,FTM_eEither);  // Capture on both edges or rising
 	FTM_SetInterruptMode (FTM3,FTM_CH_5, true);            // Enable interrupts
+#if DECODE_IC_DMA
+	FTM_SetDMAMode (FTM3, FTM_CH_5, true);                 // CHF -> DMA ring, no IRQ per edge
+#endif
 	FTM_StartClock(FTM3);                                  // Select BusClk
 }
 
@@ -312,6 +339,11 @@ void FTM_SetInterruptMode (FTM_t ftm, FTMChannel_t channel, bool mode)
 	ftm->CONTROLS[channel].CnSC = (ftm->CONTROLS[channel].CnSC & ~FTM_CnSC_CHIE_MASK) | FTM_CnSC_CHIE(mode);
 }
 
+void FTM_SetDMAMode (FTM_t ftm, FTMChannel_t channel, bool mode)
+{
+	ftm->CONTROLS[channel].CnSC = (ftm->CONTROLS[channel].CnSC & ~FTM_CnSC_DMA_MASK) | FTM_CnSC_DMA(mode);
+}
+
 bool FTM_IsInterruptPending (FTM_t ftm, FTMChannel_t channel)
 {
 	return ftm->CONTROLS[channel].CnSC & FTM_CnSC_CHF_MASK;
@@ -70,6 +70,9 @@ void clearLastBit(void);
 void unAllow(void);
 
 void PWM_setDuty(char);
+void PWM_StartStream(uint16_t modulus);
+void PWM_StopStream(void);
+volatile void *PWM_getDutyRegister(void);
 void IC_Init (void);
 
 
@@ -108,6 +111,7 @@ void        FTM_SetCounter 					 (FTM_t, FTMChannel_t, FTMData_t);
 FTMData_t   FTM_GetCounter 					 (FTM_t, FTMChannel_t);
 
 void 		FTM_SetInterruptMode   			 (FTM_t, FTMChannel_t, bool);
+void 		FTM_SetDMAMode   				 (FTM_t, FTMChannel_t, bool);
 bool 		FTM_IsInterruptPending 			 (FTM_t, FTMChannel_t);
 void 		FTM_ClearInterruptFlag 			 (FTM_t, FTMChannel_t);
 
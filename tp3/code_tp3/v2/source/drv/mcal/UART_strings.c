@@ -1,46 +1,177 @@
 #include "UART_strings.h"
+#if UART_DMA
+#include "dma.h"
+#endif
 
 /* -------- Buffers circulares -------- */
-static volatile char s_tx_buf[UART_TX_BUF_SIZE];
-static volatile size_t s_tx_head = 0;
-static volatile size_t s_tx_tail = 0;
+// Índices libres, enmascarados con SIZE - 1; head lo mueve el productor y tail el consumidor
+#define TX_MASK (UART_TX_BUF_SIZE - 1u)
+#define RX_MASK (UART_RX_BUF_SIZE - 1u)
 
+static char s_tx_buf[UART_TX_BUF_SIZE];
+static volatile uint32_t s_tx_head = 0;
+static volatile uint32_t s_tx_tail = 0;
+
+#if UART_DMA
+static volatile uint32_t s_tx_dma_len = 0; // tramo en vuelo, 0 = canal parado
+static size_t s_rx_ring_size = 0;
+static volatile uint32_t s_rx_laps = 0;    // vueltas del DMA de RX por el anillo
+static uint32_t s_rx_written = 0;          // bytes escritos al último UART_RxRingPending
+static bool s_dma_ready = false;
+#else
 static volatile char s_rx_buf[UART_RX_BUF_SIZE];
-static volatile size_t s_rx_head = 0;
-static volatile size_t s_rx_tail = 0;
+static volatile uint32_t s_rx_head = 0;
+static volatile uint32_t s_rx_tail = 0;
+#endif
+static uint32_t s_rx_overflow = 0;         // bytes de RX pisados antes de leerse
+
+#if UART_DMA
+static void tx_dma_done(void *user);
+
+// Manda el próximo tramo contiguo si el canal está parado. Corre en el loop
+// (solo con el canal parado) o en la ISR de fin de tramo: nunca a la vez.
+static void tx_dma_kick(void)
+{
+    uint32_t pending = s_tx_head - s_tx_tail;
+    if (!s_dma_ready || s_tx_dma_len != 0 || pending == 0)
+    {
+        return;
+    }
+    uint32_t start = s_tx_tail & TX_MASK;
+    uint32_t len = UART_TX_BUF_SIZE - start;
+    if (pending < len)
+    {
+        len = pending;
+    }
+
+    dma_cfg_t cfg =
+    {
+        .ch = UART_TX_DMA_CH,
+        .request_src = DMA_REQ_UART0_TX,
+        .saddr = &s_tx_buf[start],
+        .daddr = (void *)&UART0->D,
+        .elem_size = 1,
+        .soff = 1,
+        .doff = 0,
+        .major_count = (uint16_t)len,
+        .int_major = true,
+        .on_major = tx_dma_done,
+        .one_shot = true,
+    };
+    s_tx_dma_len = len;
+    DMA_Config(&cfg);
+    DMA_Start(UART_TX_DMA_CH);
+}
+
+static void tx_dma_done(void *user)
+{
+    s_tx_tail += s_tx_dma_len;
+    s_tx_dma_len = 0;
+    tx_dma_kick();
+}
+
+static void rx_dma_lap(void *user)
+{
+    (void)user;
+    s_rx_laps++;
+}
+
+int UART_DmaInit(volatile uint8_t *rx_ring, size_t rx_size)
+{
+    if (rx_ring == NULL || rx_size == 0 || (rx_size & (rx_size - 1u)) != 0
+        || rx_size > DMA_CITER_ELINKNO_CITER_MASK)
+    {
+        return -1;
+    }
+
+    dma_cfg_t rx_cfg =
+    {
+        .ch = UART_RX_DMA_CH,
+        .request_src = DMA_REQ_UART0_RX,
+        .saddr = (void *)&UART0->D,
+        .daddr = (void *)rx_ring,
+        .elem_size = 1,
+        .soff = 0,
+        .doff = 1,
+        .major_count = (uint16_t)rx_size,
+        .slast = 0,
+        .dlast = -(int32_t)rx_size,
+        .int_major = true, // una IRQ por vuelta, para contar las pisadas
+        .on_major = rx_dma_lap,
+    };
+    int err = DMA_Config(&rx_cfg);
+    if (err)
+    {
+        return err;
+    }
+    s_rx_ring_size = rx_size;
+
+    // RDRF y TDRE piden DMA en vez de IRQ
+    UART0->C5 |= UART_C5_RDMAS_MASK | UART_C5_TDMAS_MASK;
+    UART0->C2 |= UART_C2_RIE_MASK | UART_C2_TIE_MASK;
+    DMA_Start(UART_RX_DMA_CH);
+    s_dma_ready = true;
+    tx_dma_kick();
+    return 0;
+}
 
-/* Helpers para ring buffer */
-static inline size_t rb_next(size_t idx, size_t size)
+size_t UART_RxRingHead(void)
 {
-    return (idx + 1u) % size;
+    // CITER vuelve a rx_size al dar la vuelta = índice 0
+    return (s_rx_ring_size - DMA_GetCount(UART_RX_DMA_CH)) & (s_rx_ring_size - 1u);
 }
 
-static inline bool rb_full(size_t head, size_t tail, size_t size)
+size_t UART_RxRingPending(uint32_t *tail)
 {
-    return rb_next(head, size) == tail;
+    uint32_t laps, head;
+    do
+    {
+        laps = s_rx_laps;
+        head = UART_RxRingHead();
+    } while (laps != s_rx_laps);
+
+    uint32_t written = laps * s_rx_ring_size + head;
+    if ((int32_t)(written - s_rx_written) < 0)
+    {
+        written += s_rx_ring_size;  // dio la vuelta y su ISR todavía no corrió
+    }
+    s_rx_written = written;
+
+    uint32_t pending = written - *tail;
+    if (pending > s_rx_ring_size)
+    {
+        s_rx_overflow += pending - s_rx_ring_size;
+        *tail = written - s_rx_ring_size;
+        pending = s_rx_ring_size;
+    }
+    return pending;
 }
+#endif
 
-static inline bool rb_empty(size_t head, size_t tail)
+uint32_t UART_RxOverflow(void)
 {
-    return head == tail;
+    return s_rx_overflow;
 }
 
 size_t UART_TxPending(void)
 {
-    if (s_tx_head >= s_tx_tail)
-        return s_tx_head - s_tx_tail;
-    return (UART_TX_BUF_SIZE - s_tx_tail) + s_tx_head;
+    return s_tx_head - s_tx_tail;
 }
 
 size_t UART_RxAvailable(void)
 {
-    if (s_rx_head >= s_rx_tail)
-        return s_rx_head - s_rx_tail;
-    return (UART_RX_BUF_SIZE - s_rx_tail) + s_rx_head;
+#if UART_DMA
+    return 0;
+#else
+    return s_rx_head - s_rx_tail;
+#endif
 }
 
 void UART_Poll(void)
 {
+#if UART_DMA
+    tx_dma_kick();
+#else
     /* RX: leer mientras haya datos */
     while (UART0->S1 & UART_S1_RDRF_MASK)
     {
@@ -54,21 +185,44 @@ void UART_Poll(void)
             continue;
         }
 
-        size_t next = rb_next(s_rx_head, UART_RX_BUF_SIZE);
-        if (rb_full(s_rx_head, s_rx_tail, UART_RX_BUF_SIZE))
+        if (s_rx_head - s_rx_tail == UART_RX_BUF_SIZE)
         {
-            s_rx_tail = rb_next(s_rx_tail, UART_RX_BUF_SIZE);
+            s_rx_tail++; /* lleno: se pierde el más viejo */
+            s_rx_overflow++;
         }
-        s_rx_buf[s_rx_head] = c;
-        s_rx_head = next;
+        s_rx_buf[s_rx_head & RX_MASK] = c;
+        s_rx_head++;
     }
 
     /* TX: mientras el HW esté listo y haya datos */
-    while ((UART0->S1 & UART_S1_TDRE_MASK) && !rb_empty(s_tx_head, s_tx_tail))
+    while ((UART0->S1 & UART_S1_TDRE_MASK) && s_tx_head != s_tx_tail)
     {
-        UART0->D = s_tx_buf[s_tx_tail];
-        s_tx_tail = rb_next(s_tx_tail, UART_TX_BUF_SIZE);
+        UART0->D = s_tx_buf[s_tx_tail & TX_MASK];
+        s_tx_tail++;
     }
+#endif
+}
+
+size_t UART_TxReserve(char **dst)
+{
+    uint32_t head = s_tx_head;
+    uint32_t room = UART_TX_BUF_SIZE - (head - s_tx_tail);
+    uint32_t contiguous = UART_TX_BUF_SIZE - (head & TX_MASK);
+
+    *dst = &s_tx_buf[head & TX_MASK];
+    return (room < contiguous) ? room : contiguous;
+}
+
+void UART_TxCommit(size_t n)
+{
+    if (n == 0)
+        return;
+
+    __DMB(); /* datos antes que el índice, también para el DMA */
+    s_tx_head += n;
+
+    /* Empujar inmediatamente lo que se pueda */
+    UART_Poll();
 }
 
 size_t UART_SendString(const char *str)
@@ -79,19 +233,23 @@ size_t UART_SendString(const char *str)
     size_t enq = 0;
     while (*str)
     {
-        size_t next = rb_next(s_tx_head, UART_TX_BUF_SIZE);
-        if (next == s_tx_tail)
+        char *dst;
+        size_t room = UART_TxReserve(&dst);
+        if (room == 0)
         {
             /* Buffer TX lleno: salir (no bloquear) */
             break;
         }
-        s_tx_buf[s_tx_head] = *str++;
-        s_tx_head = next;
-        enq++;
+        size_t n = 0;
+        while (n < room && str[n])
+        {
+            dst[n] = str[n];
+            n++;
+        }
+        str += n;
+        enq += n;
+        UART_TxCommit(n);
     }
-
-    /* Empujar inmediatamente lo que se pueda */
-    UART_Poll();
     return enq;
 }
 
@@ -101,12 +259,13 @@ int UART_ReceiveString(char *buffer, size_t max_len)
         return 0;
 
     size_t i = 0;
+#if !UART_DMA
     bool endline = false;
 
-    while ((i < (max_len - 1)) && !rb_empty(s_rx_head, s_rx_tail))
+    while ((i < (max_len - 1)) && s_rx_head != s_rx_tail)
     {
-        char c = s_rx_buf[s_rx_tail];
-        s_rx_tail = rb_next(s_rx_tail, UART_RX_BUF_SIZE);
+        char c = s_rx_buf[s_rx_tail & RX_MASK];
+        s_rx_tail++;
 
         if (c == '\n' || c == '\r')
         {
@@ -115,8 +274,9 @@ int UART_ReceiveString(char *buffer, size_t max_len)
         }
         buffer[i++] = c;
     }
+    (void)endline; /* útil si más adelante querés diferenciar línea completa o parcial */
+#endif
 
     buffer[i] = '\0';
-    (void)endline; /* útil si más adelante querés diferenciar línea completa o parcial */
     return (int)i;
 }
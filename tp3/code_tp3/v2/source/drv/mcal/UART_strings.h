@@ -3,10 +3,20 @@
 
 #include "UART.h"
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include "MK64F12.h"
 
-/* Ajustá los tamaños según tu caso de uso */
+// 1 = UART0 RX/TX por eDMA sin copias: RX va directo al anillo de UART_DmaInit
+// y TX sale del buffer que se llena con UART_TxReserve/UART_TxCommit.
+// 0 = polling de S1 en UART_Poll (camino original)
+#ifndef UART_DMA
+#define UART_DMA 1
+#endif
+#define UART_RX_DMA_CH 2
+#define UART_TX_DMA_CH 3
+
+/* Ajustá los tamaños según tu caso de uso (potencias de 2, índices con máscara) */
 #ifndef UART_TX_BUF_SIZE
 #define UART_TX_BUF_SIZE 1024
 #endif
@@ -15,6 +25,10 @@
 #define UART_RX_BUF_SIZE 1024
 #endif
 
+#if (UART_TX_BUF_SIZE & (UART_TX_BUF_SIZE - 1)) != 0 || (UART_RX_BUF_SIZE & (UART_RX_BUF_SIZE - 1)) != 0
+#error "UART_TX_BUF_SIZE and UART_RX_BUF_SIZE must be powers of 2"
+#endif
+
 /**
  * @brief Realiza polling no bloqueante del hardware UART.
  *
@@ -35,6 +49,13 @@ void UART_Poll(void);
  */
 size_t UART_SendString(const char *str);
 
+// Tramo contiguo libre del buffer TX para escribir en el lugar; 0 si está lleno.
+// Al llegar al final del buffer el resto sale en la llamada siguiente.
+size_t UART_TxReserve(char **dst);
+
+// Publica n bytes escritos en el tramo de UART_TxReserve y los empuja.
+void UART_TxCommit(size_t n);
+
 /**
  * @brief Copia de manera no bloqueante una "línea" desde el buffer RX.
  *
@@ -58,4 +79,25 @@ size_t UART_TxPending(void);
  */
 size_t UART_RxAvailable(void);
 
+// Bytes de RX pisados antes de leerse, desde el arranque: los que UART_Poll
+// descartó con el buffer lleno, o con UART_DMA los que encontró UART_RxRingPending.
+uint32_t UART_RxOverflow(void);
+
+#if UART_DMA
+// Arma los canales de RX y TX. Llamar después de UART_Init y DMA_Init.
+// rx_ring: potencia de 2 (<= 32767) que el DMA llena en círculo sin parar; el
+// consumidor lleva su índice y pregunta con UART_RxRingPending. Sin control de
+// flujo (ver UART_RxOverflow) y sin filtrar bytes con error de paridad.
+// UART_ReceiveString devuelve 0.
+int UART_DmaInit(volatile uint8_t *rx_ring, size_t rx_size);
+
+// Próximo índice que va a escribir el DMA de RX, en [0, rx_size).
+size_t UART_RxRingHead(void);
+
+// Bytes sin leer desde *tail (índice libre, se enmascara para leer), como mucho
+// rx_size. Si el DMA ya los pisó adelanta *tail al más viejo que queda y suma
+// los perdidos a UART_RxOverflow. Llamar siempre desde el mismo contexto.
+size_t UART_RxRingPending(uint32_t *tail);
+#endif
+
 #endif /* UART_ABSTRACT_H_ */
@@ -7,8 +7,10 @@ static bool initialized = false;
 typedef struct 
 {
     dma_cb_t on_major_cb;
+    dma_cb_t on_half_cb;
     void *user_param;
     bool active;
+    bool half_done;     // INTHALF of the loop in progress already serviced
 } dma_state_t;
 
 static dma_state_t dma_ch_states[DMA_NUM_CH];
@@ -49,7 +51,9 @@ int DMA_Config(const dma_cfg_t *cfg)
 
     // Remember config
     dma_ch_states[ch].on_major_cb = cfg->on_major;
+    dma_ch_states[ch].on_half_cb = cfg->on_half;
     dma_ch_states[ch].user_param = cfg->user;
+    dma_ch_states[ch].half_done = false;
 
 	// Clear all the pending events
 	NVIC_ClearPendingIRQ(DMA0_IRQn + ch);
@@ -57,6 +61,7 @@ int DMA_Config(const dma_cfg_t *cfg)
 	NVIC_EnableIRQ(DMA0_IRQn + ch);
 
     // Enable the eDMA channel 0 and set the PORTC as the DMA request source
+    DMAMUX->CHCFG[ch] = 0;
 	DMAMUX->CHCFG[ch] |= DMAMUX_CHCFG_ENBL_MASK 
                         |DMAMUX_CHCFG_SOURCE((uint8_t)cfg->request_src);
 
@@ -87,10 +92,20 @@ int DMA_Config(const dma_cfg_t *cfg)
 	DMA0->TCD[ch].DLAST_SGA = cfg->dlast;
 
 	/* Setup control and status register. */
+    uint16_t csr = 0;
     if (cfg->int_major)
     {
-	    DMA0->TCD[ch].CSR = DMA_CSR_INTMAJOR_MASK;	//Enable Major Interrupt.
+	    csr |= DMA_CSR_INTMAJOR_MASK;	//Enable Major Interrupt.
     }
+    if (cfg->int_half)
+    {
+        csr |= DMA_CSR_INTHALF_MASK;    //Enable Half Interrupt (CITER == BITER / 2).
+    }
+    if (cfg->one_shot)
+    {
+        csr |= DMA_CSR_DREQ_MASK;       //Disarm the channel when the major loop ends.
+    }
+    DMA0->TCD[ch].CSR = csr;
 
     return 0;
 }
@@ -120,6 +135,14 @@ int DMA_Stop(uint8_t ch)
     return 0;
 }
 
+// With a circular destination the write index is major_count - CITER
+uint16_t DMA_GetCount(uint8_t ch)
+{
+    if (ch >= DMA_NUM_CH) return 0;
+
+    return DMA0->TCD[ch].CITER_ELINKNO & DMA_CITER_ELINKNO_CITER_MASK;
+}
+
 static int size2code(uint8_t bytes) 
 {
     switch (bytes) 
@@ -133,12 +156,40 @@ static int size2code(uint8_t bytes)
 
 static void DMA_IRQHandler(uint8_t ch)
 {
+    dma_state_t *st = &dma_ch_states[ch];
+
 	/* Clear the interrupt flag. */
-	DMA0->CINT |= DMA_CINT_CINT(ch);
-	if(dma_ch_states[ch].on_major_cb)
+	DMA0->CINT = DMA_CINT_CINT(ch);
+
+    /* Half and major share the INT flag, so a late entry can find both pending.
+       DONE, or a loop still in its first half (the next request already cleared
+       DONE), means the last major loop ended: its half runs first if it was not
+       serviced. Otherwise it is the INTHALF of the loop in progress. A latency
+       over half a loop is an overrun and is not detected here. */
+    uint16_t csr = DMA0->TCD[ch].CSR;
+    uint16_t citer = DMA0->TCD[ch].CITER_ELINKNO & DMA_CITER_ELINKNO_CITER_MASK;
+    uint16_t biter = DMA0->TCD[ch].BITER_ELINKNO & DMA_BITER_ELINKNO_BITER_MASK;
+    if ((csr & DMA_CSR_DONE_MASK) || citer > biter / 2)
     {
-		dma_ch_states[ch].on_major_cb(dma_ch_states[ch].user_param);
-	}
+        if ((csr & DMA_CSR_INTHALF_MASK) && !st->half_done && st->on_half_cb)
+        {
+            st->on_half_cb(st->user_param);
+        }
+        st->half_done = false;
+        DMA0->CDNE = DMA_CDNE_CDNE(ch);
+        if (st->on_major_cb)
+        {
+            st->on_major_cb(st->user_param);
+        }
+    }
+    else if (!st->half_done)
+    {
+        st->half_done = true;
+        if (st->on_half_cb)
+        {
+            st->on_half_cb(st->user_param);
+        }
+    }
 }
 
 __ISR__ DMA0_IRQHandler(void){ DMA_IRQHandler(0); }
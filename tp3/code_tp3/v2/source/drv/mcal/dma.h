@@ -94,15 +94,17 @@ typedef struct
     int32_t slast;          // pointer adjust @major end (source)
     int32_t dlast;          // pointer adjust @major end (dest)
     bool int_major;         // false/true
-    //bool int_half;          // false/true
+    bool int_half;          // false/true, IRQ at CITER == BITER/2 (ping-pong)
     dma_cb_t on_major;      // may be NULL
-    //dma_cb_t on_half;       // may be NULL
+    dma_cb_t on_half;       // may be NULL
     void *user;             // user cookie for both callbacks
+    bool one_shot;          // DREQ: clear ERQ at major end instead of restarting
 } dma_cfg_t;
 
 int DMA_Init(void);                     // clocks, NVIC
 int DMA_Config(const dma_cfg_t *cfg);   // write TCD + DMAMUX
 int DMA_Start(uint8_t ch);              // set ERQ (arm)
 int DMA_Stop(uint8_t ch);               // clear ERQ (disarm)
+uint16_t DMA_GetCount(uint8_t ch);      // CITER: elements left in the current major loop
 
 #endif
\ No newline at end of file
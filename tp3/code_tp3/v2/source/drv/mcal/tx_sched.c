@@ -0,0 +1,77 @@
+#include <stddef.h>
+
+#include "tx_sched.h"
+#include "bitstream.h"
+
+void TxSched_Init(TxSched *s, uint8_t guard_bits, TxSched_PullFn pull, void *user)
+{
+    s->pull = pull;
+    s->user = user;
+    s->guard_bits = guard_bits;
+    s->bits_left = 0;
+    s->guard_left = 0;
+    s->shift = 0;
+    s->bits = 0;
+    s->idle_bits = 0;
+    s->bytes = 0;
+    s->last_bits = 0;
+    s->last_bytes = 0;
+}
+
+bool TxSched_NextBit(TxSched *s)
+{
+    s->bits++;
+
+    if (s->bits_left == 0)
+    {
+        if (s->guard_left > 0)
+        {
+            s->guard_left--;
+            return true;
+        }
+        uint8_t byte;
+        if (s->pull == NULL || !s->pull(s->user, &byte))
+        {
+            s->idle_bits++;
+            return true;
+        }
+        s->shift = data_to_uart(byte);
+        s->bits_left = BITSTREAM_SIZE;
+    }
+
+    bool bit = s->shift & 1u;
+    s->shift >>= 1;
+    if (--s->bits_left == 0)
+    {
+        // the stop bit is going out: the byte counts and the guard follows
+        s->bytes++;
+        s->guard_left = s->guard_bits;
+    }
+    return bit;
+}
+
+bool TxSched_Busy(const TxSched *s)
+{
+    return s->bits_left != 0 || s->guard_left != 0;
+}
+
+bool TxSched_Measure(TxSched *s, uint32_t baud, uint32_t window_bits, TxSched_Rate *out)
+{
+    // bytes first: a byte finishing in between shows up in the next window
+    uint32_t bytes = s->bytes;
+    uint32_t bits = s->bits;
+    uint32_t d_bits = bits - s->last_bits;
+    if (d_bits == 0 || d_bits < window_bits)
+    {
+        return false;
+    }
+    uint32_t d_bytes = bytes - s->last_bytes;
+    s->last_bits = bits;
+    s->last_bytes = bytes;
+
+    out->bytes_per_s = (uint32_t)(((uint64_t)d_bytes * baud) / d_bits);
+    out->line_bytes_per_s = baud / BITSTREAM_SIZE;
+    uint64_t busy = (uint64_t)d_bytes * (BITSTREAM_SIZE + s->guard_bits) * 1000u / d_bits;
+    out->busy_permille = busy > 1000u ? 1000u : (uint32_t)busy;
+    return true;
+}
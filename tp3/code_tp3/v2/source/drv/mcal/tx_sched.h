@@ -0,0 +1,55 @@
+#ifndef TX_SCHED_H
+#define TX_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Transmit scheduler: turns a byte queue into the modem bit sequence.
+// Bytes go out back-to-back (UART frame + guard_bits extra mark bits) and
+// idle (mark) is inserted one bit at a time only while the queue is empty.
+// TxSched_NextBit() runs in the NCO context (DMA ISR); the bit and byte
+// counters are only written there and read by TxSched_Measure().
+
+// Extra mark bits after each stop bit (0 = back-to-back frames)
+#ifndef TX_SCHED_GUARD_BITS
+#define TX_SCHED_GUARD_BITS 0u
+#endif
+
+// Returns false when the queue is empty
+typedef bool (*TxSched_PullFn)(void *user, uint8_t *byte);
+
+typedef struct
+{
+    TxSched_PullFn pull;
+    void *user;
+    uint8_t guard_bits;
+    uint8_t bits_left;          // bits of the current frame, 0 = between frames
+    uint8_t guard_left;
+    uint16_t shift;             // current frame, LSB first
+    volatile uint32_t bits;     // bits sent since TxSched_Init
+    volatile uint32_t idle_bits;
+    volatile uint32_t bytes;
+    uint32_t last_bits;         // counters at the last TxSched_Measure
+    uint32_t last_bytes;
+} TxSched;
+
+typedef struct
+{
+    uint32_t bytes_per_s;       // achieved over the window
+    uint32_t line_bytes_per_s;  // theoretical: baud / BITSTREAM_SIZE
+    uint32_t busy_permille;     // share of the window carrying frames
+} TxSched_Rate;
+
+void TxSched_Init(TxSched *s, uint8_t guard_bits, TxSched_PullFn pull, void *user);
+
+// Next line bit (true = mark), one call per bit period
+bool TxSched_NextBit(TxSched *s);
+
+// True from the start bit to the last guard bit
+bool TxSched_Busy(const TxSched *s);
+
+// Throughput since the previous call, timed by the bit clock itself
+// (elapsed time = bits / baud). Returns false until window_bits have passed.
+bool TxSched_Measure(TxSched *s, uint32_t baud, uint32_t window_bits, TxSched_Rate *out);
+
+#endif
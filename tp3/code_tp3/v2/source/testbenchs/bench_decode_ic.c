@@ -0,0 +1,321 @@
+/**
+ * @file bench_decode_ic.c
+ * @brief Bench de host del RX por input capture: frame error rate del
+ * decodificador por ring de DMA (DECODE_IC_DMA) contra el camino original de
+ * ISR por flanco + PIT, con jitter en las capturas.
+ *
+ * Señal: FSK de fase continua (DECODE_F_MARK/DECODE_F_SPACE) a DECODE_BAUD,
+ * LEAD_BITS de idle, N_FRAMES frames data_to_uart() con datos de rand() y
+ * gap_bits de idle después de cada uno. Cada cruce por cero es una captura
+ * del FTM3 CH5 (ambos flancos) a DECODE_IC_CLK_HZ, con jitter gaussiano de
+ * jitter_us de sigma y truncada a 16 bits como el CnV.
+ *
+ * Nuevo: DECODE_V2.c tal cual. Las capturas se escriben en el ring que armó
+ * DECODE_Init() y se llaman on_half/on_major como lo haría el DMA ch1; los
+ * frames salen por DECODE_GetFrame().
+ * Viejo: copia de IC_ISR() de FTM.c (frecuencia por semiperíodo y cuenta de
+ * bit_start) con processBit()/bitStartDetected() de DECODE_V2.c, y el PIT ch2
+ * de app.c a 833 us fijos, arrancado en el flanco en que bitStartDetected()
+ * da true (App_Run sin latencia).
+ * En los dos los frames pasan por validateBitStream() (copia de app.c) y
+ * deformat_bitstream().
+ *
+ * Un frame transmitido cuenta como recibido si su dato sale en orden, entre
+ * MATCH_EARLY bits antes y MATCH_LATE bits después del final de su stop (el
+ * camino nuevo entrega de a 32 capturas y el viejo a 2400 baud tarda 10 x
+ * 833 us); los demás (perdidos, errados o rechazados por paridad) son
+ * errores de frame.
+ *
+ * Uso: bench_decode_ic [gap_bits] [jitter_us]
+ * Imprime una fila CSV: baud,gap_bits,jitter_us,frames,fer_old,fer_new,dropped
+ *
+ * Compilar desde este directorio con:
+ *   gcc -O2 -Wall -Wextra -std=gnu11 -Wno-int-to-pointer-cast
+ *       -I .. -I ../drv/mcal -I ../../SDK/CMSIS -I ../../SDK/startup
+ *       -DCPU_MK64FN1M0VLL12 -o bench_decode_ic bench_decode_ic.c
+ *       ../drv/mcal/DECODE_V2.c ../drv/mcal/bitstream.c -lm
+ * Agregar -DDECODE_BAUD=2400 para el otro perfil; el PIT del camino viejo
+ * queda en 833 us como en app.c. bench_decode_ic.sh corre la tabla completa.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "drv/mcal/DECODE_V2.h"
+#include "drv/mcal/FTM.h"
+#include "drv/mcal/bitstream.h"
+#include "drv/mcal/dma.h"
+
+#define N_FRAMES 2000u
+#define LEAD_BITS 20u
+#define TAIL_BITS 80u           // idle al final: vacía el ring (>= 64 capturas)
+#define DEFAULT_GAP 4u
+#define MATCH_EARLY 2u
+#define MATCH_LATE 48u
+#define PIT_PERIOD_S 833e-6     // PIT_TICKS_FROM_US(833) de app.c
+
+static uint8_t payload[N_FRAMES];
+static int64_t frame_end[N_FRAMES];     // fin del stop en ticks
+static int64_t *captures;       // ticks del FTM3 desenrollados
+static size_t n_captures;
+
+// ---- stubs de dma.c: el bench hace de DMA ch1 ----
+
+static dma_cfg_t ic_dma;
+
+int DMA_Config(const dma_cfg_t *cfg)
+{
+    ic_dma = *cfg;
+    return 0;
+}
+
+int DMA_Start(uint8_t ch)
+{
+    (void)ch;
+    return 0;
+}
+
+// ---- copia de IC_ISR() y sus getters (FTM.c) ----
+
+static uint32_t ic_freq;
+static int16_t bit_start;
+
+double IC_getFrequency(void)
+{
+    return ic_freq;
+}
+
+uint8_t IC_getBitStart(void)
+{
+    return bit_start;
+}
+
+void IC_clearBitStart(void)
+{
+    bit_start = 0;
+}
+
+static void ic_isr(int64_t medision)
+{
+    static int64_t prev_p;
+    static uint32_t prev_f;
+
+    int64_t period = medision - prev_p;
+    prev_p = medision;
+    if (period <= 0)
+    {
+        return;
+    }
+    uint32_t freq = (uint32_t)((50e6 / 16.0) / (2.0 * period));
+
+    if (freq > 1700 && freq < 3500)
+    {
+        ic_freq = 2200;
+        if (prev_f == 2200)
+        {
+            bit_start++;
+        }
+    }
+    else if (freq > 900 && freq < 1700)
+    {
+        ic_freq = 1200;
+        bit_start = 0;
+    }
+    prev_f = ic_freq;
+}
+
+// ---- copia de validateBitStream() (app.c) ----
+
+static bool validate(const bool *in)
+{
+    if (in[10] != 1)
+    {
+        return false;
+    }
+    int count = 0;
+    for (int i = 1; i < 10; i++)
+    {
+        count += in[i];
+    }
+    return count % 2;
+}
+
+// ---- señal ----
+
+static double gauss(void)
+{
+    double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+static void add_bits(uint64_t *bit_no, double *phase, bool mark, unsigned n_bits,
+                     double sigma_ticks)
+{
+    const double bit_s = 1.0 / DECODE_BAUD;
+    const double f = mark ? DECODE_F_MARK : DECODE_F_SPACE;
+    for (unsigned b = 0; b < n_bits; b++)
+    {
+        double t0 = (double)(*bit_no)++ * bit_s;
+        double end = *phase + f * bit_s;
+        // cruces por cero: fase en múltiplos de medio ciclo
+        for (double k = floor(2.0 * *phase) + 1.0; k <= 2.0 * end; k += 1.0)
+        {
+            double t = t0 + (k / 2.0 - *phase) / f;
+            int64_t tick = llround(t * DECODE_IC_CLK_HZ + sigma_ticks * gauss());
+            if (n_captures > 0 && tick <= captures[n_captures - 1])
+            {
+                tick = captures[n_captures - 1] + 1;
+            }
+            captures[n_captures++] = tick;
+        }
+        *phase = end - floor(end);
+    }
+}
+
+static void make_captures(unsigned gap_bits, double jitter_us)
+{
+    const double sigma = jitter_us * 1e-6 * DECODE_IC_CLK_HZ;
+    const size_t max_bits = LEAD_BITS + N_FRAMES * (DECODE_FRAME_BITS + gap_bits) + TAIL_BITS;
+    // como mucho DECODE_F_SPACE / DECODE_BAUD ciclos por bit, + 1 cruce de borde
+    captures = malloc((max_bits * (2u * DECODE_F_SPACE / DECODE_BAUD + 2u)) * sizeof(*captures));
+    if (captures == NULL)
+    {
+        exit(2);
+    }
+    uint64_t bit_no = 0;
+    double phase = 0.0;
+    add_bits(&bit_no, &phase, true, LEAD_BITS, sigma);
+    for (size_t i = 0; i < N_FRAMES; i++)
+    {
+        payload[i] = (uint8_t)rand();
+        uint16_t frame = data_to_uart(payload[i]);
+        for (unsigned b = 0; b < DECODE_FRAME_BITS; b++)
+        {
+            add_bits(&bit_no, &phase, (frame >> b) & 1u, 1, sigma);
+        }
+        frame_end[i] = llround((double)bit_no * DECODE_IC_CLK_HZ / DECODE_BAUD);
+        add_bits(&bit_no, &phase, true, gap_bits, sigma);
+    }
+    add_bits(&bit_no, &phase, true, TAIL_BITS, sigma);
+}
+
+// ---- comparación ----
+
+typedef struct
+{
+    size_t next;    // próximo frame transmitido esperado
+    size_t ok;
+} match_t;
+
+// Frame decodificado en el tick t
+static void match(match_t *m, const bool bits[DECODE_FRAME_BITS], int64_t t)
+{
+    if (!validate(bits))
+    {
+        return;
+    }
+    const int64_t bit_ticks = DECODE_IC_CLK_HZ / DECODE_BAUD;
+    while (m->next < N_FRAMES && frame_end[m->next] + MATCH_LATE * bit_ticks < t)
+    {
+        m->next++;  // ya no puede llegar: perdido
+    }
+    uint8_t data = (uint8_t)deformat_bitstream((bool *)bits);
+    for (size_t j = m->next; j < N_FRAMES && frame_end[j] <= t + MATCH_EARLY * bit_ticks; j++)
+    {
+        if (payload[j] == data)
+        {
+            m->ok++;
+            m->next = j + 1;
+            return;
+        }
+    }
+}
+
+// ---- los dos caminos ----
+
+static size_t run_new(void)
+{
+    match_t m = { 0, 0 };
+    bool bits[DECODE_FRAME_BITS];
+    DECODE_Init();
+    volatile uint16_t *ring = ic_dma.daddr;
+    uint32_t idx = 0;
+    for (size_t i = 0; i < n_captures; i++)
+    {
+        ring[idx++] = (uint16_t)captures[i];
+        if (idx == ic_dma.major_count / 2u)
+        {
+            ic_dma.on_half(ic_dma.user);
+        }
+        else if (idx == ic_dma.major_count)
+        {
+            ic_dma.on_major(ic_dma.user);
+            idx = 0;
+        }
+        else
+        {
+            continue;
+        }
+        while (DECODE_GetFrame(bits))
+        {
+            match(&m, bits, captures[i]);
+        }
+    }
+    return m.ok;
+}
+
+static size_t run_old(void)
+{
+    match_t m = { 0, 0 };
+    bool bits[DECODE_FRAME_BITS] = { 0 };
+    const int64_t pit_ticks = llround(PIT_PERIOD_S * DECODE_IC_CLK_HZ);
+    bool pit_on = false;
+    int64_t pit_next = 0;
+    unsigned cnt = 1;
+
+    for (size_t i = 0; i < n_captures; i++)
+    {
+        // ISRs del PIT que vencen antes de esta captura
+        while (pit_on && pit_next <= captures[i])
+        {
+            bits[cnt] = processBit();
+            cnt++;
+            pit_next += pit_ticks;
+            if (cnt == DECODE_FRAME_BITS)
+            {
+                pit_on = false;
+                cnt = 1;
+                clearReadingFlag();
+                IC_clearBitStart();
+                match(&m, bits, pit_next - pit_ticks);
+            }
+        }
+        ic_isr(captures[i]);
+        if (bitStartDetected())
+        {
+            setReadingFlag();
+            pit_on = true;
+            pit_next = captures[i] + pit_ticks;
+        }
+    }
+    return m.ok;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned gap_bits = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 0) : DEFAULT_GAP;
+    double jitter_us = (argc > 2) ? atof(argv[2]) : 0.0;
+
+    srand(1);
+    make_captures(gap_bits, jitter_us);
+    size_t ok_old = run_old();
+    size_t ok_new = run_new();
+    free(captures);
+
+    printf("%u,%u,%.1f,%u,%.4f,%.4f,%lu\n", DECODE_BAUD, gap_bits, jitter_us, N_FRAMES,
+           1.0 - (double)ok_old / N_FRAMES, 1.0 - (double)ok_new / N_FRAMES,
+           (unsigned long)DECODE_GetDropped());
+    return 0;
+}
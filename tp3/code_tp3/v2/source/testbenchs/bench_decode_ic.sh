@@ -0,0 +1,24 @@
+#!/bin/sh
+# Compila bench_decode_ic.c para 1200 y 2400 baud y barre el jitter de las
+# capturas, con 4 bits de idle entre frames y con frames pegados. Junta todas
+# las filas en un solo CSV. Correr desde este directorio:
+#   ./bench_decode_ic.sh > decode_ic.csv
+
+set -e
+
+CC=${CC:-gcc}
+BIN=${TMPDIR:-/tmp}/bench_decode_ic.$$
+trap 'rm -f "$BIN"' EXIT
+
+echo "baud,gap_bits,jitter_us,frames,fer_old,fer_new,dropped"
+for baud in 1200 2400; do
+    "$CC" -O2 -std=gnu11 -Wall -Wextra -Wno-int-to-pointer-cast \
+        -I .. -I ../drv/mcal -I ../../SDK/CMSIS -I ../../SDK/startup \
+        -DCPU_MK64FN1M0VLL12 -DDECODE_BAUD=$baud -o "$BIN" \
+        bench_decode_ic.c ../drv/mcal/DECODE_V2.c ../drv/mcal/bitstream.c -lm
+    for gap in 4 0; do
+        for jitter in 0 10 20 30; do
+            "$BIN" $gap $jitter
+        done
+    done
+done